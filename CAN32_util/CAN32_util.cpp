@@ -4,6 +4,91 @@
 
 uint8_t pdmslimit = 1;
 
+// RX dispatcher state
+struct CAN32_RxEntry {
+  uint32_t identifier;
+  bool extd;
+  CAN32_RxHandler handler;
+  void* ctx;
+};
+static CAN32_RxEntry _rxHandlers[CAN32_MAX_RX_HANDLERS];
+static uint8_t _rxHandlerCount = 0;
+static CAN32_RxRouter _rxRouter = nullptr;
+static CAN32_RxHandler _rxDefaultHandler = nullptr;
+static void* _rxDefaultCtx = nullptr;
+static TaskHandle_t _rxTaskHandle = nullptr;
+static volatile bool _rxTaskRun = false;
+static volatile bool _rxTaskDone = true;  // Set by the task as its very last step
+static CAN32_RxStats _rxStats;  // Working copy, only the RX task touches it
+// Published copy for CAN32_getRxStats, same seqlock as the health monitor below
+static const size_t CAN32_RX_STATS_WORDS = (sizeof(CAN32_RxStats) + 3) / 4;
+static uint32_t _rxStatsWords[CAN32_RX_STATS_WORDS];
+static uint32_t _rxStatsSeq = 0;
+
+// TX scheduler state
+struct CAN32_TxSlot {
+  twai_message_t msg;
+  uint32_t deadline;  // millis() value, valid when hasDeadline
+  uint32_t seq;       // Queue order, kept when the payload is replaced
+  uint32_t version;   // Bumped on every payload write
+  uint8_t priority;
+  bool hasDeadline;
+  bool used;
+  bool inFlight;      // Claimed by a CAN32_serviceTxQueue caller, being handed to the driver
+  uint32_t flightVersion;  // Version of the payload in flight
+};
+static CAN32_TxSlot _txSlots[CAN32_TX_SLOTS];
+static uint32_t _txSeq = 0;
+static uint32_t _txVersion = 0;
+static uint8_t _txPending = 0;
+static CAN32_TxStats _txStats;
+static portMUX_TYPE _txMux = portMUX_INITIALIZER_UNLOCKED;
+
+// Health monitor state
+static uint32_t _pendingAlerts = 0;   // Raised while the RX task owned the alert queue
+static uint32_t _healthAlerts = 0;    // Taken by anyone, not yet counted by CAN32_pollHealth
+static CAN32_Health _health;              // Working copy, only CAN32_pollHealth touches it
+// Published copy for CAN32_getHealth, same seqlock as AmsSnapshot (ams_snapshot.h)
+static const size_t CAN32_HEALTH_WORDS = (sizeof(CAN32_Health) + 3) / 4;
+static uint32_t _healthWords[CAN32_HEALTH_WORDS];
+static uint32_t _healthSeq = 0;           // Odd while _healthWords is being written
+static bool _autoRecovery = true;
+static bool _recoveryStarted = false;
+static uint32_t _busOffSince = 0;
+static uint32_t _lastHealthPoll = 0;
+static uint32_t _rateWindowStart = 0;
+static uint32_t _rateWindowErrors = 0;
+
+// Seqlock write side: readers retry while the count is odd. Word-wise relaxed
+// atomics so the copy racing a reader is not a data race. One writer per seq.
+template <typename T, size_t N>
+static void CAN32_seqPublish(uint32_t* seqCount, uint32_t (&words)[N], const T& src) {
+  static_assert(sizeof(T) <= sizeof(words), "Published words too small");
+  uint32_t copy[N] = {};
+  memcpy(copy, &src, sizeof(T));
+  uint32_t seq = __atomic_load_n(seqCount, __ATOMIC_RELAXED);
+  __atomic_store_n(seqCount, seq + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  for (size_t i = 0; i < N; i++) __atomic_store_n(&words[i], copy[i], __ATOMIC_RELAXED);
+  __atomic_store_n(seqCount, seq + 2, __ATOMIC_RELEASE);
+}
+
+template <typename T, size_t N>
+static void CAN32_seqRead(const uint32_t* seqCount, const uint32_t (&words)[N], T* dst) {
+  uint32_t copy[N];
+  for (uint32_t attempt = 1;; attempt++) {
+    uint32_t before = __atomic_load_n(seqCount, __ATOMIC_ACQUIRE);
+    if (!(before & 1)) {
+      for (size_t i = 0; i < N; i++) copy[i] = __atomic_load_n(&words[i], __ATOMIC_RELAXED);
+      __atomic_thread_fence(__ATOMIC_ACQUIRE);
+      if (__atomic_load_n(seqCount, __ATOMIC_RELAXED) == before) break;
+    }
+    // Preempted the writer on its own core: let it finish
+    if (attempt % 64 == 0) delay(1);
+  }
+  memcpy(dst, copy, sizeof(T));
+}
+
 // No BUS ID Filter (Accept all)
 bool CAN32_initCANBus(int can_tx,int can_rx,
                 twai_timing_config_t t_config) {
@@ -13,8 +98,9 @@ bool CAN32_initCANBus(int can_tx,int can_rx,
   // Configure CAN timing for 250 kbps (as per your code)
   twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)can_tx,(gpio_num_t)can_rx,TWAI_MODE_NORMAL);
   twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
-  g_config.rx_queue_len = 32;
-  g_config.tx_queue_len = 6;
+  g_config.alerts_enabled = CAN32_DEFAULT_ALERTS;
+  g_config.rx_queue_len = CAN32_RX_QUEUE_LEN;
+  g_config.tx_queue_len = CAN32_TX_QUEUE_LEN;
   // Install TWAI driver
   if (twai_driver_install(&g_config, &t_config, &f_config) == ESP_OK) {
     Serial.println(" Driver installed");
@@ -41,8 +127,9 @@ bool CAN32_initCANBus(int can_tx,int can_rx,
   
   // Configure CAN timing for 250 kbps (as per your code)
   twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT((gpio_num_t)can_tx,(gpio_num_t)can_rx,TWAI_MODE_NORMAL);
-  g_config.rx_queue_len = 32;
-  g_config.tx_queue_len = 32;
+  g_config.alerts_enabled = CAN32_DEFAULT_ALERTS;
+  g_config.rx_queue_len = CAN32_RX_QUEUE_LEN;
+  g_config.tx_queue_len = CAN32_TX_QUEUE_LEN;
   // Install TWAI driver
   if (twai_driver_install(&g_config, &t_config, &f_config) == ESP_OK) {
     Serial.println(" Driver installed");
@@ -81,7 +168,17 @@ int CAN32_receiveCAN(twai_message_t* rx_msg, bool canbusready) {
   // Error Handling will be for user
 }
 
-void CAN32_twai_debug(uint32_t alerts_trigger){
+// Alerts are consumed by one reader only: the RX task when it runs, else the caller.
+// Every alert passes through here so the health counters never miss one.
+static uint32_t CAN32_takeAlerts() {
+  uint32_t alerts = 0;
+  if (_rxTaskHandle) alerts = __atomic_exchange_n(&_pendingAlerts, 0, __ATOMIC_ACQ_REL);
+  else twai_read_alerts(&alerts, 0);
+  if (alerts) __atomic_fetch_or(&_healthAlerts, alerts, __ATOMIC_RELEASE);
+  return alerts;
+}
+
+void CAN32_twai_debug(uint32_t &alerts_trigger){
   //Debug and troubleshoot TWAI bus
   /*
   TWAI_ALERT_RX_DATA        0x00000004    Alert(4)    : A frame has been received and added to the RX queue
@@ -91,8 +188,8 @@ void CAN32_twai_debug(uint32_t alerts_trigger){
   */
   //Error Alert message
   twai_status_info_t status_info;
-  // Configure alert anable
-  twai_read_alerts(&alerts_trigger, pdMS_TO_TICKS(1));
+  // Non blocking, alerts handed back to the caller
+  alerts_trigger = CAN32_takeAlerts();
   twai_get_status_info(&status_info);
   // Serial.println(alerts_triggered); // can be twai alert all
   
@@ -104,7 +201,7 @@ void CAN32_twai_debug(uint32_t alerts_trigger){
         Serial.println("STOPPED");
         break;
       case TWAI_STATE_BUS_OFF:
-        Serial.println("BUS OFF - Recovery needed!");
+        Serial.println(_autoRecovery ? "BUS OFF - Auto recovery (CAN32_pollHealth)" : "BUS OFF - Recovery needed!");
         break;
       case TWAI_STATE_RECOVERING:  
         Serial.println("REOCVERING TEC REC PLESE WAIT");
@@ -128,4 +225,487 @@ void CAN32_debugFrame(twai_message_t* rx_msg){
   for (int i = 0; i < rx_msg->data_length_code; i++) 
       Serial.printf("%X",rx_msg->data[i]);
   Serial.println();
-}
\ No newline at end of file
+}
+
+// ============================================================================
+// RX DISPATCHER TASK
+// ============================================================================
+
+bool CAN32_registerRxHandler(uint32_t identifier, bool extd, CAN32_RxHandler handler, void* ctx) {
+  // Re-registering an ID replaces its handler
+  for (uint8_t i = 0; i < _rxHandlerCount; i++) {
+    if (_rxHandlers[i].identifier == identifier && _rxHandlers[i].extd == extd) {
+      _rxHandlers[i].handler = handler;
+      _rxHandlers[i].ctx = ctx;
+      return true;
+    }
+  }
+  if (_rxHandlerCount >= CAN32_MAX_RX_HANDLERS) return false;
+  _rxHandlers[_rxHandlerCount++] = {identifier, extd, handler, ctx};
+  return true;
+}
+
+void CAN32_setDefaultRxHandler(CAN32_RxHandler handler, void* ctx) {
+  _rxDefaultHandler = handler;
+  _rxDefaultCtx = ctx;
+}
+
+void CAN32_setRxRouter(CAN32_RxRouter router) {
+  _rxRouter = router;
+}
+
+void CAN32_routeTableError(const char* reason) {
+  // Only reachable when a route table is built at runtime
+  Serial.printf("[CAN] Route table error: %s\n", reason);
+}
+
+static void CAN32_dispatchFrame(const twai_message_t* rx_msg) {
+  if (_rxRouter && _rxRouter(rx_msg)) {
+    _rxStats.dispatched++;
+    return;
+  }
+  for (uint8_t i = 0; i < _rxHandlerCount; i++) {
+    if (_rxHandlers[i].identifier == rx_msg->identifier && _rxHandlers[i].extd == (bool)rx_msg->extd) {
+      _rxHandlers[i].handler(rx_msg, _rxHandlers[i].ctx);
+      _rxStats.dispatched++;
+      return;
+    }
+  }
+  _rxStats.unhandled++;
+  if (_rxDefaultHandler) _rxDefaultHandler(rx_msg, _rxDefaultCtx);
+}
+
+static void CAN32_rxTask(void* arg) {
+  twai_message_t rx_msg;
+  uint32_t alerts = 0;
+  while (_rxTaskRun) {
+    // Timeout only so a stop request is noticed, frames wake us through the alert
+    alerts = 0;
+    twai_read_alerts(&alerts, pdMS_TO_TICKS(100));
+    _rxStats.wakeups++;
+    if (alerts & TWAI_ALERT_RX_QUEUE_FULL) _rxStats.rxQueueFull++;
+    // Leave everything but RX_DATA for CAN32_pollHealth / CAN32_twai_debug
+    if (alerts & ~TWAI_ALERT_RX_DATA) __atomic_fetch_or(&_pendingAlerts, alerts & ~TWAI_ALERT_RX_DATA, __ATOMIC_RELEASE);
+
+    // Drain everything queued, one alert may stand for many frames
+    uint32_t burst = 0;
+    while (twai_receive(&rx_msg, 0) == ESP_OK) {
+      _rxStats.received++;
+      burst++;
+      CAN32_dispatchFrame(&rx_msg);
+    }
+    if (burst > _rxStats.maxBurst) _rxStats.maxBurst = burst;
+    CAN32_seqPublish(&_rxStatsSeq, _rxStatsWords, _rxStats);
+  }
+  _rxTaskHandle = nullptr;
+  _rxTaskDone = true;
+  vTaskDelete(nullptr);
+}
+
+bool CAN32_startRxTask(int priority, int core, uint32_t stackSize) {
+  if (!_rxTaskDone) return true;  // Already running
+  if (twai_reconfigure_alerts(CAN32_DEFAULT_ALERTS | TWAI_ALERT_RX_DATA, nullptr) != ESP_OK) {
+    Serial.println("[CAN] ERROR: Could not enable RX alerts (driver installed?)");
+    return false;
+  }
+  _rxTaskRun = true;
+  _rxTaskDone = false;
+  if (xTaskCreatePinnedToCore(CAN32_rxTask, "CAN32_rx", stackSize, nullptr,
+                              priority, &_rxTaskHandle, core) != pdPASS) {
+    _rxTaskRun = false;
+    _rxTaskDone = true;
+    _rxTaskHandle = nullptr;
+    Serial.println("[CAN] ERROR: Could not create RX task");
+    return false;
+  }
+  return true;
+}
+
+void CAN32_stopRxTask() {
+  // Task exits on its next wakeup (<= 100 ms). Wait for it, so a start right
+  // after this never finds a task that has already left its loop.
+  _rxTaskRun = false;
+  while (!_rxTaskDone) delay(1);
+}
+
+void CAN32_getRxStats(CAN32_RxStats* stats) {
+  CAN32_seqRead(&_rxStatsSeq, _rxStatsWords, stats);
+}
+
+// ============================================================================
+// TX SCHEDULER
+// ============================================================================
+
+int CAN32_queueCAN(const twai_message_t* tx_msg, uint8_t priority, uint32_t deadlineMs) {
+  uint32_t now = millis();
+  int result = ESP_OK;
+  portENTER_CRITICAL(&_txMux);
+  int freeSlot = -1;
+  int match = -1;
+  for (int i = 0; i < CAN32_TX_SLOTS; i++) {
+    if (!_txSlots[i].used) {
+      if (freeSlot < 0) freeSlot = i;
+    } else if (_txSlots[i].msg.identifier == tx_msg->identifier && _txSlots[i].msg.extd == tx_msg->extd) {
+      match = i;
+      break;
+    }
+  }
+  int slot = (match >= 0) ? match : freeSlot;
+  if (slot < 0) {
+    _txStats.rejected++;
+    result = ESP_ERR_NO_MEM;
+  } else {
+    CAN32_TxSlot& s = _txSlots[slot];
+    if (match >= 0) {
+      // A payload already in flight is being sent, the new one simply goes next
+      if (!s.inFlight || s.version != s.flightVersion) _txStats.coalesced++;
+    } else {
+      s.seq = _txSeq++;  // Replaced payloads keep their place in line
+      _txPending++;
+      if (_txPending > _txStats.peakPending) _txStats.peakPending = _txPending;
+    }
+    s.msg = *tx_msg;
+    s.version = _txVersion++;
+    s.priority = priority;
+    s.hasDeadline = (deadlineMs > 0);
+    s.deadline = now + deadlineMs;
+    s.used = true;
+    _txStats.queued++;
+  }
+  portEXIT_CRITICAL(&_txMux);
+
+  CAN32_serviceTxQueue();
+  return result;
+}
+
+void CAN32_serviceTxQueue() {
+  twai_message_t msg;
+  while (true) {
+    uint32_t now = millis();
+    int best = -1;
+    uint32_t version = 0;
+
+    portENTER_CRITICAL(&_txMux);
+    for (int i = 0; i < CAN32_TX_SLOTS; i++) {
+      CAN32_TxSlot& s = _txSlots[i];
+      if (!s.used || s.inFlight) continue;
+      if (s.hasDeadline && (int32_t)(now - s.deadline) > 0) {
+        s.used = false;
+        _txPending--;
+        _txStats.expired++;
+        continue;
+      }
+      if (best < 0) { best = i; continue; }
+      const CAN32_TxSlot& b = _txSlots[best];
+      bool earlier;
+      if (s.priority != b.priority) earlier = s.priority < b.priority;
+      else if (s.hasDeadline != b.hasDeadline) earlier = s.hasDeadline;
+      else if (s.hasDeadline && s.deadline != b.deadline) earlier = (int32_t)(s.deadline - b.deadline) < 0;
+      else earlier = (int32_t)(s.seq - b.seq) < 0;
+      if (earlier) best = i;
+    }
+    if (best >= 0) {
+      msg = _txSlots[best].msg;
+      version = _txSlots[best].version;
+      _txSlots[best].inFlight = true;  // Another caller now skips it
+      _txSlots[best].flightVersion = version;
+    }
+    portEXIT_CRITICAL(&_txMux);
+
+    if (best < 0) return;
+    // Zero timeout: a full driver queue leaves the frame parked for next time
+    bool sent = (twai_transmit(&msg, 0) == ESP_OK);
+
+    portENTER_CRITICAL(&_txMux);
+    _txSlots[best].inFlight = false;
+    if (sent) {
+      _txStats.sent++;
+      // Only free the slot if no newer payload arrived while transmitting
+      if (_txSlots[best].version == version) {
+        _txSlots[best].used = false;
+        _txPending--;
+      }
+    } else if (_txSlots[best].version != version) {
+      _txStats.coalesced++;  // Never sent, and replaced meanwhile
+    }
+    portEXIT_CRITICAL(&_txMux);
+    if (!sent) return;
+  }
+}
+
+uint8_t CAN32_pendingTx() {
+  return _txPending;
+}
+
+void CAN32_getTxStats(CAN32_TxStats* stats) {
+  portENTER_CRITICAL(&_txMux);
+  *stats = _txStats;
+  portEXIT_CRITICAL(&_txMux);
+}
+
+// ============================================================================
+// BUS HEALTH MONITOR
+// ============================================================================
+
+void CAN32_setAutoRecovery(bool enable) {
+  _autoRecovery = enable;
+}
+
+void CAN32_pollHealth() {
+  uint32_t now = millis();
+  CAN32_takeAlerts();
+  uint32_t alerts = __atomic_exchange_n(&_healthAlerts, 0, __ATOMIC_ACQ_REL);
+  twai_status_info_t status_info;
+  if (twai_get_status_info(&status_info) != ESP_OK) return;  // Driver not installed
+
+  if (_lastHealthPoll != 0 && _health.state <= TWAI_STATE_RECOVERING) {
+    _health.msInState[_health.state] += now - _lastHealthPoll;
+  }
+  _lastHealthPoll = now;
+
+  if (alerts & TWAI_ALERT_RX_QUEUE_FULL) _health.rxQueueFull++;
+  if (alerts & TWAI_ALERT_ERR_PASS) _health.errPassive++;
+
+  _health.state = status_info.state;
+  _health.txErrorCounter = status_info.tx_error_counter;
+  _health.rxErrorCounter = status_info.rx_error_counter;
+  _health.busErrors = status_info.bus_error_count;
+  _health.arbLost = status_info.arb_lost_count;
+  _health.txFailed = status_info.tx_failed_count;
+  _health.rxMissed = status_info.rx_missed_count;
+  _health.rxOverrun = status_info.rx_overrun_count;
+
+  if (now - _rateWindowStart >= 1000) {
+    if (_rateWindowStart != 0) {
+      _health.busErrorRate = (status_info.bus_error_count - _rateWindowErrors) * 1000.0f / (now - _rateWindowStart);
+    }
+    _rateWindowStart = now;
+    _rateWindowErrors = status_info.bus_error_count;
+  }
+
+  // Bus off -> initiate recovery -> (128 x 11 recessive bits) -> stopped -> start
+  switch (status_info.state) {
+    case TWAI_STATE_BUS_OFF:
+      if (_busOffSince == 0) {
+        _health.busOff++;
+        _busOffSince = now ? now : 1;
+      }
+      if (_autoRecovery && !_recoveryStarted && twai_initiate_recovery() == ESP_OK) _recoveryStarted = true;
+      break;
+    case TWAI_STATE_STOPPED:
+      if (_recoveryStarted && twai_start() == ESP_OK) {
+        _recoveryStarted = false;
+        _health.recoveries++;
+        _health.lastRecoveryMs = now - _busOffSince;
+        _health.state = TWAI_STATE_RUNNING;
+        _busOffSince = 0;
+      }
+      break;
+    case TWAI_STATE_RUNNING:
+      _recoveryStarted = false;
+      _busOffSince = 0;
+      break;
+    default:
+      break;
+  }
+
+  CAN32_seqPublish(&_healthSeq, _healthWords, _health);
+}
+
+void CAN32_getHealth(CAN32_Health* health) {
+  CAN32_seqRead(&_healthSeq, _healthWords, health);
+}
+
+// ============================================================================
+// ACCEPTANCE FILTER BUILDER
+// ============================================================================
+// Register layout (ESP32 TWAI, acceptance_code/mask, mask bit 1 = don't care)
+// Single filter : STD ID10..0 -> 31..21, RTR 20, data0/1 15..0
+//                 EXT ID28..0 -> 31..3,  RTR 2
+// Dual filter   : filter 1 STD ID -> 31..21, RTR 20, data0 19..16 + 3..0
+//                          EXT ID28..13 -> 31..16
+//                 filter 2 STD ID -> 15..5,  RTR 4
+//                          EXT ID28..13 -> 15..0
+
+// Register bits an ID lands on plus the bits that must stay don't care
+struct CAN32_FilterBits {
+  uint32_t code;
+  uint32_t care;    // Bits compared against the ID
+  uint32_t forced;  // Bits this format needs as don't care (RTR, data bytes)
+};
+
+static CAN32_FilterBits CAN32_filterLayout(const CAN32_FilterId& id, bool single, uint8_t slot) {
+  uint32_t ident = id.identifier, care = ~id.dontCare;
+  if (single) {
+    if (id.extd) return {(ident & 0x1FFFFFFF) << 3, (care & 0x1FFFFFFF) << 3, 0x00000007};
+    return {(ident & 0x7FF) << 21, (care & 0x7FF) << 21, 0x001FFFFF};
+  }
+  if (id.extd) {
+    uint32_t code = (ident >> 13) & 0xFFFF, c = (care >> 13) & 0xFFFF;
+    return slot == 0 ? CAN32_FilterBits{code << 16, c << 16, 0} : CAN32_FilterBits{code, c, 0};
+  }
+  if (slot == 0) return {(ident & 0x7FF) << 21, (care & 0x7FF) << 21, 0x001F000F};
+  return {(ident & 0x7FF) << 5, (care & 0x7FF) << 5, 0x00000010};
+}
+
+// Matching patterns of a (code, mask) pair restricted to `bits`
+static uint32_t CAN32_patternCount(uint32_t mask, uint32_t bits) {
+  return 1u << __builtin_popcount(mask & bits);
+}
+
+// Union of two pattern sets over the same field
+static uint32_t CAN32_patternUnion(uint32_t code1, uint32_t mask1, uint32_t code2, uint32_t mask2, uint32_t bits) {
+  bool overlap = ((code1 ^ code2) & ~mask1 & ~mask2 & bits) == 0;
+  return CAN32_patternCount(mask1, bits) + CAN32_patternCount(mask2, bits) -
+         (overlap ? (1u << __builtin_popcount(mask1 & mask2 & bits)) : 0);
+}
+
+// A data frame (RTR = 0) passes the RTR bit check
+static bool CAN32_rtrPasses(uint32_t code, uint32_t mask, uint32_t rtrBit) {
+  return (mask & rtrBit) || !(code & rtrBit);
+}
+
+uint32_t CAN32_filterAcceptCount(const twai_filter_config_t* f_config, bool extd) {
+  uint32_t code = f_config->acceptance_code, mask = f_config->acceptance_mask;
+  if (f_config->single_filter) {
+    if (extd) return CAN32_rtrPasses(code, mask, 1u << 2) ? CAN32_patternCount(mask >> 3, 0x1FFFFFFF) : 0;
+    return CAN32_rtrPasses(code, mask, 1u << 20) ? CAN32_patternCount(mask >> 21, 0x7FF) : 0;
+  }
+  if (extd) {
+    // Both filters see ID28..13, ID12..0 always pass
+    return CAN32_patternUnion(code >> 16, mask >> 16, code, mask, 0xFFFF) << 13;
+  }
+  bool pass1 = CAN32_rtrPasses(code, mask, 1u << 20);
+  bool pass2 = CAN32_rtrPasses(code, mask, 1u << 4);
+  uint32_t c1 = code >> 21, m1 = mask >> 21, c2 = code >> 5, m2 = mask >> 5;
+  if (pass1 && pass2) return CAN32_patternUnion(c1, m1, c2, m2, 0x7FF);
+  if (pass1) return CAN32_patternCount(m1, 0x7FF);
+  if (pass2) return CAN32_patternCount(m2, 0x7FF);
+  return 0;
+}
+
+// Merge every ID of the given slot(s) into one register value.
+// slotOf == nullptr means single filter mode.
+static twai_filter_config_t CAN32_mergeFilter(const CAN32_FilterId* ids, size_t count, const uint8_t* slotOf) {
+  bool single = (slotOf == nullptr);
+  uint32_t code[2] = {0, 0}, care[2] = {0, 0}, forced = 0;
+  bool used[2] = {false, false};
+  for (size_t i = 0; i < count; i++) {
+    uint8_t slot = single ? 0 : slotOf[i];
+    CAN32_FilterBits b = CAN32_filterLayout(ids[i], single, slot);
+    forced |= b.forced;
+    if (!used[slot]) {
+      code[slot] = b.code;
+      care[slot] = b.care;
+      used[slot] = true;
+    } else {
+      care[slot] &= b.care & ~(code[slot] ^ b.code);  // Differing bits become don't care
+    }
+  }
+  twai_filter_config_t f;
+  f.single_filter = single;
+  if (single) {
+    f.acceptance_code = code[0] & care[0];
+    f.acceptance_mask = ~care[0] | forced;
+    return f;
+  }
+  // An empty slot copies the other one so it accepts nothing extra
+  if (!used[0]) { code[0] = code[1] << 16; care[0] = care[1] << 16; }
+  if (!used[1]) { code[1] = code[0] >> 16; care[1] = care[0] >> 16; }
+  uint32_t c = (code[0] & 0xFFFF0000) | (code[1] & 0x0000FFFF);
+  uint32_t k = (care[0] & 0xFFFF0000) | (care[1] & 0x0000FFFF);
+  // Filter 1 data nibble in bits 3..0 overlaps filter 2, its forced bits win
+  f.acceptance_code = c & k & ~forced;
+  f.acceptance_mask = ~k | forced;
+  return f;
+}
+
+// Frames of a format nobody subscribed to still reach the RX queue, count both
+static uint32_t CAN32_filterAcceptTotal(const twai_filter_config_t* f) {
+  return CAN32_filterAcceptCount(f, false) + CAN32_filterAcceptCount(f, true);
+}
+
+// IDs matched by at least one of the `members` entries (all of one format).
+// Splits on the highest bit anyone compares until no two entries overlap.
+static uint32_t CAN32_unionCount(const CAN32_FilterId* ids, uint64_t members, uint32_t space) {
+  if (!members) return 0;
+  uint32_t careAny = 0;
+  int last = -1;
+  for (int i = 0; i < 64; i++) {
+    if (!(members >> i & 1)) continue;
+    uint32_t care = ~ids[i].dontCare & space;
+    if (!care) return 1u << __builtin_popcount(space);  // Covers everything left
+    careAny |= care;
+    last = i;
+  }
+  if ((members & (members - 1)) == 0) return 1u << __builtin_popcount(ids[last].dontCare & space);
+  uint32_t bit = 1u << (31 - __builtin_clz(careAny));
+  uint64_t zero = 0, one = 0;
+  for (int i = 0; i < 64; i++) {
+    if (!(members >> i & 1)) continue;
+    if (ids[i].dontCare & bit) { zero |= 1ull << i; one |= 1ull << i; }
+    else if (ids[i].identifier & bit) one |= 1ull << i;
+    else zero |= 1ull << i;
+  }
+  return CAN32_unionCount(ids, zero, space & ~bit) + CAN32_unionCount(ids, one, space & ~bit);
+}
+
+bool CAN32_buildFilter(const CAN32_FilterId* ids, size_t count,
+                       twai_filter_config_t* f_config, CAN32_FilterReport* report) {
+  if (count == 0) return false;
+
+  // Distinct IDs, an ID listed twice (or inside two ranges) counts once
+  uint32_t subscribed = 0;
+  if (count <= 64) {
+    uint64_t stdIds = 0, extIds = 0;
+    for (size_t i = 0; i < count; i++) (ids[i].extd ? extIds : stdIds) |= 1ull << i;
+    subscribed = CAN32_unionCount(ids, stdIds, 0x7FF) + CAN32_unionCount(ids, extIds, 0x1FFFFFFF);
+  } else {
+    // Longer lists fall back to the plain sum, overlaps counted twice
+    for (size_t i = 0; i < count; i++) {
+      uint32_t space = ids[i].extd ? 0x1FFFFFFF : 0x7FF;
+      subscribed += 1u << __builtin_popcount(ids[i].dontCare & space);
+    }
+  }
+
+  twai_filter_config_t best = CAN32_mergeFilter(ids, count, nullptr);
+  uint32_t bestAccepted = CAN32_filterAcceptTotal(&best);
+
+  // Dual filter: split the list in two. Exhaustive for short lists,
+  // otherwise try splitting on the format and on every ID bit (up to 32 IDs).
+  uint8_t slotOf[32];
+  auto tryDual = [&]() {
+    for (int order = 0; order < 2; order++) {
+      twai_filter_config_t f = CAN32_mergeFilter(ids, count, slotOf);
+      uint32_t accepted = CAN32_filterAcceptTotal(&f);
+      if (accepted < bestAccepted) {
+        best = f;
+        bestAccepted = accepted;
+      }
+      for (size_t i = 0; i < count; i++) slotOf[i] ^= 1;  // Swap the two filters
+    }
+  };
+  if (count <= 12) {
+    for (uint32_t split = 1; split < (1u << (count - 1)); split++) {
+      for (size_t i = 0; i < count; i++) slotOf[i] = (split >> i) & 1;
+      tryDual();
+    }
+  } else if (count <= sizeof(slotOf)) {
+    for (size_t i = 0; i < count; i++) slotOf[i] = ids[i].extd;
+    tryDual();
+    for (uint8_t bit = 0; bit < 29; bit++) {
+      for (size_t i = 0; i < count; i++) slotOf[i] = (ids[i].identifier >> bit) & 1;
+      tryDual();
+    }
+  }
+
+  *f_config = best;
+  if (report) {
+    report->subscribed = subscribed;
+    report->accepted = bestAccepted;
+    report->falseAccepts = bestAccepted > subscribed ? bestAccepted - subscribed : 0;
+    report->falseAcceptRate = bestAccepted ? (float)report->falseAccepts / bestAccepted : 0.0f;
+    report->singleFilter = best.single_filter;
+  }
+  return true;
+}
@@ -1,12 +1,295 @@
 #include <cstdint>
+#include <cstddef>
+#include <driver/twai.h>
+
+// Driver queue depths, same for both init overloads
+#define CAN32_RX_QUEUE_LEN 32
+#define CAN32_TX_QUEUE_LEN 32
+// Alerts enabled at init, the RX task adds TWAI_ALERT_RX_DATA on top
+#define CAN32_DEFAULT_ALERTS (TWAI_ALERT_ERR_ACTIVE | TWAI_ALERT_ERR_PASS | TWAI_ALERT_BUS_ERROR | \
+                              TWAI_ALERT_BUS_OFF | TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_ARB_LOST | \
+                              TWAI_ALERT_TX_FAILED | TWAI_ALERT_RX_QUEUE_FULL | TWAI_ALERT_ABOVE_ERR_WARN)
 
 bool CAN32_initCANBus(int can_tx,int can_rx,twai_timing_config_t t_config);
 bool CAN32_initCANBus(int can_tx,int can_rx,
                 twai_timing_config_t t_config, twai_filter_config_t f_config);
 int CAN32_sendCAN(twai_message_t* tx_msg,bool canbusready =1);
 int CAN32_receiveCAN(twai_message_t* rx_msg,bool canbusready =1);
-void CAN32_twai_debug(uint32_t alerts_trigger);
+// Prints bus state/REC/TEC when not running, alerts raised since last call are returned in alerts_trigger
+void CAN32_twai_debug(uint32_t &alerts_trigger);
 
 void CAN32_debugFrame(twai_message_t* rx_msg);
 
-// Example to write for filter -> Make it an output of twai_filter_config_t type , to get the data strcuture need
\ No newline at end of file
+// ============================================================================
+// RX DISPATCHER TASK (alert driven, replaces polling CAN32_receiveCAN)
+// ============================================================================
+// The task sleeps on TWAI_ALERT_RX_DATA, drains the whole RX queue in one pass
+// and hands every frame to the handler registered for its ID.
+// Do not mix with CAN32_receiveCAN polling while the task is running.
+#define CAN32_MAX_RX_HANDLERS 16
+
+typedef void (*CAN32_RxHandler)(const twai_message_t* rx_msg, void* ctx);
+
+struct CAN32_RxStats {
+  uint32_t received = 0;     // Frames pulled out of the driver queue
+  uint32_t dispatched = 0;   // Frames that reached a registered handler
+  uint32_t unhandled = 0;    // Frames with no handler (default handler included)
+  uint32_t wakeups = 0;      // Alert wakeups of the task
+  uint32_t maxBurst = 0;     // Most frames drained in one wakeup
+  uint32_t rxQueueFull = 0;  // TWAI_ALERT_RX_QUEUE_FULL seen (frames were lost)
+};
+
+// Register before CAN32_startRxTask, returns false if the table is full
+bool CAN32_registerRxHandler(uint32_t identifier, bool extd, CAN32_RxHandler handler, void* ctx = nullptr);
+// Called for frames without a registered handler (nullptr = drop)
+void CAN32_setDefaultRxHandler(CAN32_RxHandler handler, void* ctx = nullptr);
+bool CAN32_startRxTask(int priority = 5, int core = tskNO_AFFINITY, uint32_t stackSize = 4096);
+// Blocks until the task has exited (up to ~100 ms), never call it from a handler
+void CAN32_stopRxTask();
+// Consistent copy from any task, published by the RX task once per wakeup
+void CAN32_getRxStats(CAN32_RxStats* stats);
+
+// ============================================================================
+// CONSTANT-TIME ROUTING TABLE (built at compile time, needs C++14 or later)
+// ============================================================================
+// One table per node lists every ID it consumes, ranges included, e.g.
+//
+//   constexpr CAN32_Route routes[] = {
+//     CAN32_route(OBC_ADD, true, onOBC),
+//     CAN32_routeRange(BMU_ADD, true, MODULE_NUM, BMU_MODULE_SHIFT, onBMU), // index = module
+//   };
+//   constexpr CAN32_RouteTable<64> canRoutes(routes);
+//   CAN32_setRxRouter([](const twai_message_t* m) { return canRoutes.dispatch(m); });
+//
+// Lookup is a multiplicative hash with linear probing. The multiplier is picked
+// at compile time to minimise the longest probe, duplicate IDs or an undersized
+// table (load > 50%) fail to compile.
+typedef void (*CAN32_RouteHandler)(const twai_message_t* rx_msg, uint8_t index);
+typedef bool (*CAN32_RxRouter)(const twai_message_t* rx_msg);
+
+struct CAN32_Route {
+  uint32_t identifier;  // First ID of the route
+  bool extd;
+  uint8_t count;        // IDs in the range: identifier + (k << strideShift), k < count
+  uint8_t strideShift;
+  CAN32_RouteHandler handler;
+};
+
+constexpr CAN32_Route CAN32_route(uint32_t identifier, bool extd, CAN32_RouteHandler handler) {
+  return CAN32_Route{identifier, extd, 1, 0, handler};
+}
+constexpr CAN32_Route CAN32_routeRange(uint32_t base, bool extd, uint8_t count, uint8_t strideShift,
+                                       CAN32_RouteHandler handler) {
+  return CAN32_Route{base, extd, count, strideShift, handler};
+}
+
+// Deliberately not constexpr: reaching it during constant evaluation is a compile error
+void CAN32_routeTableError(const char* reason);
+
+// Loops in constexpr functions need C++14, older toolchains only get the per-ID handlers
+#if __cplusplus >= 201402L
+template <size_t Slots>
+class CAN32_RouteTable {
+  static_assert(Slots >= 2 && (Slots & (Slots - 1)) == 0, "Slots must be a power of two");
+
+  struct Slot {
+    uint32_t key = 0;
+    CAN32_RouteHandler handler = nullptr;
+    uint8_t index = 0;
+    bool used = false;
+  };
+
+  Slot _slots[Slots] = {};
+  uint32_t _mult = 0;
+  uint16_t _size = 0;
+  uint8_t _maxProbe = 0;
+
+  static constexpr uint8_t hashBits() {
+    uint8_t bits = 0;
+    while ((size_t(1) << bits) < Slots) bits++;
+    return bits;
+  }
+  static constexpr uint32_t makeKey(uint32_t identifier, bool extd) {
+    return (identifier & TWAI_EXTD_ID_MASK) | (extd ? 0x80000000u : 0u);
+  }
+  static constexpr size_t hash(uint32_t key, uint32_t mult) {
+    return (size_t)((uint32_t)(key * mult) >> (32 - hashBits()));
+  }
+
+  // Fill slots with the given multiplier, returns the longest probe sequence
+  template <size_t N>
+  static constexpr uint8_t build(const CAN32_Route (&routes)[N], uint32_t mult, Slot (&slots)[Slots]) {
+    uint8_t maxProbe = 0;
+    for (size_t r = 0; r < N; r++) {
+      for (uint8_t k = 0; k < routes[r].count; k++) {
+        uint32_t key = makeKey(routes[r].identifier + ((uint32_t)k << routes[r].strideShift), routes[r].extd);
+        size_t i = hash(key, mult);
+        uint8_t probe = 0;
+        while (slots[i].used) {
+          if (slots[i].key == key) CAN32_routeTableError("duplicate CAN ID in route table");
+          i = (i + 1) & (Slots - 1);
+          probe++;
+        }
+        slots[i].key = key;
+        slots[i].handler = routes[r].handler;
+        slots[i].index = k;
+        slots[i].used = true;
+        if (probe > maxProbe) maxProbe = probe;
+      }
+    }
+    return maxProbe;
+  }
+
+public:
+  template <size_t N>
+  constexpr CAN32_RouteTable(const CAN32_Route (&routes)[N]) {
+    size_t total = 0;
+    for (size_t r = 0; r < N; r++) total += routes[r].count;
+    if (total * 2 > Slots) {
+      // A full table would never end a probe, leave it empty (routes nothing)
+      CAN32_routeTableError("route table load above 50%, raise Slots");
+      return;
+    }
+    _size = (uint16_t)total;
+
+    // Try a handful of odd multipliers (golden ratio first), keep the shortest probe
+    uint32_t mult = 0x9E3779B1u;
+    uint8_t bestProbe = 0xFF;
+    for (int c = 0; c < 32 && bestProbe > 0; c++) {
+      Slot trial[Slots] = {};
+      uint8_t probe = build(routes, mult, trial);
+      if (probe < bestProbe) {
+        bestProbe = probe;
+        _mult = mult;
+      }
+      mult = (mult * 1664525u + 1013904223u) | 1u;
+    }
+    _maxProbe = build(routes, _mult, _slots);
+  }
+
+  // Runs the handler for rx_msg, false if the ID is not routed
+  bool dispatch(const twai_message_t* rx_msg) const {
+    uint32_t key = makeKey(rx_msg->identifier, rx_msg->extd);
+    size_t i = hash(key, _mult);
+    for (uint8_t p = 0; p <= _maxProbe; p++) {
+      const Slot& s = _slots[(i + p) & (Slots - 1)];
+      if (s.used && s.key == key) {
+        s.handler(rx_msg, s.index);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  constexpr bool covers(uint32_t identifier, bool extd) const {
+    uint32_t key = makeKey(identifier, extd);
+    size_t i = hash(key, _mult);
+    for (uint8_t p = 0; p <= _maxProbe; p++) {
+      const Slot& s = _slots[(i + p) & (Slots - 1)];
+      if (s.used && s.key == key) return true;
+    }
+    return false;
+  }
+  constexpr uint16_t size() const { return _size; }         // IDs routed
+  constexpr uint8_t maxProbe() const { return _maxProbe; }  // Extra slots checked in the worst case
+};
+#endif
+
+// RX task asks the router first, unrouted frames fall back to the per-ID handlers
+void CAN32_setRxRouter(CAN32_RxRouter router);
+
+// ============================================================================
+// TX SCHEDULER (software queue in front of the driver TX queue)
+// ============================================================================
+// CAN32_queueCAN never blocks: the frame is parked in a slot and pushed to the
+// driver as soon as it has room. A pending frame with the same ID is replaced
+// (periodic messages only ever send their latest payload). Lowest priority
+// value goes first, then earliest deadline, then queue order.
+#define CAN32_TX_SLOTS 32
+
+struct CAN32_TxStats {
+  uint32_t queued = 0;     // Frames accepted by CAN32_queueCAN
+  uint32_t sent = 0;       // Frames handed to the driver
+  uint32_t coalesced = 0;  // Pending frames replaced by a newer payload
+  uint32_t expired = 0;    // Dropped because their deadline passed
+  uint32_t rejected = 0;   // Refused because every slot was busy
+  uint8_t peakPending = 0; // Most slots in use at once
+};
+
+// deadlineMs: drop if not sent within this time (0 = no deadline)
+// Returns ESP_OK, or ESP_ERR_NO_MEM when all slots are taken
+int CAN32_queueCAN(const twai_message_t* tx_msg, uint8_t priority, uint32_t deadlineMs = 0);
+// Move pending frames into the driver queue, call every loop (never blocks).
+// Safe from several tasks at once, each frame is handed to the driver once.
+void CAN32_serviceTxQueue();
+uint8_t CAN32_pendingTx();
+void CAN32_getTxStats(CAN32_TxStats* stats);
+
+// ============================================================================
+// BUS HEALTH MONITOR (bus-off auto recovery + counters)
+// ============================================================================
+// CAN32_pollHealth never blocks: it collects alerts, follows the controller
+// state and on BUS_OFF runs twai_initiate_recovery() then twai_start().
+// Readers take a consistent copy with CAN32_getHealth from any task.
+struct CAN32_Health {
+  twai_state_t state = TWAI_STATE_STOPPED;
+  uint32_t txErrorCounter = 0;    // TEC
+  uint32_t rxErrorCounter = 0;    // REC
+  uint32_t busErrors = 0;         // Bit/stuff/CRC/form/ACK errors (driver total)
+  float busErrorRate = 0.0;       // Bus errors per second over the last window
+  uint32_t arbLost = 0;
+  uint32_t txFailed = 0;
+  uint32_t rxMissed = 0;          // Frames lost to a full RX queue
+  uint32_t rxOverrun = 0;         // Frames lost to a hardware FIFO overrun
+  uint32_t rxQueueFull = 0;       // TWAI_ALERT_RX_QUEUE_FULL events
+  uint32_t errPassive = 0;        // Entries into error passive
+  uint32_t busOff = 0;            // Entries into bus off
+  uint32_t recoveries = 0;        // Successful restarts after bus off
+  uint32_t lastRecoveryMs = 0;    // Bus off -> running again, last time
+  uint32_t msInState[4] = {0};    // Indexed by twai_state_t
+};
+
+void CAN32_pollHealth();
+void CAN32_getHealth(CAN32_Health* health);
+void CAN32_setAutoRecovery(bool enable);  // Default on
+
+// ============================================================================
+// ACCEPTANCE FILTER BUILDER (feeds the filtered CAN32_initCANBus overload)
+// ============================================================================
+// List the IDs a node handles, get the tightest single or dual filter the
+// TWAI controller can do. RTR and data bytes are left as don't care.
+struct CAN32_FilterId {
+  uint32_t identifier;
+  uint32_t dontCare;  // ID bits allowed to take any value, 0 = exact ID
+  bool extd;
+};
+
+struct CAN32_FilterReport {
+  uint32_t subscribed = 0;      // Distinct IDs covered by the list (per dontCare masks)
+  uint32_t accepted = 0;        // IDs the hardware filter lets through
+  uint32_t falseAccepts = 0;    // accepted - subscribed, frames copied for nothing
+  float falseAcceptRate = 0.0;  // falseAccepts / accepted
+  bool singleFilter = true;
+};
+
+constexpr CAN32_FilterId CAN32_filterId(uint32_t identifier, bool extd) {
+  return CAN32_FilterId{identifier, 0, extd};
+}
+#if __cplusplus >= 201402L
+// identifier + (k << strideShift) for k < count, same shape as CAN32_routeRange
+constexpr CAN32_FilterId CAN32_filterRange(uint32_t base, bool extd, uint8_t count, uint8_t strideShift) {
+  uint32_t orIds = base, andIds = base;
+  for (uint8_t k = 1; k < count; k++) {
+    orIds |= base + ((uint32_t)k << strideShift);
+    andIds &= base + ((uint32_t)k << strideShift);
+  }
+  return CAN32_FilterId{base, orIds ^ andIds, extd};
+}
+#endif
+
+// Returns false for an empty list (f_config is left untouched)
+bool CAN32_buildFilter(const CAN32_FilterId* ids, size_t count,
+                       twai_filter_config_t* f_config, CAN32_FilterReport* report = nullptr);
+// Number of data-frame IDs of one format a filter config accepts.
+// STD frames are counted on ID/RTR only, data byte matching is ignored.
+uint32_t CAN32_filterAcceptCount(const twai_filter_config_t* f_config, bool extd);
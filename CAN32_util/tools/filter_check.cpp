@@ -0,0 +1,134 @@
+// ============================================================================
+// filter_check - brute-force check of CAN32_buildFilter against the controller
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -pthread -I.. -Ihost filter_check.cpp ../CAN32_util.cpp host/twai_sim.cpp -o filter_check
+// Usage : filter_check
+// For each ID list, runs the filter CAN32_buildFilter picks through the
+// simulated controller's acceptance match (host/twai_sim.cpp) and checks:
+//   - every subscribed ID passes, with a range of data bytes (STD filters
+//     overlap data bits)
+//   - every one of the 2^11 STD and 2^29 EXT IDs is tried, the totals must
+//     equal CAN32_filterAcceptCount and the report
+//   - report.subscribed equals the distinct IDs of the list, enumerated
+// Exits non-zero on the first mismatch.
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include <Arduino.h>
+#include "CAN32_util.h"
+
+static int _failures = 0;
+
+#define CHECK(cond, ...)                     \
+  do {                                       \
+    if (!(cond)) {                           \
+      printf("  FAIL: " __VA_ARGS__);        \
+      printf("\n");                          \
+      _failures++;                           \
+    }                                        \
+  } while (0)
+
+static bool accepts(const twai_filter_config_t& f, uint32_t id, bool extd, uint8_t d0 = 0, uint8_t d1 = 0) {
+  twai_message_t msg = {};
+  msg.extd = extd;
+  msg.identifier = id;
+  msg.data_length_code = 8;
+  msg.data[0] = d0;
+  msg.data[1] = d1;
+  return twai_sim_filter_accepts(&f, &msg);
+}
+
+// Calls fn(id) for every ID an entry covers
+template <typename Fn>
+static void forEachId(const CAN32_FilterId& e, Fn fn) {
+  uint32_t space = e.extd ? 0x1FFFFFFF : 0x7FF;
+  uint32_t dc = e.dontCare & space, sub = 0;
+  do {
+    fn((e.identifier & ~dc & space) | sub);
+    sub = (sub - dc) & dc;
+  } while (sub != 0);
+}
+
+static void check(const char* name, const CAN32_FilterId* ids, size_t n) {
+  twai_filter_config_t f;
+  CAN32_FilterReport r;
+  printf("%s\n", name);
+  if (!CAN32_buildFilter(ids, n, &f, &r)) {
+    CHECK(false, "buildFilter refused the list");
+    return;
+  }
+
+  std::vector<bool> stdSeen(1u << 11), extSeen(1u << 29);
+  uint32_t distinct = 0;
+  for (size_t i = 0; i < n; i++) {
+    forEachId(ids[i], [&](uint32_t id) {
+      std::vector<bool>& seen = ids[i].extd ? extSeen : stdSeen;
+      if (!seen[id]) {
+        seen[id] = true;
+        distinct++;
+      }
+      for (int d = 0; d < 256; d += 17) {
+        CHECK(accepts(f, id, ids[i].extd, (uint8_t)d, (uint8_t)(255 - d)), "subscribed %s 0x%X data 0x%02X rejected",
+              ids[i].extd ? "EXT" : "STD", id, d);
+      }
+    });
+  }
+
+  // STD totals ignore data byte matching, like CAN32_filterAcceptCount: a
+  // filter that compares data bits is counted on ID/RTR only
+  twai_filter_config_t idOnly = f;
+  idOnly.acceptance_mask |= f.single_filter ? 0x000FFFFF : 0x000F000F;
+  uint32_t stdAccepted = 0, extAccepted = 0;
+  for (uint32_t id = 0; id < (1u << 11); id++) stdAccepted += accepts(idOnly, id, false);
+  for (uint32_t id = 0; id < (1u << 29); id++) extAccepted += accepts(f, id, true);
+
+  printf("  %s filter code 0x%08X mask 0x%08X\n", f.single_filter ? "single" : "dual", f.acceptance_code,
+         f.acceptance_mask);
+  printf("  STD accepted %u, EXT accepted %u, subscribed %u, false accept rate %.4f\n", stdAccepted, extAccepted,
+         r.subscribed, r.falseAcceptRate);
+  CHECK(stdAccepted == CAN32_filterAcceptCount(&f, false), "STD count %u, filterAcceptCount says %u", stdAccepted,
+        CAN32_filterAcceptCount(&f, false));
+  CHECK(extAccepted == CAN32_filterAcceptCount(&f, true), "EXT count %u, filterAcceptCount says %u", extAccepted,
+        CAN32_filterAcceptCount(&f, true));
+  CHECK(r.accepted == stdAccepted + extAccepted, "report.accepted %u, counted %u", r.accepted,
+        stdAccepted + extAccepted);
+  CHECK(r.subscribed == distinct, "report.subscribed %u, distinct IDs %u", r.subscribed, distinct);
+  CHECK(r.falseAccepts == r.accepted - distinct, "report.falseAccepts %u, expected %u", r.falseAccepts,
+        r.accepted - distinct);
+}
+
+int main() {
+  Serial.quiet = true;
+
+  const CAN32_FilterId ams[] = {
+      CAN32_filterId(0x1806E5F4, true),              // OBC
+      CAN32_filterId(0x18000000, true),              // AMS
+      CAN32_filterRange(0x18200001, true, 7, 16),    // BMU modules
+  };
+  check("AMS node (OBC, AMS, 7 BMU modules)", ams, 3);
+
+  const CAN32_FilterId std3[] = {CAN32_filterId(0x100, false), CAN32_filterId(0x101, false),
+                                 CAN32_filterId(0x7F0, false)};
+  check("3 STD IDs", std3, 3);
+
+  const CAN32_FilterId mixed[] = {CAN32_filterId(0x123, false), CAN32_filterId(0x18FF50E5, true)};
+  check("STD + EXT", mixed, 2);
+
+  CAN32_FilterId many[14];
+  for (int i = 0; i < 14; i++) many[i] = CAN32_filterId(0x18200000 + i * 0x10000 + (i & 1), true);
+  check("14 EXT IDs (heuristic dual split)", many, 14);
+
+  // Overlaps must count once
+  const CAN32_FilterId overlapStd[] = {CAN32_filterRange(0x100, false, 16, 0), CAN32_filterId(0x105, false),
+                                       CAN32_filterId(0x105, false), CAN32_FilterId{0x108, 0x7, false}};
+  check("overlapping STD entries", overlapStd, 4);
+
+  const CAN32_FilterId overlapExt[] = {CAN32_FilterId{0x18200000, 0x000F0003, true},
+                                       CAN32_FilterId{0x18200001, 0x00070000, true},
+                                       CAN32_FilterId{0x18200000, 0x00300000, true}, CAN32_filterId(0x1806E5F4, true)};
+  check("overlapping EXT ranges", overlapExt, 4);
+
+  printf("\n%s (%d failures)\n", _failures ? "FAILED" : "all checks passed", _failures);
+  return _failures ? 1 : 0;
+}
@@ -0,0 +1,59 @@
+// Host stand-in for the Arduino core, enough to link CAN32_util.cpp into host tools
+#pragma once
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <thread>
+#include <type_traits>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define BIN 2
+#define DEC 10
+#define HEX 16
+
+// Set HostSerial::quiet to silence the library's status prints in benchmarks
+struct HostSerial {
+  bool quiet = false;
+  int printf(const char* fmt, ...) {
+    if (quiet) return 0;
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n;
+  }
+  size_t print(const char* s) { return quiet ? 0 : (fputs(s, stdout), strlen(s)); }
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+  size_t print(T v, int base = DEC) {
+    char buf[66];
+    int n = 0;
+    bool neg = std::is_signed<T>::value && v < 0;
+    unsigned long long u = neg ? 0ull - (unsigned long long)v : (unsigned long long)v;
+    do buf[n++] = "0123456789ABCDEF"[u % base]; while ((u /= base) && n < 64);
+    if (neg) buf[n++] = '-';
+    for (int i = 0; i < n / 2; i++) { char c = buf[i]; buf[i] = buf[n - 1 - i]; buf[n - 1 - i] = c; }
+    buf[n] = 0;
+    return print(buf);
+  }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+  size_t println(T v, int base = DEC) { return print(v, base) + print("\n"); }
+};
+
+inline HostSerial Serial;  // One instance shared by every translation unit
+
+inline std::chrono::steady_clock::time_point hostEpoch() {
+  static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  return t0;
+}
+inline uint32_t millis() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - hostEpoch()).count();
+}
+inline uint32_t micros() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostEpoch()).count();
+}
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
@@ -0,0 +1,146 @@
+// Host stand-in for the ESP-IDF TWAI driver, backed by a simulated controller
+// (twai_sim.cpp) so CAN32_util.cpp runs unmodified in host tools.
+//
+// Same API, types and return codes as ESP-IDF 4.4. The simulation keeps:
+//   - a bounded RX queue fed through the acceptance filter, frames arriving
+//     while it is full count as rx_missed and raise TWAI_ALERT_RX_QUEUE_FULL
+//   - a bounded TX queue drained at the configured bit rate
+//   - alerts filtered by alerts_enabled, twai_read_alerts blocks like the driver
+//   - the STOPPED / RUNNING / BUS_OFF / RECOVERING state machine
+// The twai_sim_* functions below play the rest of the bus.
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+#define ESP_ERR_NO_MEM 0x101
+#define ESP_ERR_INVALID_ARG 0x102
+#define ESP_ERR_INVALID_STATE 0x103
+#define ESP_ERR_NOT_SUPPORTED 0x106
+#define ESP_ERR_TIMEOUT 0x107
+
+typedef int gpio_num_t;
+#define TWAI_IO_UNUSED ((gpio_num_t)-1)
+
+#define TWAI_EXTD_ID_MASK 0x1FFFFFFF
+#define TWAI_STD_ID_MASK 0x7FF
+#define TWAI_FRAME_MAX_DLC 8
+
+#define TWAI_ALERT_TX_IDLE 0x00000001
+#define TWAI_ALERT_TX_SUCCESS 0x00000002
+#define TWAI_ALERT_RX_DATA 0x00000004
+#define TWAI_ALERT_BELOW_ERR_WARN 0x00000008
+#define TWAI_ALERT_ERR_ACTIVE 0x00000010
+#define TWAI_ALERT_RECOVERY_IN_PROGRESS 0x00000020
+#define TWAI_ALERT_BUS_RECOVERED 0x00000040
+#define TWAI_ALERT_ARB_LOST 0x00000080
+#define TWAI_ALERT_ABOVE_ERR_WARN 0x00000100
+#define TWAI_ALERT_BUS_ERROR 0x00000200
+#define TWAI_ALERT_TX_FAILED 0x00000400
+#define TWAI_ALERT_RX_QUEUE_FULL 0x00000800
+#define TWAI_ALERT_ERR_PASS 0x00001000
+#define TWAI_ALERT_BUS_OFF 0x00002000
+#define TWAI_ALERT_RX_FIFO_OVERRUN 0x00004000
+#define TWAI_ALERT_TX_RETRIED 0x00008000
+#define TWAI_ALERT_PERIPH_RESET 0x00010000
+#define TWAI_ALERT_ALL 0x0001FFFF
+#define TWAI_ALERT_NONE 0x00000000
+
+typedef enum { TWAI_MODE_NORMAL, TWAI_MODE_NO_ACK, TWAI_MODE_LISTEN_ONLY } twai_mode_t;
+typedef enum { TWAI_STATE_STOPPED, TWAI_STATE_RUNNING, TWAI_STATE_BUS_OFF, TWAI_STATE_RECOVERING } twai_state_t;
+
+typedef struct {
+  union {
+    struct {
+      uint32_t extd : 1;
+      uint32_t rtr : 1;
+      uint32_t ss : 1;
+      uint32_t self : 1;
+      uint32_t dlc_non_comp : 1;
+      uint32_t reserved : 27;
+    };
+    uint32_t flags;
+  };
+  uint32_t identifier;
+  uint8_t data_length_code;
+  uint8_t data[TWAI_FRAME_MAX_DLC];
+} twai_message_t;
+
+typedef struct {
+  twai_mode_t mode;
+  gpio_num_t tx_io;
+  gpio_num_t rx_io;
+  gpio_num_t clkout_io;
+  gpio_num_t bus_off_io;
+  uint32_t tx_queue_len;
+  uint32_t rx_queue_len;
+  uint32_t alerts_enabled;
+  uint32_t clkout_divider;
+  int intr_flags;
+} twai_general_config_t;
+
+typedef struct {
+  uint32_t brp;
+  uint8_t tseg_1;
+  uint8_t tseg_2;
+  uint8_t sjw;
+  bool triple_sampling;
+} twai_timing_config_t;
+
+typedef struct {
+  uint32_t acceptance_code;
+  uint32_t acceptance_mask;
+  bool single_filter;
+} twai_filter_config_t;
+
+typedef struct {
+  twai_state_t state;
+  uint32_t msgs_to_tx;
+  uint32_t msgs_to_rx;
+  uint32_t tx_error_counter;
+  uint32_t rx_error_counter;
+  uint32_t tx_failed_count;
+  uint32_t rx_missed_count;
+  uint32_t rx_overrun_count;
+  uint32_t arb_lost_count;
+  uint32_t bus_error_count;
+} twai_status_info_t;
+
+#define TWAI_GENERAL_CONFIG_DEFAULT(tx_io_num, rx_io_num, op_mode) \
+  {op_mode, tx_io_num, rx_io_num, TWAI_IO_UNUSED, TWAI_IO_UNUSED, 5, 5, TWAI_ALERT_NONE, 0, 0}
+#define TWAI_FILTER_CONFIG_ACCEPT_ALL() {0, 0xFFFFFFFF, true}
+// 80 MHz APB / brp / (1 + tseg_1 + tseg_2)
+#define TWAI_TIMING_CONFIG_125KBITS() {32, 15, 4, 3, false}
+#define TWAI_TIMING_CONFIG_250KBITS() {16, 15, 4, 3, false}
+#define TWAI_TIMING_CONFIG_500KBITS() {8, 15, 4, 3, false}
+#define TWAI_TIMING_CONFIG_1MBITS() {4, 15, 4, 3, false}
+
+esp_err_t twai_driver_install(const twai_general_config_t* g_config, const twai_timing_config_t* t_config,
+                              const twai_filter_config_t* f_config);
+esp_err_t twai_driver_uninstall();
+esp_err_t twai_start();
+esp_err_t twai_stop();
+esp_err_t twai_transmit(const twai_message_t* message, TickType_t ticks_to_wait);
+esp_err_t twai_receive(twai_message_t* message, TickType_t ticks_to_wait);
+esp_err_t twai_read_alerts(uint32_t* alerts, TickType_t ticks_to_wait);
+esp_err_t twai_reconfigure_alerts(uint32_t alerts_enabled, uint32_t* current_alerts);
+esp_err_t twai_initiate_recovery();
+esp_err_t twai_get_status_info(twai_status_info_t* status_info);
+esp_err_t twai_clear_transmit_queue();
+esp_err_t twai_clear_receive_queue();
+
+// ---- Simulation controls (host only) ----
+// A frame from another node. False if the filter dropped it, the RX queue
+// was full (rx_missed) or the controller is not running.
+bool twai_sim_inject(const twai_message_t* message);
+// Frames this node has finished transmitting, oldest first, returns how many were copied
+size_t twai_sim_take_tx(twai_message_t* out, size_t max);
+// Drive TEC past 255, the controller goes bus off and drops its TX queue
+void twai_sim_bus_off();
+// The controller's acceptance filter match, exposed for filter tests
+bool twai_sim_filter_accepts(const twai_filter_config_t* f_config, const twai_message_t* message);
+// Bus time of a frame in microseconds at the installed bit rate (no bit stuffing)
+uint32_t twai_sim_frame_us(const twai_message_t* message);
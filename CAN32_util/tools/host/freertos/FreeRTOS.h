@@ -0,0 +1,78 @@
+// Host stand-in for the FreeRTOS subset CAN32_util uses. Tasks are real
+// threads and critical sections are real locks, so races in the library show
+// up on the host the same way they do between the ESP32's two cores.
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS 1  // 1 kHz tick, as configured by the Arduino core
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// portMUX is a spinlock the owning core may take again, a recursive mutex here
+struct portMUX_TYPE {
+  std::recursive_mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL(mux) (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->m.unlock()
+
+typedef void (*TaskFunction_t)(void*);
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+
+// Thrown by vTaskDelete(nullptr) to unwind the task's thread
+struct HostTaskExit {};
+
+struct HostTask {
+  const char* name;
+};
+
+inline HostTask*& hostCurrentTask() {
+  static thread_local HostTask* self = nullptr;
+  return self;
+}
+
+// The handle is written before the task can run, like xTaskCreate does
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                          UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  (void)stackDepth; (void)priority; (void)core;
+  HostTask* task = new HostTask{name};
+  if (handle) *handle = task;
+  std::thread([fn, arg, task]() {
+    hostCurrentTask() = task;
+    try {
+      fn(arg);
+    } catch (HostTaskExit&) {
+    }
+    delete task;
+  }).detach();
+  return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+// Only self-deletion is supported, which is all the library does
+inline void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == hostCurrentTask()) throw HostTaskExit();
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask(); }
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
@@ -0,0 +1,263 @@
+// Simulated TWAI controller behind host/driver/twai.h
+#include "driver/twai.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+typedef std::chrono::steady_clock Clock;
+
+namespace {
+
+struct Sim {
+  std::mutex m;
+  std::condition_variable cv;  // RX data, TX room and alerts
+  bool installed = false;
+  twai_state_t state = TWAI_STATE_STOPPED;
+  twai_filter_config_t filter = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+  uint32_t bitrate = 250000;
+  size_t rxLen = 5, txLen = 5;
+  std::deque<twai_message_t> rx, tx;
+  std::vector<twai_message_t> sent;     // Finished transmissions for twai_sim_take_tx
+  Clock::time_point txHeadStart;        // When the frame at tx.front() took the bus
+  Clock::time_point recoveryDone;
+  uint32_t alertsEnabled = 0, alertsRaised = 0;
+  twai_status_info_t status = {};
+};
+
+Sim sim;
+
+uint32_t frameBits(const twai_message_t* msg) {
+  // SOF..EOF + interframe space, data field only for data frames
+  uint32_t dlc = msg->data_length_code > 8 ? 8 : msg->data_length_code;
+  return (msg->extd ? 67 : 47) + (msg->rtr ? 0 : 8 * dlc);
+}
+
+Clock::duration frameTime(const twai_message_t* msg) {
+  return std::chrono::microseconds((uint64_t)frameBits(msg) * 1000000 / sim.bitrate);
+}
+
+void raise(uint32_t alerts) {
+  sim.alertsRaised |= alerts & sim.alertsEnabled;
+  sim.cv.notify_all();
+}
+
+// Bring the simulated controller up to `now`: finish transmissions and recovery
+void advance(Clock::time_point now) {
+  if (sim.state == TWAI_STATE_RECOVERING && now >= sim.recoveryDone) {
+    sim.state = TWAI_STATE_STOPPED;
+    sim.status.tx_error_counter = 0;
+    sim.status.rx_error_counter = 0;
+    raise(TWAI_ALERT_BUS_RECOVERED);
+  }
+  if (sim.state != TWAI_STATE_RUNNING) return;
+  bool drained = false;
+  while (!sim.tx.empty() && sim.txHeadStart + frameTime(&sim.tx.front()) <= now) {
+    sim.txHeadStart += frameTime(&sim.tx.front());
+    sim.sent.push_back(sim.tx.front());
+    sim.tx.pop_front();
+    raise(TWAI_ALERT_TX_SUCCESS);
+    drained = true;
+  }
+  if (drained && sim.tx.empty()) raise(TWAI_ALERT_TX_IDLE);
+  if (drained) sim.cv.notify_all();
+}
+
+// Wait on the condition until `until` (or forever for portMAX_DELAY), waking in
+// time to finish the current transmission
+template <typename Pred>
+bool waitFor(std::unique_lock<std::mutex>& lock, TickType_t ticks, Pred ready) {
+  Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(ticks);
+  while (true) {
+    Clock::time_point now = Clock::now();
+    advance(now);
+    if (ready()) return true;
+    if (ticks != portMAX_DELAY && now >= deadline) return false;
+    Clock::time_point wake = ticks == portMAX_DELAY ? now + std::chrono::milliseconds(10) : deadline;
+    if (!sim.tx.empty() && sim.state == TWAI_STATE_RUNNING) {
+      Clock::time_point txDone = sim.txHeadStart + frameTime(&sim.tx.front());
+      if (txDone < wake) wake = txDone;
+    }
+    if (sim.state == TWAI_STATE_RECOVERING && sim.recoveryDone < wake) wake = sim.recoveryDone;
+    sim.cv.wait_until(lock, wake);
+  }
+}
+
+}  // namespace
+
+esp_err_t twai_driver_install(const twai_general_config_t* g_config, const twai_timing_config_t* t_config,
+                              const twai_filter_config_t* f_config) {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (sim.installed) return ESP_ERR_INVALID_STATE;
+  if (g_config->rx_queue_len == 0 || t_config->brp == 0) return ESP_ERR_INVALID_ARG;
+  sim.installed = true;
+  sim.state = TWAI_STATE_STOPPED;
+  sim.filter = *f_config;
+  sim.bitrate = 80000000u / (t_config->brp * (1u + t_config->tseg_1 + t_config->tseg_2));
+  sim.rxLen = g_config->rx_queue_len;
+  sim.txLen = g_config->tx_queue_len;
+  sim.alertsEnabled = g_config->alerts_enabled;
+  sim.alertsRaised = 0;
+  sim.rx.clear();
+  sim.tx.clear();
+  sim.status = twai_status_info_t{};
+  return ESP_OK;
+}
+
+esp_err_t twai_driver_uninstall() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed || (sim.state != TWAI_STATE_STOPPED && sim.state != TWAI_STATE_BUS_OFF)) return ESP_ERR_INVALID_STATE;
+  sim.installed = false;
+  sim.cv.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t twai_start() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  advance(Clock::now());
+  if (!sim.installed || sim.state != TWAI_STATE_STOPPED) return ESP_ERR_INVALID_STATE;
+  sim.state = TWAI_STATE_RUNNING;
+  sim.rx.clear();
+  return ESP_OK;
+}
+
+esp_err_t twai_stop() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed || sim.state != TWAI_STATE_RUNNING) return ESP_ERR_INVALID_STATE;
+  sim.state = TWAI_STATE_STOPPED;
+  sim.tx.clear();
+  return ESP_OK;
+}
+
+esp_err_t twai_transmit(const twai_message_t* message, TickType_t ticks_to_wait) {
+  std::unique_lock<std::mutex> lock(sim.m);
+  if (!sim.installed || sim.state != TWAI_STATE_RUNNING) return ESP_ERR_INVALID_STATE;
+  if (message->data_length_code > TWAI_FRAME_MAX_DLC) return ESP_ERR_INVALID_ARG;
+  if (sim.txLen == 0) return ESP_ERR_NOT_SUPPORTED;
+  if (!waitFor(lock, ticks_to_wait, [] { return sim.tx.size() < sim.txLen || sim.state != TWAI_STATE_RUNNING; }))
+    return ESP_ERR_TIMEOUT;
+  if (sim.state != TWAI_STATE_RUNNING) return ESP_FAIL;
+  if (sim.tx.empty()) sim.txHeadStart = Clock::now();
+  sim.tx.push_back(*message);
+  return ESP_OK;
+}
+
+esp_err_t twai_receive(twai_message_t* message, TickType_t ticks_to_wait) {
+  std::unique_lock<std::mutex> lock(sim.m);
+  if (!sim.installed) return ESP_ERR_INVALID_STATE;
+  if (!waitFor(lock, ticks_to_wait, [] { return !sim.rx.empty(); })) return ESP_ERR_TIMEOUT;
+  *message = sim.rx.front();
+  sim.rx.pop_front();
+  return ESP_OK;
+}
+
+esp_err_t twai_read_alerts(uint32_t* alerts, TickType_t ticks_to_wait) {
+  std::unique_lock<std::mutex> lock(sim.m);
+  if (!sim.installed) return ESP_ERR_INVALID_STATE;
+  bool got = waitFor(lock, ticks_to_wait, [] { return sim.alertsRaised != 0; });
+  *alerts = sim.alertsRaised;
+  sim.alertsRaised = 0;
+  return got ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+esp_err_t twai_reconfigure_alerts(uint32_t alerts_enabled, uint32_t* current_alerts) {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed) return ESP_ERR_INVALID_STATE;
+  if (current_alerts) *current_alerts = sim.alertsRaised;
+  sim.alertsRaised = 0;
+  sim.alertsEnabled = alerts_enabled;
+  return ESP_OK;
+}
+
+esp_err_t twai_initiate_recovery() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed || sim.state != TWAI_STATE_BUS_OFF) return ESP_ERR_INVALID_STATE;
+  // 128 occurrences of 11 recessive bits
+  sim.state = TWAI_STATE_RECOVERING;
+  sim.recoveryDone = Clock::now() + std::chrono::microseconds(128ull * 11 * 1000000 / sim.bitrate);
+  sim.cv.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t twai_get_status_info(twai_status_info_t* status_info) {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed) return ESP_ERR_INVALID_STATE;
+  advance(Clock::now());
+  *status_info = sim.status;
+  status_info->state = sim.state;
+  status_info->msgs_to_tx = (uint32_t)sim.tx.size();
+  status_info->msgs_to_rx = (uint32_t)sim.rx.size();
+  return ESP_OK;
+}
+
+esp_err_t twai_clear_transmit_queue() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed) return ESP_ERR_INVALID_STATE;
+  sim.tx.clear();
+  sim.cv.notify_all();
+  return ESP_OK;
+}
+
+esp_err_t twai_clear_receive_queue() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed) return ESP_ERR_INVALID_STATE;
+  sim.rx.clear();
+  return ESP_OK;
+}
+
+bool twai_sim_filter_accepts(const twai_filter_config_t* f_config, const twai_message_t* message) {
+  uint32_t code = f_config->acceptance_code, care = ~f_config->acceptance_mask;
+  auto match = [&](uint32_t frame, uint32_t bits) { return ((frame ^ code) & care & bits) == 0; };
+  uint32_t rtr = message->rtr;
+  if (message->extd) {
+    uint32_t id = message->identifier & TWAI_EXTD_ID_MASK;
+    if (f_config->single_filter) return match((id << 3) | (rtr << 2), 0xFFFFFFFC);
+    return match((id >> 13) << 16, 0xFFFF0000) || match(id >> 13, 0x0000FFFF);
+  }
+  uint32_t id = message->identifier & TWAI_STD_ID_MASK;
+  uint32_t d0 = message->data[0], d1 = message->data[1];
+  if (f_config->single_filter) return match((id << 21) | (rtr << 20) | (d0 << 8) | d1, 0xFFF0FFFF);
+  return match((id << 21) | (rtr << 20) | ((d0 >> 4) << 16) | (d0 & 0xF), 0xFFFF000F) ||
+         match((id << 5) | (rtr << 4), 0x0000FFF0);
+}
+
+bool twai_sim_inject(const twai_message_t* message) {
+  std::lock_guard<std::mutex> lock(sim.m);
+  advance(Clock::now());
+  if (!sim.installed || sim.state != TWAI_STATE_RUNNING) return false;
+  if (!twai_sim_filter_accepts(&sim.filter, message)) return false;
+  if (sim.rx.size() >= sim.rxLen) {
+    sim.status.rx_missed_count++;
+    raise(TWAI_ALERT_RX_QUEUE_FULL);
+    return false;
+  }
+  sim.rx.push_back(*message);
+  raise(TWAI_ALERT_RX_DATA);
+  sim.cv.notify_all();
+  return true;
+}
+
+size_t twai_sim_take_tx(twai_message_t* out, size_t max) {
+  std::lock_guard<std::mutex> lock(sim.m);
+  advance(Clock::now());
+  size_t n = sim.sent.size() < max ? sim.sent.size() : max;
+  for (size_t i = 0; i < n; i++) out[i] = sim.sent[i];
+  sim.sent.erase(sim.sent.begin(), sim.sent.begin() + n);
+  return n;
+}
+
+void twai_sim_bus_off() {
+  std::lock_guard<std::mutex> lock(sim.m);
+  if (!sim.installed || sim.state != TWAI_STATE_RUNNING) return;
+  sim.state = TWAI_STATE_BUS_OFF;
+  sim.status.tx_error_counter = 256;
+  sim.status.tx_failed_count += (uint32_t)sim.tx.size();
+  sim.tx.clear();
+  raise(TWAI_ALERT_ERR_PASS | TWAI_ALERT_BUS_OFF);
+}
+
+uint32_t twai_sim_frame_us(const twai_message_t* message) {
+  std::lock_guard<std::mutex> lock(sim.m);
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(frameTime(message)).count();
+}
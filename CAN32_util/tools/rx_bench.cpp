@@ -0,0 +1,162 @@
+// ============================================================================
+// rx_bench - host throughput / drop benchmark for the CAN RX paths
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -pthread -I.. -Ihost rx_bench.cpp ../CAN32_util.cpp host/twai_sim.cpp -o rx_bench
+// Usage : rx_bench [seconds=2] [loopMs=5] [cycles=300]
+// Runs CAN32_util.cpp against the simulated TWAI controller (host/twai_sim.cpp,
+// 250 kbit/s, CAN32_RX_QUEUE_LEN deep). Another node sends 8 byte extended
+// frames at a fixed rate while the main loop spends loopMs per iteration on
+// other work, as the AMS sketches do. Two receive paths are compared:
+//   polling   one CAN32_receiveCAN per loop iteration
+//   rx task   CAN32_startRxTask + registered handler
+// For each rate it prints frames delivered, frames lost to a full RX queue
+// (rx_missed) and the arrival -> handler latency. Then a stop/start stress
+// restarts the task `cycles` times under traffic and fails if any restart
+// leaves no task receiving.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <Arduino.h>
+#include "CAN32_util.h"
+
+static const uint32_t BASE_ID = 0x18200001;
+static std::atomic<uint32_t> _delivered(0);
+static std::vector<uint32_t> _latencyUs;  // Only touched by the receiving thread
+
+static void onFrame(const twai_message_t* msg, void*) {
+  uint32_t sentAt;
+  memcpy(&sentAt, msg->data, sizeof(sentAt));
+  _latencyUs.push_back(micros() - sentAt);
+  _delivered.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Another node on the bus: evenly spaced frames, 8 module IDs in turn
+struct Sender {
+  std::atomic<bool> run{true};
+  std::atomic<uint32_t> injected{0};
+  std::thread t;
+
+  explicit Sender(uint32_t fps) {
+    t = std::thread([this, fps]() {
+      auto period = std::chrono::nanoseconds(1000000000ull / fps);
+      auto next = std::chrono::steady_clock::now();
+      for (uint32_t k = 0; run.load(); k++) {
+        std::this_thread::sleep_until(next);
+        next += period;
+        twai_message_t msg = {};
+        msg.extd = 1;
+        msg.identifier = BASE_ID + ((k & 7) << 16);
+        msg.data_length_code = 8;
+        uint32_t now = micros();
+        memcpy(msg.data, &now, sizeof(now));
+        twai_sim_inject(&msg);
+        injected.fetch_add(1);
+      }
+    });
+  }
+  void stop() {
+    run = false;
+    t.join();
+  }
+};
+
+static uint32_t rxMissed() {
+  twai_status_info_t st;
+  twai_get_status_info(&st);
+  return st.rx_missed_count;
+}
+
+static void report(const char* path, uint32_t fps, uint32_t injected, uint32_t missed) {
+  std::vector<uint32_t>& l = _latencyUs;
+  std::sort(l.begin(), l.end());
+  uint32_t n = (uint32_t)l.size();
+  printf("%-8s %6u %9u %10u %8u %7.2f%% %9u %9u %9u\n", path, fps, injected, _delivered.load(), missed,
+         injected ? 100.0 * missed / injected : 0.0, n ? l[n / 2] : 0, n ? l[n * 99 / 100] : 0, n ? l[n - 1] : 0);
+}
+
+static void runPolling(uint32_t fps, double seconds, uint32_t loopMs) {
+  _delivered = 0;
+  _latencyUs.clear();
+  twai_clear_receive_queue();
+  uint32_t missed0 = rxMissed();
+  Sender sender(fps);
+  auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+  twai_message_t msg;
+  while (std::chrono::steady_clock::now() < end) {
+    if (CAN32_receiveCAN(&msg) == ESP_OK) onFrame(&msg, nullptr);
+    delay(loopMs);  // Rest of loop(): sensors, SD, telemetry
+  }
+  sender.stop();
+  report("polling", fps, sender.injected, rxMissed() - missed0);
+}
+
+static void runTask(uint32_t fps, double seconds, uint32_t loopMs) {
+  _delivered = 0;
+  _latencyUs.clear();
+  twai_clear_receive_queue();
+  uint32_t missed0 = rxMissed();
+  CAN32_startRxTask();
+  Sender sender(fps);
+  auto end = std::chrono::steady_clock::now() + std::chrono::duration<double>(seconds);
+  while (std::chrono::steady_clock::now() < end) {
+    CAN32_pollHealth();
+    delay(loopMs);
+  }
+  sender.stop();
+  CAN32_stopRxTask();
+  report("rx task", fps, sender.injected, rxMissed() - missed0);
+}
+
+// Restart the task under traffic, each start must be followed by deliveries
+static bool stressStartStop(uint32_t cycles) {
+  _latencyUs.reserve(1 << 20);
+  Sender sender(1000);
+  uint32_t dead = 0, worstStopUs = 0;
+  CAN32_startRxTask();
+  for (uint32_t c = 0; c < cycles; c++) {
+    uint32_t t0 = micros();
+    CAN32_stopRxTask();
+    worstStopUs = std::max(worstStopUs, micros() - t0);
+    _latencyUs.clear();  // Task has exited, safe to touch
+    CAN32_startRxTask();
+    uint32_t before = _delivered.load();
+    uint32_t waitStart = millis();
+    while (_delivered.load() == before && millis() - waitStart < 200) delay(1);
+    if (_delivered.load() == before) dead++;
+  }
+  CAN32_stopRxTask();
+  sender.stop();
+  printf("\nstop/start x%u under 1000 fps: %u restarts left no RX task, longest stop %u us\n", cycles, dead,
+         worstStopUs);
+  return dead == 0;
+}
+
+int main(int argc, char** argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+  uint32_t loopMs = argc > 2 ? (uint32_t)atoi(argv[2]) : 5;
+  uint32_t cycles = argc > 3 ? (uint32_t)atoi(argv[3]) : 300;
+
+  Serial.quiet = true;
+  if (!CAN32_initCANBus(21, 22, TWAI_TIMING_CONFIG_250KBITS())) return 1;
+  for (int m = 0; m < 8; m++) CAN32_registerRxHandler(BASE_ID + (m << 16), true, onFrame);
+  _latencyUs.reserve(1 << 20);
+
+  twai_message_t probe = {};
+  probe.extd = 1;
+  probe.data_length_code = 8;
+  printf("250 kbit/s, 8 byte extended frame = %u us on the bus (%u fps max), RX queue %d, loop work %u ms\n\n",
+         twai_sim_frame_us(&probe), 1000000 / twai_sim_frame_us(&probe), CAN32_RX_QUEUE_LEN, loopMs);
+  printf("%-8s %6s %9s %10s %8s %8s %9s %9s %9s\n", "path", "fps", "injected", "delivered", "missed", "drop",
+         "p50 us", "p99 us", "max us");
+  const uint32_t rates[] = {100, 250, 500, 1000, 1800};
+  for (uint32_t fps : rates) {
+    runPolling(fps, seconds, loopMs);
+    runTask(fps, seconds, loopMs);
+  }
+  return stressStartStop(cycles) ? 0 : 1;
+}
@@ -0,0 +1,157 @@
+#ifndef SD32_CSV_H
+#define SD32_CSV_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ============================================================================
+// CSV ROW BUILDER (fixed buffer, no printf, no heap)
+// ============================================================================
+// Fields are formatted straight into a caller-owned buffer, commas and line
+// endings are inserted automatically. Several rows can be batched and handed to
+// the file in a single write:
+//   SD32_CsvBuffer<1024> csv;
+//   csv.u32(millis()).fixed(raw * 2, 2).i32(temp).endRow();   // V_CELL * 0.02 -> "3.64"
+//   if (csv.remaining() < 128) SD32_appendRowsPersistent(csv.data(), csv.size(), 1000, 0), csv.clear();
+
+// "00".."99", two digits per division
+static const char SD32_DIGIT_PAIRS[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+// Writes v in decimal to out (up to 10 chars, no terminator), returns the length
+static inline size_t SD32_u32toa(uint32_t v, char* out) {
+  char tmp[10];
+  char* p = tmp + sizeof(tmp);
+  while (v >= 100) {
+    uint32_t q = v / 100;
+    p -= 2;
+    memcpy(p, SD32_DIGIT_PAIRS + 2 * (v - q * 100), 2);
+    v = q;
+  }
+  if (v >= 10) {
+    p -= 2;
+    memcpy(p, SD32_DIGIT_PAIRS + 2 * v, 2);
+  } else {
+    *--p = (char)('0' + v);
+  }
+  size_t len = tmp + sizeof(tmp) - p;
+  memcpy(out, p, len);
+  return len;
+}
+
+static inline size_t SD32_i32toa(int32_t v, char* out) {
+  if (v >= 0) return SD32_u32toa((uint32_t)v, out);
+  *out = '-';
+  return 1 + SD32_u32toa(0u - (uint32_t)v, out + 1);
+}
+
+// scaled = value * 10^decimals, e.g. (3640, 3) -> "3.640", (-5, 2) -> "-0.05"
+static inline size_t SD32_fixedtoa(int32_t scaled, uint8_t decimals, char* out) {
+  if (decimals == 0) return SD32_i32toa(scaled, out);
+  size_t n = 0;
+  uint32_t mag = (uint32_t)scaled;
+  if (scaled < 0) {
+    out[n++] = '-';
+    mag = 0u - mag;
+  }
+  uint32_t div = 1;
+  for (uint8_t i = 0; i < decimals; i++) div *= 10;
+  n += SD32_u32toa(mag / div, out + n);
+  out[n++] = '.';
+  uint32_t frac = mag % div;
+  for (uint8_t i = decimals; i > 0; i--) {  // Zero padded, right to left
+    out[n + i - 1] = (char)('0' + frac % 10);
+    frac /= 10;
+  }
+  return n + decimals;
+}
+
+template <size_t Size>
+class SD32_CsvBuffer {
+ public:
+  // Longest single field: sign + 10 digits + point, or a string up to the space left
+  static const size_t FIELD_MAX = 12;
+
+  SD32_CsvBuffer& u32(uint32_t v) {
+    if (reserve(FIELD_MAX)) _len += SD32_u32toa(v, _buf + _len);
+    return *this;
+  }
+  SD32_CsvBuffer& i32(int32_t v) {
+    if (reserve(FIELD_MAX)) _len += SD32_i32toa(v, _buf + _len);
+    return *this;
+  }
+  SD32_CsvBuffer& fixed(int32_t scaled, uint8_t decimals) {
+    if (decimals > 9) decimals = 9;
+    if (reserve(FIELD_MAX + decimals)) _len += SD32_fixedtoa(scaled, decimals, _buf + _len);
+    return *this;
+  }
+  SD32_CsvBuffer& boolean(bool v) {
+    if (reserve(1)) _buf[_len++] = v ? '1' : '0';
+    return *this;
+  }
+  SD32_CsvBuffer& str(const char* s) {
+    size_t n = strlen(s);
+    if (reserve(n)) {
+      memcpy(_buf + _len, s, n);
+      _len += n;
+    }
+    return *this;
+  }
+  SD32_CsvBuffer& empty() {  // Blank field, keeps the column count
+    reserve(0);
+    return *this;
+  }
+  // Terminates the row; a row that overflowed is removed as a whole
+  SD32_CsvBuffer& endRow() {
+    if (_overflow || _len + 2 > Size) {
+      _len = _rowStart;
+      _overflow = false;
+      _dropped++;
+    } else {
+      _buf[_len++] = '\r';
+      _buf[_len++] = '\n';
+      _rows++;
+    }
+    _rowStart = _len;
+    _fields = 0;
+    return *this;
+  }
+
+  const char* data() const { return _buf; }
+  size_t size() const { return _len; }  // Write and clear between rows
+  size_t remaining() const { return Size - _len; }
+  uint32_t rows() const { return _rows; }
+  uint32_t dropped() const { return _dropped; }  // Rows that did not fit
+  void clear() {
+    _len = _rowStart = 0;
+    _rows = 0;
+    _fields = 0;
+    _overflow = false;
+  }
+
+ private:
+  // Separator + n bytes, marks the row overflowed when it does not fit
+  bool reserve(size_t n) {
+    size_t sep = _fields > 0 ? 1 : 0;
+    _fields++;
+    if (_overflow || _len + sep + n > Size) {
+      _overflow = true;
+      return false;
+    }
+    if (sep) _buf[_len++] = ',';
+    return true;
+  }
+
+  char _buf[Size];
+  size_t _len = 0;
+  size_t _rowStart = 0;
+  uint32_t _rows = 0;
+  uint32_t _dropped = 0;
+  uint16_t _fields = 0;  // Fields in the row being built
+  bool _overflow = false;
+};
+
+#endif
@@ -0,0 +1,117 @@
+#ifndef SD32_LOGFORMAT_H
+#define SD32_LOGFORMAT_H
+
+// ============================================================================
+// BPLOG BINARY LOG FORMAT (shared by the logger and tools/bplog_convert.cpp)
+// ============================================================================
+// A log is a sequence of 512 B blocks, one SD sector each:
+//   [SD32_BlockHeader 16 B][payload, payloadLen bytes][zero padding]
+// Block 0 is the schema block, every other block is a data block.
+// A data block restarts its time base, so a damaged sector loses that block only
+// and the reader resyncs on the next SD32_BLOCK_SYNC word.
+//
+// Schema payload : SD32_SchemaHeader, then fieldCount x SD32_SchemaField
+// Data payload   : uint64 baseTimeMs, uint16 recordCount,
+//                  recordCount x [zigzag varint delta ms from previous][record]
+// All integers little endian. crc = CRC-32 of header (crc = 0) + payload.
+
+#include <cstdint>
+#include <cstddef>
+
+#define SD32_BLOCK_SIZE 512
+#define SD32_BLOCK_SYNC 0x424C5042u  // "BPLB"
+#define SD32_LOG_VERSION 1
+#define SD32_FIELD_NAME_LEN 16
+#define SD32_BLOCK_SCHEMA 1
+#define SD32_BLOCK_DATA 2
+
+enum SD32_FieldType : uint8_t {
+  SD32_U8 = 1, SD32_I8, SD32_U16, SD32_I16, SD32_U32, SD32_I32, SD32_F32, SD32_U64, SD32_BOOL
+};
+
+struct __attribute__((packed)) SD32_BlockHeader {
+  uint32_t sync;
+  uint16_t type;
+  uint16_t payloadLen;
+  uint32_t seq;         // Block number in the file, schema = 0
+  uint32_t crc;
+};
+
+struct __attribute__((packed)) SD32_SchemaHeader {
+  uint16_t version;
+  uint16_t recordSize;
+  uint16_t fieldCount;
+  uint64_t startUnixMs;  // Wall clock at open, 0 if unknown
+  char name[24];         // Stream name, e.g. "AMS"
+};
+
+struct __attribute__((packed)) SD32_SchemaField {
+  char name[SD32_FIELD_NAME_LEN];
+  uint8_t type;          // SD32_FieldType
+  uint8_t count;         // Array length, 1 for scalars
+  uint16_t offset;       // Byte offset inside the record
+};
+
+#define SD32_DATA_PREFIX (sizeof(uint64_t) + sizeof(uint16_t))
+#define SD32_BLOCK_PAYLOAD (SD32_BLOCK_SIZE - sizeof(SD32_BlockHeader))
+#define SD32_MAX_FIELDS ((SD32_BLOCK_PAYLOAD - sizeof(SD32_SchemaHeader)) / sizeof(SD32_SchemaField))
+
+static inline uint8_t SD32_fieldSize(uint8_t type) {
+  switch (type) {
+    case SD32_U8: case SD32_I8: case SD32_BOOL: return 1;
+    case SD32_U16: case SD32_I16: return 2;
+    case SD32_U32: case SD32_I32: case SD32_F32: return 4;
+    case SD32_U64: return 8;
+    default: return 0;
+  }
+}
+
+// CRC-32 (IEEE, reflected), nibble table: small and fast enough for 512 B blocks
+static inline uint32_t SD32_crc32(uint32_t crc, const uint8_t* data, size_t len) {
+  static const uint32_t table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+  };
+  crc = ~crc;
+  for (size_t i = 0; i < len; i++) {
+    crc = table[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+    crc = table[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+  }
+  return ~crc;
+}
+
+static inline uint32_t SD32_blockCrc(const uint8_t* block) {
+  SD32_BlockHeader h;
+  for (size_t i = 0; i < sizeof(h); i++) ((uint8_t*)&h)[i] = block[i];
+  h.crc = 0;
+  uint32_t crc = SD32_crc32(0, (const uint8_t*)&h, sizeof(h));
+  uint16_t len = h.payloadLen > SD32_BLOCK_PAYLOAD ? SD32_BLOCK_PAYLOAD : h.payloadLen;
+  return SD32_crc32(crc, block + sizeof(h), len);
+}
+
+// Zigzag varint, at most 10 bytes for 64-bit values
+static inline size_t SD32_putVarint(uint8_t* out, int64_t value) {
+  uint64_t v = ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+// Returns bytes consumed, 0 on malformed input
+static inline size_t SD32_getVarint(const uint8_t* in, size_t avail, int64_t* value) {
+  uint64_t v = 0;
+  for (size_t n = 0; n < avail && n < 10; n++) {
+    v |= (uint64_t)(in[n] & 0x7F) << (7 * n);
+    if (!(in[n] & 0x80)) {
+      *value = (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+      return n + 1;
+    }
+  }
+  return 0;
+}
+
+#endif // SD32_LOGFORMAT_H
@@ -1,9 +1,23 @@
 #include "Arduino.h"
 #include "FS.h"
 #include "SD.h"
+#include "SD_MMC.h"
 #include "SPI.h"
+#include <stdarg.h>
+#include <unistd.h>
 #include <SD32_util.h>
 
+#define SD32_MOUNT_POINT "/sd"
+
+static void SD32_recoverJournals();
+
+// ============================================================================
+// CARD BACKEND
+// ============================================================================
+static fs::FS* _sdfs = &SD;  // Every file operation goes through the mounted backend
+static SD32_Backend _backend = SD32_BACKEND_SPI;
+static SD32_CardStats _cardStats;
+
 // ============================================================================
 // PERSISTENT FILE HANDLE
 // ============================================================================
@@ -12,126 +26,435 @@ static bool _persistentFileOpen = false;
 static unsigned long _lastFlushTime = 0;
 static unsigned long _lastCloseTime = 0;
 static char _persistentFilePath[48] = {0};
+static size_t _preallocBytes = 0;        // 0 = plain append mode
+static SD32_LatencyHist _persistentLatency;
+static SD32_StartupStats _startupStats;
+static bool _persistentJournaled = false;
+
+// ============================================================================
+// BINARY RING LOGGER STATE
+// ============================================================================
+static File _logFile;
+static uint8_t* _logRing = nullptr;       // ringRecords * recordSize
+static uint32_t* _logSeq = nullptr;       // Per slot sequence, Vyukov style bounded queue
+static uint8_t* _logChunk = nullptr;      // SD32_LOG_CHUNK staging buffer
+static size_t _logRecordSize = 0;
+static uint32_t _logMask = 0;
+static uint32_t _logEnqueuePos = 0;       // Shared by producers (CAS)
+static uint32_t _logDequeuePos = 0;       // Writer task only
+static unsigned long _logFlushIntervalMs = 1000;
+static TaskHandle_t _logTask = nullptr;
+static volatile bool _logRun = false;
+static volatile bool _logStopping = false;  // Set once no producer can add records
+static volatile bool _logDone = true;
+static uint32_t _logProducers = 0;        // Producers inside SD32_logRecord
+static SD32_LoggerStats _logStats;
+static size_t _logFileBase = 0;           // File size when the logger started
+static volatile bool _logJournaled = false;
+
+// BPLOG block builder
+static uint8_t _blogBlock[SD32_BLOCK_SIZE];
+static size_t _blogFill = 0;          // Bytes used in _blogBlock, header included
+static uint16_t _blogCount = 0;       // Records in the current block
+static uint16_t _blogRecordSize = 0;
+static uint32_t _blogSeq = 0;
+static uint64_t _blogLastTime = 0;
+static bool _blogOpen = false;
+
+// ============================================================================
+// MULTI-STREAM STATE
+// ============================================================================
+struct SD32_StreamState {
+  File file;
+  uint8_t* buf = nullptr;         // 2 * half bytes
+  size_t half = 0;
+  size_t fill[2] = {0, 0};
+  bool pending[2] = {false, false};  // Half handed to the writer
+  uint8_t active = 0;             // Half producers copy into
+  unsigned long flushIntervalMs = 1000;
+  unsigned long firstByteMs = 0;  // Active half got its first byte
+  unsigned long lastFlushMs = 0;
+  unsigned long openedMs = 0;
+  bool used = false;              // Slot taken
+  bool ready = false;             // File and buffer set up
+  bool closing = false;
+  bool flushRequested = false;
+  SD32_StreamStats stats;
+};
+
+static SD32_StreamState _streams[SD32_MAX_STREAMS];
+static portMUX_TYPE _streamMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t _streamTask = nullptr;
+static volatile bool _streamStopping = false;
+static volatile bool _streamDone = true;
 
 // ============================================================================
 // SD CARD INITIALIZATION
 // ============================================================================
 
-void SD32_initSDCard(int sd_sck, int sd_miso, int sd_mosi, int sd_cs, bool &sdCardReady) {
+static uint8_t SD32_cardType() {
+  return _backend == SD32_BACKEND_SPI ? SD.cardType() : SD_MMC.cardType();
+}
+
+static uint64_t SD32_cardSize() {
+  return _backend == SD32_BACKEND_SPI ? SD.cardSize() : SD_MMC.cardSize();
+}
+
+static void SD32_unmount() {
+  if (_backend == SD32_BACKEND_SPI) SD.end();
+  else SD_MMC.end();
+}
+
+static bool SD32_mount(const SD32_Config& cfg, uint32_t freqKHz) {
+  if (cfg.backend == SD32_BACKEND_SPI) {
+    return SD.begin(cfg.cs, SPI, freqKHz * 1000, SD32_MOUNT_POINT, cfg.maxFiles, false);
+  }
+  return SD_MMC.begin(SD32_MOUNT_POINT, cfg.backend == SD32_BACKEND_SDMMC_1BIT, false, freqKHz, cfg.maxFiles);
+}
+
+// Write a pattern, read it back through a fresh handle and compare
+static bool SD32_verifyReadBack(uint32_t seed) {
+  const char* path = "/sd32_probe.bin";
+  uint8_t buf[512];
+  bool ok = true;
+  File file = _sdfs->open(path, FILE_WRITE);
+  if (!file) return false;
+  uint32_t x = seed;
+  for (int block = 0; block < 8 && ok; block++) {
+    for (size_t i = 0; i < sizeof(buf); i++) {
+      x = x * 1664525 + 1013904223;
+      buf[i] = x >> 24;
+    }
+    ok = file.write(buf, sizeof(buf)) == sizeof(buf);
+  }
+  file.close();
+
+  file = _sdfs->open(path, FILE_READ);
+  if (!file) ok = false;
+  x = seed;
+  for (int block = 0; block < 8 && ok; block++) {
+    ok = file.read(buf, sizeof(buf)) == sizeof(buf);
+    for (size_t i = 0; ok && i < sizeof(buf); i++) {
+      x = x * 1664525 + 1013904223;
+      ok = buf[i] == (uint8_t)(x >> 24);
+    }
+  }
+  if (file) file.close();
+  _sdfs->remove(path);
+  return ok;
+}
+
+// Sequential 4 KB writes, one fsync at the end
+static void SD32_runSelfTest(uint32_t kb) {
+  const char* path = "/sd32_bench.bin";
+  size_t writes = (kb + 3) / 4;
+  uint8_t* chunk = (uint8_t*)malloc(SD32_LOG_CHUNK);
+  uint32_t* us = (uint32_t*)malloc(writes * sizeof(uint32_t));
+  File file = _sdfs->open(path, FILE_WRITE);
+  if (!chunk || !us || !file) {
+    Serial.println("[SD] Self-test skipped (no memory or file)");
+    free(chunk);
+    free(us);
+    if (file) file.close();
+    return;
+  }
+  memset(chunk, 0xA5, SD32_LOG_CHUNK);
+
+  unsigned long t0 = micros();
+  for (size_t i = 0; i < writes; i++) {
+    unsigned long w0 = micros();
+    file.write(chunk, SD32_LOG_CHUNK);
+    us[i] = micros() - w0;
+  }
+  file.flush();
+  uint32_t total = micros() - t0;
+  file.close();
+  _sdfs->remove(path);
+
+  // Insertion sort, a few hundred samples at most
+  for (size_t i = 1; i < writes; i++) {
+    uint32_t v = us[i];
+    size_t j = i;
+    while (j > 0 && us[j - 1] > v) {
+      us[j] = us[j - 1];
+      j--;
+    }
+    us[j] = v;
+  }
+  _cardStats.writeKBps = total ? (uint32_t)((uint64_t)writes * SD32_LOG_CHUNK * 1000 / total) : 0;
+  _cardStats.p99WriteUs = us[writes * 99 / 100];
+  _cardStats.maxWriteUs = us[writes - 1];
+  free(chunk);
+  free(us);
+  Serial.printf("[SD] Self-test: %u KB, %u.%02u MB/s, p99 %u us, max %u us\n", (unsigned)(writes * 4),
+                _cardStats.writeKBps / 1000, (_cardStats.writeKBps % 1000) / 10, _cardStats.p99WriteUs,
+                _cardStats.maxWriteUs);
+}
+
+bool SD32_initSDCard(const SD32_Config& cfg) {
   Serial.println("--- SD Card Initialization ---");
   Serial.print("Initializing SD card...");
-  SPI.begin(sd_sck, sd_miso, sd_mosi, sd_cs);
+  _cardStats = SD32_CardStats();
+  _backend = cfg.backend;
+  _sdfs = cfg.backend == SD32_BACKEND_SPI ? (fs::FS*)&SD : (fs::FS*)&SD_MMC;
+  if (cfg.backend == SD32_BACKEND_SPI) {
+    SPI.begin(cfg.sck, cfg.miso, cfg.mosi, cfg.cs);
+  } else {
+#ifdef SOC_SDMMC_USE_GPIO_MATRIX
+    if (cfg.backend == SD32_BACKEND_SDMMC_1BIT) SD_MMC.setPins(cfg.sck, cfg.mosi, cfg.miso);
+    else SD_MMC.setPins(cfg.sck, cfg.mosi, cfg.miso, cfg.d1, cfg.d2, cfg.d3);
+#endif
+  }
+
+  // Highest clock first; a clock only counts once data reads back intact
+  static const uint32_t spiKHz[] = {40000, 26000, 20000, 16000, 10000, 8000, 4000};
+  static const uint32_t sdmmcKHz[] = {SDMMC_FREQ_HIGHSPEED, SDMMC_FREQ_DEFAULT};
+  const uint32_t* steps = cfg.backend == SD32_BACKEND_SPI ? spiKHz : sdmmcKHz;
+  size_t stepCount = cfg.backend == SD32_BACKEND_SPI ? sizeof(spiKHz) / sizeof(spiKHz[0]) : 2;
 
-  if (!SD.begin(sd_cs, SPI, 4000000, "/sd", 10, false)) {
+  unsigned long t0 = micros();
+  bool mounted = false;
+  for (size_t i = 0; i < stepCount && !mounted; i++) {
+    if (steps[i] > cfg.maxFreqKHz && i + 1 < stepCount) continue;
+    _cardStats.probes++;
+    if (!SD32_mount(cfg, steps[i])) continue;
+    if (!cfg.probe || SD32_verifyReadBack(steps[i])) {
+      mounted = true;
+      _cardStats.freqKHz = steps[i];
+    } else {
+      SD32_unmount();
+    }
+  }
+  _startupStats.mountUs = micros() - t0;
+  if (!mounted) {
     Serial.println(" FAILED!");
     Serial.println("SD card logging disabled.");
     Serial.println("Check:");
     Serial.println("  - SD card is inserted");
     Serial.println("  - Connections are correct");
     Serial.println("  - SD card is formatted (FAT32)");
-    sdCardReady = false;
-    return;
+    return false;
   }
   Serial.println(" SUCCESS!");
-  sdCardReady = true;
+  static const char* const backendNames[] = {"SPI", "SDMMC 1-bit", "SDMMC 4-bit"};
+  Serial.printf("Bus: %s @ %u kHz (%u probe%s)\n", backendNames[cfg.backend], _cardStats.freqKHz,
+                _cardStats.probes, _cardStats.probes == 1 ? "" : "s");
 
-  uint8_t cardType = SD.cardType();
+  uint8_t cardType = SD32_cardType();
   Serial.print("Card Type: ");
   if (cardType == CARD_MMC) Serial.println("MMC");
   else if (cardType == CARD_SD) Serial.println("SDSC");
   else if (cardType == CARD_SDHC) Serial.println("SDHC");
   else Serial.println("UNKNOWN");
 
-  uint64_t cardSize = SD.cardSize() / (1024 * 1024);
+  uint64_t cardSize = SD32_cardSize() / (1024 * 1024);
   Serial.printf("Card Size: %lluMB\n", cardSize);
+
+  SD32_recoverJournals();
+  if (cfg.selfTestKB > 0) SD32_runSelfTest(cfg.selfTestKB);
+  return true;
+}
+
+void SD32_initSDCard(int sd_sck, int sd_miso, int sd_mosi, int sd_cs, bool &sdCardReady) {
+  SD32_Config cfg;
+  cfg.sck = sd_sck;
+  cfg.miso = sd_miso;
+  cfg.mosi = sd_mosi;
+  cfg.cs = sd_cs;
+  sdCardReady = SD32_initSDCard(cfg);
 }
 
 bool SD32_checkSDconnect() {
-  return SD.cardType() != CARD_NONE;
+  return SD32_cardType() != CARD_NONE;
 }
 
 void SD32_getSDsize() {
-  uint64_t cardSize = SD.cardSize() / (1024 * 1024);
+  uint64_t cardSize = SD32_cardSize() / (1024 * 1024);
   Serial.printf("SD Card Size: %lluMB\n", cardSize);
 }
 
+void SD32_getCardStats(SD32_CardStats* stats) {
+  *stats = _cardStats;
+}
+
+void SD32_getStartupStats(SD32_StartupStats* stats) {
+  *stats = _startupStats;
+}
+
 // ============================================================================
 // SESSION DIRECTORY MANAGEMENT
 // ============================================================================
 
+// Session index: "/{prefix}_{kind}.idx" holds two slots, each a complete copy of
+// the last number handed out. Writes alternate between slots, so a reset in the
+// middle of a write leaves the other slot valid. The root scan only runs when
+// both slots are bad or the next number is already taken on the card.
+#define SD32_INDEX_MAGIC 0x58444E49  // "INDX"
+
+struct __attribute__((packed)) SD32_IndexSlot {
+  uint32_t magic;
+  uint32_t seq;
+  int32_t last;
+  uint32_t crc;
+};
+
+static bool SD32_readIndex(const char* idxPath, int &last, uint32_t &seq) {
+  File file = _sdfs->open(idxPath, FILE_READ);
+  if (!file) return false;
+  SD32_IndexSlot slots[2];
+  size_t n = file.read((uint8_t*)slots, sizeof(slots));
+  file.close();
+
+  bool found = false;
+  for (size_t i = 0; i < n / sizeof(SD32_IndexSlot); i++) {
+    const SD32_IndexSlot& s = slots[i];
+    if (s.magic != SD32_INDEX_MAGIC || s.crc != SD32_crc32(0, (const uint8_t*)&s, offsetof(SD32_IndexSlot, crc))) continue;
+    if (!found || (int32_t)(s.seq - seq) > 0) {
+      last = s.last;
+      seq = s.seq;
+      found = true;
+    }
+  }
+  return found;
+}
+
+static void SD32_writeIndex(const char* idxPath, int last, uint32_t seq) {
+  SD32_IndexSlot slot = {SD32_INDEX_MAGIC, seq, last, 0};
+  slot.crc = SD32_crc32(0, (const uint8_t*)&slot, offsetof(SD32_IndexSlot, crc));
+
+  File file = _sdfs->exists(idxPath) ? _sdfs->open(idxPath, "r+") : File();
+  if (file && file.size() >= 2 * sizeof(slot)) {
+    file.seek((seq & 1) * sizeof(slot));
+    file.write((const uint8_t*)&slot, sizeof(slot));
+  } else {
+    if (file) file.close();
+    file = _sdfs->open(idxPath, FILE_WRITE);
+    if (!file) return;
+    file.write((const uint8_t*)&slot, sizeof(slot));
+    file.write((const uint8_t*)&slot, sizeof(slot));
+  }
+  file.flush();
+  file.close();
+}
+
 void SD32_generateUniqueFilename(int &sessionNumber, char* csvFilename, const char* prefix) {
-  sessionNumber = 0;
-  String searchPrefix = String(prefix) + "_";
-  int prefixLen = searchPrefix.length();
-
-  File root = SD.open("/");
-  if (root) {
-    File entry = root.openNextFile();
-    while (entry) {
-      // entry.name() returns full path (e.g. "/Front_001.csv"), strip leading '/'
-      String filename = entry.name();
-      if (filename.startsWith("/")) filename = filename.substring(1);
-      if (filename.startsWith(searchPrefix) && filename.endsWith(".csv")) {
-        int endIdx = filename.indexOf(".csv");
-        if (endIdx > prefixLen) {
-          String numStr = filename.substring(prefixLen, endIdx);
-          int fileNum = numStr.toInt();
-          if (fileNum >= sessionNumber) {
-            sessionNumber = fileNum + 1;
+  unsigned long t0 = micros();
+  char buffer[32];
+  char idxPath[40];
+  snprintf(idxPath, sizeof(idxPath), "/%s_file.idx", prefix);
+
+  int last = 0;
+  uint32_t seq = 0;
+  bool indexHit = SD32_readIndex(idxPath, last, seq);
+  if (indexHit) {
+    snprintf(buffer, sizeof(buffer), "/%s_%03d.csv", prefix, last + 1);
+    indexHit = !_sdfs->exists(buffer);
+  }
+  _startupStats.indexHit = indexHit;
+  _startupStats.scannedEntries = 0;
+
+  if (indexHit) {
+    sessionNumber = last + 1;
+  } else {
+    sessionNumber = 0;
+    String searchPrefix = String(prefix) + "_";
+    int prefixLen = searchPrefix.length();
+
+    File root = _sdfs->open("/");
+    if (root) {
+      File entry = root.openNextFile();
+      while (entry) {
+        _startupStats.scannedEntries++;
+        // entry.name() returns full path (e.g. "/Front_001.csv"), strip leading '/'
+        String filename = entry.name();
+        if (filename.startsWith("/")) filename = filename.substring(1);
+        if (filename.startsWith(searchPrefix) && filename.endsWith(".csv")) {
+          int endIdx = filename.indexOf(".csv");
+          if (endIdx > prefixLen) {
+            String numStr = filename.substring(prefixLen, endIdx);
+            int fileNum = numStr.toInt();
+            if (fileNum >= sessionNumber) {
+              sessionNumber = fileNum + 1;
+            }
           }
         }
+        entry.close();
+        entry = root.openNextFile();
       }
-      entry.close();
-      entry = root.openNextFile();
+      root.close();
     }
-    root.close();
   }
+  SD32_writeIndex(idxPath, sessionNumber, seq + 1);
 
-  char buffer[32];
   snprintf(buffer, sizeof(buffer), "/%s_%03d.csv", prefix, sessionNumber);
   strncpy(csvFilename, buffer, 31);
   csvFilename[31] = '\0';
+  _startupStats.numberingUs = micros() - t0;
 
   Serial.print("Generated unique filename: ");
   Serial.println(csvFilename);
 }
 
 void SD32_createSessionDir(int &sessionNumber, char* sessionDirPath, const char* prefix) {
-  sessionNumber = 0;
-
-  // Build search pattern: "{prefix}_session_"
-  char searchPattern[32];
-  snprintf(searchPattern, sizeof(searchPattern), "%s_session_", prefix);
-  int patternLen = strlen(searchPattern);
-
-  // Find next available session number
-  File root = SD.open("/");
-  if (root) {
-    File entry = root.openNextFile();
-    while (entry) {
-      if (entry.isDirectory()) {
-        // entry.name() returns full path (e.g. "/Front_session_000"), strip leading '/'
-        String dirname = entry.name();
-        if (dirname.startsWith("/")) dirname = dirname.substring(1);
-        if (dirname.startsWith(searchPattern)) {
-          int num = dirname.substring(patternLen).toInt();
-          if (num >= sessionNumber) {
-            sessionNumber = num + 1;
+  unsigned long t0 = micros();
+  char idxPath[40];
+  snprintf(idxPath, sizeof(idxPath), "/%s_session.idx", prefix);
+
+  int last = 0;
+  uint32_t seq = 0;
+  bool indexHit = SD32_readIndex(idxPath, last, seq);
+  if (indexHit) {
+    snprintf(sessionDirPath, 48, "/%s_session_%03d", prefix, last + 1);
+    indexHit = !_sdfs->exists(sessionDirPath);
+  }
+  _startupStats.indexHit = indexHit;
+  _startupStats.scannedEntries = 0;
+
+  if (indexHit) {
+    sessionNumber = last + 1;
+  } else {
+    sessionNumber = 0;
+
+    // Build search pattern: "{prefix}_session_"
+    char searchPattern[32];
+    snprintf(searchPattern, sizeof(searchPattern), "%s_session_", prefix);
+    int patternLen = strlen(searchPattern);
+
+    // Find next available session number
+    File root = _sdfs->open("/");
+    if (root) {
+      File entry = root.openNextFile();
+      while (entry) {
+        _startupStats.scannedEntries++;
+        if (entry.isDirectory()) {
+          // entry.name() returns full path (e.g. "/Front_session_000"), strip leading '/'
+          String dirname = entry.name();
+          if (dirname.startsWith("/")) dirname = dirname.substring(1);
+          if (dirname.startsWith(searchPattern)) {
+            int num = dirname.substring(patternLen).toInt();
+            if (num >= sessionNumber) {
+              sessionNumber = num + 1;
+            }
           }
         }
+        entry.close();
+        entry = root.openNextFile();
       }
-      entry.close();
-      entry = root.openNextFile();
+      root.close();
     }
-    root.close();
   }
+  SD32_writeIndex(idxPath, sessionNumber, seq + 1);
 
   // Create session directory
   snprintf(sessionDirPath, 48, "/%s_session_%03d", prefix, sessionNumber);
-  if (!SD.exists(sessionDirPath)) {
-    SD.mkdir(sessionDirPath);
+  if (!_sdfs->exists(sessionDirPath)) {
+    _sdfs->mkdir(sessionDirPath);
     Serial.printf("[SD] Created session directory: %s\n", sessionDirPath);
   }
+  _startupStats.numberingUs = micros() - t0;
+  if (!indexHit) {
+    Serial.printf("[SD] Session index rebuilt from %u root entries\n", _startupStats.scannedEntries);
+  }
 }
 
 void SD32_generateFilenameInDir(char* filepath, const char* dirPath, const char* prefix, int index) {
@@ -147,7 +470,7 @@ void SD32_generateFilenameInDir(char* filepath, const char* dirPath, const char*
 // ============================================================================
 
 void SD32_createCSVFile(char* csvFilename, const char* csvHeader) {
-  File dataFile = SD.open((const char*)csvFilename, FILE_WRITE);
+  File dataFile = _sdfs->open((const char*)csvFilename, FILE_WRITE);
   if (dataFile) {
     dataFile.println(csvHeader);
     dataFile.flush();
@@ -159,7 +482,7 @@ void SD32_createCSVFile(char* csvFilename, const char* csvHeader) {
 }
 
 void SD32_appendBulkDataToCSV(const char* filepath, AppenderFunc* appenders, void** dataArray, size_t count) {
-  File file = SD.open(filepath, FILE_APPEND);
+  File file = _sdfs->open(filepath, FILE_APPEND);
   if (!file) {
     Serial.println("[SD] ERROR: Could not open file!");
     return;
@@ -178,19 +501,309 @@ void SD32_appendBulkDataToCSV(const char* filepath, AppenderFunc* appenders, voi
 // PERSISTENT FILE FUNCTIONS
 // ============================================================================
 
-bool SD32_openPersistentFile(const char* filepath) {
+static bool SD32_sectorIsZero(File& file, size_t sector, uint8_t* buf) {
+  file.seek(sector * 512);
+  size_t n = file.read(buf, 512);
+  for (size_t i = 0; i < n; i++) {
+    if (buf[i]) return false;
+  }
+  return true;
+}
+
+// Data length of a file whose unused tail is zero. Logged data never contains a
+// whole zero sector (CSV has no NUL bytes, BPLOG blocks start with a sync word),
+// so the first zero sector is found by binary search, O(log n) sector reads.
+static size_t SD32_findDataEnd(File& file) {
+  uint8_t buf[512];
+  size_t sectors = (file.size() + 511) / 512;
+  size_t lo = 0, hi = sectors;  // First zero sector is in [lo, hi]
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (SD32_sectorIsZero(file, mid, buf)) hi = mid;
+    else lo = mid + 1;
+  }
+  if (lo == 0) return 0;
+
+  file.seek((lo - 1) * 512);
+  size_t n = file.read(buf, 512);
+  while (n > 0 && buf[n - 1] == 0) n--;
+  return (lo - 1) * 512 + n;
+}
+
+static void SD32_truncateFile(const char* filepath, size_t length) {
+  char vfsPath[64];
+  snprintf(vfsPath, sizeof(vfsPath), SD32_MOUNT_POINT "%s", filepath);
+  if (truncate(vfsPath, length) != 0) {
+    Serial.printf("[SD] ERROR: Could not truncate %s\n", filepath);
+  }
+}
+
+size_t SD32_recoverPreallocatedFile(const char* filepath) {
+  File file = _sdfs->open(filepath, FILE_READ);
+  if (!file) return 0;
+  size_t size = file.size();
+  size_t end = SD32_findDataEnd(file);
+  file.close();
+  if (end < size) {
+    SD32_truncateFile(filepath, end);
+    Serial.printf("[SD] Recovered %s: %u of %u bytes\n", filepath, (unsigned)end, (unsigned)size);
+  }
+  return end;
+}
+
+// Opens (or creates) the file in r+ mode, zero-fills it up to the requested size
+// and leaves the position at the end of the existing data. Fails if the fill
+// comes up short (card full, write error). Writing zeros through FAT reserves
+// the clusters but does not make them contiguous, that is up to the card's free
+// space (a freshly formatted card gives contiguous runs).
+static bool SD32_openPreallocated(const char* filepath, size_t bytes) {
+  if (!_sdfs->exists(filepath)) {
+    File created = _sdfs->open(filepath, FILE_WRITE);
+    if (!created) return false;
+    created.close();
+  }
+  _persistentFile = _sdfs->open(filepath, "r+");
+  if (!_persistentFile) return false;
+
+  size_t size = _persistentFile.size();
+  size_t end = SD32_findDataEnd(_persistentFile);
+  if (size < bytes) {
+    uint8_t* zeros = (uint8_t*)calloc(1, SD32_LOG_CHUNK);
+    if (!zeros) {
+      _persistentFile.close();
+      return false;
+    }
+    unsigned long t0 = millis();
+    _persistentFile.seek(size);
+    while (size < bytes) {
+      size_t n = bytes - size < SD32_LOG_CHUNK ? bytes - size : SD32_LOG_CHUNK;
+      if (_persistentFile.write(zeros, n) != n) break;
+      size += n;
+    }
+    free(zeros);
+    _persistentFile.flush();
+    if (size < bytes) {
+      Serial.printf("[SD] ERROR: Preallocation stopped at %u of %u KB\n", (unsigned)(size / 1024),
+                    (unsigned)(bytes / 1024));
+      _persistentFile.close();
+      return false;
+    }
+    Serial.printf("[SD] Preallocated %u KB in %lu ms\n", (unsigned)(size / 1024), millis() - t0);
+  }
+  _persistentFile.seek(end);
+  return true;
+}
+
+// ============================================================================
+// COMMIT JOURNAL
+// ============================================================================
+// One journal file per channel (persistent file, binary logger), each only
+// touched by the task that owns the channel. A commit = data flush, then one
+// CRC checked slot with the committed length, alternating between two slots.
+// Recovery only reads the file tail after the committed length.
+#define SD32_JOURNAL_MAGIC 0x4C4E524A  // "JRNL"
+#define SD32_JOURNAL_CHANNELS 2
+#define SD32_JOURNAL_PERSISTENT 0
+#define SD32_JOURNAL_BINARY 1
+
+enum SD32_JournalKind : uint8_t {
+  SD32_JOURNAL_CSV = 0,    // Committed length ends a row, keep complete rows after it
+  SD32_JOURNAL_BPLOG = 1,  // Block aligned, keep CRC valid blocks after it
+};
+
+struct __attribute__((packed)) SD32_JournalSlot {
+  uint32_t magic;
+  uint32_t seq;
+  uint32_t length;  // Committed data length
+  uint8_t kind;     // SD32_JournalKind
+  uint8_t closed;   // 1 = closed cleanly, nothing to recover
+  char path[48];
+  uint32_t crc;
+};
+
+static const char* const _journalPaths[SD32_JOURNAL_CHANNELS] = {"/persist.jnl", "/binlog.jnl"};
+static File _journalFile[SD32_JOURNAL_CHANNELS];
+static SD32_JournalSlot _journalSlot[SD32_JOURNAL_CHANNELS];
+
+static bool SD32_readJournal(uint8_t channel, SD32_JournalSlot* out) {
+  File file = _sdfs->open(_journalPaths[channel], FILE_READ);
+  if (!file) return false;
+  SD32_JournalSlot slots[2];
+  size_t n = file.read((uint8_t*)slots, sizeof(slots));
+  file.close();
+
+  bool found = false;
+  for (size_t i = 0; i < n / sizeof(SD32_JournalSlot); i++) {
+    const SD32_JournalSlot& s = slots[i];
+    if (s.magic != SD32_JOURNAL_MAGIC ||
+        s.crc != SD32_crc32(0, (const uint8_t*)&s, offsetof(SD32_JournalSlot, crc))) continue;
+    if (!found || (int32_t)(s.seq - out->seq) > 0) {
+      *out = s;
+      found = true;
+    }
+  }
+  if (found) out->path[sizeof(out->path) - 1] = '\0';
+  return found;
+}
+
+static void SD32_journalCommit(uint8_t channel, size_t length, bool closed) {
+  SD32_JournalSlot& slot = _journalSlot[channel];
+  File& file = _journalFile[channel];
+  if (!file) return;
+  slot.seq++;
+  slot.length = length;
+  slot.closed = closed;
+  slot.crc = SD32_crc32(0, (const uint8_t*)&slot, offsetof(SD32_JournalSlot, crc));
+  file.seek((slot.seq & 1) * sizeof(slot));
+  file.write((const uint8_t*)&slot, sizeof(slot));
+  file.flush();
+}
+
+static bool SD32_journalBegin(uint8_t channel, const char* filepath, SD32_JournalKind kind, size_t length) {
+  SD32_JournalSlot& slot = _journalSlot[channel];
+  uint32_t seq = SD32_readJournal(channel, &slot) ? slot.seq : 0;
+
+  File& file = _journalFile[channel];
+  file = _sdfs->open(_journalPaths[channel], "r+");
+  if (!file || file.size() < 2 * sizeof(SD32_JournalSlot)) {
+    if (file) file.close();
+    file = _sdfs->open(_journalPaths[channel], FILE_WRITE);
+    if (!file) return false;
+    memset(&slot, 0, sizeof(slot));
+    file.write((const uint8_t*)&slot, sizeof(slot));
+    file.write((const uint8_t*)&slot, sizeof(slot));
+    file.close();
+    file = _sdfs->open(_journalPaths[channel], "r+");
+    if (!file) return false;
+  }
+
+  memset(&slot, 0, sizeof(slot));
+  slot.magic = SD32_JOURNAL_MAGIC;
+  slot.seq = seq;
+  slot.kind = kind;
+  strncpy(slot.path, filepath, sizeof(slot.path) - 1);
+  SD32_journalCommit(channel, length, false);
+  return true;
+}
+
+static void SD32_journalEnd(uint8_t channel, size_t length) {
+  if (!_journalFile[channel]) return;
+  SD32_journalCommit(channel, length, true);
+  _journalFile[channel].close();
+}
+
+// Position after the last '\n' before pos, 0 if none. Reads backwards sector by sector.
+static size_t SD32_lastRowEnd(File& file, size_t pos) {
+  uint8_t buf[512];
+  while (pos > 0) {
+    size_t start = pos > sizeof(buf) ? pos - sizeof(buf) : 0;
+    file.seek(start);
+    size_t n = file.read(buf, pos - start);
+    while (n > 0) {
+      if (buf[n - 1] == '\n') return start + n;
+      n--;
+    }
+    pos = start;
+  }
+  return 0;
+}
+
+// Valid data length of a journaled file, reading only what follows the commit
+static size_t SD32_recoverTail(File& file, const SD32_JournalSlot& slot) {
+  uint8_t buf[SD32_BLOCK_SIZE];
+  size_t size = file.size();
+  size_t pos = slot.length < size ? slot.length : size;
+
+  if (slot.kind == SD32_JOURNAL_BPLOG) {
+    // Commits are block aligned, a shorter file restarts a whole block earlier
+    pos = slot.length;
+    while (pos > size) pos = pos >= SD32_BLOCK_SIZE ? pos - SD32_BLOCK_SIZE : 0;
+    while (pos + SD32_BLOCK_SIZE <= size) {
+      file.seek(pos);
+      if (file.read(buf, SD32_BLOCK_SIZE) != SD32_BLOCK_SIZE) break;
+      SD32_BlockHeader h;
+      memcpy(&h, buf, sizeof(h));
+      if (h.sync != SD32_BLOCK_SYNC || h.crc != SD32_blockCrc(buf)) break;
+      pos += SD32_BLOCK_SIZE;
+    }
+    return pos;
+  }
+
+  // CSV: the commit point ends a row unless the file lost data behind it
+  if (pos > 0) {
+    file.seek(pos - 1);
+    if (file.read() != '\n') pos = SD32_lastRowEnd(file, pos);
+  }
+  size_t end = pos;
+  file.seek(pos);
+  while (pos < size) {
+    size_t n = file.read(buf, sizeof(buf));
+    if (n == 0) break;
+    for (size_t i = 0; i < n; i++) {
+      if (buf[i] == 0) return end;  // Preallocated zero tail
+      if (buf[i] == '\n') end = pos + i + 1;
+    }
+    pos += n;
+  }
+  return end;
+}
+
+static void SD32_recoverJournals() {
+  unsigned long t0 = micros();
+  _startupStats.recoveredFiles = 0;
+  _startupStats.truncatedBytes = 0;
+  for (uint8_t ch = 0; ch < SD32_JOURNAL_CHANNELS; ch++) {
+    SD32_JournalSlot slot;
+    if (!SD32_readJournal(ch, &slot) || slot.closed) continue;
+
+    File file = _sdfs->open(slot.path, FILE_READ);
+    if (file) {
+      size_t size = file.size();
+      size_t end = SD32_recoverTail(file, slot);
+      file.close();
+      if (end < size) SD32_truncateFile(slot.path, end);
+      _startupStats.recoveredFiles++;
+      _startupStats.truncatedBytes += size - end;
+      Serial.printf("[SD] Recovered %s: %u bytes valid, %u dropped\n", slot.path, (unsigned)end,
+                    (unsigned)(size - end));
+      slot.length = end;
+    }
+
+    // Mark the journal closed so the next boot does not redo it
+    _journalSlot[ch] = slot;
+    _journalFile[ch] = _sdfs->open(_journalPaths[ch], "r+");
+    SD32_journalEnd(ch, slot.length);
+  }
+  _startupStats.recoveryUs = micros() - t0;
+}
+
+bool SD32_openPersistentFile(const char* filepath, uint32_t preallocMB, bool journaled) {
   if (_persistentFileOpen) {
     Serial.println("[SD] Persistent file already open");
     return true;
   }
 
-  _persistentFile = SD.open(filepath, FILE_APPEND);
-  if (!_persistentFile) {
+  _preallocBytes = (size_t)preallocMB * 1024 * 1024;
+  bool opened;
+  if (_preallocBytes > 0) {
+    opened = SD32_openPreallocated(filepath, _preallocBytes);
+  } else {
+    _persistentFile = _sdfs->open(filepath, FILE_APPEND);
+    opened = (bool)_persistentFile;
+  }
+  if (!opened) {
     Serial.println("[SD] ERROR: Could not open persistent file!");
     _persistentFileOpen = false;
+    _preallocBytes = 0;
     return false;
   }
 
+  _persistentJournaled = journaled &&
+      SD32_journalBegin(SD32_JOURNAL_PERSISTENT, filepath, SD32_JOURNAL_CSV, _persistentFile.position());
+  if (journaled && !_persistentJournaled) {
+    Serial.println("[SD] WARNING: Could not open journal, logging without commits");
+  }
+
   _persistentFileOpen = true;
   _lastFlushTime = millis();
   strncpy(_persistentFilePath, filepath, sizeof(_persistentFilePath) - 1);
@@ -201,8 +814,17 @@ bool SD32_openPersistentFile(const char* filepath) {
 
 void SD32_closePersistentFile() {
   if (_persistentFileOpen && _persistentFile) {
+    size_t end = _persistentFile.position();
     _persistentFile.flush();
     _persistentFile.close();
+    if (_preallocBytes > 0) {
+      SD32_truncateFile(_persistentFilePath, end);
+      _preallocBytes = 0;
+    }
+    if (_persistentJournaled) {
+      SD32_journalEnd(SD32_JOURNAL_PERSISTENT, end);
+      _persistentJournaled = false;
+    }
     _persistentFileOpen = false;
     _persistentFilePath[0] = '\0';
     Serial.println("[SD] Persistent file closed");
@@ -216,36 +838,614 @@ bool SD32_isPersistentFileOpen() {
 void SD32_flushPersistentFile() {
   if (_persistentFileOpen && _persistentFile) {
     _persistentFile.flush();
+    if (_persistentJournaled) SD32_journalCommit(SD32_JOURNAL_PERSISTENT, _persistentFile.position(), false);
     _lastFlushTime = millis();
   }
 }
 
-void SD32_appendBulkDataPersistent(AppenderFunc* appenders, void** dataArray, size_t count, unsigned long flushIntervalMs, unsigned long closeIntervalMs) {
-  if (!_persistentFileOpen || !_persistentFile) {
-    Serial.println("[SD] ERROR: Persistent file not open!");
+static void SD32_recordLatency(SD32_LatencyHist* hist, uint32_t us) {
+  uint8_t bucket = 0;
+  while (bucket < SD32_LATENCY_BUCKETS - 1 && us >= (64UL << bucket)) bucket++;
+  hist->buckets[bucket]++;
+  hist->count++;
+  hist->totalUs += us;
+  if (us > hist->maxUs) hist->maxUs = us;
+}
+
+void SD32_getPersistentLatency(SD32_LatencyHist* hist) {
+  *hist = _persistentLatency;
+}
+
+void SD32_resetPersistentLatency() {
+  _persistentLatency = SD32_LatencyHist();
+}
+
+void SD32_printLatencyHist(const SD32_LatencyHist* hist) {
+  if (hist->count == 0) {
+    Serial.println("[SD] Latency: no samples");
     return;
   }
-
-  for (size_t i = 0; i < count; i++) {
-    appenders[i](_persistentFile, dataArray[i]);
+  Serial.printf("[SD] Latency: %u writes, avg %u us, max %u us\n", hist->count,
+                (unsigned)(hist->totalUs / hist->count), hist->maxUs);
+  for (uint8_t i = 0; i < SD32_LATENCY_BUCKETS; i++) {
+    if (hist->buckets[i] == 0) continue;
+    if (i < SD32_LATENCY_BUCKETS - 1) Serial.printf("  < %7lu us: %u\n", 64UL << i, hist->buckets[i]);
+    else Serial.printf("  >=%7lu us: %u\n", 64UL << (i - 1), hist->buckets[i]);
   }
+}
 
-  _persistentFile.println();
-
+// Flush / commit / close cycle shared by both persistent append paths
+static void SD32_afterPersistentWrite(unsigned long t0, unsigned long flushIntervalMs, unsigned long closeIntervalMs) {
   unsigned long now = millis();
   if (flushIntervalMs == 0 || (now - _lastFlushTime >= flushIntervalMs)) {
     _persistentFile.flush();
+    if (_persistentJournaled) SD32_journalCommit(SD32_JOURNAL_PERSISTENT, _persistentFile.position(), false);
     _lastFlushTime = now;
   }
   if (closeIntervalMs > 0 && (now - _lastCloseTime >= closeIntervalMs)) {
+    size_t end = _persistentFile.position();
     _persistentFile.flush();
     _persistentFile.close();
-    // Reopen the file
-    _persistentFile = SD.open(_persistentFilePath, FILE_APPEND);
+    // Reopen the file, in place at the data end when preallocated
+    if (_preallocBytes > 0) {
+      _persistentFile = _sdfs->open(_persistentFilePath, "r+");
+      if (_persistentFile) _persistentFile.seek(end);
+    } else {
+      _persistentFile = _sdfs->open(_persistentFilePath, FILE_APPEND);
+    }
     if (!_persistentFile) {
       _persistentFileOpen = false;
       Serial.println("[SD] ERROR: Could not reopen persistent file after cycle!");
     }
     _lastCloseTime = now;
   }
+  SD32_recordLatency(&_persistentLatency, micros() - t0);
+  if (_startupStats.firstRecordMs == 0) _startupStats.firstRecordMs = millis();
+}
+
+void SD32_appendBulkDataPersistent(AppenderFunc* appenders, void** dataArray, size_t count, unsigned long flushIntervalMs, unsigned long closeIntervalMs) {
+  if (!_persistentFileOpen || !_persistentFile) {
+    Serial.println("[SD] ERROR: Persistent file not open!");
+    return;
+  }
+
+  unsigned long t0 = micros();
+  for (size_t i = 0; i < count; i++) {
+    appenders[i](_persistentFile, dataArray[i]);
+  }
+
+  _persistentFile.println();
+  SD32_afterPersistentWrite(t0, flushIntervalMs, closeIntervalMs);
+}
+
+void SD32_appendRowsPersistent(const char* rows, size_t len, unsigned long flushIntervalMs, unsigned long closeIntervalMs) {
+  if (!_persistentFileOpen || !_persistentFile) {
+    Serial.println("[SD] ERROR: Persistent file not open!");
+    return;
+  }
+
+  unsigned long t0 = micros();
+  _persistentFile.write((const uint8_t*)rows, len);
+  SD32_afterPersistentWrite(t0, flushIntervalMs, closeIntervalMs);
+}
+
+// ============================================================================
+// BINARY RING LOGGER
+// ============================================================================
+
+static void SD32_writeLogChunk(size_t len) {
+  unsigned long t0 = micros();
+  size_t written = _logFile.write(_logChunk, len);
+  uint32_t us = micros() - t0;
+  if (us > _logStats.maxWriteUs) _logStats.maxWriteUs = us;
+  _logStats.bytesWritten += written;
+  _logStats.writes++;
+}
+
+// Flush and record the committed length, logger task only
+static void SD32_commitLog() {
+  _logFile.flush();
+  if (_logJournaled) SD32_journalCommit(SD32_JOURNAL_BINARY, _logFileBase + _logStats.bytesWritten, false);
+}
+
+// Bytes from the end of the log file to its next SD32_LOG_CHUNK boundary. Chunks
+// are cut there, so full chunks stay sector aligned in the file whatever size
+// it had at start and after every idle partial flush.
+static size_t SD32_logChunkLen() {
+  return SD32_LOG_CHUNK - (_logFileBase + _logStats.bytesWritten) % SD32_LOG_CHUNK;
+}
+
+static void SD32_loggerTask(void* arg) {
+  size_t fill = 0;
+  size_t chunkLen = SD32_logChunkLen();
+  unsigned long lastWrite = millis();
+  unsigned long lastCommit = lastWrite;
+  while (true) {
+    bool stopping = _logStopping;
+    // Move committed records into the staging chunk, write whenever it is full
+    while (true) {
+      uint32_t pos = _logDequeuePos;
+      uint32_t slot = pos & _logMask;
+      if (__atomic_load_n(&_logSeq[slot], __ATOMIC_ACQUIRE) != pos + 1) break;  // Not committed yet
+      const uint8_t* rec = _logRing + (size_t)slot * _logRecordSize;
+      size_t copied = 0;
+      while (copied < _logRecordSize) {
+        size_t n = _logRecordSize - copied;
+        if (n > chunkLen - fill) n = chunkLen - fill;
+        memcpy(_logChunk + fill, rec + copied, n);
+        fill += n;
+        copied += n;
+        if (fill == chunkLen) {
+          SD32_writeLogChunk(fill);
+          fill = 0;
+          chunkLen = SD32_logChunkLen();
+          lastWrite = millis();
+          // A busy ring never goes idle, journaled logs still commit on schedule
+          if (_logJournaled && lastWrite - lastCommit >= _logFlushIntervalMs) {
+            SD32_commitLog();
+            lastCommit = lastWrite;
+          }
+        }
+      }
+      __atomic_store_n(&_logSeq[slot], pos + _logMask + 1, __ATOMIC_RELEASE);  // Free for the next lap
+      _logDequeuePos = pos + 1;
+    }
+
+    if (fill > 0 && (stopping || millis() - lastWrite >= _logFlushIntervalMs)) {
+      SD32_writeLogChunk(fill);
+      SD32_commitLog();
+      fill = 0;
+      chunkLen = SD32_logChunkLen();  // Only tops up to the boundary next time
+      lastWrite = millis();
+      lastCommit = lastWrite;
+    }
+    if (stopping) break;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(_logFlushIntervalMs));
+  }
+
+  SD32_commitLog();
+  _logFile.close();
+  _logTask = nullptr;
+  _logDone = true;
+  vTaskDelete(nullptr);
+}
+
+bool SD32_startBinaryLogger(const char* filepath, size_t recordSize, size_t ringRecords,
+                            unsigned long flushIntervalMs, int priority, int core) {
+  if (!_logDone) {
+    Serial.println("[SD] Binary logger already running");
+    return false;
+  }
+  if (recordSize == 0 || ringRecords < 2) return false;
+  uint32_t slots = 2;
+  while (slots < ringRecords) slots <<= 1;
+
+  _logRing = (uint8_t*)malloc(slots * recordSize);
+  _logSeq = (uint32_t*)malloc(slots * sizeof(uint32_t));
+  _logChunk = (uint8_t*)malloc(SD32_LOG_CHUNK);
+  _logFile = _sdfs->open(filepath, FILE_APPEND);
+  if (!_logRing || !_logSeq || !_logChunk || !_logFile) {
+    Serial.println("[SD] ERROR: Could not start binary logger!");
+    if (_logFile) _logFile.close();
+    free(_logRing); free(_logSeq); free(_logChunk);
+    _logRing = nullptr; _logSeq = nullptr; _logChunk = nullptr;
+    return false;
+  }
+
+  _logFileBase = _logFile.size();
+  for (uint32_t i = 0; i < slots; i++) _logSeq[i] = i;
+  _logRecordSize = recordSize;
+  _logMask = slots - 1;
+  _logEnqueuePos = 0;
+  _logDequeuePos = 0;
+  _logFlushIntervalMs = flushIntervalMs;
+  _logStats = SD32_LoggerStats();
+  _logStats.capacity = slots;
+  _logRun = true;
+  _logStopping = false;
+  _logDone = false;
+  if (xTaskCreatePinnedToCore(SD32_loggerTask, "SD32_log", 4096, nullptr, priority, &_logTask,
+                              core < 0 ? tskNO_AFFINITY : core) != pdPASS) {
+    Serial.println("[SD] ERROR: Could not create logger task!");
+    _logRun = false;
+    _logDone = true;
+    _logFile.close();
+    free(_logRing); free(_logSeq); free(_logChunk);
+    _logRing = nullptr; _logSeq = nullptr; _logChunk = nullptr;
+    return false;
+  }
+  Serial.printf("[SD] Binary logger started: %s (%u x %u B)\n", filepath, (unsigned)slots, (unsigned)recordSize);
+  return true;
+}
+
+static bool SD32_enqueueRecord(const void* record);
+
+bool SD32_logRecord(const void* record) {
+  __atomic_fetch_add(&_logProducers, 1, __ATOMIC_SEQ_CST);
+  bool ok = __atomic_load_n(&_logRun, __ATOMIC_SEQ_CST) && SD32_enqueueRecord(record);
+  __atomic_fetch_sub(&_logProducers, 1, __ATOMIC_ACQ_REL);
+  return ok;
+}
+
+static bool SD32_enqueueRecord(const void* record) {
+  uint32_t pos = __atomic_load_n(&_logEnqueuePos, __ATOMIC_RELAXED);
+  while (true) {
+    uint32_t slot = pos & _logMask;
+    int32_t diff = (int32_t)(__atomic_load_n(&_logSeq[slot], __ATOMIC_ACQUIRE) - pos);
+    if (diff == 0) {
+      // Slot free for this lap, claim it
+      if (__atomic_compare_exchange_n(&_logEnqueuePos, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+    } else if (diff < 0) {
+      __atomic_fetch_add(&_logStats.overruns, 1, __ATOMIC_RELAXED);
+      return false;
+    } else {
+      pos = __atomic_load_n(&_logEnqueuePos, __ATOMIC_RELAXED);
+    }
+  }
+  uint32_t slot = pos & _logMask;
+  memcpy(_logRing + (size_t)slot * _logRecordSize, record, _logRecordSize);
+  __atomic_store_n(&_logSeq[slot], pos + 1, __ATOMIC_RELEASE);
+
+  __atomic_fetch_add(&_logStats.records, 1, __ATOMIC_RELAXED);
+  uint32_t used = pos + 1 - _logDequeuePos;
+  if (used > _logStats.peakRecords) _logStats.peakRecords = used;  // Approximate under contention
+  // Wake the writer once a full chunk is waiting
+  if ((used * _logRecordSize) >= SD32_LOG_CHUNK && _logTask) xTaskNotifyGive(_logTask);
+  return true;
+}
+
+void SD32_stopBinaryLogger() {
+  if (_logDone) return;
+  __atomic_store_n(&_logRun, false, __ATOMIC_SEQ_CST);
+  // Let producers already past the _logRun check commit before the final drain
+  while (__atomic_load_n(&_logProducers, __ATOMIC_ACQUIRE) != 0) delay(1);
+  _logStopping = true;
+  if (_logTask) xTaskNotifyGive(_logTask);
+  while (!_logDone) delay(1);
+  free(_logRing); free(_logSeq); free(_logChunk);
+  _logRing = nullptr; _logSeq = nullptr; _logChunk = nullptr;
+  Serial.println("[SD] Binary logger stopped");
+}
+
+bool SD32_isBinaryLoggerRunning() {
+  return _logRun;
+}
+
+void SD32_getLoggerStats(SD32_LoggerStats* stats) {
+  *stats = _logStats;
+}
+
+// ============================================================================
+// BPLOG BINARY LOG
+// ============================================================================
+
+static bool SD32_sealBlock(uint16_t type) {
+  SD32_BlockHeader h;
+  h.sync = SD32_BLOCK_SYNC;
+  h.type = type;
+  h.payloadLen = (uint16_t)(_blogFill - sizeof(h));
+  h.seq = _blogSeq++;
+  h.crc = 0;
+  if (type == SD32_BLOCK_DATA) memcpy(_blogBlock + sizeof(h) + sizeof(uint64_t), &_blogCount, sizeof(_blogCount));
+  memset(_blogBlock + _blogFill, 0, SD32_BLOCK_SIZE - _blogFill);
+  memcpy(_blogBlock, &h, sizeof(h));
+  h.crc = SD32_blockCrc(_blogBlock);
+  memcpy(_blogBlock, &h, sizeof(h));
+  bool ok = SD32_logRecord(_blogBlock);
+  _blogFill = 0;
+  _blogCount = 0;
+  return ok;
+}
+
+bool SD32_openBinaryLog(const char* filepath, const char* name, const SD32_LogField* fields, uint8_t fieldCount,
+                        uint16_t recordSize, uint64_t startUnixMs, size_t ringBlocks) {
+  if (_blogOpen) {
+    Serial.println("[SD] Binary log already open");
+    return false;
+  }
+  if (fieldCount > SD32_MAX_FIELDS ||
+      (size_t)recordSize + 10 > SD32_BLOCK_PAYLOAD - SD32_DATA_PREFIX) {
+    Serial.println("[SD] ERROR: Binary log schema too large for a block!");
+    return false;
+  }
+  if (!SD32_startBinaryLogger(filepath, SD32_BLOCK_SIZE, ringBlocks)) return false;
+  _logJournaled = SD32_journalBegin(SD32_JOURNAL_BINARY, filepath, SD32_JOURNAL_BPLOG, _logFileBase);
+
+  _blogRecordSize = recordSize;
+  _blogSeq = 0;
+  _blogLastTime = 0;
+
+  // Schema block
+  SD32_SchemaHeader sh;
+  memset(&sh, 0, sizeof(sh));
+  sh.version = SD32_LOG_VERSION;
+  sh.recordSize = recordSize;
+  sh.fieldCount = fieldCount;
+  sh.startUnixMs = startUnixMs;
+  strncpy(sh.name, name ? name : "", sizeof(sh.name) - 1);
+  _blogFill = sizeof(SD32_BlockHeader);
+  memcpy(_blogBlock + _blogFill, &sh, sizeof(sh));
+  _blogFill += sizeof(sh);
+  for (uint8_t i = 0; i < fieldCount; i++) {
+    SD32_SchemaField f;
+    memset(&f, 0, sizeof(f));
+    strncpy(f.name, fields[i].name, SD32_FIELD_NAME_LEN - 1);
+    f.type = fields[i].type;
+    f.count = fields[i].count;
+    f.offset = fields[i].offset;
+    memcpy(_blogBlock + _blogFill, &f, sizeof(f));
+    _blogFill += sizeof(f);
+  }
+  _blogOpen = true;
+  return SD32_sealBlock(SD32_BLOCK_SCHEMA);
+}
+
+bool SD32_appendBinaryLog(uint64_t timestampMs, const void* record) {
+  if (!_blogOpen) return false;
+  bool ok = true;
+  if (_blogFill != 0 && _blogFill + 10 + _blogRecordSize > SD32_BLOCK_SIZE) {
+    ok = SD32_sealBlock(SD32_BLOCK_DATA);
+  }
+  if (_blogFill == 0) {
+    // New block: own time base so it decodes without its predecessors
+    _blogFill = sizeof(SD32_BlockHeader);
+    memcpy(_blogBlock + _blogFill, &timestampMs, sizeof(timestampMs));
+    _blogFill += SD32_DATA_PREFIX;
+    _blogLastTime = timestampMs;
+  }
+  _blogFill += SD32_putVarint(_blogBlock + _blogFill, (int64_t)(timestampMs - _blogLastTime));
+  memcpy(_blogBlock + _blogFill, record, _blogRecordSize);
+  _blogFill += _blogRecordSize;
+  _blogCount++;
+  _blogLastTime = timestampMs;
+  return ok;
+}
+
+void SD32_flushBinaryLog() {
+  if (_blogOpen && _blogCount > 0) SD32_sealBlock(SD32_BLOCK_DATA);
+}
+
+void SD32_closeBinaryLog() {
+  if (!_blogOpen) return;
+  SD32_flushBinaryLog();
+  _blogOpen = false;
+  SD32_stopBinaryLogger();
+  if (_logJournaled) {
+    _logJournaled = false;
+    SD32_journalEnd(SD32_JOURNAL_BINARY, _logFileBase + _logStats.bytesWritten);
+  }
+}
+
+// ============================================================================
+// MULTI-STREAM LOGGING
+// ============================================================================
+
+// Writes the pending half of one stream, flushes and closes it when due.
+// Writer task only.
+static void SD32_serviceStream(SD32_StreamState& s, bool stopping, unsigned long now) {
+  portENTER_CRITICAL(&_streamMux);
+  bool closing = s.closing || stopping;
+  uint8_t other = s.active ^ 1;
+  bool handoff = false;
+  if (!s.pending[other] && s.fill[s.active] > 0 &&
+      (closing || s.flushRequested || now - s.firstByteMs >= s.flushIntervalMs)) {
+    s.pending[s.active] = true;
+    s.active = other;
+    s.flushRequested = false;
+    handoff = true;  // Partial half, flush right after the write
+  }
+  int half = s.pending[0] ? 0 : (s.pending[1] ? 1 : -1);
+  size_t len = half >= 0 ? s.fill[half] : 0;
+  portEXIT_CRITICAL(&_streamMux);
+
+  if (half >= 0) {
+    unsigned long t0 = micros();
+    size_t written = s.file.write(s.buf + half * s.half, len);
+    uint32_t us = micros() - t0;
+    bool flush = handoff || closing || now - s.lastFlushMs >= s.flushIntervalMs;
+    if (flush) {
+      s.file.flush();
+      s.lastFlushMs = now;
+    }
+    portENTER_CRITICAL(&_streamMux);
+    s.fill[half] = 0;
+    s.pending[half] = false;
+    s.stats.bytesWritten += written;
+    s.stats.writes++;
+    if (flush) s.stats.flushes++;
+    SD32_recordLatency(&s.stats.writeLatency, us);
+    portEXIT_CRITICAL(&_streamMux);
+  }
+
+  // Producers are refused once closing is set, but read the halves under the
+  // lock like every other access to them
+  portENTER_CRITICAL(&_streamMux);
+  bool drained = !s.pending[0] && !s.pending[1] && s.fill[s.active] == 0;
+  portEXIT_CRITICAL(&_streamMux);
+  if (closing && drained) {
+    s.file.flush();
+    s.file.close();
+    free(s.buf);
+    portENTER_CRITICAL(&_streamMux);
+    s.buf = nullptr;
+    s.ready = false;
+    s.used = false;
+    portEXIT_CRITICAL(&_streamMux);
+  }
+}
+
+static void SD32_streamWriterTask(void* arg) {
+  while (true) {
+    bool stopping = _streamStopping;
+    bool anyOpen = false;
+    unsigned long now = millis();
+    for (int i = 0; i < SD32_MAX_STREAMS; i++) {
+      if (!_streams[i].ready) continue;
+      SD32_serviceStream(_streams[i], stopping, now);
+      anyOpen |= _streams[i].ready;
+    }
+    if (stopping && !anyOpen) break;
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(SD32_STREAM_TICK_MS));
+  }
+  _streamDone = true;
+  vTaskDelete(nullptr);
+}
+
+bool SD32_startStreamWriter(int priority, int core) {
+  if (!_streamDone) return true;
+  _streamStopping = false;
+  _streamDone = false;
+  if (xTaskCreatePinnedToCore(SD32_streamWriterTask, "SD32_stream", 4096, nullptr, priority, &_streamTask,
+                              core < 0 ? tskNO_AFFINITY : core) != pdPASS) {
+    Serial.println("[SD] ERROR: Could not create stream writer task!");
+    _streamDone = true;
+    return false;
+  }
+  return true;
+}
+
+void SD32_stopStreamWriter() {
+  if (_streamDone) return;
+  portENTER_CRITICAL(&_streamMux);
+  for (int i = 0; i < SD32_MAX_STREAMS; i++) _streams[i].closing = true;  // Refuse new rows
+  portEXIT_CRITICAL(&_streamMux);
+  _streamStopping = true;
+  xTaskNotifyGive(_streamTask);
+  while (!_streamDone) delay(1);
+  _streamTask = nullptr;
+  Serial.println("[SD] Stream writer stopped");
+}
+
+SD32_Stream SD32_openStream(const char* filepath, size_t bufferBytes, unsigned long flushIntervalMs,
+                            const char* header) {
+  if (bufferBytes == 0 || !SD32_startStreamWriter()) return -1;
+
+  SD32_Stream id = -1;
+  portENTER_CRITICAL(&_streamMux);
+  for (int i = 0; i < SD32_MAX_STREAMS; i++) {
+    if (!_streams[i].used) {
+      id = i;
+      _streams[i].used = true;  // Reserved, not ready until the file is open
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&_streamMux);
+  if (id < 0) {
+    Serial.println("[SD] ERROR: No free stream slot!");
+    return -1;
+  }
+
+  SD32_StreamState& s = _streams[id];
+  s.buf = (uint8_t*)malloc(2 * bufferBytes);
+  s.file = _sdfs->open(filepath, FILE_APPEND);
+  if (!s.buf || !s.file) {
+    Serial.printf("[SD] ERROR: Could not open stream %s\n", filepath);
+    if (s.file) s.file.close();
+    free(s.buf);
+    portENTER_CRITICAL(&_streamMux);
+    s.buf = nullptr;
+    s.used = false;
+    portEXIT_CRITICAL(&_streamMux);
+    return -1;
+  }
+  if (header && s.file.size() == 0) {
+    s.file.println(header);
+    s.file.flush();
+  }
+
+  unsigned long now = millis();
+  portENTER_CRITICAL(&_streamMux);
+  s.half = bufferBytes;
+  s.fill[0] = s.fill[1] = 0;
+  s.pending[0] = s.pending[1] = false;
+  s.active = 0;
+  s.flushIntervalMs = flushIntervalMs;
+  s.lastFlushMs = now;
+  s.openedMs = now;
+  s.flushRequested = false;
+  s.stats = SD32_StreamStats();
+  s.closing = false;
+  s.ready = true;
+  portEXIT_CRITICAL(&_streamMux);
+  Serial.printf("[SD] Stream %d opened: %s (2 x %u B)\n", id, filepath, (unsigned)bufferBytes);
+  return id;
+}
+
+bool SD32_streamWrite(SD32_Stream stream, const void* data, size_t len) {
+  if (stream < 0 || stream >= SD32_MAX_STREAMS) return false;
+  SD32_StreamState& s = _streams[stream];
+  unsigned long now = millis();
+  bool ok = true;
+  bool notify = false;
+
+  portENTER_CRITICAL(&_streamMux);
+  if (!s.ready || s.closing || len > s.half) {
+    ok = false;
+  } else if (s.fill[s.active] + len > s.half) {
+    // Active half full: hand it over if the writer is done with the other one
+    uint8_t other = s.active ^ 1;
+    if (s.pending[other]) {
+      ok = false;
+    } else {
+      s.pending[s.active] = true;
+      s.active = other;
+      notify = true;
+    }
+  }
+  if (ok) {
+    size_t& fill = s.fill[s.active];
+    if (fill == 0) s.firstByteMs = now;
+    memcpy(s.buf + s.active * s.half + fill, data, len);
+    fill += len;
+    s.stats.rows++;
+    if (fill > s.stats.peakFill) s.stats.peakFill = fill;
+  } else if (s.ready) {
+    s.stats.dropped++;
+  }
+  portEXIT_CRITICAL(&_streamMux);
+
+  if (notify) xTaskNotifyGive(_streamTask);
+  return ok;
+}
+
+bool SD32_streamPrintf(SD32_Stream stream, const char* format, ...) {
+  char row[256];
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(row, sizeof(row), format, args);
+  va_end(args);
+  if (len < 0) return false;
+  return SD32_streamWrite(stream, row, (size_t)len < sizeof(row) ? (size_t)len : sizeof(row) - 1);
+}
+
+void SD32_flushStream(SD32_Stream stream) {
+  if (stream < 0 || stream >= SD32_MAX_STREAMS) return;
+  portENTER_CRITICAL(&_streamMux);
+  _streams[stream].flushRequested = true;
+  portEXIT_CRITICAL(&_streamMux);
+  if (_streamTask) xTaskNotifyGive(_streamTask);
+}
+
+void SD32_closeStream(SD32_Stream stream) {
+  if (stream < 0 || stream >= SD32_MAX_STREAMS || _streamDone) return;
+  SD32_StreamState& s = _streams[stream];
+  portENTER_CRITICAL(&_streamMux);
+  bool open = s.ready && !s.closing;
+  if (open) s.closing = true;
+  portEXIT_CRITICAL(&_streamMux);
+  if (!open) return;
+  xTaskNotifyGive(_streamTask);
+  while (s.ready) delay(1);
+  Serial.printf("[SD] Stream %d closed\n", stream);
+}
+
+void SD32_getStreamStats(SD32_Stream stream, SD32_StreamStats* stats) {
+  if (stream < 0 || stream >= SD32_MAX_STREAMS) return;
+  SD32_StreamState& s = _streams[stream];
+  portENTER_CRITICAL(&_streamMux);
+  *stats = s.stats;
+  unsigned long openedMs = s.openedMs;
+  portEXIT_CRITICAL(&_streamMux);
+  unsigned long elapsed = millis() - openedMs;
+  stats->bytesPerSec = elapsed ? (uint32_t)((uint64_t)stats->bytesWritten * 1000 / elapsed) : 0;
 }
@@ -2,13 +2,47 @@
 #define SD32_UTIL_H
 
 #include <FS.h>
+#include <stddef.h>
+#include "SD32_logformat.h"
+#include "SD32_csv.h"
 
 // ============================================================================
 // SD CARD INITIALIZATION
 // ============================================================================
+enum SD32_Backend : uint8_t {
+  SD32_BACKEND_SPI = 0,
+  SD32_BACKEND_SDMMC_1BIT,
+  SD32_BACKEND_SDMMC_4BIT,
+};
+
+// SPI uses sck/miso/mosi/cs. SDMMC uses sck = CLK, mosi = CMD, miso = D0 and
+// d1..d3 in 4-bit mode; pins only apply on chips with a routable SDMMC (S3),
+// the classic ESP32 has them fixed.
+struct SD32_Config {
+  SD32_Backend backend = SD32_BACKEND_SPI;
+  int sck = -1, miso = -1, mosi = -1, cs = -1;
+  int d1 = -1, d2 = -1, d3 = -1;
+  uint32_t maxFreqKHz = 40000;  // Probing starts at the highest step not above this
+  bool probe = true;            // Read-back verify each clock, step down on mismatch
+  uint8_t maxFiles = 10;
+  uint32_t selfTestKB = 0;      // Sequential write self-test size, 0 = skip
+};
+
+struct SD32_CardStats {
+  uint32_t freqKHz = 0;      // Clock the card was mounted at
+  uint32_t probes = 0;       // Clock steps tried
+  uint32_t writeKBps = 0;    // Self-test sequential write speed
+  uint32_t p99WriteUs = 0;   // Self-test 4 KB write latency
+  uint32_t maxWriteUs = 0;
+};
+
+// Mounts at the highest clock that passes a read-back verify, recovers journals
+bool SD32_initSDCard(const SD32_Config& cfg);
+// SPI, probing up to 40 MHz, no self-test
 void SD32_initSDCard(int sd_sck, int sd_miso, int sd_mosi, int sd_cs, bool &sdCardReady);
 bool SD32_checkSDconnect();
 void SD32_getSDsize();
+void SD32_getCardStats(SD32_CardStats* stats);
 
 // ============================================================================
 // SESSION & FILENAME MANAGEMENT
@@ -17,6 +51,22 @@ void SD32_generateUniqueFilename(int &sessionNumber, char* csvFilename, const ch
 void SD32_createSessionDir(int &sessionNumber, char* sessionDirPath, const char* prefix);
 void SD32_generateFilenameInDir(char* filepath, const char* dirPath, const char* prefix, int index);
 
+// Numbering reads the last number from "/{prefix}_file.idx" / "/{prefix}_session.idx"
+// (two CRC checked slots, written alternately) and only scans the root directory
+// when the index is missing, corrupt or points at a name already on the card.
+struct SD32_StartupStats {
+  uint32_t mountUs = 0;         // SD.begin
+  uint32_t numberingUs = 0;     // Last SD32_generateUniqueFilename / SD32_createSessionDir
+  uint32_t scannedEntries = 0;  // Root entries walked by the fallback scan
+  bool indexHit = false;        // Number came from the index
+  uint32_t firstRecordMs = 0;   // millis() at the first persistent row, 0 = none yet
+  uint32_t recoveryUs = 0;      // Journal recovery in SD32_initSDCard
+  uint32_t recoveredFiles = 0;  // Files found not closed cleanly
+  uint32_t truncatedBytes = 0;  // Partial rows / blocks cut off by recovery
+};
+
+void SD32_getStartupStats(SD32_StartupStats* stats);
+
 // ============================================================================
 // CSV LOGGING - APPENDER ARCHITECTURE
 // ============================================================================
@@ -31,15 +81,129 @@ void SD32_appendBulkDataToCSV(const char* filepath, AppenderFunc* appenders, voi
 // PERSISTENT FILE HANDLE (recommended for continuous logging)
 // ============================================================================
 // Open file once, keep open for continuous logging
-bool SD32_openPersistentFile(const char* filepath);
+// preallocMB > 0: the file is zero-filled to that size up front so no FAT
+// cluster is allocated while logging, rows are written in place and the file is
+// truncated to the data length on close. A file left full size by a reset is
+// reopened at its data end (first all-zero sector) or trimmed by the recovery call.
+// Returns false if the card cannot hold the full size. The zero fill reserves
+// clusters through FAT, it does not guarantee they are contiguous.
+// journaled: every flush is followed by a commit record (committed length) in
+// /persist.jnl. After a power cut SD32_initSDCard keeps the committed rows plus
+// any complete rows written after them and truncates the rest, reading only
+// the tail behind the commit. Makes long flush intervals safe to use.
+bool SD32_openPersistentFile(const char* filepath, uint32_t preallocMB = 0, bool journaled = false);
 void SD32_closePersistentFile();
 bool SD32_isPersistentFileOpen();
+size_t SD32_recoverPreallocatedFile(const char* filepath);  // Trim to data length, returns it
 
 // Append data to persistent file
 // flushIntervalMs: time between flushes (0 = flush every write)
 void SD32_appendBulkDataPersistent(AppenderFunc* appenders, void** dataArray, size_t count, unsigned long flushIntervalMs, unsigned long closeIntervalMs);
+// Pre-formatted rows (e.g. SD32_CsvBuffer, SD32_csv.h) in a single write, same flush / close policy
+void SD32_appendRowsPersistent(const char* rows, size_t len, unsigned long flushIntervalMs, unsigned long closeIntervalMs);
 
 // Force flush (call before power off or SD removal)
 void SD32_flushPersistentFile();
 
+// Latency of SD32_appendBulkDataPersistent calls (rows + flush/cycle)
+// Bucket 0: < 64 us, bucket i: < 64 << i us, last bucket: everything slower
+#define SD32_LATENCY_BUCKETS 16
+
+struct SD32_LatencyHist {
+  uint32_t buckets[SD32_LATENCY_BUCKETS] = {0};
+  uint32_t count = 0;
+  uint32_t maxUs = 0;
+  uint64_t totalUs = 0;
+};
+
+void SD32_getPersistentLatency(SD32_LatencyHist* hist);
+void SD32_resetPersistentLatency();
+void SD32_printLatencyHist(const SD32_LatencyHist* hist);
+
+// ============================================================================
+// BINARY RING LOGGER (background writer task, producers never block)
+// ============================================================================
+// Producers copy fixed-size records into a lock-free ring (any task, any number
+// of producers). core = -1 lets the scheduler pick. A low priority task drains it into the file in writes ending
+// on SD32_LOG_CHUNK boundaries of the file (a multiple of the 512 B sector), so they stay sector aligned whatever
+// the file's size at start. An idle flush writes a partial chunk, the next write only tops up to the boundary.
+#define SD32_LOG_CHUNK 4096
+
+struct SD32_LoggerStats {
+  uint32_t records = 0;       // Records accepted
+  uint32_t overruns = 0;      // Records refused because the ring was full
+  uint32_t peakRecords = 0;   // Highest ring occupancy seen
+  uint32_t capacity = 0;      // Ring size in records
+  uint32_t bytesWritten = 0;
+  uint32_t writes = 0;        // File write calls
+  uint32_t maxWriteUs = 0;    // Slowest single write
+};
+
+// ringRecords is rounded up to a power of two. flushIntervalMs: an idle ring
+// with buffered data is written and flushed after this long.
+bool SD32_startBinaryLogger(const char* filepath, size_t recordSize, size_t ringRecords = 256,
+                            unsigned long flushIntervalMs = 1000, int priority = 1, int core = -1);
+bool SD32_logRecord(const void* record);  // false = overrun, record dropped
+void SD32_stopBinaryLogger();             // Drains, flushes and closes (blocks until done)
+bool SD32_isBinaryLoggerRunning();
+void SD32_getLoggerStats(SD32_LoggerStats* stats);
+
+// ============================================================================
+// BPLOG BINARY LOG (self-describing, see SD32_logformat.h)
+// ============================================================================
+// Records are packed into 512 B blocks on the caller's thread (memcpy + varint)
+// and each full block goes through the ring logger above. One producer per log.
+// Journaled in /binlog.jnl like a journaled persistent file, recovery keeps the
+// CRC valid blocks behind the last commit.
+// tools/bplog_convert.cpp turns the files of a session into CSV / columns.
+struct SD32_LogField {
+  const char* name;
+  uint8_t type;     // SD32_FieldType
+  uint8_t count;    // Array length, 1 for scalars
+  uint16_t offset;  // Byte offset inside the record
+};
+#define SD32_FIELD(rec, member, type, count) {#member, type, count, (uint16_t)offsetof(rec, member)}
+
+bool SD32_openBinaryLog(const char* filepath, const char* name, const SD32_LogField* fields, uint8_t fieldCount,
+                        uint16_t recordSize, uint64_t startUnixMs = 0, size_t ringBlocks = 16);
+bool SD32_appendBinaryLog(uint64_t timestampMs, const void* record);  // false = block dropped (ring full)
+void SD32_flushBinaryLog();   // Queue the partial block now
+void SD32_closeBinaryLog();
+
+// ============================================================================
+// MULTI-STREAM LOGGING (N persistent files, one shared writer task)
+// ============================================================================
+// Each stream owns a double buffer of 2 x bufferBytes. Producers copy whole rows
+// into the active half (a row is never split across writes) and the writer task
+// writes the other half in a single call. One wake-up writes every pending half
+// back to back and a stream's file is flushed at most once per flushIntervalMs,
+// so the bus is not bounced between files row by row. Rows that find both halves
+// busy are dropped and counted.
+#define SD32_MAX_STREAMS 4
+#define SD32_STREAM_TICK_MS 20  // Writer wake-up period for deadline checks
+
+typedef int8_t SD32_Stream;  // -1 = invalid
+
+struct SD32_StreamStats {
+  uint32_t rows = 0;          // Rows accepted
+  uint32_t dropped = 0;       // Rows refused (both halves busy, stream closing)
+  uint32_t bytesWritten = 0;
+  uint32_t bytesPerSec = 0;   // bytesWritten since open
+  uint32_t writes = 0;        // File write calls
+  uint32_t flushes = 0;
+  uint32_t peakFill = 0;      // Highest active half fill in bytes
+  SD32_LatencyHist writeLatency;
+};
+
+bool SD32_startStreamWriter(int priority = 1, int core = -1);
+void SD32_stopStreamWriter();  // Drains and closes every stream (blocks until done)
+// Starts the writer with default settings if needed. header is written only to a new file.
+SD32_Stream SD32_openStream(const char* filepath, size_t bufferBytes = 4096,
+                            unsigned long flushIntervalMs = 1000, const char* header = nullptr);
+bool SD32_streamWrite(SD32_Stream stream, const void* data, size_t len);  // false = dropped
+bool SD32_streamPrintf(SD32_Stream stream, const char* format, ...);      // Rows up to 256 B
+void SD32_flushStream(SD32_Stream stream);  // Hand the partial half to the writer now
+void SD32_closeStream(SD32_Stream stream);  // Blocks until written and closed
+void SD32_getStreamStats(SD32_Stream stream, SD32_StreamStats* stats);
+
 #endif
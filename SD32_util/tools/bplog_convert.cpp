@@ -0,0 +1,208 @@
+// ============================================================================
+// bplog_convert - host tool, BPLOG binary logs -> CSV / columnar files
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. bplog_convert.cpp -o bplog_convert
+// Usage : bplog_convert [--columns] <log file | session dir>...
+//   <log>.csv          timestamp_ms + one column per field element
+//   <log>.cols/        with --columns: one little-endian array per column
+//                      (<column>.col) plus schema.txt listing name and type
+// Damaged blocks (bad sync or CRC) are skipped, the reader resyncs on the next
+// sync word and reports how many blocks were lost.
+
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "SD32_logformat.h"
+
+namespace fsys = std::filesystem;
+
+struct Column {
+  std::string name;
+  uint8_t type;
+  uint16_t offset;  // Of this element inside the record
+};
+
+struct Schema {
+  SD32_SchemaHeader header;
+  std::vector<Column> columns;
+};
+
+static const char* typeName(uint8_t type) {
+  switch (type) {
+    case SD32_U8: return "u8";
+    case SD32_I8: return "i8";
+    case SD32_U16: return "u16";
+    case SD32_I16: return "i16";
+    case SD32_U32: return "u32";
+    case SD32_I32: return "i32";
+    case SD32_F32: return "f32";
+    case SD32_U64: return "u64";
+    case SD32_BOOL: return "bool";
+    default: return "?";
+  }
+}
+
+static void printValue(FILE* out, uint8_t type, const uint8_t* p) {
+  switch (type) {
+    case SD32_U8: fprintf(out, "%u", *p); break;
+    case SD32_BOOL: fprintf(out, "%u", *p ? 1 : 0); break;
+    case SD32_I8: fprintf(out, "%d", (int8_t)*p); break;
+    case SD32_U16: { uint16_t v; memcpy(&v, p, 2); fprintf(out, "%u", v); break; }
+    case SD32_I16: { int16_t v; memcpy(&v, p, 2); fprintf(out, "%d", v); break; }
+    case SD32_U32: { uint32_t v; memcpy(&v, p, 4); fprintf(out, "%" PRIu32, v); break; }
+    case SD32_I32: { int32_t v; memcpy(&v, p, 4); fprintf(out, "%" PRId32, v); break; }
+    case SD32_F32: { float v; memcpy(&v, p, 4); fprintf(out, "%.6g", v); break; }
+    case SD32_U64: { uint64_t v; memcpy(&v, p, 8); fprintf(out, "%" PRIu64, v); break; }
+  }
+}
+
+static bool blockValid(const uint8_t* b, size_t avail) {
+  if (avail < SD32_BLOCK_SIZE) return false;
+  SD32_BlockHeader h;
+  memcpy(&h, b, sizeof(h));
+  return h.sync == SD32_BLOCK_SYNC && h.payloadLen <= SD32_BLOCK_PAYLOAD && h.crc == SD32_blockCrc(b);
+}
+
+static bool parseSchema(const uint8_t* b, Schema* s) {
+  const uint8_t* p = b + sizeof(SD32_BlockHeader);
+  memcpy(&s->header, p, sizeof(s->header));
+  if (s->header.version != SD32_LOG_VERSION || s->header.fieldCount > SD32_MAX_FIELDS) return false;
+  p += sizeof(s->header);
+  s->columns.clear();
+  for (uint16_t i = 0; i < s->header.fieldCount; i++, p += sizeof(SD32_SchemaField)) {
+    SD32_SchemaField f;
+    memcpy(&f, p, sizeof(f));
+    std::string name(f.name, strnlen(f.name, SD32_FIELD_NAME_LEN));
+    for (uint8_t k = 0; k < f.count; k++) {
+      std::string col = f.count > 1 ? name + "_" + std::to_string(k) : name;
+      uint16_t off = f.offset + k * SD32_fieldSize(f.type);
+      if (off + SD32_fieldSize(f.type) > s->header.recordSize) return false;
+      s->columns.push_back({col, f.type, off});
+    }
+  }
+  return true;
+}
+
+static bool convert(const fsys::path& path, bool columns) {
+  std::ifstream in(path, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  Schema schema;
+  bool haveSchema = false;
+  size_t pos = 0, good = 0, bad = 0, records = 0;
+  FILE* csv = nullptr;
+  std::vector<FILE*> cols;
+  FILE* timeCol = nullptr;
+  fsys::path colDir = path.string() + ".cols";
+
+  while (pos + SD32_BLOCK_SIZE <= data.size()) {
+    const uint8_t* b = data.data() + pos;
+    if (!blockValid(b, data.size() - pos)) {
+      // Resync: next sync word that starts a valid block
+      bad++;
+      size_t next = pos + 1;
+      while (next + SD32_BLOCK_SIZE <= data.size()) {
+        uint32_t sync;
+        memcpy(&sync, data.data() + next, 4);
+        if (sync == SD32_BLOCK_SYNC && blockValid(data.data() + next, data.size() - next)) break;
+        next++;
+      }
+      pos = next;
+      continue;
+    }
+    good++;
+    SD32_BlockHeader h;
+    memcpy(&h, b, sizeof(h));
+    const uint8_t* p = b + sizeof(h);
+    const uint8_t* end = p + h.payloadLen;
+
+    if (h.type == SD32_BLOCK_SCHEMA) {
+      if (!haveSchema && parseSchema(b, &schema)) {
+        haveSchema = true;
+        csv = fopen((path.string() + ".csv").c_str(), "w");
+        if (!csv) return false;
+        fprintf(csv, "timestamp_ms");
+        for (auto& c : schema.columns) fprintf(csv, ",%s", c.name.c_str());
+        fprintf(csv, "\n");
+        if (columns) {
+          fsys::create_directories(colDir);
+          FILE* meta = fopen((colDir / "schema.txt").c_str(), "w");
+          fprintf(meta, "stream %s\nstart_unix_ms %" PRIu64 "\ntimestamp_ms i64\n",
+                  std::string(schema.header.name, strnlen(schema.header.name, sizeof(schema.header.name))).c_str(),
+                  schema.header.startUnixMs);
+          timeCol = fopen((colDir / "timestamp_ms.col").c_str(), "wb");
+          for (auto& c : schema.columns) {
+            fprintf(meta, "%s %s\n", c.name.c_str(), typeName(c.type));
+            cols.push_back(fopen((colDir / (c.name + ".col")).c_str(), "wb"));
+          }
+          fclose(meta);
+        }
+      }
+    } else if (h.type == SD32_BLOCK_DATA && haveSchema && h.payloadLen >= SD32_DATA_PREFIX) {
+      uint64_t t;
+      uint16_t count;
+      memcpy(&t, p, 8);
+      memcpy(&count, p + 8, 2);
+      p += SD32_DATA_PREFIX;
+      for (uint16_t r = 0; r < count; r++) {
+        int64_t delta;
+        size_t n = SD32_getVarint(p, end - p, &delta);
+        if (n == 0 || p + n + schema.header.recordSize > end) break;
+        p += n;
+        t += delta;
+        fprintf(csv, "%" PRIu64, t);
+        for (size_t c = 0; c < schema.columns.size(); c++) {
+          fputc(',', csv);
+          printValue(csv, schema.columns[c].type, p + schema.columns[c].offset);
+          if (columns) fwrite(p + schema.columns[c].offset, SD32_fieldSize(schema.columns[c].type), 1, cols[c]);
+        }
+        fputc('\n', csv);
+        if (columns) fwrite(&t, sizeof(t), 1, timeCol);
+        p += schema.header.recordSize;
+        records++;
+      }
+    }
+    pos += SD32_BLOCK_SIZE;
+  }
+
+  if (csv) fclose(csv);
+  if (timeCol) fclose(timeCol);
+  for (FILE* f : cols) if (f) fclose(f);
+  printf("%s: %zu records, %zu blocks ok, %zu damaged%s\n", path.c_str(), records, good, bad,
+         haveSchema ? "" : " (no schema block, skipped)");
+  return haveSchema;
+}
+
+int main(int argc, char** argv) {
+  bool columns = false;
+  std::vector<fsys::path> inputs;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--columns")) columns = true;
+    else inputs.push_back(argv[i]);
+  }
+  if (inputs.empty()) {
+    fprintf(stderr, "usage: %s [--columns] <log file | session dir>...\n", argv[0]);
+    return 1;
+  }
+
+  int failed = 0;
+  for (auto& in : inputs) {
+    if (fsys::is_directory(in)) {
+      // Session directory: every file whose first block is a BPLOG schema
+      for (auto& e : fsys::directory_iterator(in)) {
+        if (!e.is_regular_file()) continue;
+        std::ifstream f(e.path(), std::ios::binary);
+        uint32_t sync = 0;
+        f.read((char*)&sync, 4);
+        if (sync == SD32_BLOCK_SYNC && !convert(e.path(), columns)) failed++;
+      }
+    } else if (!convert(in, columns)) {
+      failed++;
+    }
+  }
+  return failed ? 2 : 0;
+}
@@ -0,0 +1,138 @@
+// ============================================================================
+// csv_bench - host micro-benchmark, Print based appenders vs SD32_CsvBuffer
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. csv_bench.cpp -o csv_bench
+// Usage : csv_bench [rows=200000]
+// Formats an AMS-like row (timestamp, 10 cell voltages, 2 temperatures, flags)
+// both ways into a sink that counts write() calls, the stand-in for the File /
+// VFS driver calls on the ESP32. The Print path follows the Arduino core:
+// virtual write per chunk, printFloat emitting the fraction digit by digit.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+#include "SD32_csv.h"
+
+// Minimal copy of the Arduino Print number / float paths
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(const uint8_t* p, size_t n) = 0;
+  size_t write(uint8_t c) { return write(&c, 1); }
+  size_t print(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  size_t print(unsigned long n) {
+    char buf[8 * sizeof(long) + 1];
+    char* str = &buf[sizeof(buf) - 1];
+    *str = '\0';
+    do {
+      unsigned long m = n;
+      n /= 10;
+      *--str = (char)('0' + (m - 10 * n));
+    } while (n);
+    return print(str);
+  }
+  size_t print(long n) {
+    if (n < 0) return write('-') + print((unsigned long)-n);
+    return print((unsigned long)n);
+  }
+  size_t print(double number, int digits) {
+    size_t n = 0;
+    if (number < 0.0) {
+      n += write('-');
+      number = -number;
+    }
+    double rounding = 0.5;
+    for (int i = 0; i < digits; ++i) rounding /= 10.0;
+    number += rounding;
+    unsigned long intPart = (unsigned long)number;
+    double remainder = number - (double)intPart;
+    n += print(intPart);
+    if (digits > 0) n += write('.');
+    while (digits-- > 0) {
+      remainder *= 10.0;
+      unsigned int toPrint = (unsigned int)remainder;
+      n += print((unsigned long)toPrint);
+      remainder -= toPrint;
+    }
+    return n;
+  }
+};
+
+class Sink : public Print {
+ public:
+  std::vector<uint8_t> data;
+  size_t calls = 0;
+  size_t write(const uint8_t* p, size_t n) override {
+    calls++;
+    data.insert(data.end(), p, p + n);
+    return n;
+  }
+  using Print::write;
+};
+
+struct Sample {
+  uint32_t ms;
+  uint8_t cellRaw[10];  // V_CELL, 0.02 V per bit
+  int8_t temp[2];
+  bool fault;
+};
+
+static double seconds(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+int main(int argc, char** argv) {
+  long rows = argc > 1 ? atol(argv[1]) : 200000;
+  std::vector<Sample> samples(1024);
+  for (size_t i = 0; i < samples.size(); i++) {
+    samples[i].ms = (uint32_t)(i * 10);
+    for (int c = 0; c < 10; c++) samples[i].cellRaw[c] = (uint8_t)(160 + (i + c) % 50);
+    samples[i].temp[0] = (int8_t)(20 + i % 30);
+    samples[i].temp[1] = (int8_t)(-5 + i % 40);
+    samples[i].fault = i % 97 == 0;
+  }
+
+  // Current path: one print per field, separators and line end as separate calls
+  Sink printSink;
+  auto t0 = std::chrono::steady_clock::now();
+  for (long r = 0; r < rows; r++) {
+    const Sample& s = samples[r & 1023];
+    printSink.print((unsigned long)s.ms);
+    for (int c = 0; c < 10; c++) {
+      printSink.print(",");
+      printSink.print(s.cellRaw[c] * 0.02, 2);
+    }
+    for (int t = 0; t < 2; t++) {
+      printSink.print(",");
+      printSink.print((long)s.temp[t]);
+    }
+    printSink.print(",");
+    printSink.print((unsigned long)s.fault);
+    printSink.print("\r\n");
+  }
+  double printSec = seconds(t0);
+
+  // Row builder: fixed point, one write per batch
+  Sink csvSink;
+  SD32_CsvBuffer<4096> csv;
+  t0 = std::chrono::steady_clock::now();
+  for (long r = 0; r < rows; r++) {
+    const Sample& s = samples[r & 1023];
+    csv.u32(s.ms);
+    for (int c = 0; c < 10; c++) csv.fixed(s.cellRaw[c] * 2, 2);
+    csv.i32(s.temp[0]).i32(s.temp[1]).boolean(s.fault).endRow();
+    if (csv.remaining() < 128) {
+      csvSink.write((const uint8_t*)csv.data(), csv.size());
+      csv.clear();
+    }
+  }
+  csvSink.write((const uint8_t*)csv.data(), csv.size());
+  double csvSec = seconds(t0);
+
+  bool same = printSink.data == csvSink.data;
+  printf("print  : %9.0f rows/s, %6.2f write calls/row\n", rows / printSec, (double)printSink.calls / rows);
+  printf("csvbuf : %9.0f rows/s, %6.4f write calls/row\n", rows / csvSec, (double)csvSink.calls / rows);
+  printf("speedup: %.1fx, output %s\n", printSec / csvSec, same ? "identical" : "DIFFERS");
+  return same ? 0 : 1;
+}
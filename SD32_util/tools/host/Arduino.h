@@ -0,0 +1,123 @@
+// Host stand-in for the Arduino core, enough to link SD32_util.cpp into host tools
+#pragma once
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#define BIN 2
+#define DEC 10
+#define HEX 16
+
+// The subset of String the library's directory scans use
+class String {
+ public:
+  String(const char* s = "") : _s(s ? s : "") {}
+  String(const std::string& s) : _s(s) {}
+  unsigned int length() const { return (unsigned int)_s.size(); }
+  const char* c_str() const { return _s.c_str(); }
+  bool startsWith(const String& p) const { return _s.compare(0, p._s.size(), p._s) == 0; }
+  bool endsWith(const String& p) const {
+    return _s.size() >= p._s.size() && _s.compare(_s.size() - p._s.size(), p._s.size(), p._s) == 0;
+  }
+  int indexOf(const String& p) const {
+    size_t i = _s.find(p._s);
+    return i == std::string::npos ? -1 : (int)i;
+  }
+  String substring(unsigned int from) const { return from < _s.size() ? String(_s.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const {
+    return from < to && from < _s.size() ? String(_s.substr(from, to - from)) : String();
+  }
+  long toInt() const { return atol(_s.c_str()); }
+  String operator+(const String& o) const { return String(_s + o._s); }
+  bool operator==(const String& o) const { return _s == o._s; }
+
+ private:
+  std::string _s;
+};
+
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t c) = 0;
+  virtual size_t write(const uint8_t* buf, size_t len) {
+    size_t n = 0;
+    while (len-- && write(*buf++)) n++;
+    return n;
+  }
+  size_t write(const char* s) { return write((const uint8_t*)s, strlen(s)); }
+  int printf(const char* fmt, ...) {
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    if (n < 0) return n;
+    return (int)write((const uint8_t*)buf, (size_t)n < sizeof(buf) ? (size_t)n : sizeof(buf) - 1);
+  }
+  size_t print(const char* s) { return write(s); }
+  size_t print(const String& s) { return write(s.c_str()); }
+  size_t print(char c) { return write((uint8_t)c); }
+  template <typename T, typename = typename std::enable_if<std::is_integral<T>::value>::type>
+  size_t print(T v, int base = DEC) {
+    char buf[66];
+    int n = 0;
+    bool neg = std::is_signed<T>::value && v < 0;
+    unsigned long long u = neg ? 0ull - (unsigned long long)v : (unsigned long long)v;
+    do buf[n++] = "0123456789ABCDEF"[u % base]; while ((u /= base) && n < 64);
+    if (neg) buf[n++] = '-';
+    for (int i = 0; i < n / 2; i++) { char c = buf[i]; buf[i] = buf[n - 1 - i]; buf[n - 1 - i] = c; }
+    buf[n] = 0;
+    return print(buf);
+  }
+  size_t print(double v, int digits = 2) { return printf("%.*f", digits, v); }
+  size_t println() { return write("\r\n"); }
+  template <typename T>
+  size_t println(T v) { return print(v) + println(); }
+  template <typename T>
+  size_t println(T v, int fmt) { return print(v, fmt) + println(); }
+};
+
+class Stream : public Print {
+ public:
+  virtual int available() { return 0; }
+  virtual int read() { return -1; }
+};
+
+// Set HostSerial::quiet to silence the library's status prints in benchmarks
+class HostSerial : public Stream {
+ public:
+  bool quiet = false;
+  size_t write(uint8_t c) override {
+    if (!quiet) fputc(c, stdout);
+    return 1;
+  }
+  size_t write(const uint8_t* buf, size_t len) override {
+    if (!quiet) fwrite(buf, 1, len, stdout);
+    return len;
+  }
+  using Print::write;
+};
+
+inline HostSerial Serial;  // One instance shared by every translation unit
+
+inline std::chrono::steady_clock::time_point hostEpoch() {
+  static const std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+  return t0;
+}
+inline uint32_t millis() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - hostEpoch()).count();
+}
+inline uint32_t micros() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - hostEpoch()).count();
+}
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() { std::this_thread::yield(); }
@@ -0,0 +1,282 @@
+// Host stand-in for the Arduino FS layer: one in-memory card behind SD and
+// SD_MMC. hostfs::powerCutAfter(n) lets the next n bytes of file writes land
+// and drops everything after, the rest of that write included, as a card
+// does when the supply goes mid-write. Every write is also counted in 512 B
+// sectors so tools can see how the library's writes line up with them.
+#pragma once
+#include <sys/types.h>
+#include <unistd.h>
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Arduino.h"
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace hostfs {
+
+struct Node {
+  std::vector<uint8_t> data;
+  bool dir = false;
+};
+
+struct WriteStats {
+  uint64_t writes = 0;
+  uint64_t bytes = 0;
+  uint64_t sectors = 0;          // Sectors touched
+  uint64_t partialSectors = 0;   // Touched but not fully covered, a read-modify-write on the card
+  uint64_t unalignedStarts = 0;  // Writes not starting on a sector boundary of the file
+  uint64_t unalignedEnds = 0;    // Writes not ending on one
+};
+
+typedef std::map<std::string, std::vector<uint8_t>> Image;  // Path -> contents, directories excluded
+
+struct Card {
+  std::recursive_mutex m;
+  std::map<std::string, std::shared_ptr<Node>> nodes;
+  int64_t budget = -1;  // Bytes left before the power cut, -1 = never
+  bool powered = true;
+  uint32_t usPerSector = 0;  // Simulated program time per sector, 0 = instant
+  WriteStats stats;
+  Card() { nodes["/"] = std::make_shared<Node>(); nodes["/"]->dir = true; }
+};
+
+inline Card& card() {
+  static Card c;
+  return c;
+}
+
+inline void format() {
+  Card& c = card();
+  std::lock_guard<std::recursive_mutex> lock(c.m);
+  c.nodes.clear();
+  c.nodes["/"] = std::make_shared<Node>();
+  c.nodes["/"]->dir = true;
+}
+
+inline void powerCutAfter(int64_t bytes) {
+  std::lock_guard<std::recursive_mutex> lock(card().m);
+  card().budget = bytes;
+  card().powered = bytes != 0;
+}
+
+inline void powerOn() {
+  std::lock_guard<std::recursive_mutex> lock(card().m);
+  card().budget = -1;
+  card().powered = true;
+}
+
+inline bool powered() {
+  std::lock_guard<std::recursive_mutex> lock(card().m);
+  return card().powered;
+}
+
+inline WriteStats stats() {
+  std::lock_guard<std::recursive_mutex> lock(card().m);
+  return card().stats;
+}
+
+inline void resetStats() {
+  std::lock_guard<std::recursive_mutex> lock(card().m);
+  card().stats = WriteStats();
+}
+
+inline Image image() {
+  Card& c = card();
+  std::lock_guard<std::recursive_mutex> lock(c.m);
+  Image img;
+  for (auto& kv : c.nodes)
+    if (!kv.second->dir) img[kv.first] = kv.second->data;
+  return img;
+}
+
+inline std::vector<uint8_t>* fileData(const std::string& path) {
+  Card& c = card();
+  std::lock_guard<std::recursive_mutex> lock(c.m);
+  auto it = c.nodes.find(path);
+  return it == c.nodes.end() || it->second->dir ? nullptr : &it->second->data;
+}
+
+inline std::string parentOf(const std::string& path) {
+  size_t slash = path.find_last_of('/');
+  return slash == 0 || slash == std::string::npos ? "/" : path.substr(0, slash);
+}
+
+}  // namespace hostfs
+
+namespace fs {
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File : public Stream {
+ public:
+  File() {}
+  File(std::shared_ptr<hostfs::Node> node, const std::string& path, bool writable, bool append)
+      : _node(node), _path(path), _writable(writable), _append(append) {
+    if (append) _pos = node->data.size();
+  }
+
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  size_t write(const uint8_t* buf, size_t len) override {
+    hostfs::Card& c = hostfs::card();
+    std::lock_guard<std::recursive_mutex> lock(c.m);
+    if (!_node || !_writable || !c.powered) return 0;
+    if (_append) _pos = _node->data.size();
+    size_t n = len;
+    if (c.budget >= 0) {
+      n = std::min<size_t>(len, (size_t)c.budget);
+      c.budget -= n;
+      if (c.budget == 0) c.powered = false;
+    }
+    if (n == 0) return 0;
+    if (_node->data.size() < _pos + n) _node->data.resize(_pos + n);
+    memcpy(_node->data.data() + _pos, buf, n);
+    size_t first = _pos / 512, last = (_pos + n - 1) / 512;
+    c.stats.writes++;
+    c.stats.bytes += n;
+    c.stats.sectors += last - first + 1;
+    bool head = _pos % 512 != 0, tail = (_pos + n) % 512 != 0;
+    c.stats.partialSectors += first == last ? (head || tail) : head + tail;
+    c.stats.unalignedStarts += head;
+    c.stats.unalignedEnds += tail;
+    _pos += n;
+    if (c.usPerSector) delayMicroseconds(c.usPerSector * (uint32_t)(last - first + 1));
+    return n;
+  }
+  using Print::write;
+
+  int available() override { return _node ? (int)(size() - std::min(size(), _pos)) : 0; }
+  int read() override {
+    uint8_t b;
+    return read(&b, 1) == 1 ? b : -1;
+  }
+  size_t read(uint8_t* buf, size_t len) {
+    std::lock_guard<std::recursive_mutex> lock(hostfs::card().m);
+    if (!_node || _pos >= _node->data.size()) return 0;
+    size_t n = std::min(len, _node->data.size() - _pos);
+    memcpy(buf, _node->data.data() + _pos, n);
+    _pos += n;
+    return n;
+  }
+  bool seek(uint32_t pos, SeekMode mode = SeekSet) {
+    if (!_node) return false;
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? _pos : size();
+    _pos = base + pos;
+    return true;
+  }
+  size_t position() const { return _pos; }
+  size_t size() const {
+    std::lock_guard<std::recursive_mutex> lock(hostfs::card().m);
+    return _node ? _node->data.size() : 0;
+  }
+  void flush() {}
+  void close() {
+    _node.reset();
+    _children.clear();
+  }
+  operator bool() const { return (bool)_node; }
+  const char* name() const { return _path.c_str(); }
+  const char* path() const { return _path.c_str(); }
+  bool isDirectory() const { return _node && _node->dir; }
+
+  File openNextFile(const char* mode = FILE_READ) {
+    (void)mode;
+    if (!isDirectory()) return File();
+    if (_next == 0) {
+      std::lock_guard<std::recursive_mutex> lock(hostfs::card().m);
+      for (auto& kv : hostfs::card().nodes)
+        if (kv.first != _path && hostfs::parentOf(kv.first) == _path) _children.push_back(kv.first);
+    }
+    while (_next < _children.size()) {
+      std::lock_guard<std::recursive_mutex> lock(hostfs::card().m);
+      auto it = hostfs::card().nodes.find(_children[_next++]);
+      if (it != hostfs::card().nodes.end()) return File(it->second, it->first, false, false);
+    }
+    return File();
+  }
+
+ private:
+  std::shared_ptr<hostfs::Node> _node;
+  std::string _path;
+  size_t _pos = 0;
+  bool _writable = false;
+  bool _append = false;
+  std::vector<std::string> _children;
+  size_t _next = 0;
+};
+
+class FS {
+ public:
+  File open(const char* path, const char* mode = FILE_READ, bool create = false) {
+    (void)create;
+    hostfs::Card& c = hostfs::card();
+    std::lock_guard<std::recursive_mutex> lock(c.m);
+    std::string m = mode;
+    auto it = c.nodes.find(path);
+    if (m == "r" || m == "r+") {
+      if (it == c.nodes.end()) return File();
+      return File(it->second, path, m == "r+" && c.powered, false);
+    }
+    if (!c.powered) return File();
+    std::shared_ptr<hostfs::Node> node;
+    if (it == c.nodes.end()) {
+      if (!exists(hostfs::parentOf(path).c_str())) return File();
+      node = std::make_shared<hostfs::Node>();
+      c.nodes[path] = node;
+    } else {
+      node = it->second;
+      if (node->dir) return File();
+      if (m == "w") node->data.clear();
+    }
+    return File(node, path, true, m == "a");
+  }
+  File open(const String& path, const char* mode = FILE_READ) { return open(path.c_str(), mode); }
+  bool exists(const char* path) {
+    std::lock_guard<std::recursive_mutex> lock(hostfs::card().m);
+    return hostfs::card().nodes.count(path) != 0;
+  }
+  bool mkdir(const char* path) {
+    hostfs::Card& c = hostfs::card();
+    std::lock_guard<std::recursive_mutex> lock(c.m);
+    if (!c.powered || c.nodes.count(path) || !c.nodes.count(hostfs::parentOf(path))) return false;
+    c.nodes[path] = std::make_shared<hostfs::Node>();
+    c.nodes[path]->dir = true;
+    return true;
+  }
+  bool remove(const char* path) {
+    hostfs::Card& c = hostfs::card();
+    std::lock_guard<std::recursive_mutex> lock(c.m);
+    return c.powered && c.nodes.erase(path) != 0;
+  }
+  bool rename(const char* from, const char* to) {
+    hostfs::Card& c = hostfs::card();
+    std::lock_guard<std::recursive_mutex> lock(c.m);
+    auto it = c.nodes.find(from);
+    if (!c.powered || it == c.nodes.end()) return false;
+    c.nodes[to] = it->second;
+    c.nodes.erase(from);
+    return true;
+  }
+};
+
+}  // namespace fs
+
+using fs::File;
+using fs::FS;
+
+// The library truncates through the VFS path (mount point + file path)
+inline int hostfs_truncate(const char* vfsPath, off_t length) {
+  hostfs::Card& c = hostfs::card();
+  std::lock_guard<std::recursive_mutex> lock(c.m);
+  const char* path = strncmp(vfsPath, "/sd/", 4) == 0 ? vfsPath + 3 : vfsPath;
+  auto it = c.nodes.find(path);
+  if (!c.powered || it == c.nodes.end() || it->second->dir) return -1;
+  it->second->data.resize((size_t)length);
+  return 0;
+}
+#define truncate hostfs_truncate
@@ -0,0 +1,22 @@
+// Host stand-in for the SD (SPI) library over the in-memory card of FS.h
+#pragma once
+#include "FS.h"
+#include "SPI.h"
+
+typedef enum { CARD_NONE, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN } sdcard_type_t;
+
+namespace fs {
+class SDFS : public FS {
+ public:
+  bool begin(uint8_t ssPin = 5, SPIClass& spi = SPI, uint32_t frequency = 4000000, const char* mountpoint = "/sd",
+             uint8_t maxFiles = 5, bool formatIfEmpty = false) {
+    (void)ssPin; (void)spi; (void)frequency; (void)mountpoint; (void)maxFiles; (void)formatIfEmpty;
+    return true;
+  }
+  void end() {}
+  sdcard_type_t cardType() { return CARD_SDHC; }
+  uint64_t cardSize() { return 32ull << 30; }
+};
+}  // namespace fs
+
+inline fs::SDFS SD;
@@ -0,0 +1,28 @@
+// Host stand-in for SD_MMC, the same in-memory card as SD
+#pragma once
+#include "FS.h"
+#include "SD.h"
+
+#define SDMMC_FREQ_DEFAULT 20000
+#define SDMMC_FREQ_HIGHSPEED 40000
+
+namespace fs {
+class SDMMCFS : public FS {
+ public:
+  bool setPins(int clk, int cmd, int d0) { (void)clk; (void)cmd; (void)d0; return true; }
+  bool setPins(int clk, int cmd, int d0, int d1, int d2, int d3) {
+    (void)clk; (void)cmd; (void)d0; (void)d1; (void)d2; (void)d3;
+    return true;
+  }
+  bool begin(const char* mountpoint = "/sdcard", bool mode1bit = false, bool formatOnFail = false,
+             int sdmmcFrequency = SDMMC_FREQ_DEFAULT, uint8_t maxOpenFiles = 5) {
+    (void)mountpoint; (void)mode1bit; (void)formatOnFail; (void)sdmmcFrequency; (void)maxOpenFiles;
+    return true;
+  }
+  void end() {}
+  sdcard_type_t cardType() { return CARD_SDHC; }
+  uint64_t cardSize() { return 32ull << 30; }
+};
+}  // namespace fs
+
+inline fs::SDMMCFS SD_MMC;
@@ -0,0 +1,109 @@
+// Host stand-in for the FreeRTOS subset SD32_util uses. Tasks are real
+// threads and critical sections are real locks, so races between the
+// library's writer tasks and their producers show up on the host too.
+#pragma once
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFu)
+#define portTICK_PERIOD_MS 1  // 1 kHz tick, as configured by the Arduino core
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define tskNO_AFFINITY 0x7FFFFFFF
+
+// portMUX is a spinlock the owning core may take again, a recursive mutex here
+struct portMUX_TYPE {
+  std::recursive_mutex m;
+};
+#define portMUX_INITIALIZER_UNLOCKED {}
+#define portENTER_CRITICAL(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL(mux) (mux)->m.unlock()
+#define portENTER_CRITICAL_ISR(mux) (mux)->m.lock()
+#define portEXIT_CRITICAL_ISR(mux) (mux)->m.unlock()
+
+typedef void (*TaskFunction_t)(void*);
+struct HostTask;
+typedef HostTask* TaskHandle_t;
+
+// Thrown by vTaskDelete(nullptr) to unwind the task's thread
+struct HostTaskExit {};
+
+// A task with its notification value, the only inter-task signal the library uses
+struct HostTask {
+  const char* name;
+  std::mutex m;
+  std::condition_variable cv;
+  uint32_t notified = 0;
+};
+
+inline HostTask*& hostCurrentTask() {
+  static thread_local HostTask* self = nullptr;
+  return self;
+}
+
+// Set to make the next xTaskCreate* fail, for the library's out of memory paths
+inline bool hostFailTaskCreate = false;
+
+// The handle is written before the task can run, like xTaskCreate does
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                          UBaseType_t priority, TaskHandle_t* handle, BaseType_t core) {
+  (void)stackDepth; (void)priority; (void)core;
+  if (hostFailTaskCreate) {
+    hostFailTaskCreate = false;
+    return pdFAIL;
+  }
+  HostTask* task = new HostTask();
+  task->name = name;
+  if (handle) *handle = task;
+  std::thread([fn, arg, task]() {
+    hostCurrentTask() = task;
+    try {
+      fn(arg);
+    } catch (HostTaskExit&) {
+    }
+    delete task;
+  }).detach();
+  return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                              UBaseType_t priority, TaskHandle_t* handle) {
+  return xTaskCreatePinnedToCore(fn, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+// Only self-deletion is supported, which is all the library does
+inline void vTaskDelete(TaskHandle_t task) {
+  if (task == nullptr || task == hostCurrentTask()) throw HostTaskExit();
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return hostCurrentTask(); }
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  {
+    std::lock_guard<std::mutex> lock(task->m);
+    task->notified++;
+  }
+  task->cv.notify_one();
+  return pdPASS;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  HostTask* task = hostCurrentTask();
+  std::unique_lock<std::mutex> lock(task->m);
+  task->cv.wait_for(lock, std::chrono::milliseconds(ticks), [task]() { return task->notified != 0; });
+  uint32_t value = task->notified;
+  if (value) task->notified = clearOnExit ? 0 : value - 1;
+  return value;
+}
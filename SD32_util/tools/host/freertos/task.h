@@ -0,0 +1,3 @@
+// Host stand-in, everything lives in FreeRTOS.h
+#pragma once
+#include "FreeRTOS.h"
@@ -0,0 +1,137 @@
+// ============================================================================
+// logger_bench - host benchmark of the binary ring logger on an in-memory card
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -pthread -I.. -Ihost logger_bench.cpp ../SD32_util.cpp -o logger_bench
+// Usage : logger_bench [seconds=3] [producers=3] [recordSize=40] [usPerSector=20] [fileBase=1000]
+// `producers` threads call SD32_logRecord in bursts with idle gaps longer than
+// the flush interval, so the writer task does both full chunks and idle
+// partial flushes. The log file already holds fileBase bytes, an arbitrary
+// size like a file appended to across boots. The card (host/FS.h) takes
+// usPerSector per 512 B sector written. Reports producer ns/record, overruns
+// and the writes as the card sees them, and checks that:
+//   - the file holds every accepted record once, each producer's in order
+//   - a write only starts off a sector boundary right after one that ended
+//     off it (an idle flush) or at the unaligned start of the file
+//   - a failed writer task start frees the ring buffers
+// Exits non-zero on any violation.
+
+#include <malloc.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+#include <Arduino.h>
+#include <SD.h>
+#include "SD32_util.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const unsigned long FLUSH_MS = 100;
+
+struct BenchRecord {
+  uint32_t producer;
+  uint32_t seq;
+};
+
+int main(int argc, char** argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 3.0;
+  int producers = argc > 2 ? atoi(argv[2]) : 3;
+  size_t recordSize = argc > 3 ? (size_t)atoi(argv[3]) : 40;
+  uint32_t usPerSector = argc > 4 ? (uint32_t)atoi(argv[4]) : 20;
+  size_t fileBase = argc > 5 ? (size_t)atoi(argv[5]) : 1000;
+  if (recordSize < sizeof(BenchRecord)) recordSize = sizeof(BenchRecord);
+  bool ok = true;
+
+  Serial.quiet = true;
+  hostfs::format();
+
+  // Create failure must not leak the ring
+  size_t heapBefore = mallinfo2().uordblks;
+  hostFailTaskCreate = true;
+  bool started = SD32_startBinaryLogger("/leak.bin", recordSize, 1024);
+  size_t leaked = mallinfo2().uordblks - heapBefore;
+  printf("failed task start: started %d, heap delta %zu bytes\n", started, leaked);
+  if (started || leaked > 256) ok = false;  // The empty file node stays, the ring must not
+
+  File f = SD.open("/log.bin", FILE_WRITE);
+  std::vector<uint8_t> junk(fileBase, 0xAA);
+  f.write(junk.data(), junk.size());
+  f.close();
+  hostfs::resetStats();
+  hostfs::card().usPerSector = usPerSector;
+
+  if (!SD32_startBinaryLogger("/log.bin", recordSize, 256, FLUSH_MS)) return 1;
+  std::atomic<bool> run(true);
+  std::vector<std::thread> threads;
+  std::vector<uint64_t> callNs(producers), calls(producers), worstNs(producers);
+  for (int p = 0; p < producers; p++) {
+    threads.emplace_back([&, p]() {
+      std::vector<uint8_t> rec(recordSize, (uint8_t)p);
+      BenchRecord head = {(uint32_t)p, 0};
+      uint32_t burst = 0;
+      while (run.load()) {
+        // 300 ms of one record per 50 us, then 1.5 flush intervals idle
+        if (++burst % 6000 == 0) delay(FLUSH_MS * 3 / 2);
+        memcpy(rec.data(), &head, sizeof(head));
+        Clock::time_point t0 = Clock::now();
+        bool accepted = SD32_logRecord(rec.data());
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+        callNs[p] += ns;
+        calls[p]++;
+        worstNs[p] = std::max(worstNs[p], ns);
+        if (accepted) head.seq++;
+        delayMicroseconds(50);
+      }
+    });
+  }
+  delay((uint32_t)(seconds * 1000));
+  run = false;
+  for (std::thread& t : threads) t.join();
+  SD32_stopBinaryLogger();
+
+  SD32_LoggerStats st;
+  SD32_getLoggerStats(&st);
+  hostfs::WriteStats ws = hostfs::stats();
+
+  // Every accepted record once, in order per producer
+  const std::vector<uint8_t>& data = *hostfs::fileData("/log.bin");
+  std::vector<uint32_t> next(producers, 0);
+  size_t bad = 0, found = 0;
+  if ((data.size() - fileBase) % recordSize != 0) bad++;
+  for (size_t pos = fileBase; pos + recordSize <= data.size(); pos += recordSize) {
+    BenchRecord r;
+    memcpy(&r, &data[pos], sizeof(r));
+    if (r.producer >= (uint32_t)producers || r.seq != next[r.producer]) {
+      bad++;
+      continue;
+    }
+    next[r.producer]++;
+    found++;
+  }
+
+  uint64_t totalCalls = 0, totalNs = 0, worst = 0;
+  for (int p = 0; p < producers; p++) {
+    totalCalls += calls[p];
+    totalNs += callNs[p];
+    worst = std::max(worst, worstNs[p]);
+  }
+  printf("%d producers, %.1f s, %zu B records, ring %u, %u us/sector, file base %zu B\n", producers, seconds,
+         recordSize, st.capacity, usPerSector, fileBase);
+  printf("SD32_logRecord      %8.1f ns/call  worst %.1f us\n", (double)totalNs / totalCalls, worst / 1000.0);
+  printf("records %u  overruns %u  peak ring %u  bytes %u\n", st.records, st.overruns, st.peakRecords,
+         st.bytesWritten);
+  printf("writes %llu  sectors %llu  partial sectors %llu  unaligned starts %llu  unaligned ends %llu  "
+         "slowest %u us\n",
+         (unsigned long long)ws.writes, (unsigned long long)ws.sectors, (unsigned long long)ws.partialSectors,
+         (unsigned long long)ws.unalignedStarts, (unsigned long long)ws.unalignedEnds, st.maxWriteUs);
+  printf("records in file %zu, bad %zu\n", found, bad);
+
+  if (bad || found != st.records) ok = false;
+  // Only the start of the file and the write after each idle flush may begin mid-sector
+  if (ws.unalignedStarts > ws.unalignedEnds + (fileBase % 512 != 0)) ok = false;
+  printf("%s\n", ok ? "OK" : "FAILED");
+  return ok ? 0 : 1;
+}
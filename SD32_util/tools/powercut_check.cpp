@@ -0,0 +1,211 @@
+// ============================================================================
+// powercut_check - journal recovery after power cuts at random byte offsets
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -pthread -I.. -Ihost powercut_check.cpp ../SD32_util.cpp -o powercut_check
+// Usage : powercut_check [csvTrials=300] [binaryTrials=20] [seed=1]
+// Runs a journaled session on the in-memory card of host/FS.h with the power
+// cut after a random number of written bytes (journal and data files alike,
+// the write in progress torn at that byte), then boots with SD32_initSDCard
+// and checks that recovery:
+//   - CSV (append and preallocated): leaves exactly the complete rows that
+//     reached the card, rows 0..n-1 in order, no partial row, no zero tail
+//   - BPLOG (SD32_openBinaryLog): leaves exactly the complete blocks that
+//     reached the card, every one with a valid sync word, CRC and sequence
+//   - marks the journal closed, a second boot recovers nothing
+// A quarter of the cuts fall anywhere in the session, opening included, the
+// rest while rows are being logged. Exits non-zero on any failed trial.
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+#include <Arduino.h>
+#include <SD.h>
+#include "SD32_util.h"
+
+static std::mt19937 rng;
+static int _failures = 0;
+static int _recovered = 0;  // Trials where recovery had a file to trim
+
+#define CHECK(cond, ...)                 \
+  do {                                   \
+    if (!(cond)) {                       \
+      if (_failures < 20) {              \
+        printf("  FAIL: " __VA_ARGS__);  \
+        printf("\n");                    \
+      }                                  \
+      _failures++;                       \
+      return;                            \
+    }                                    \
+  } while (0)
+
+static uint64_t bytesWritten() { return hostfs::stats().bytes; }
+
+static SD32_StartupStats boot() {
+  bool ready;
+  hostfs::powerOn();
+  SD32_initSDCard(18, 19, 23, 5, ready);
+  SD32_StartupStats st;
+  SD32_getStartupStats(&st);
+  return st;
+}
+
+// Random cut: anywhere in [0, total) or only past `logging`
+static int64_t pickCut(uint64_t logging, uint64_t total) {
+  uint64_t from = rng() % 4 == 0 ? 0 : logging;
+  return (int64_t)(from + rng() % (total - from));
+}
+
+// ---- CSV ----
+
+static const int CSV_ROWS = 240;
+
+static void appendRow(File& file, void* data) { file.printf("%d,%s", *(int*)data, "cell-voltages-and-temps"); }
+
+// One session: open, rows with a flush (journal commit) every 7, close.
+// Returns the bytes written when the logging started.
+static uint64_t csvSession(bool prealloc) {
+  hostfs::format();
+  hostfs::resetStats();
+  SD32_openPersistentFile("/log.csv", prealloc ? 1 : 0, true);
+  uint64_t logging = bytesWritten();
+  for (int i = 0; i < CSV_ROWS; i++) {
+    AppenderFunc appenders[1] = {appendRow};
+    void* data[1] = {&i};
+    SD32_appendBulkDataPersistent(appenders, data, 1, 60000, 0);
+    if (i % 7 == 6) SD32_flushPersistentFile();
+  }
+  SD32_closePersistentFile();
+  return logging;
+}
+
+// Complete rows on the card: up to the last '\n' before the end or a zero byte
+static size_t csvCompleteRows(const std::vector<uint8_t>* data, size_t* validEnd) {
+  size_t rows = 0, end = 0;
+  if (data) {
+    for (size_t i = 0; i < data->size() && (*data)[i] != 0; i++) {
+      if ((*data)[i] == '\n') {
+        rows++;
+        end = i + 1;
+      }
+    }
+  }
+  *validEnd = end;
+  return rows;
+}
+
+static void csvTrial(int trial, bool prealloc, uint64_t logging, uint64_t total) {
+  int64_t cut = pickCut(logging, total);
+  hostfs::format();
+  hostfs::powerCutAfter(cut);
+  csvSession(prealloc);
+  size_t validEnd;
+  size_t expected = csvCompleteRows(hostfs::fileData("/log.csv"), &validEnd);
+
+  SD32_StartupStats st = boot();
+  const std::vector<uint8_t>* data = hostfs::fileData("/log.csv");
+  if (st.recoveredFiles == 0) {
+    // Cut before the journal's first commit landed: no rows reached the card either
+    CHECK(expected == 0, "trial %d (%s, cut %lld): %zu rows on the card, nothing recovered", trial,
+          prealloc ? "prealloc" : "append", (long long)cut, expected);
+  } else {
+    _recovered++;
+    CHECK(st.recoveredFiles == 1 && data, "trial %d: recoveredFiles %u", trial, st.recoveredFiles);
+    CHECK(data->size() == validEnd, "trial %d (%s, cut %lld): recovered %zu bytes, %zu complete", trial,
+          prealloc ? "prealloc" : "append", (long long)cut, data->size(), validEnd);
+    std::string text(data->begin(), data->end());
+    size_t pos = 0;
+    for (size_t row = 0; row < expected; row++) {
+      char want[64];
+      snprintf(want, sizeof(want), "%zu,cell-voltages-and-temps\r\n", row);
+      CHECK(text.compare(pos, strlen(want), want) == 0, "trial %d: row %zu damaged", trial, row);
+      pos += strlen(want);
+    }
+    CHECK(pos == text.size(), "trial %d: %zu bytes after the last row", trial, text.size() - pos);
+  }
+  CHECK(boot().recoveredFiles == 0, "trial %d: second boot recovered again", trial);
+}
+
+// ---- BPLOG ----
+
+struct Sample {
+  uint32_t i;
+  float v;
+};
+
+static const uint32_t BPLOG_RECORDS = 3000;  // Per half, a commit in between
+
+static uint64_t binarySession() {
+  static const SD32_LogField fields[] = {SD32_FIELD(Sample, i, SD32_U32, 1), SD32_FIELD(Sample, v, SD32_F32, 1)};
+  hostfs::format();
+  hostfs::resetStats();
+  if (!SD32_openBinaryLog("/run.bplog", "cut", fields, 2, sizeof(Sample), 0, 256)) return bytesWritten();
+  uint64_t logging = bytesWritten();
+  for (uint32_t i = 0; i < 2 * BPLOG_RECORDS; i++) {
+    Sample s = {i, i * 0.5f};
+    SD32_appendBinaryLog(i, &s);
+    if (i == BPLOG_RECORDS - 1) {
+      SD32_flushBinaryLog();
+      delay(1200);  // Idle past the flush interval, the writer commits
+    }
+  }
+  SD32_closeBinaryLog();
+  return logging;
+}
+
+static void binaryTrial(int trial, uint64_t logging, uint64_t total) {
+  int64_t cut = pickCut(logging, total);
+  hostfs::format();
+  hostfs::powerCutAfter(cut);
+  binarySession();
+  const std::vector<uint8_t>* data = hostfs::fileData("/run.bplog");
+  size_t expected = data ? data->size() / SD32_BLOCK_SIZE * SD32_BLOCK_SIZE : 0;
+
+  SD32_StartupStats st = boot();
+  data = hostfs::fileData("/run.bplog");
+  if (st.recoveredFiles == 0) {
+    CHECK(expected == 0, "trial %d (cut %lld): %zu block bytes on the card, nothing recovered", trial,
+          (long long)cut, expected);
+  } else {
+    _recovered++;
+    CHECK(data && data->size() == expected, "trial %d (cut %lld): recovered %zu bytes, %zu in complete blocks",
+          trial, (long long)cut, data ? data->size() : 0, expected);
+    for (size_t pos = 0; pos < data->size(); pos += SD32_BLOCK_SIZE) {
+      SD32_BlockHeader h;
+      memcpy(&h, &(*data)[pos], sizeof(h));
+      CHECK(h.sync == SD32_BLOCK_SYNC && h.crc == SD32_blockCrc(&(*data)[pos]) &&
+                h.seq == pos / SD32_BLOCK_SIZE,
+            "trial %d: block %zu invalid", trial, pos / SD32_BLOCK_SIZE);
+    }
+  }
+  CHECK(boot().recoveredFiles == 0, "trial %d: second boot recovered again", trial);
+}
+
+int main(int argc, char** argv) {
+  int csvTrials = argc > 1 ? atoi(argv[1]) : 300;
+  int binaryTrials = argc > 2 ? atoi(argv[2]) : 20;
+  rng.seed(argc > 3 ? atoi(argv[3]) : 1);
+  Serial.quiet = true;
+
+  for (int prealloc = 0; prealloc < 2; prealloc++) {
+    uint64_t logging = csvSession(prealloc);
+    uint64_t total = bytesWritten();
+    int before = _failures;
+    _recovered = 0;
+    for (int t = 0; t < csvTrials / 2; t++) csvTrial(t, prealloc, logging, total);
+    printf("CSV %-8s %4d cuts over %8llu bytes, %4d recovered, %d failed\n", prealloc ? "prealloc" : "append",
+           csvTrials / 2, (unsigned long long)total, _recovered, _failures - before);
+  }
+
+  uint64_t logging = binarySession();
+  uint64_t total = bytesWritten();
+  int before = _failures;
+  _recovered = 0;
+  for (int t = 0; t < binaryTrials; t++) binaryTrial(t, logging, total);
+  printf("BPLOG        %4d cuts over %8llu bytes, %4d recovered, %d failed\n", binaryTrials,
+         (unsigned long long)total, _recovered, _failures - before);
+
+  printf("\n%s (%d failures)\n", _failures ? "FAILED" : "all checks passed", _failures);
+  return _failures ? 1 : 0;
+}
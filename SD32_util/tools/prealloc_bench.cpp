@@ -0,0 +1,111 @@
+// ============================================================================
+// prealloc_bench - host benchmark, append vs preallocated logging latency
+// ============================================================================
+// Build : g++ -std=c++17 -O2 prealloc_bench.cpp -o prealloc_bench
+// Usage : prealloc_bench <dir> [rows=20000] [rowBytes=200] [flushEvery=10] [preallocMB=16]
+// Run it on a FAT32 image to see cluster allocation stalls, e.g.
+//   truncate -s 256M sd.img && mkfs.vfat -F 32 sd.img
+//   sudo mount -o loop,sync sd.img /mnt/sd && ./prealloc_bench /mnt/sd
+// Same scheme as SD32_appendBulkDataPersistent: one row per write, fsync every
+// flushEvery rows, each call timed into the SD32_LatencyHist buckets.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+#define BUCKETS 16  // Same edges as SD32_LATENCY_BUCKETS: < 64 << i us
+
+struct Hist {
+  uint32_t buckets[BUCKETS] = {0};
+  uint32_t count = 0;
+  uint64_t totalUs = 0;
+  uint32_t maxUs = 0;
+  std::vector<uint32_t> samples;
+};
+
+static uint64_t nowUs() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void record(Hist& h, uint32_t us) {
+  int b = 0;
+  while (b < BUCKETS - 1 && us >= (64u << b)) b++;
+  h.buckets[b]++;
+  h.count++;
+  h.totalUs += us;
+  if (us > h.maxUs) h.maxUs = us;
+  h.samples.push_back(us);
+}
+
+static void print(const char* label, Hist& h) {
+  std::sort(h.samples.begin(), h.samples.end());
+  printf("%s: %u writes, avg %u us, p99 %u us, max %u us\n", label, h.count,
+         (unsigned)(h.totalUs / h.count), h.samples[h.samples.size() * 99 / 100], h.maxUs);
+  for (int i = 0; i < BUCKETS; i++) {
+    if (h.buckets[i] == 0) continue;
+    printf("  %s%7u us: %u\n", i < BUCKETS - 1 ? "< " : ">=", i < BUCKETS - 1 ? 64u << i : 64u << (i - 1), h.buckets[i]);
+  }
+}
+
+static Hist run(const std::string& path, long rows, size_t rowBytes, long flushEvery, size_t preallocBytes) {
+  Hist h;
+  std::string row(rowBytes - 1, '7');
+  row += '\n';
+  int fd;
+  if (preallocBytes > 0) {
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    std::vector<char> zeros(4096, 0);
+    for (size_t done = 0; done < preallocBytes; done += zeros.size()) {
+      if (write(fd, zeros.data(), zeros.size()) < 0) break;
+    }
+    fsync(fd);
+    lseek(fd, 0, SEEK_SET);
+  } else {
+    fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+  }
+  if (fd < 0) {
+    perror(path.c_str());
+    exit(1);
+  }
+
+  for (long i = 0; i < rows; i++) {
+    uint64_t t0 = nowUs();
+    if (write(fd, row.data(), row.size()) < 0) break;
+    if ((i + 1) % flushEvery == 0) fsync(fd);
+    record(h, (uint32_t)(nowUs() - t0));
+  }
+  if (preallocBytes > 0) ftruncate(fd, (off_t)rows * rowBytes);
+  close(fd);
+  return h;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s <dir> [rows] [rowBytes] [flushEvery] [preallocMB]\n", argv[0]);
+    return 1;
+  }
+  std::string dir = argv[1];
+  long rows = argc > 2 ? atol(argv[2]) : 20000;
+  size_t rowBytes = argc > 3 ? atol(argv[3]) : 200;
+  long flushEvery = argc > 4 ? atol(argv[4]) : 10;
+  size_t preallocBytes = (argc > 5 ? atol(argv[5]) : 16) * 1024UL * 1024UL;
+  if (rowBytes < 2 || flushEvery < 1 || preallocBytes < (size_t)rows * rowBytes) {
+    fprintf(stderr, "preallocMB must hold rows * rowBytes\n");
+    return 1;
+  }
+
+  Hist append = run(dir + "/bench_append.csv", rows, rowBytes, flushEvery, 0);
+  Hist prealloc = run(dir + "/bench_prealloc.csv", rows, rowBytes, flushEvery, preallocBytes);
+  print("append", append);
+  print("prealloc", prealloc);
+  unlink((dir + "/bench_append.csv").c_str());
+  unlink((dir + "/bench_prealloc.csv").c_str());
+  return 0;
+}
@@ -0,0 +1,116 @@
+/************************* Incremental Aggregator ***************************/
+
+#include "ams_aggregate.h"
+#include <string.h>
+
+static uint16_t maskOf(const BMUdata* b, uint8_t kind) {
+  switch (kind) {
+    case AMS_OV_WARN: return b->OVERVOLTAGE_WARNING;
+    case AMS_OV_CRIT: return b->OVERVOLTAGE_CRITICAL;
+    case AMS_LV_WARN: return b->LOWVOLTAGE_WARNING;
+    case AMS_LV_CRIT: return b->LOWVOLTAGE_CRITICAL;
+    case AMS_OT_WARN: return b->OVERTEMP_WARNING;
+    case AMS_OT_CRIT: return b->OVERTEMP_CRITICAL;
+    case AMS_DV_WARN: return b->OVERDIV_VOLTAGE_WARNING;
+    default: return b->OVERDIV_VOLTAGE_CRITICAL;
+  }
+}
+
+// Cells sit within a few codes of each other, so the walk after the extreme
+// bucket empties is short
+static void histRemove(AmsAggregator* agg, uint8_t v) {
+  agg->cellHist[v]--;
+  agg->cellCount--;
+  if (agg->cellCount == 0) {
+    agg->cellMin = 0xFF;
+    agg->cellMax = 0;
+    return;
+  }
+  if (agg->cellHist[v] != 0) return;
+  if (v == agg->cellMin) {
+    while (agg->cellHist[agg->cellMin] == 0) agg->cellMin++;
+  }
+  if (v == agg->cellMax) {
+    while (agg->cellHist[agg->cellMax] == 0) agg->cellMax--;
+  }
+}
+
+static void histAdd(AmsAggregator* agg, uint8_t v) {
+  agg->cellHist[v]++;
+  agg->cellCount++;
+  if (v < agg->cellMin) agg->cellMin = v;
+  if (v > agg->cellMax) agg->cellMax = v;
+}
+
+void amsAggInit(AmsAggregator* agg) {
+  memset(agg, 0, sizeof(*agg));
+  agg->cellMin = 0xFF;
+}
+
+void amsAggRemove(AmsAggregator* agg, int moduleNum) {
+  if (moduleNum < 0 || moduleNum >= MODULE_NUM) return;
+  AmsModuleContribution& c = agg->module[moduleNum];
+  if (!c.counted) return;
+  agg->accumRaw -= c.vModule;
+  for (uint8_t k = 0; k < AMS_FAULT_KINDS; k++) agg->faultCells[k] -= __builtin_popcount(c.mask[k]);
+  for (int i = 0; i < CELL_NUM; i++) histRemove(agg, c.vCell[i]);
+  agg->connected--;
+  c.counted = false;
+}
+
+void amsAggUpdate(AmsAggregator* agg, int moduleNum, const BMUdata* bmu, uint32_t nowMs) {
+  if (moduleNum < 0 || moduleNum >= MODULE_NUM) return;
+  if (!bmu->BMUconnected) {
+    amsAggRemove(agg, moduleNum);
+    return;
+  }
+
+  // Same evaluation as the kernel in mockAMS, ORed with what the BMU reported
+  static const AmsLimits limits;
+  uint32_t eval[AMS_FAULT_KINDS];
+  AmsModuleEval e = amsEvalModule(bmu->V_CELL, CELL_NUM, bmu->TEMP_SENSE, TEMP_SENSOR_NUM, limits, eval, 1);
+
+  AmsModuleContribution& c = agg->module[moduleNum];
+  bool wasCounted = c.counted;
+  agg->accumRaw += e.vSum - (wasCounted ? c.vModule : 0);
+  c.vModule = e.vSum;
+  for (uint8_t k = 0; k < AMS_FAULT_KINDS; k++) {
+    uint16_t mask = (uint16_t)(maskOf(bmu, k) | eval[k]);
+    if (wasCounted && mask == c.mask[k]) continue;
+    agg->faultCells[k] += __builtin_popcount(mask) - (wasCounted ? __builtin_popcount(c.mask[k]) : 0);
+    c.mask[k] = mask;
+  }
+  // Only cells that changed touch the histogram (a frame carries part of them)
+  for (int i = 0; i < CELL_NUM; i++) {
+    uint8_t v = bmu->V_CELL[i];
+    if (wasCounted && v == c.vCell[i]) continue;
+    histAdd(agg, v);  // Add first, so the extremes never walk over an empty histogram
+    if (wasCounted) histRemove(agg, c.vCell[i]);
+    c.vCell[i] = v;
+  }
+  c.lastSeenMs = nowMs;
+  if (!wasCounted) agg->connected++;
+  c.counted = true;
+}
+
+uint8_t amsAggExpire(AmsAggregator* agg, BMUdata* bmuArray, uint32_t nowMs) {
+  uint8_t expired = 0;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    const AmsModuleContribution& c = agg->module[m];
+    if (!c.counted || nowMs - c.lastSeenMs < AMS_DISCONNECT_TIMEOUT_MS) continue;
+    amsAggRemove(agg, m);
+    bmuArray[m].BMUconnected = false;
+    expired++;
+  }
+  return expired;
+}
+
+void amsAggApply(const AmsAggregator* agg, AMSdata* ams) {
+  AmsPackSummary summary;
+  summary.accumSum = agg->accumRaw;
+  summary.packMin = agg->cellMin;
+  summary.packMax = agg->cellMax;
+  summary.connected = agg->connected;
+  for (uint8_t k = 0; k < AMS_FAULT_KINDS; k++) summary.faults |= (uint8_t)((agg->faultCells[k] != 0) << k);
+  amsApplySummary(&summary, ams);
+}
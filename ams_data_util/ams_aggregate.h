@@ -0,0 +1,49 @@
+// =======================================================================
+// Incremental accumulator statistics, updated per received BMU frame
+// =======================================================================
+#ifndef AMS_AGGREGATE_H
+#define AMS_AGGREGATE_H
+
+#include "ams_pack.h"
+
+// mockAMS rebuilds everything from all modules. Here each module's last counted
+// contribution is kept, so an update subtracts it and adds the new one:
+// O(CELL_NUM) per frame whatever MODULE_NUM is. Flags come from counts of faulty
+// cells per category, so a flag clears as soon as its last cell clears. A cell
+// counts if the BMU reported it or the module evaluation (amsEvalModule) flags it.
+// Only connected modules contribute.
+
+#define AMS_DISCONNECT_TIMEOUT_MS ((uint32_t)(DISCONNENCTION_TIMEOUT))
+
+struct AmsModuleContribution {
+  uint8_t vCell[CELL_NUM];
+  uint16_t vModule;                // Sum of the cells, 0.02 V
+  uint16_t mask[AMS_FAULT_KINDS];  // Reported | evaluated fault masks, AmsFaultKind order
+  uint32_t lastSeenMs;
+  bool counted;
+};
+
+struct AmsAggregator {
+  AmsModuleContribution module[MODULE_NUM];
+  uint32_t accumRaw;                     // Sum of vModule, 0.02 V
+  uint16_t faultCells[AMS_FAULT_KINDS];  // Faulty cells / sensors per AmsFaultKind
+  uint16_t cellHist[256];                // Connected cells per V_CELL code
+  uint16_t cellCount;
+  uint8_t cellMin;                       // 0xFF / 0 when nothing is connected
+  uint8_t cellMax;
+  uint8_t connected;
+};
+
+void amsAggInit(AmsAggregator* agg);
+// After decodeBMUFrame: swaps the module's old contribution for bmu's current
+// state. A module with BMUconnected == false is removed instead.
+void amsAggUpdate(AmsAggregator* agg, int moduleNum, const BMUdata* bmu, uint32_t nowMs);
+void amsAggRemove(AmsAggregator* agg, int moduleNum);
+// Drops modules silent for AMS_DISCONNECT_TIMEOUT_MS and clears their
+// BMUconnected. Call from the periodic task, returns how many expired.
+uint8_t amsAggExpire(AmsAggregator* agg, BMUdata* bmuArray, uint32_t nowMs);
+// Same AMSdata as mockAMS on the connected modules, through amsApplySummary
+// (tools/aggregate_check compares the two)
+void amsAggApply(const AmsAggregator* agg, AMSdata* ams);
+
+#endif // AMS_AGGREGATE_H
@@ -0,0 +1,83 @@
+/************************* Balancing Planner ***************************/
+
+#include "ams_balance.h"
+
+static_assert(CELL_NUM <= 16, "BalancingDischarge_Cells is 16 bit");
+
+AmsBalanceResult amsPlanBalancing(BMUdata* bmuArray, const AmsBalanceConfig* cfg) {
+  static const AmsBalanceConfig defaults;
+  if (!cfg) cfg = &defaults;
+  AmsBalanceResult res = {0xFF, 0, 0, 0, false};
+
+  uint8_t packMax = 0;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    if (!bmuArray[m].BMUconnected) continue;
+    for (int c = 0; c < CELL_NUM; c++) {
+      uint8_t v = bmuArray[m].V_CELL[c];
+      res.packMin = v < res.packMin ? v : res.packMin;
+      packMax = v > packMax ? v : packMax;
+    }
+  }
+  if (packMax == 0) {  // Nothing connected
+    for (int m = 0; m < MODULE_NUM; m++) {
+      bmuArray[m].BalancingDischarge_Cells = 0;
+      bmuArray[m].BMUneedBalance = false;
+    }
+    res.packMin = 0;
+    res.converged = true;
+    return res;
+  }
+  res.spread = packMax - res.packMin;
+  bool anyAboveStart = false;
+
+  for (int m = 0; m < MODULE_NUM; m++) {
+    BMUdata& b = bmuArray[m];
+    if (!b.BMUconnected) {
+      b.BalancingDischarge_Cells = 0;
+      b.BMUneedBalance = false;
+      continue;
+    }
+
+    // Candidates: excess over the target, bleeding cells keep going down to stop
+    uint8_t excess[CELL_NUM];
+    uint16_t candidates = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      excess[c] = b.V_CELL[c] - res.packMin;
+      bool bleeding = (b.BalancingDischarge_Cells >> c) & 1;
+      bool want = excess[c] >= cfg->startRaw || (bleeding && excess[c] > cfg->stopRaw);
+      candidates |= (uint16_t)(want << c);
+      anyAboveStart |= excess[c] >= cfg->startRaw;
+    }
+
+    uint16_t hottest = 0;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) hottest = b.TEMP_SENSE[s] > hottest ? b.TEMP_SENSE[s] : hottest;
+    uint8_t slots = cfg->maxBleed;
+    if (hottest >= cfg->tempStopRaw) slots = 0;
+    else if (hottest >= cfg->tempDerateRaw) slots = (uint8_t)((slots + 1) / 2);
+    if (slots < cfg->maxBleed && candidates) res.thermalLimited++;
+
+    // Largest excess first; ties go to the cell already bleeding, then the lower index
+    uint16_t mask = 0, blocked = 0;
+    for (uint8_t k = 0; k < slots && (candidates & ~blocked); k++) {
+      int best = -1;
+      for (int c = 0; c < CELL_NUM; c++) {
+        if (!((candidates & ~blocked) >> c & 1)) continue;
+        if (best < 0 || excess[c] > excess[best] ||
+            (excess[c] == excess[best] && (b.BalancingDischarge_Cells >> c & 1) &&
+             !(b.BalancingDischarge_Cells >> best & 1))) {
+          best = c;
+        }
+      }
+      mask |= (uint16_t)(1u << best);
+      blocked |= (uint16_t)(1u << best);
+      if (cfg->noAdjacent) blocked |= (uint16_t)((1u << (best + 1)) | (best ? 1u << (best - 1) : 0));
+    }
+
+    b.BalancingDischarge_Cells = mask;
+    b.BMUneedBalance = candidates != 0;
+    res.bleeding += (uint8_t)__builtin_popcount(mask);
+  }
+
+  res.converged = res.spread < DVMAX_RAW && !anyAboveStart;
+  return res;
+}
@@ -0,0 +1,41 @@
+// =======================================================================
+// Cell balancing planner: which cells bleed this cycle
+// =======================================================================
+#ifndef AMS_BALANCE_H
+#define AMS_BALANCE_H
+
+#include "ams_data_util.h"
+
+// Passive balancing only removes charge, so every cell is driven down to the
+// lowest connected cell. With at most K bleeders per module, bleeding the K
+// cells with the most excess first is longest-remaining-work-first, which is
+// makespan optimal for preemptive jobs on K identical machines. So the slowest
+// module finishes as early as it can.
+// Hysteresis (start / stop above the pack minimum) keeps the masks from
+// chattering on V_CELL's 0.02 V steps.
+// Thermal: a module whose hottest sensor reaches TEMP_WARN_RAW runs half the
+// bleeders, and at TEMP_MAX_RAW (TEMP_MAX_CELL) none.
+
+struct AmsBalanceConfig {
+  uint8_t startRaw = DV_WARN_RAW;      // Start bleeding at min + 0.10 V
+  uint8_t stopRaw = DV_WARN_RAW / 2;   // Stop at min + 0.04 V, spread ends well inside DVMAX
+  uint8_t maxBleed = 4;                // Simultaneous bleeders per module
+  bool noAdjacent = false;             // AFEs that cannot bleed neighbouring cells together
+  uint16_t tempDerateRaw = TEMP_WARN_RAW;
+  uint16_t tempStopRaw = TEMP_MAX_RAW;
+};
+
+struct AmsBalanceResult {
+  uint8_t packMin;      // Target, V_CELL raw
+  uint8_t spread;       // Pack max - min, V_CELL raw
+  uint8_t bleeding;     // Cells bleeding this cycle
+  uint8_t thermalLimited;  // Modules derated or stopped by temperature
+  bool converged;       // spread < DVMAX_RAW and nothing above the start point
+};
+
+// Writes BalancingDischarge_Cells and BMUneedBalance of every module. It uses
+// the previous masks as hysteresis state, so pass the same array every cycle.
+// Disconnected modules get an empty mask.
+AmsBalanceResult amsPlanBalancing(BMUdata* bmuArray, const AmsBalanceConfig* cfg = nullptr);
+
+#endif // AMS_BALANCE_H
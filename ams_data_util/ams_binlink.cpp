@@ -0,0 +1,326 @@
+/************************* Binary Telemetry Link ***************************/
+
+#include "ams_binlink.h"
+#include <string.h>
+
+uint16_t amsCrc16(uint16_t crc, const uint8_t* data, size_t len) {
+  static const uint16_t table[16] = {
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+  };
+  for (size_t i = 0; i < len; i++) {
+    crc = table[((crc >> 12) ^ (data[i] >> 4)) & 0x0F] ^ (uint16_t)(crc << 4);
+    crc = table[((crc >> 12) ^ data[i]) & 0x0F] ^ (uint16_t)(crc << 4);
+  }
+  return crc;
+}
+
+size_t amsCobsEncode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t code = 0, n = 1;
+  uint8_t run = 1;
+  for (size_t i = 0; i < len; i++) {
+    if (in[i] != 0) {
+      out[n++] = in[i];
+      run++;
+    }
+    if (in[i] == 0 || run == 0xFF) {
+      out[code] = run;
+      code = n++;
+      run = 1;
+    }
+  }
+  out[code] = run;
+  return n;
+}
+
+size_t amsCobsDecode(const uint8_t* in, size_t len, uint8_t* out) {
+  size_t n = 0, i = 0;
+  while (i < len) {
+    uint8_t code = in[i++];
+    if (code == 0 || i + code - 1 > len) return 0;
+    for (uint8_t k = 1; k < code; k++) out[n++] = in[i++];
+    if (code != 0xFF && i < len) out[n++] = 0;
+  }
+  return n;
+}
+
+static inline uint8_t* put16(uint8_t* p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  return p + 2;
+}
+
+static inline uint16_t get16(const uint8_t* p) {
+  return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint16_t toFixed(float v, float scale, float max) {
+  float x = v * scale + 0.5f;
+  return x <= 0.0f ? 0 : (x >= max ? (uint16_t)max : (uint16_t)x);
+}
+
+void amsBinPack(const AMSdata* ams, const BMUdata* bmuArray, const OBCdata* obc, uint8_t* image) {
+  uint8_t* p = image;
+  p = put16(p, amsConvert<AmsAccumBinV>(AmsMillivolts(ams->ACCUM_VOLTAGE_MV)).count);
+  *p++ = (uint8_t)(ams->OVERVOLT_WARNING | ams->LOWVOLT_WARNING << 1 | ams->OVERTEMP_WARNING << 2 |
+                   ams->OVERDIV_WARNING << 3 | ams->OVERVOLT_CRITICAL << 4 | ams->LOWVOLT_CRITICAL << 5 |
+                   ams->OVERTEMP_CRITICAL << 6 | ams->OVERDIV_CRITICAL << 7);
+  *p++ = (uint8_t)(ams->AMS_OK | ams->ACCUM_CHG_READY << 1);
+  p = put16(p, toFixed(ams->ACCUM_SOC, 100.0f, 10000.0f));
+  *p++ = (uint8_t)toFixed(ams->ACCUM_SOH, 1.0f, 100.0f);
+
+  static const OBCdata noObc = {0, 0, 0, false};
+  if (!obc) obc = &noObc;
+  p = put16(p, obc->OBCVolt);
+  p = put16(p, obc->OBCAmp);
+  *p++ = obc->OBCstatusbit;
+  *p++ = obc->OBC_OK;
+
+  for (int m = 0; m < MODULE_NUM; m++) {
+    const BMUdata& b = bmuArray[m];
+    *p++ = (uint8_t)(b.BMUconnected | b.BMUneedBalance << 1);
+    memcpy(p, b.V_CELL, CELL_NUM);
+    p += CELL_NUM;
+    p = put16(p, b.V_MODULE);
+    *p++ = b.DV;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) p = put16(p, b.TEMP_SENSE[s]);
+    p = put16(p, b.BalancingDischarge_Cells);
+    p = put16(p, b.OVERVOLTAGE_WARNING);
+    p = put16(p, b.OVERVOLTAGE_CRITICAL);
+    p = put16(p, b.LOWVOLTAGE_WARNING);
+    p = put16(p, b.LOWVOLTAGE_CRITICAL);
+    p = put16(p, b.OVERTEMP_WARNING);
+    p = put16(p, b.OVERTEMP_CRITICAL);
+    p = put16(p, b.OVERDIV_VOLTAGE_WARNING);
+    p = put16(p, b.OVERDIV_VOLTAGE_CRITICAL);
+  }
+}
+
+void amsBinUnpack(const uint8_t* image, AMSdata* ams, BMUdata* bmuArray, OBCdata* obc) {
+  const uint8_t* p = image;
+  if (ams) {
+    amsSetAccumVoltage(ams, amsConvert<AmsMillivolts>(AmsAccumBinV(get16(p))));
+    uint8_t f = p[2], s = p[3];
+    ams->OVERVOLT_WARNING = f & 1;
+    ams->LOWVOLT_WARNING = f >> 1 & 1;
+    ams->OVERTEMP_WARNING = f >> 2 & 1;
+    ams->OVERDIV_WARNING = f >> 3 & 1;
+    ams->OVERVOLT_CRITICAL = f >> 4 & 1;
+    ams->LOWVOLT_CRITICAL = f >> 5 & 1;
+    ams->OVERTEMP_CRITICAL = f >> 6 & 1;
+    ams->OVERDIV_CRITICAL = f >> 7 & 1;
+    ams->AMS_OK = s & 1;
+    ams->ACCUM_CHG_READY = s >> 1 & 1;
+    ams->ACCUM_SOC = get16(p + 4) * 0.01f;
+    ams->ACCUM_SOH = p[6];
+  }
+  p += AMS_BIN_AMS_BYTES;
+  if (obc) {
+    obc->OBCVolt = get16(p);
+    obc->OBCAmp = get16(p + 2);
+    obc->OBCstatusbit = p[4];
+    obc->OBC_OK = p[5];
+  }
+  p += AMS_BIN_OBC_BYTES;
+  if (!bmuArray) return;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    BMUdata& b = bmuArray[m];
+    b.BMU_ID = BMU_ADD + ((uint32_t)m << BMU_MODULE_SHIFT);
+    b.BMUconnected = p[0] & 1;
+    b.BMUneedBalance = p[0] >> 1 & 1;
+    p++;
+    memcpy(b.V_CELL, p, CELL_NUM);
+    p += CELL_NUM;
+    b.V_MODULE = get16(p);
+    b.DV = p[2];
+    p += 3;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++, p += 2) b.TEMP_SENSE[s] = get16(p);
+    b.BalancingDischarge_Cells = get16(p);
+    b.OVERVOLTAGE_WARNING = get16(p + 2);
+    b.OVERVOLTAGE_CRITICAL = get16(p + 4);
+    b.LOWVOLTAGE_WARNING = get16(p + 6);
+    b.LOWVOLTAGE_CRITICAL = get16(p + 8);
+    b.OVERTEMP_WARNING = get16(p + 10);
+    b.OVERTEMP_CRITICAL = get16(p + 12);
+    b.OVERDIV_VOLTAGE_WARNING = get16(p + 14);
+    b.OVERDIV_VOLTAGE_CRITICAL = get16(p + 16);
+    p += 18;
+  }
+}
+
+static size_t putVarint(uint8_t* out, uint32_t v) {
+  size_t n = 0;
+  while (v >= 0x80) {
+    out[n++] = (uint8_t)(v | 0x80);
+    v >>= 7;
+  }
+  out[n++] = (uint8_t)v;
+  return n;
+}
+
+static size_t getVarint(const uint8_t* in, size_t avail, uint32_t* v) {
+  *v = 0;
+  for (size_t n = 0; n < avail && n < 3; n++) {
+    *v |= (uint32_t)(in[n] & 0x7F) << (7 * n);
+    if (!(in[n] & 0x80)) return n + 1;
+  }
+  return 0;
+}
+
+void amsBinEncoderInit(AmsBinEncoder* enc, uint16_t keyEvery) {
+  memset(enc->prev, 0, sizeof(enc->prev));
+  enc->seq = 0;
+  enc->keyEvery = keyEvery ? keyEvery : 1;
+  enc->sinceKey = 0;
+  enc->havePrev = false;
+}
+
+void amsBinForceKey(AmsBinEncoder* enc) {
+  enc->havePrev = false;
+}
+
+size_t amsBinEncode(AmsBinEncoder* enc, const AMSdata* ams, const BMUdata* bmuArray, const OBCdata* obc,
+                    uint8_t* out, size_t cap) {
+  if (cap < AMS_BIN_FRAME_MAX) return 0;
+  uint8_t image[AMS_BIN_IMAGE_BYTES];
+  uint8_t packet[AMS_BIN_PACKET_MAX];
+  amsBinPack(ams, bmuArray, obc, image);
+
+  bool key = !enc->havePrev || enc->sinceKey >= enc->keyEvery;
+  size_t n = 2;
+  packet[1] = enc->seq;
+  if (key) {
+    packet[0] = AMS_BIN_KEY;
+    packet[n++] = MODULE_NUM;
+    packet[n++] = CELL_NUM;
+    packet[n++] = TEMP_SENSOR_NUM;
+    memcpy(packet + n, image, AMS_BIN_IMAGE_BYTES);
+    n += AMS_BIN_IMAGE_BYTES;
+    enc->sinceKey = 0;
+  } else {
+    packet[0] = AMS_BIN_DELTA;
+    size_t pos = 0, i = 0;
+    while (i < AMS_BIN_IMAGE_BYTES) {
+      if (image[i] == enc->prev[i]) {
+        i++;
+        continue;
+      }
+      // Run of changed bytes; one or two equal bytes inside cost less than a new header
+      size_t end = i + 1;
+      while (end < AMS_BIN_IMAGE_BYTES) {
+        if (image[end] != enc->prev[end]) end++;
+        else if (end + 2 < AMS_BIN_IMAGE_BYTES && (image[end + 1] != enc->prev[end + 1] ||
+                                                    image[end + 2] != enc->prev[end + 2])) end += 2;
+        else break;
+      }
+      if (end > AMS_BIN_IMAGE_BYTES) end = AMS_BIN_IMAGE_BYTES;
+      n += putVarint(packet + n, (uint32_t)(i - pos));
+      n += putVarint(packet + n, (uint32_t)(end - i));
+      memcpy(packet + n, image + i, end - i);
+      n += end - i;
+      pos = i = end;
+    }
+    enc->sinceKey++;
+  }
+  uint16_t crc = amsCrc16(0xFFFF, packet, n);
+  packet[n++] = (uint8_t)crc;
+  packet[n++] = (uint8_t)(crc >> 8);
+
+  memcpy(enc->prev, image, AMS_BIN_IMAGE_BYTES);
+  enc->havePrev = true;
+  enc->seq++;
+
+  size_t len = amsCobsEncode(packet, n, out);
+  out[len++] = 0;
+  return len;
+}
+
+void amsBinDecoderInit(AmsBinDecoder* dec) {
+  dec->frameLen = 0;
+  dec->overflow = false;
+  memset(dec->image, 0, sizeof(dec->image));
+  dec->lastSeq = 0;
+  dec->synced = false;
+  memset(&dec->stats, 0, sizeof(dec->stats));
+}
+
+// Applies one packet to dec->image, false if it cannot be used
+static bool applyPacket(AmsBinDecoder* dec, const uint8_t* pkt, size_t n) {
+  if (n < 4 || amsCrc16(0xFFFF, pkt, n - 2) != get16(pkt + n - 2)) {
+    dec->stats.crcErrors++;
+    dec->synced = false;
+    return false;
+  }
+  n -= 2;
+  uint8_t type = pkt[0], seq = pkt[1];
+
+  if (type == AMS_BIN_KEY) {
+    if (n != 5 + AMS_BIN_IMAGE_BYTES) {
+      dec->stats.crcErrors++;
+      return false;
+    }
+    if (pkt[2] != MODULE_NUM || pkt[3] != CELL_NUM || pkt[4] != TEMP_SENSOR_NUM) {
+      dec->stats.mismatched++;
+      return false;
+    }
+    memcpy(dec->image, pkt + 5, AMS_BIN_IMAGE_BYTES);
+    dec->stats.keys++;
+  } else if (type == AMS_BIN_DELTA) {
+    if (!dec->synced || seq != (uint8_t)(dec->lastSeq + 1)) {
+      dec->stats.gaps++;
+      dec->synced = false;
+      return false;
+    }
+    // Validate into a copy so a malformed delta leaves the image untouched
+    uint8_t next[AMS_BIN_IMAGE_BYTES];
+    memcpy(next, dec->image, AMS_BIN_IMAGE_BYTES);
+    size_t i = 2, pos = 0;
+    while (i < n) {
+      uint32_t skip, len;
+      size_t a = getVarint(pkt + i, n - i, &skip);
+      size_t b = a ? getVarint(pkt + i + a, n - i - a, &len) : 0;
+      if (!b || pos + skip + len > AMS_BIN_IMAGE_BYTES || i + a + b + len > n) {
+        dec->stats.crcErrors++;
+        dec->synced = false;
+        return false;
+      }
+      i += a + b;
+      pos += skip;
+      memcpy(next + pos, pkt + i, len);
+      pos += len;
+      i += len;
+    }
+    memcpy(dec->image, next, AMS_BIN_IMAGE_BYTES);
+  } else {
+    dec->stats.crcErrors++;
+    return false;
+  }
+  dec->lastSeq = seq;
+  dec->synced = true;
+  dec->stats.packets++;
+  return true;
+}
+
+bool amsBinFeed(AmsBinDecoder* dec, uint8_t byte, AMSdata* ams, BMUdata* bmuArray, OBCdata* obc) {
+  if (byte != 0) {
+    if (dec->frameLen < sizeof(dec->frame)) dec->frame[dec->frameLen++] = byte;
+    else dec->overflow = true;
+    return false;
+  }
+  size_t len = dec->frameLen;
+  bool overflow = dec->overflow;
+  dec->frameLen = 0;
+  dec->overflow = false;
+  if (len == 0) return false;  // Back to back delimiters
+
+  uint8_t packet[AMS_BIN_FRAME_MAX];
+  size_t n = overflow ? 0 : amsCobsDecode(dec->frame, len, packet);
+  if (n == 0 || n > AMS_BIN_PACKET_MAX) {
+    dec->stats.crcErrors++;
+    dec->synced = false;
+    return false;
+  }
+  if (!applyPacket(dec, packet, n)) return false;
+  amsBinUnpack(dec->image, ams, bmuArray, obc);
+  return true;
+}
@@ -0,0 +1,85 @@
+// =======================================================================
+// Binary telemetry link: COBS framed, CRC checked, delta coded snapshots
+// =======================================================================
+#ifndef AMS_BINLINK_H
+#define AMS_BINLINK_H
+
+#include "ams_data_util.h"
+
+// A snapshot is a fixed little endian image of AMSdata + OBCdata + every
+// BMUdata (layout below). Packets carry either the whole image (key) or the
+// byte runs that changed since the previous packet (delta):
+//
+//   packet  = type u8 | seq u8 | payload | crc16 u16 LE   (CRC-16/CCITT-FALSE over type..payload)
+//   key     = MODULE_NUM u8 | CELL_NUM u8 | TEMP_SENSOR_NUM u8 | image
+//   delta   = runs of [skip varint][len varint][len bytes], positions relative
+//             to the end of the previous run; empty = nothing changed
+//   wire    = COBS(packet) 0x00
+//
+// The receiver applies a delta only on top of seq - 1, after a lost or corrupt
+// packet it waits for the next key (every keyEvery packets).
+//
+// Image: AMS  ACCUM_VOLTAGE u16 0.01 V, fault flags u8 (AMS frame order),
+//             AMS_OK | CHG_READY << 1 u8, ACCUM_SOC u16 0.01 %, ACCUM_SOH u8 %
+//        OBC  OBCVolt u16, OBCAmp u16, OBCstatusbit u8, OBC_OK u8
+//        BMU  BMUconnected | BMUneedBalance << 1 u8, V_CELL[] u8, V_MODULE u16,
+//             DV u8, TEMP_SENSE[] u16, BalancingDischarge_Cells u16, 8 fault masks u16
+
+#define AMS_BIN_AMS_BYTES 7
+#define AMS_BIN_OBC_BYTES 6
+#define AMS_BIN_BMU_BYTES (1 + CELL_NUM + 2 + 1 + 2 * TEMP_SENSOR_NUM + 2 + 16)
+#define AMS_BIN_IMAGE_BYTES (AMS_BIN_AMS_BYTES + AMS_BIN_OBC_BYTES + MODULE_NUM * AMS_BIN_BMU_BYTES)
+#define AMS_BIN_PACKET_MAX (2 + 3 + AMS_BIN_IMAGE_BYTES + 2)
+#define AMS_BIN_FRAME_MAX (AMS_BIN_PACKET_MAX + AMS_BIN_PACKET_MAX / 254 + 2)  // COBS + delimiter
+
+enum AmsBinType : uint8_t {
+  AMS_BIN_KEY = 1,
+  AMS_BIN_DELTA = 2,
+};
+
+uint16_t amsCrc16(uint16_t crc, const uint8_t* data, size_t len);  // Start with 0xFFFF
+size_t amsCobsEncode(const uint8_t* in, size_t len, uint8_t* out);  // No delimiter
+size_t amsCobsDecode(const uint8_t* in, size_t len, uint8_t* out);  // 0 on malformed input
+
+void amsBinPack(const AMSdata* ams, const BMUdata* bmuArray, const OBCdata* obc, uint8_t* image);
+void amsBinUnpack(const uint8_t* image, AMSdata* ams, BMUdata* bmuArray, OBCdata* obc);
+
+struct AmsBinEncoder {
+  uint8_t prev[AMS_BIN_IMAGE_BYTES];
+  uint8_t seq;
+  uint16_t keyEvery;
+  uint16_t sinceKey;
+  bool havePrev;
+};
+
+void amsBinEncoderInit(AmsBinEncoder* enc, uint16_t keyEvery = 20);
+void amsBinForceKey(AmsBinEncoder* enc);
+// One framed packet (trailing 0x00 included) into out, cap >= AMS_BIN_FRAME_MAX.
+// obc may be null (sent as zeros).
+size_t amsBinEncode(AmsBinEncoder* enc, const AMSdata* ams, const BMUdata* bmuArray, const OBCdata* obc,
+                    uint8_t* out, size_t cap);
+
+struct AmsBinDecoderStats {
+  uint32_t packets;     // Applied
+  uint32_t keys;
+  uint32_t crcErrors;   // Bad COBS, CRC or length
+  uint32_t gaps;        // Delta skipped, waiting for a key
+  uint32_t mismatched;  // Key for a different MODULE_NUM / CELL_NUM / TEMP_SENSOR_NUM
+};
+
+struct AmsBinDecoder {
+  uint8_t frame[AMS_BIN_FRAME_MAX];
+  size_t frameLen;
+  bool overflow;
+  uint8_t image[AMS_BIN_IMAGE_BYTES];
+  uint8_t lastSeq;
+  bool synced;
+  AmsBinDecoderStats stats;
+};
+
+void amsBinDecoderInit(AmsBinDecoder* dec);
+// Byte at a time from the link. true when a packet completed a snapshot,
+// then ams / bmuArray / obc (each may be null) hold it.
+bool amsBinFeed(AmsBinDecoder* dec, uint8_t byte, AMSdata* ams, BMUdata* bmuArray, OBCdata* obc);
+
+#endif // AMS_BINLINK_H
@@ -0,0 +1,636 @@
+// Generated by tools/dbc_codegen.py from ams_can.dbc, do not edit
+#ifndef AMS_CAN_DB_H
+#define AMS_CAN_DB_H
+
+#include <cstdint>
+#include <cstring>
+
+struct DbcSignalPos {
+  uint8_t startBit;  // As written in the DBC
+  uint8_t length;
+  bool bigEndian;
+};
+
+// memcpy: one load / store where the target allows unaligned access
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#define DBC_LE64(v) __builtin_bswap64(v)
+#define DBC_BE64(v) (v)
+#else
+#define DBC_LE64(v) (v)
+#define DBC_BE64(v) __builtin_bswap64(v)
+#endif
+static inline uint64_t dbcLoadLE(const uint8_t* d) {
+  uint64_t v;
+  memcpy(&v, d, 8);
+  return DBC_LE64(v);
+}
+static inline uint64_t dbcLoadBE(const uint8_t* d) {
+  uint64_t v;
+  memcpy(&v, d, 8);
+  return DBC_BE64(v);
+}
+static inline void dbcStoreLE(uint8_t* d, uint64_t v) {
+  v = DBC_LE64(v);
+  memcpy(d, &v, 8);
+}
+static inline void dbcStoreBE(uint8_t* d, uint64_t v) {
+  v = DBC_BE64(v);
+  memcpy(d, &v, 8);
+}
+
+// ---- BMU_F0 ----
+constexpr uint32_t DBC_BMU_F0_ID = 0x18200001;
+constexpr bool DBC_BMU_F0_EXTD = true;
+constexpr uint8_t DBC_BMU_F0_DLC = 8;
+constexpr uint8_t DBC_BMU_F0_SIGNAL_NUM = 8;
+constexpr DbcSignalPos DBC_BMU_F0_SIGNALS[] = {
+  {0, 8, false},  // V_CELL_0
+  {8, 8, false},  // V_CELL_1
+  {16, 8, false},  // V_CELL_2
+  {24, 8, false},  // V_CELL_3
+  {32, 8, false},  // V_CELL_4
+  {40, 8, false},  // V_CELL_5
+  {48, 8, false},  // V_CELL_6
+  {56, 8, false},  // V_CELL_7
+};
+
+struct __attribute__((packed)) dbc_BMU_F0 {
+  uint8_t V_CELL_0;
+  uint8_t V_CELL_1;
+  uint8_t V_CELL_2;
+  uint8_t V_CELL_3;
+  uint8_t V_CELL_4;
+  uint8_t V_CELL_5;
+  uint8_t V_CELL_6;
+  uint8_t V_CELL_7;
+};
+
+static inline void dbc_BMU_F0_unpack(const uint8_t* data, dbc_BMU_F0* m) {
+  const uint64_t le = dbcLoadLE(data);
+  m->V_CELL_0 = (uint8_t)((le >> 0) & 0xFFULL);
+  m->V_CELL_1 = (uint8_t)((le >> 8) & 0xFFULL);
+  m->V_CELL_2 = (uint8_t)((le >> 16) & 0xFFULL);
+  m->V_CELL_3 = (uint8_t)((le >> 24) & 0xFFULL);
+  m->V_CELL_4 = (uint8_t)((le >> 32) & 0xFFULL);
+  m->V_CELL_5 = (uint8_t)((le >> 40) & 0xFFULL);
+  m->V_CELL_6 = (uint8_t)((le >> 48) & 0xFFULL);
+  m->V_CELL_7 = (uint8_t)((le >> 56) & 0xFFULL);
+}
+
+static inline void dbc_BMU_F0_pack(const dbc_BMU_F0* m, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)m->V_CELL_0 & 0xFFULL) << 0;
+  le |= ((uint64_t)m->V_CELL_1 & 0xFFULL) << 8;
+  le |= ((uint64_t)m->V_CELL_2 & 0xFFULL) << 16;
+  le |= ((uint64_t)m->V_CELL_3 & 0xFFULL) << 24;
+  le |= ((uint64_t)m->V_CELL_4 & 0xFFULL) << 32;
+  le |= ((uint64_t)m->V_CELL_5 & 0xFFULL) << 40;
+  le |= ((uint64_t)m->V_CELL_6 & 0xFFULL) << 48;
+  le |= ((uint64_t)m->V_CELL_7 & 0xFFULL) << 56;
+  dbcStoreLE(data, le);
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_BMU_F0_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  t->V_CELL[0] = (uint8_t)((le >> 0) & 0xFFULL);
+  t->V_CELL[1] = (uint8_t)((le >> 8) & 0xFFULL);
+  t->V_CELL[2] = (uint8_t)((le >> 16) & 0xFFULL);
+  t->V_CELL[3] = (uint8_t)((le >> 24) & 0xFFULL);
+  t->V_CELL[4] = (uint8_t)((le >> 32) & 0xFFULL);
+  t->V_CELL[5] = (uint8_t)((le >> 40) & 0xFFULL);
+  t->V_CELL[6] = (uint8_t)((le >> 48) & 0xFFULL);
+  t->V_CELL[7] = (uint8_t)((le >> 56) & 0xFFULL);
+}
+
+template <typename T>
+static inline void dbc_BMU_F0_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)t->V_CELL[0] & 0xFFULL) << 0;
+  le |= ((uint64_t)t->V_CELL[1] & 0xFFULL) << 8;
+  le |= ((uint64_t)t->V_CELL[2] & 0xFFULL) << 16;
+  le |= ((uint64_t)t->V_CELL[3] & 0xFFULL) << 24;
+  le |= ((uint64_t)t->V_CELL[4] & 0xFFULL) << 32;
+  le |= ((uint64_t)t->V_CELL[5] & 0xFFULL) << 40;
+  le |= ((uint64_t)t->V_CELL[6] & 0xFFULL) << 48;
+  le |= ((uint64_t)t->V_CELL[7] & 0xFFULL) << 56;
+  dbcStoreLE(data, le);
+}
+
+constexpr float DBC_V_CELL_0_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_0_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_0_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_1_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_1_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_1_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_2_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_2_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_2_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_3_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_3_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_3_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_4_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_4_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_4_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_5_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_5_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_5_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_6_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_6_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_6_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_7_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_7_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_7_milli(int32_t raw) { return raw * 20; }  // V x1000
+
+// ---- BMU_F1 ----
+constexpr uint32_t DBC_BMU_F1_ID = 0x18200002;
+constexpr bool DBC_BMU_F1_EXTD = true;
+constexpr uint8_t DBC_BMU_F1_DLC = 8;
+constexpr uint8_t DBC_BMU_F1_SIGNAL_NUM = 6;
+constexpr DbcSignalPos DBC_BMU_F1_SIGNALS[] = {
+  {0, 8, false},  // V_CELL_8
+  {8, 8, false},  // V_CELL_9
+  {16, 16, false},  // V_MODULE
+  {32, 8, false},  // DV
+  {40, 8, false},  // BMUneedBalance
+  {48, 16, false},  // TEMP_SENSE_0
+};
+
+struct __attribute__((packed)) dbc_BMU_F1 {
+  uint8_t V_CELL_8;
+  uint8_t V_CELL_9;
+  uint16_t V_MODULE;
+  uint8_t DV;
+  uint8_t BMUneedBalance;
+  uint16_t TEMP_SENSE_0;
+};
+
+static inline void dbc_BMU_F1_unpack(const uint8_t* data, dbc_BMU_F1* m) {
+  const uint64_t le = dbcLoadLE(data);
+  m->V_CELL_8 = (uint8_t)((le >> 0) & 0xFFULL);
+  m->V_CELL_9 = (uint8_t)((le >> 8) & 0xFFULL);
+  m->V_MODULE = (uint16_t)((le >> 16) & 0xFFFFULL);
+  m->DV = (uint8_t)((le >> 32) & 0xFFULL);
+  m->BMUneedBalance = (uint8_t)((le >> 40) & 0xFFULL);
+  m->TEMP_SENSE_0 = (uint16_t)((le >> 48) & 0xFFFFULL);
+}
+
+static inline void dbc_BMU_F1_pack(const dbc_BMU_F1* m, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)m->V_CELL_8 & 0xFFULL) << 0;
+  le |= ((uint64_t)m->V_CELL_9 & 0xFFULL) << 8;
+  le |= ((uint64_t)m->V_MODULE & 0xFFFFULL) << 16;
+  le |= ((uint64_t)m->DV & 0xFFULL) << 32;
+  le |= ((uint64_t)m->BMUneedBalance & 0xFFULL) << 40;
+  le |= ((uint64_t)m->TEMP_SENSE_0 & 0xFFFFULL) << 48;
+  dbcStoreLE(data, le);
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_BMU_F1_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  t->V_CELL[8] = (uint8_t)((le >> 0) & 0xFFULL);
+  t->V_CELL[9] = (uint8_t)((le >> 8) & 0xFFULL);
+  t->V_MODULE = (uint16_t)((le >> 16) & 0xFFFFULL);
+  t->DV = (uint8_t)((le >> 32) & 0xFFULL);
+  t->BMUneedBalance = (uint8_t)((le >> 40) & 0xFFULL);
+  t->TEMP_SENSE[0] = (uint16_t)((le >> 48) & 0xFFFFULL);
+}
+
+template <typename T>
+static inline void dbc_BMU_F1_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)t->V_CELL[8] & 0xFFULL) << 0;
+  le |= ((uint64_t)t->V_CELL[9] & 0xFFULL) << 8;
+  le |= ((uint64_t)t->V_MODULE & 0xFFFFULL) << 16;
+  le |= ((uint64_t)t->DV & 0xFFULL) << 32;
+  le |= ((uint64_t)t->BMUneedBalance & 0xFFULL) << 40;
+  le |= ((uint64_t)t->TEMP_SENSE[0] & 0xFFFFULL) << 48;
+  dbcStoreLE(data, le);
+}
+
+constexpr float DBC_V_CELL_8_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_8_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_8_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_CELL_9_FACTOR = 0.02f;
+constexpr float DBC_V_CELL_9_OFFSET = 0.0f;
+static inline int32_t DBC_V_CELL_9_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_V_MODULE_FACTOR = 0.02f;
+constexpr float DBC_V_MODULE_OFFSET = 0.0f;
+static inline int32_t DBC_V_MODULE_milli(int32_t raw) { return raw * 20; }  // V x1000
+constexpr float DBC_DV_FACTOR = 0.1f;
+constexpr float DBC_DV_OFFSET = 0.0f;
+static inline int32_t DBC_DV_milli(int32_t raw) { return raw * 100; }  // V x1000
+constexpr float DBC_TEMP_SENSE_0_FACTOR = 0.0125f;
+constexpr float DBC_TEMP_SENSE_0_OFFSET = 2.0f;
+static inline int32_t DBC_TEMP_SENSE_0_milli(int32_t raw) { return ((raw * 25 + 1) >> 1) + 2000; }  // V x1000
+
+// ---- BMU_F2 ----
+constexpr uint32_t DBC_BMU_F2_ID = 0x18200003;
+constexpr bool DBC_BMU_F2_EXTD = true;
+constexpr uint8_t DBC_BMU_F2_DLC = 8;
+constexpr uint8_t DBC_BMU_F2_SIGNAL_NUM = 4;
+constexpr DbcSignalPos DBC_BMU_F2_SIGNALS[] = {
+  {0, 16, false},  // TEMP_SENSE_1
+  {16, 16, false},  // BalancingDischarge_Cells
+  {32, 16, false},  // OVERVOLTAGE_WARNING
+  {48, 16, false},  // OVERVOLTAGE_CRITICAL
+};
+
+struct __attribute__((packed)) dbc_BMU_F2 {
+  uint16_t TEMP_SENSE_1;
+  uint16_t BalancingDischarge_Cells;
+  uint16_t OVERVOLTAGE_WARNING;
+  uint16_t OVERVOLTAGE_CRITICAL;
+};
+
+static inline void dbc_BMU_F2_unpack(const uint8_t* data, dbc_BMU_F2* m) {
+  const uint64_t le = dbcLoadLE(data);
+  m->TEMP_SENSE_1 = (uint16_t)((le >> 0) & 0xFFFFULL);
+  m->BalancingDischarge_Cells = (uint16_t)((le >> 16) & 0xFFFFULL);
+  m->OVERVOLTAGE_WARNING = (uint16_t)((le >> 32) & 0xFFFFULL);
+  m->OVERVOLTAGE_CRITICAL = (uint16_t)((le >> 48) & 0xFFFFULL);
+}
+
+static inline void dbc_BMU_F2_pack(const dbc_BMU_F2* m, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)m->TEMP_SENSE_1 & 0xFFFFULL) << 0;
+  le |= ((uint64_t)m->BalancingDischarge_Cells & 0xFFFFULL) << 16;
+  le |= ((uint64_t)m->OVERVOLTAGE_WARNING & 0xFFFFULL) << 32;
+  le |= ((uint64_t)m->OVERVOLTAGE_CRITICAL & 0xFFFFULL) << 48;
+  dbcStoreLE(data, le);
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_BMU_F2_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  t->TEMP_SENSE[1] = (uint16_t)((le >> 0) & 0xFFFFULL);
+  t->BalancingDischarge_Cells = (uint16_t)((le >> 16) & 0xFFFFULL);
+  t->OVERVOLTAGE_WARNING = (uint16_t)((le >> 32) & 0xFFFFULL);
+  t->OVERVOLTAGE_CRITICAL = (uint16_t)((le >> 48) & 0xFFFFULL);
+}
+
+template <typename T>
+static inline void dbc_BMU_F2_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)t->TEMP_SENSE[1] & 0xFFFFULL) << 0;
+  le |= ((uint64_t)t->BalancingDischarge_Cells & 0xFFFFULL) << 16;
+  le |= ((uint64_t)t->OVERVOLTAGE_WARNING & 0xFFFFULL) << 32;
+  le |= ((uint64_t)t->OVERVOLTAGE_CRITICAL & 0xFFFFULL) << 48;
+  dbcStoreLE(data, le);
+}
+
+constexpr float DBC_TEMP_SENSE_1_FACTOR = 0.0125f;
+constexpr float DBC_TEMP_SENSE_1_OFFSET = 2.0f;
+static inline int32_t DBC_TEMP_SENSE_1_milli(int32_t raw) { return ((raw * 25 + 1) >> 1) + 2000; }  // V x1000
+
+// ---- BMU_F3 ----
+constexpr uint32_t DBC_BMU_F3_ID = 0x18200004;
+constexpr bool DBC_BMU_F3_EXTD = true;
+constexpr uint8_t DBC_BMU_F3_DLC = 8;
+constexpr uint8_t DBC_BMU_F3_SIGNAL_NUM = 4;
+constexpr DbcSignalPos DBC_BMU_F3_SIGNALS[] = {
+  {0, 16, false},  // LOWVOLTAGE_WARNING
+  {16, 16, false},  // LOWVOLTAGE_CRITICAL
+  {32, 16, false},  // OVERTEMP_WARNING
+  {48, 16, false},  // OVERTEMP_CRITICAL
+};
+
+struct __attribute__((packed)) dbc_BMU_F3 {
+  uint16_t LOWVOLTAGE_WARNING;
+  uint16_t LOWVOLTAGE_CRITICAL;
+  uint16_t OVERTEMP_WARNING;
+  uint16_t OVERTEMP_CRITICAL;
+};
+
+static inline void dbc_BMU_F3_unpack(const uint8_t* data, dbc_BMU_F3* m) {
+  const uint64_t le = dbcLoadLE(data);
+  m->LOWVOLTAGE_WARNING = (uint16_t)((le >> 0) & 0xFFFFULL);
+  m->LOWVOLTAGE_CRITICAL = (uint16_t)((le >> 16) & 0xFFFFULL);
+  m->OVERTEMP_WARNING = (uint16_t)((le >> 32) & 0xFFFFULL);
+  m->OVERTEMP_CRITICAL = (uint16_t)((le >> 48) & 0xFFFFULL);
+}
+
+static inline void dbc_BMU_F3_pack(const dbc_BMU_F3* m, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)m->LOWVOLTAGE_WARNING & 0xFFFFULL) << 0;
+  le |= ((uint64_t)m->LOWVOLTAGE_CRITICAL & 0xFFFFULL) << 16;
+  le |= ((uint64_t)m->OVERTEMP_WARNING & 0xFFFFULL) << 32;
+  le |= ((uint64_t)m->OVERTEMP_CRITICAL & 0xFFFFULL) << 48;
+  dbcStoreLE(data, le);
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_BMU_F3_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  t->LOWVOLTAGE_WARNING = (uint16_t)((le >> 0) & 0xFFFFULL);
+  t->LOWVOLTAGE_CRITICAL = (uint16_t)((le >> 16) & 0xFFFFULL);
+  t->OVERTEMP_WARNING = (uint16_t)((le >> 32) & 0xFFFFULL);
+  t->OVERTEMP_CRITICAL = (uint16_t)((le >> 48) & 0xFFFFULL);
+}
+
+template <typename T>
+static inline void dbc_BMU_F3_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)t->LOWVOLTAGE_WARNING & 0xFFFFULL) << 0;
+  le |= ((uint64_t)t->LOWVOLTAGE_CRITICAL & 0xFFFFULL) << 16;
+  le |= ((uint64_t)t->OVERTEMP_WARNING & 0xFFFFULL) << 32;
+  le |= ((uint64_t)t->OVERTEMP_CRITICAL & 0xFFFFULL) << 48;
+  dbcStoreLE(data, le);
+}
+
+
+// ---- BMU_F4 ----
+constexpr uint32_t DBC_BMU_F4_ID = 0x18200005;
+constexpr bool DBC_BMU_F4_EXTD = true;
+constexpr uint8_t DBC_BMU_F4_DLC = 4;
+constexpr uint8_t DBC_BMU_F4_SIGNAL_NUM = 2;
+constexpr DbcSignalPos DBC_BMU_F4_SIGNALS[] = {
+  {0, 16, false},  // OVERDIV_VOLTAGE_WARNING
+  {16, 16, false},  // OVERDIV_VOLTAGE_CRITICAL
+};
+
+struct __attribute__((packed)) dbc_BMU_F4 {
+  uint16_t OVERDIV_VOLTAGE_WARNING;
+  uint16_t OVERDIV_VOLTAGE_CRITICAL;
+};
+
+static inline void dbc_BMU_F4_unpack(const uint8_t* data, dbc_BMU_F4* m) {
+  const uint64_t le = dbcLoadLE(data);
+  m->OVERDIV_VOLTAGE_WARNING = (uint16_t)((le >> 0) & 0xFFFFULL);
+  m->OVERDIV_VOLTAGE_CRITICAL = (uint16_t)((le >> 16) & 0xFFFFULL);
+}
+
+static inline void dbc_BMU_F4_pack(const dbc_BMU_F4* m, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)m->OVERDIV_VOLTAGE_WARNING & 0xFFFFULL) << 0;
+  le |= ((uint64_t)m->OVERDIV_VOLTAGE_CRITICAL & 0xFFFFULL) << 16;
+  dbcStoreLE(data, le);
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_BMU_F4_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  t->OVERDIV_VOLTAGE_WARNING = (uint16_t)((le >> 0) & 0xFFFFULL);
+  t->OVERDIV_VOLTAGE_CRITICAL = (uint16_t)((le >> 16) & 0xFFFFULL);
+}
+
+template <typename T>
+static inline void dbc_BMU_F4_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)t->OVERDIV_VOLTAGE_WARNING & 0xFFFFULL) << 0;
+  le |= ((uint64_t)t->OVERDIV_VOLTAGE_CRITICAL & 0xFFFFULL) << 16;
+  dbcStoreLE(data, le);
+}
+
+
+// ---- AMS_STATE ----
+constexpr uint32_t DBC_AMS_STATE_ID = 0x18000000;
+constexpr bool DBC_AMS_STATE_EXTD = true;
+constexpr uint8_t DBC_AMS_STATE_DLC = 4;
+constexpr uint8_t DBC_AMS_STATE_SIGNAL_NUM = 11;
+constexpr DbcSignalPos DBC_AMS_STATE_SIGNALS[] = {
+  {0, 16, false},  // ACCUM_VOLTAGE
+  {16, 1, false},  // OVERVOLT_WARNING
+  {17, 1, false},  // LOWVOLT_WARNING
+  {18, 1, false},  // OVERTEMP_WARNING
+  {19, 1, false},  // OVERDIV_WARNING
+  {20, 1, false},  // OVERVOLT_CRITICAL
+  {21, 1, false},  // LOWVOLT_CRITICAL
+  {22, 1, false},  // OVERTEMP_CRITICAL
+  {23, 1, false},  // OVERDIV_CRITICAL
+  {24, 1, false},  // AMS_OK
+  {25, 1, false},  // ACCUM_CHG_READY
+};
+
+struct __attribute__((packed)) dbc_AMS_STATE {
+  uint16_t ACCUM_VOLTAGE;
+  uint8_t OVERVOLT_WARNING;
+  uint8_t LOWVOLT_WARNING;
+  uint8_t OVERTEMP_WARNING;
+  uint8_t OVERDIV_WARNING;
+  uint8_t OVERVOLT_CRITICAL;
+  uint8_t LOWVOLT_CRITICAL;
+  uint8_t OVERTEMP_CRITICAL;
+  uint8_t OVERDIV_CRITICAL;
+  uint8_t AMS_OK;
+  uint8_t ACCUM_CHG_READY;
+};
+
+static inline void dbc_AMS_STATE_unpack(const uint8_t* data, dbc_AMS_STATE* m) {
+  const uint64_t le = dbcLoadLE(data);
+  m->ACCUM_VOLTAGE = (uint16_t)((le >> 0) & 0xFFFFULL);
+  m->OVERVOLT_WARNING = (uint8_t)((le >> 16) & 0x1ULL);
+  m->LOWVOLT_WARNING = (uint8_t)((le >> 17) & 0x1ULL);
+  m->OVERTEMP_WARNING = (uint8_t)((le >> 18) & 0x1ULL);
+  m->OVERDIV_WARNING = (uint8_t)((le >> 19) & 0x1ULL);
+  m->OVERVOLT_CRITICAL = (uint8_t)((le >> 20) & 0x1ULL);
+  m->LOWVOLT_CRITICAL = (uint8_t)((le >> 21) & 0x1ULL);
+  m->OVERTEMP_CRITICAL = (uint8_t)((le >> 22) & 0x1ULL);
+  m->OVERDIV_CRITICAL = (uint8_t)((le >> 23) & 0x1ULL);
+  m->AMS_OK = (uint8_t)((le >> 24) & 0x1ULL);
+  m->ACCUM_CHG_READY = (uint8_t)((le >> 25) & 0x1ULL);
+}
+
+static inline void dbc_AMS_STATE_pack(const dbc_AMS_STATE* m, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)m->ACCUM_VOLTAGE & 0xFFFFULL) << 0;
+  le |= ((uint64_t)m->OVERVOLT_WARNING & 0x1ULL) << 16;
+  le |= ((uint64_t)m->LOWVOLT_WARNING & 0x1ULL) << 17;
+  le |= ((uint64_t)m->OVERTEMP_WARNING & 0x1ULL) << 18;
+  le |= ((uint64_t)m->OVERDIV_WARNING & 0x1ULL) << 19;
+  le |= ((uint64_t)m->OVERVOLT_CRITICAL & 0x1ULL) << 20;
+  le |= ((uint64_t)m->LOWVOLT_CRITICAL & 0x1ULL) << 21;
+  le |= ((uint64_t)m->OVERTEMP_CRITICAL & 0x1ULL) << 22;
+  le |= ((uint64_t)m->OVERDIV_CRITICAL & 0x1ULL) << 23;
+  le |= ((uint64_t)m->AMS_OK & 0x1ULL) << 24;
+  le |= ((uint64_t)m->ACCUM_CHG_READY & 0x1ULL) << 25;
+  dbcStoreLE(data, le);
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_AMS_STATE_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  t->ACCUM_VOLTAGE = (uint16_t)((le >> 0) & 0xFFFFULL);
+  t->OVERVOLT_WARNING = (uint8_t)((le >> 16) & 0x1ULL);
+  t->LOWVOLT_WARNING = (uint8_t)((le >> 17) & 0x1ULL);
+  t->OVERTEMP_WARNING = (uint8_t)((le >> 18) & 0x1ULL);
+  t->OVERDIV_WARNING = (uint8_t)((le >> 19) & 0x1ULL);
+  t->OVERVOLT_CRITICAL = (uint8_t)((le >> 20) & 0x1ULL);
+  t->LOWVOLT_CRITICAL = (uint8_t)((le >> 21) & 0x1ULL);
+  t->OVERTEMP_CRITICAL = (uint8_t)((le >> 22) & 0x1ULL);
+  t->OVERDIV_CRITICAL = (uint8_t)((le >> 23) & 0x1ULL);
+  t->AMS_OK = (uint8_t)((le >> 24) & 0x1ULL);
+  t->ACCUM_CHG_READY = (uint8_t)((le >> 25) & 0x1ULL);
+}
+
+template <typename T>
+static inline void dbc_AMS_STATE_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  le |= ((uint64_t)t->ACCUM_VOLTAGE & 0xFFFFULL) << 0;
+  le |= ((uint64_t)t->OVERVOLT_WARNING & 0x1ULL) << 16;
+  le |= ((uint64_t)t->LOWVOLT_WARNING & 0x1ULL) << 17;
+  le |= ((uint64_t)t->OVERTEMP_WARNING & 0x1ULL) << 18;
+  le |= ((uint64_t)t->OVERDIV_WARNING & 0x1ULL) << 19;
+  le |= ((uint64_t)t->OVERVOLT_CRITICAL & 0x1ULL) << 20;
+  le |= ((uint64_t)t->LOWVOLT_CRITICAL & 0x1ULL) << 21;
+  le |= ((uint64_t)t->OVERTEMP_CRITICAL & 0x1ULL) << 22;
+  le |= ((uint64_t)t->OVERDIV_CRITICAL & 0x1ULL) << 23;
+  le |= ((uint64_t)t->AMS_OK & 0x1ULL) << 24;
+  le |= ((uint64_t)t->ACCUM_CHG_READY & 0x1ULL) << 25;
+  dbcStoreLE(data, le);
+}
+
+constexpr float DBC_ACCUM_VOLTAGE_FACTOR = 0.1f;
+constexpr float DBC_ACCUM_VOLTAGE_OFFSET = 0.0f;
+static inline int32_t DBC_ACCUM_VOLTAGE_milli(int32_t raw) { return raw * 100; }  // V x1000
+
+// ---- OBC_CMD ----
+constexpr uint32_t DBC_OBC_CMD_ID = 0x1806E5F4;
+constexpr bool DBC_OBC_CMD_EXTD = true;
+constexpr uint8_t DBC_OBC_CMD_DLC = 8;
+constexpr uint8_t DBC_OBC_CMD_SIGNAL_NUM = 3;
+constexpr DbcSignalPos DBC_OBC_CMD_SIGNALS[] = {
+  {7, 16, true},  // CMD_VOLT
+  {23, 16, true},  // CMD_AMP
+  {32, 8, false},  // CMD_STOP
+};
+
+struct __attribute__((packed)) dbc_OBC_CMD {
+  uint16_t CMD_VOLT;
+  uint16_t CMD_AMP;
+  uint8_t CMD_STOP;
+};
+
+static inline void dbc_OBC_CMD_unpack(const uint8_t* data, dbc_OBC_CMD* m) {
+  const uint64_t le = dbcLoadLE(data);
+  const uint64_t be = dbcLoadBE(data);
+  m->CMD_VOLT = (uint16_t)((be >> 48) & 0xFFFFULL);
+  m->CMD_AMP = (uint16_t)((be >> 32) & 0xFFFFULL);
+  m->CMD_STOP = (uint8_t)((le >> 32) & 0xFFULL);
+}
+
+static inline void dbc_OBC_CMD_pack(const dbc_OBC_CMD* m, uint8_t* data) {
+  uint64_t le = 0;
+  uint64_t be = 0;
+  be |= ((uint64_t)m->CMD_VOLT & 0xFFFFULL) << 48;
+  be |= ((uint64_t)m->CMD_AMP & 0xFFFFULL) << 32;
+  le |= ((uint64_t)m->CMD_STOP & 0xFFULL) << 32;
+  uint8_t tmp[8];
+  dbcStoreLE(data, le);
+  dbcStoreBE(tmp, be);
+  for (int i = 0; i < 8; i++) data[i] |= tmp[i];
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_OBC_CMD_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  const uint64_t be = dbcLoadBE(data);
+  t->CMD_VOLT = (uint16_t)((be >> 48) & 0xFFFFULL);
+  t->CMD_AMP = (uint16_t)((be >> 32) & 0xFFFFULL);
+  t->CMD_STOP = (uint8_t)((le >> 32) & 0xFFULL);
+}
+
+template <typename T>
+static inline void dbc_OBC_CMD_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  uint64_t be = 0;
+  be |= ((uint64_t)t->CMD_VOLT & 0xFFFFULL) << 48;
+  be |= ((uint64_t)t->CMD_AMP & 0xFFFFULL) << 32;
+  le |= ((uint64_t)t->CMD_STOP & 0xFFULL) << 32;
+  uint8_t tmp[8];
+  dbcStoreLE(data, le);
+  dbcStoreBE(tmp, be);
+  for (int i = 0; i < 8; i++) data[i] |= tmp[i];
+}
+
+constexpr float DBC_CMD_VOLT_FACTOR = 0.1f;
+constexpr float DBC_CMD_VOLT_OFFSET = 0.0f;
+static inline int32_t DBC_CMD_VOLT_milli(int32_t raw) { return raw * 100; }  // V x1000
+constexpr float DBC_CMD_AMP_FACTOR = 0.1f;
+constexpr float DBC_CMD_AMP_OFFSET = 0.0f;
+static inline int32_t DBC_CMD_AMP_milli(int32_t raw) { return raw * 100; }  // A x1000
+
+// ---- OBC_STATUS ----
+constexpr uint32_t DBC_OBC_STATUS_ID = 0x18FF50E5;
+constexpr bool DBC_OBC_STATUS_EXTD = true;
+constexpr uint8_t DBC_OBC_STATUS_DLC = 8;
+constexpr uint8_t DBC_OBC_STATUS_SIGNAL_NUM = 3;
+constexpr DbcSignalPos DBC_OBC_STATUS_SIGNALS[] = {
+  {7, 16, true},  // OBC_VOLT
+  {23, 16, true},  // OBC_AMP
+  {32, 8, false},  // OBC_STATUS_BITS
+};
+
+struct __attribute__((packed)) dbc_OBC_STATUS {
+  uint16_t OBC_VOLT;
+  uint16_t OBC_AMP;
+  uint8_t OBC_STATUS_BITS;
+};
+
+static inline void dbc_OBC_STATUS_unpack(const uint8_t* data, dbc_OBC_STATUS* m) {
+  const uint64_t le = dbcLoadLE(data);
+  const uint64_t be = dbcLoadBE(data);
+  m->OBC_VOLT = (uint16_t)((be >> 48) & 0xFFFFULL);
+  m->OBC_AMP = (uint16_t)((be >> 32) & 0xFFFFULL);
+  m->OBC_STATUS_BITS = (uint8_t)((le >> 32) & 0xFFULL);
+}
+
+static inline void dbc_OBC_STATUS_pack(const dbc_OBC_STATUS* m, uint8_t* data) {
+  uint64_t le = 0;
+  uint64_t be = 0;
+  be |= ((uint64_t)m->OBC_VOLT & 0xFFFFULL) << 48;
+  be |= ((uint64_t)m->OBC_AMP & 0xFFFFULL) << 32;
+  le |= ((uint64_t)m->OBC_STATUS_BITS & 0xFFULL) << 32;
+  uint8_t tmp[8];
+  dbcStoreLE(data, le);
+  dbcStoreBE(tmp, be);
+  for (int i = 0; i < 8; i++) data[i] |= tmp[i];
+}
+
+// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>
+template <typename T>
+static inline void dbc_OBC_STATUS_unpack_to(const uint8_t* data, T* t) {
+  const uint64_t le = dbcLoadLE(data);
+  const uint64_t be = dbcLoadBE(data);
+  t->OBC_VOLT = (uint16_t)((be >> 48) & 0xFFFFULL);
+  t->OBC_AMP = (uint16_t)((be >> 32) & 0xFFFFULL);
+  t->OBC_STATUS_BITS = (uint8_t)((le >> 32) & 0xFFULL);
+}
+
+template <typename T>
+static inline void dbc_OBC_STATUS_pack_from(const T* t, uint8_t* data) {
+  uint64_t le = 0;
+  uint64_t be = 0;
+  be |= ((uint64_t)t->OBC_VOLT & 0xFFFFULL) << 48;
+  be |= ((uint64_t)t->OBC_AMP & 0xFFFFULL) << 32;
+  le |= ((uint64_t)t->OBC_STATUS_BITS & 0xFFULL) << 32;
+  uint8_t tmp[8];
+  dbcStoreLE(data, le);
+  dbcStoreBE(tmp, be);
+  for (int i = 0; i < 8; i++) data[i] |= tmp[i];
+}
+
+constexpr float DBC_OBC_VOLT_FACTOR = 0.1f;
+constexpr float DBC_OBC_VOLT_OFFSET = 0.0f;
+static inline int32_t DBC_OBC_VOLT_milli(int32_t raw) { return raw * 100; }  // V x1000
+constexpr float DBC_OBC_AMP_FACTOR = 0.1f;
+constexpr float DBC_OBC_AMP_OFFSET = 0.0f;
+static inline int32_t DBC_OBC_AMP_milli(int32_t raw) { return raw * 100; }  // A x1000
+
+// ---- Array signals (NAME_<n> sharing one scaling) ----
+constexpr float DBC_TEMP_SENSE_FACTOR = DBC_TEMP_SENSE_0_FACTOR;
+constexpr float DBC_TEMP_SENSE_OFFSET = DBC_TEMP_SENSE_0_OFFSET;
+static inline int32_t DBC_TEMP_SENSE_milli(int32_t raw) { return DBC_TEMP_SENSE_0_milli(raw); }
+constexpr float DBC_V_CELL_FACTOR = DBC_V_CELL_0_FACTOR;
+constexpr float DBC_V_CELL_OFFSET = DBC_V_CELL_0_OFFSET;
+static inline int32_t DBC_V_CELL_milli(int32_t raw) { return DBC_V_CELL_0_milli(raw); }
+
+#endif // AMS_CAN_DB_H
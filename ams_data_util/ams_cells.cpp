@@ -0,0 +1,247 @@
+/************************* Cell Store / Fault Kernel ***************************/
+
+#include "ams_cells.h"
+#include "ams_pack.h"
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if !AMS_OT_CONFIGURED
+#warning "TEMP_WARN_RAW / TEMP_MAX_RAW not defined, over-temperature is not evaluated (see ams_data_util.h)"
+#endif
+
+void amsLoadModule(AmsCellStore* store, const BMUdata* bmu, int moduleNum) {
+  for (int c = 0; c < CELL_NUM; c++) store->v[c][moduleNum] = bmu->V_CELL[c];
+  for (int s = 0; s < TEMP_SENSOR_NUM; s++) store->temp[s][moduleNum] = bmu->TEMP_SENSE[s];
+  store->connected[moduleNum] = bmu->BMUconnected ? 0xFF : 0;
+}
+
+void amsLoadCells(AmsCellStore* store, const BMUdata* bmuArray) {
+  for (int m = 0; m < MODULE_NUM; m++) amsLoadModule(store, &bmuArray[m], m);
+  for (int m = MODULE_NUM; m < AMS_MODULE_PAD; m++) {  // Neutral padding lanes
+    for (int c = 0; c < CELL_NUM; c++) store->v[c][m] = VNOM_CELL_RAW;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) store->temp[s][m] = 0;
+    store->connected[m] = 0;
+  }
+}
+
+// Pack totals and summary bits from the (already masked) per-module results
+static void amsReduce(const AmsCellStore* store, AmsFaultResult* r) {
+  uint32_t sum = 0;
+  uint8_t packMin = 0xFF, packMax = 0;
+  uint16_t any[8] = {0};
+  for (int m = 0; m < MODULE_NUM; m++) {
+    uint8_t k = store->connected[m];
+    sum += r->vSum[m];
+    uint8_t lo = r->vMin[m] | (uint8_t)~k;
+    uint8_t hi = r->vMax[m] & k;
+    packMin = lo < packMin ? lo : packMin;
+    packMax = hi > packMax ? hi : packMax;
+    any[0] |= r->ovWarn[m];
+    any[1] |= r->ovCrit[m];
+    any[2] |= r->lvWarn[m];
+    any[3] |= r->lvCrit[m];
+    any[4] |= r->otWarn[m];
+    any[5] |= r->otCrit[m];
+    any[6] |= r->dvWarn[m];
+    any[7] |= r->dvCrit[m];
+  }
+  uint8_t faults = 0;
+  for (int i = 0; i < 8; i++) faults |= (uint8_t)((any[i] != 0) << i);
+  r->accumSum = sum;
+  r->packMin = packMin;
+  r->packMax = packMax;
+  r->faults = faults;
+}
+
+// Scalar path: SWAR over a native word of modules (4 on the ESP32, 8 on a 64
+// bit host; a row of the store holds one cell of consecutive modules), so a
+// core without SIMD still compares a word of cells per instruction. Each lane
+// result lives in its byte's bit 7.
+typedef uintptr_t AmsLanes;
+static const int LANES = sizeof(AmsLanes);
+static const AmsLanes LANE_ONES = ~(AmsLanes)0 / 0xFF, LANE_HI = LANE_ONES * 0x80, LANE_LO7 = LANE_ONES * 0x7F;
+static const AmsLanes LANE_EVEN = ~(AmsLanes)0 / 0xFFFF * 0xFF;  // Low byte of each 16 bit lane
+
+// x >= T per lane, T a constant: bit 7 is the carry out of x + (256 - T)
+template <unsigned T>
+static inline AmsLanes lanesGe(AmsLanes x) {
+  if (T == 0) return LANE_HI;
+  if (T > 255) return 0;
+  const AmsLanes k = ((256 - T) & 0xFF) * LANE_ONES;
+  AmsLanes s = (x & LANE_LO7) + (k & LANE_LO7);
+  return ((x & k) | ((x | k) & s)) & LANE_HI;
+}
+
+// x >= y per lane: no borrow out of bit 7 of x - y
+static inline AmsLanes lanesGe(AmsLanes x, AmsLanes y) {
+  AmsLanes t = (x | LANE_HI) - (y & ~LANE_HI);
+  return ~((~x & y) | (~(x ^ y) & ~t)) & LANE_HI;
+}
+
+static inline AmsLanes lanesFull(AmsLanes bit7) { return (bit7 >> 7) * 0xFF; }
+
+void amsEvalFaultsScalar(const AmsCellStore* store, AmsFaultResult* r) {
+  for (int b = 0; b < MODULE_NUM; b += LANES) {  // Rows are padded to 16 lanes, whole words stay inside
+    AmsLanes row[CELL_NUM];
+    AmsLanes mn = ~(AmsLanes)0, mx = 0, sumEven = 0, sumOdd = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      AmsLanes x;
+      memcpy(&x, &store->v[c][b], sizeof(x));
+      row[c] = x;
+      AmsLanes ge = lanesFull(lanesGe(x, mn));
+      mn = (mn & ge) | (x & ~ge);
+      ge = lanesFull(lanesGe(x, mx));
+      mx = (x & ge) | (mx & ~ge);
+      sumEven += x & LANE_EVEN;  // 16 bit lanes, 16 cells of 255 fit
+      sumOdd += (x >> 8) & LANE_EVEN;
+    }
+
+    // Bit c of a module's mask: cells 0-7 in its lane byte of lo, 8-15 of hi
+    AmsLanes ovWlo = 0, ovClo = 0, lvWlo = 0, lvClo = 0, dvWlo = 0, dvClo = 0;
+    AmsLanes ovWhi = 0, ovChi = 0, lvWhi = 0, lvChi = 0, dvWhi = 0, dvChi = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      AmsLanes x = row[c];
+      AmsLanes d = x - mn;  // Every lane is >= its min, no borrow crosses lanes
+      AmsLanes ovW = lanesGe<VMAX_CELL_RAW - VCELL_WARN_MARGIN_RAW>(x);
+      AmsLanes ovC = lanesGe<VMAX_CELL_RAW + 1>(x);
+      AmsLanes lvW = ~lanesGe<VMIN_CELL_RAW + VCELL_WARN_MARGIN_RAW + 1>(x) & LANE_HI;
+      AmsLanes lvC = ~lanesGe<VMIN_CELL_RAW>(x) & LANE_HI;
+      AmsLanes dvW = lanesGe<DV_WARN_RAW>(d);
+      AmsLanes dvC = lanesGe<DVMAX_RAW>(d);
+      if (c < 8) {
+        int sh = 7 - c;
+        ovWlo |= ovW >> sh; ovClo |= ovC >> sh; lvWlo |= lvW >> sh;
+        lvClo |= lvC >> sh; dvWlo |= dvW >> sh; dvClo |= dvC >> sh;
+      } else {
+        int sh = 15 - c;
+        ovWhi |= ovW >> sh; ovChi |= ovC >> sh; lvWhi |= lvW >> sh;
+        lvChi |= lvC >> sh; dvWhi |= dvW >> sh; dvChi |= dvC >> sh;
+      }
+    }
+
+    for (int i = 0; i < LANES && b + i < MODULE_NUM; i++) {
+      int m = b + i, shift = 8 * i;
+      uint16_t k = (uint16_t)(int16_t)(int8_t)store->connected[m];  // 0xFFFF or 0
+      auto lane = [shift](AmsLanes lo, AmsLanes hi) {
+        return (uint16_t)(((lo >> shift) & 0xFF) | (((hi >> shift) & 0xFF) << 8));
+      };
+      uint32_t otW = 0, otC = 0;
+      for (int s = TEMP_SENSOR_NUM - 1; s >= 0; s--) {
+        uint32_t t = store->temp[s][m];
+        otW = (otW << 1) | (t >= TEMP_WARN_RAW);
+        otC = (otC << 1) | (t >= TEMP_MAX_RAW);
+      }
+      r->ovWarn[m] = lane(ovWlo, ovWhi) & k;
+      r->ovCrit[m] = lane(ovClo, ovChi) & k;
+      r->lvWarn[m] = lane(lvWlo, lvWhi) & k;
+      r->lvCrit[m] = lane(lvClo, lvChi) & k;
+      r->dvWarn[m] = lane(dvWlo, dvWhi) & k;
+      r->dvCrit[m] = lane(dvClo, dvChi) & k;
+      r->otWarn[m] = otW & k;
+      r->otCrit[m] = otC & k;
+      r->vSum[m] = (uint16_t)(((i & 1) ? sumOdd : sumEven) >> (16 * (i >> 1))) & k;
+      r->vMin[m] = (uint8_t)(mn >> shift);
+      r->vMax[m] = (uint8_t)(mx >> shift);
+    }
+  }
+  amsReduce(store, r);
+}
+
+#if defined(__SSE2__)
+// a >= b, unsigned bytes
+static inline __m128i geU8(__m128i a, __m128i b) {
+  return _mm_cmpeq_epi8(_mm_max_epu8(a, b), a);
+}
+
+// Byte compare result of 16 modules -> bit into two vectors of 8 u16 masks
+static inline void orBit(__m128i cmp, __m128i bit, __m128i* mask) {
+  mask[0] = _mm_or_si128(mask[0], _mm_and_si128(_mm_unpacklo_epi8(cmp, cmp), bit));
+  mask[1] = _mm_or_si128(mask[1], _mm_and_si128(_mm_unpackhi_epi8(cmp, cmp), bit));
+}
+
+static inline void storeMasked(uint16_t* dst, const __m128i* mask, __m128i k0, __m128i k1) {
+  _mm_store_si128((__m128i*)dst, _mm_and_si128(mask[0], k0));
+  _mm_store_si128((__m128i*)(dst + 8), _mm_and_si128(mask[1], k1));
+}
+
+void amsEvalFaults(const AmsCellStore* store, AmsFaultResult* r) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i ovW = _mm_set1_epi8((char)(VMAX_CELL_RAW - VCELL_WARN_MARGIN_RAW));
+  const __m128i ovC = _mm_set1_epi8((char)(VMAX_CELL_RAW + 1));
+  const __m128i lvW = _mm_set1_epi8((char)(VMIN_CELL_RAW + VCELL_WARN_MARGIN_RAW));
+  const __m128i lvC = _mm_set1_epi8((char)(VMIN_CELL_RAW - 1));
+  const __m128i dvW = _mm_set1_epi8((char)DV_WARN_RAW);
+  const __m128i dvC = _mm_set1_epi8((char)DVMAX_RAW);
+  // Unsigned u16 compare via the sign flip: t >= x  <=>  (t ^ 0x8000) > ((x - 1) ^ 0x8000)
+  const __m128i flip = _mm_set1_epi16((short)0x8000);
+  const __m128i otW = _mm_set1_epi16((short)((TEMP_WARN_RAW - 1) ^ 0x8000));
+  const __m128i otC = _mm_set1_epi16((short)((TEMP_MAX_RAW - 1) ^ 0x8000));
+
+  for (int b = 0; b < AMS_MODULE_PAD; b += 16) {
+    __m128i mn = _mm_set1_epi8((char)0xFF), mx = zero, sum0 = zero, sum1 = zero;
+    for (int c = 0; c < CELL_NUM; c++) {
+      __m128i v = _mm_load_si128((const __m128i*)&store->v[c][b]);
+      mn = _mm_min_epu8(mn, v);
+      mx = _mm_max_epu8(mx, v);
+      sum0 = _mm_add_epi16(sum0, _mm_unpacklo_epi8(v, zero));
+      sum1 = _mm_add_epi16(sum1, _mm_unpackhi_epi8(v, zero));
+    }
+
+    __m128i ovWm[2] = {zero, zero}, ovCm[2] = {zero, zero}, lvWm[2] = {zero, zero}, lvCm[2] = {zero, zero};
+    __m128i dvWm[2] = {zero, zero}, dvCm[2] = {zero, zero}, otWm[2] = {zero, zero}, otCm[2] = {zero, zero};
+    for (int c = 0; c < CELL_NUM; c++) {
+      __m128i bit = _mm_set1_epi16((short)(1 << c));
+      __m128i v = _mm_load_si128((const __m128i*)&store->v[c][b]);
+      __m128i d = _mm_subs_epu8(v, mn);
+      orBit(geU8(v, ovW), bit, ovWm);
+      orBit(geU8(v, ovC), bit, ovCm);
+      orBit(geU8(lvW, v), bit, lvWm);
+      orBit(geU8(lvC, v), bit, lvCm);
+      orBit(geU8(d, dvW), bit, dvWm);
+      orBit(geU8(d, dvC), bit, dvCm);
+    }
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) {
+      __m128i bit = _mm_set1_epi16((short)(1 << s));
+      for (int h = 0; h < 2; h++) {
+        __m128i t = _mm_xor_si128(_mm_load_si128((const __m128i*)&store->temp[s][b + 8 * h]), flip);
+        otWm[h] = _mm_or_si128(otWm[h], _mm_and_si128(_mm_cmpgt_epi16(t, otW), bit));
+        otCm[h] = _mm_or_si128(otCm[h], _mm_and_si128(_mm_cmpgt_epi16(t, otC), bit));
+      }
+    }
+
+    __m128i k = _mm_load_si128((const __m128i*)&store->connected[b]);
+    __m128i k0 = _mm_unpacklo_epi8(k, k), k1 = _mm_unpackhi_epi8(k, k);
+    storeMasked(&r->ovWarn[b], ovWm, k0, k1);
+    storeMasked(&r->ovCrit[b], ovCm, k0, k1);
+    storeMasked(&r->lvWarn[b], lvWm, k0, k1);
+    storeMasked(&r->lvCrit[b], lvCm, k0, k1);
+    storeMasked(&r->dvWarn[b], dvWm, k0, k1);
+    storeMasked(&r->dvCrit[b], dvCm, k0, k1);
+    storeMasked(&r->otWarn[b], otWm, k0, k1);
+    storeMasked(&r->otCrit[b], otCm, k0, k1);
+    __m128i sums[2] = {sum0, sum1};
+    storeMasked(&r->vSum[b], sums, k0, k1);
+    _mm_store_si128((__m128i*)&r->vMin[b], mn);
+    _mm_store_si128((__m128i*)&r->vMax[b], mx);
+  }
+  amsReduce(store, r);
+}
+#else
+void amsEvalFaults(const AmsCellStore* store, AmsFaultResult* r) {
+  amsEvalFaultsScalar(store, r);
+}
+#endif
+
+void amsApplyFaults(const AmsFaultResult* r, const BMUdata* bmuArray, AMSdata* ams) {
+  AmsPackSummary summary;
+  summary.accumSum = r->accumSum;
+  summary.packMin = r->packMin;
+  summary.packMax = r->packMax;
+  summary.faults = r->faults;
+  // What a BMU reported stays set even if its cells look fine from here
+  for (int m = 0; m < MODULE_NUM; m++)
+    if (bmuArray[m].BMUconnected) summary.faults |= amsReportedFaults(&bmuArray[m]);
+  amsApplySummary(&summary, ams);
+}
@@ -0,0 +1,79 @@
+// =======================================================================
+// Cell store (structure of arrays) + branch-free fault kernel
+// =======================================================================
+#ifndef AMS_CELLS_H
+#define AMS_CELLS_H
+
+#include "ams_data_util.h"
+
+// v[cell][module]: row c holds cell c of every module, so one 16 byte vector
+// covers 16 modules and per-module min / max / sum are plain lane operations.
+// Rows are padded to AMS_MODULE_PAD lanes; padding and disconnected modules
+// hold neutral values and their results are masked to zero.
+#define AMS_MODULE_PAD (((MODULE_NUM) + 15) / 16 * 16)
+
+static_assert(CELL_NUM <= 16 && TEMP_SENSOR_NUM <= 16, "Fault masks are 16 bit");
+static_assert(VMIN_CELL_RAW > VCELL_WARN_MARGIN_RAW && VMAX_CELL_RAW + 1 <= 0xFF, "Raw limits out of u8 range");
+
+struct AmsCellStore {
+  alignas(16) uint8_t v[CELL_NUM][AMS_MODULE_PAD];           // V_CELL raw
+  alignas(16) uint16_t temp[TEMP_SENSOR_NUM][AMS_MODULE_PAD];  // TEMP_SENSE raw
+  alignas(16) uint8_t connected[AMS_MODULE_PAD];             // 0xFF connected, 0 not
+};
+
+enum AmsFaultBit : uint8_t {
+  AMS_FAULT_OV_WARN = 1 << 0,
+  AMS_FAULT_OV_CRIT = 1 << 1,
+  AMS_FAULT_LV_WARN = 1 << 2,
+  AMS_FAULT_LV_CRIT = 1 << 3,
+  AMS_FAULT_OT_WARN = 1 << 4,
+  AMS_FAULT_OT_CRIT = 1 << 5,
+  AMS_FAULT_DV_WARN = 1 << 6,
+  AMS_FAULT_DV_CRIT = 1 << 7,
+};
+
+// Everything one kernel pass produces, lanes [0, MODULE_NUM) are valid.
+// Masks: bit c = cell c, OT masks: bit s = sensor s.
+//   OV warn  v >= VMAX - margin    OV crit  v > VMAX
+//   LV warn  v <= VMIN + margin    LV crit  v < VMIN
+//   DV warn  v - min >= DV_WARN    DV crit  v - min >= DVMAX
+//   OT warn  t >= TEMP_WARN_RAW    OT crit  t >= TEMP_MAX_RAW
+struct AmsFaultResult {
+  alignas(16) uint16_t ovWarn[AMS_MODULE_PAD];
+  alignas(16) uint16_t ovCrit[AMS_MODULE_PAD];
+  alignas(16) uint16_t lvWarn[AMS_MODULE_PAD];
+  alignas(16) uint16_t lvCrit[AMS_MODULE_PAD];
+  alignas(16) uint16_t otWarn[AMS_MODULE_PAD];
+  alignas(16) uint16_t otCrit[AMS_MODULE_PAD];
+  alignas(16) uint16_t dvWarn[AMS_MODULE_PAD];
+  alignas(16) uint16_t dvCrit[AMS_MODULE_PAD];
+  alignas(16) uint8_t vMin[AMS_MODULE_PAD];
+  alignas(16) uint8_t vMax[AMS_MODULE_PAD];
+  alignas(16) uint16_t vSum[AMS_MODULE_PAD];  // Module voltage, V_CELL units
+  uint32_t accumSum;  // Connected modules, V_CELL units (0.02 V)
+  uint8_t packMin;    // 0xFF when nothing is connected
+  uint8_t packMax;
+  uint8_t faults;     // AmsFaultBit, set if any connected module has it
+};
+
+// AoS -> SoA, all MODULE_NUM modules / one module (e.g. from the CAN RX path)
+void amsLoadCells(AmsCellStore* store, const BMUdata* bmuArray);
+void amsLoadModule(AmsCellStore* store, const BMUdata* bmu, int moduleNum);
+
+// SSE2 on hosts that have it, scalar elsewhere (ESP32). Same results bit for bit.
+void amsEvalFaults(const AmsCellStore* store, AmsFaultResult* result);
+void amsEvalFaultsScalar(const AmsCellStore* store, AmsFaultResult* result);
+
+// AmsFaultBit of the masks a BMU reported in its own frames
+static inline uint8_t amsReportedFaults(const BMUdata* b) {
+  return (b->OVERVOLTAGE_WARNING ? AMS_FAULT_OV_WARN : 0) | (b->OVERVOLTAGE_CRITICAL ? AMS_FAULT_OV_CRIT : 0) |
+         (b->LOWVOLTAGE_WARNING ? AMS_FAULT_LV_WARN : 0) | (b->LOWVOLTAGE_CRITICAL ? AMS_FAULT_LV_CRIT : 0) |
+         (b->OVERTEMP_WARNING ? AMS_FAULT_OT_WARN : 0) | (b->OVERTEMP_CRITICAL ? AMS_FAULT_OT_CRIT : 0) |
+         (b->OVERDIV_VOLTAGE_WARNING ? AMS_FAULT_DV_WARN : 0) | (b->OVERDIV_VOLTAGE_CRITICAL ? AMS_FAULT_DV_CRIT : 0);
+}
+
+// Flags / voltage into AMSdata: the kernel's faults ORed with the ones the
+// connected BMUs reported, so the BCU never clears a BMU fault. bmuArray is only read.
+void amsApplyFaults(const AmsFaultResult* result, const BMUdata* bmuArray, AMSdata* ams);
+
+#endif // AMS_CELLS_H
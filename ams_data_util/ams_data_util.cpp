@@ -2,10 +2,14 @@
 
 #include <Arduino.h>
 #include <ams_data_util.h>
+#include "ams_can_db.h"
+#include "ams_pack.h"
 
 void debugAMSstate(AMSdata* myAMS) {
   Serial.printf("AMS_OK: %d\n", myAMS->AMS_OK);
-  Serial.printf("AMS_VOLT: %.2f Low: %d Full: %d \n", myAMS->ACCUM_VOLTAGE);
+  float volts = amsAccumVoltage(myAMS);
+  Serial.printf("AMS_VOLT: %s Low: %d Full: %d\n", amsText<2>(AmsMillivolts(myAMS->ACCUM_VOLTAGE_MV)).s,
+                volts <= myAMS->ACCUM_MINVOLTAGE, volts >= myAMS->ACCUM_MAXVOLTAGE);
   Serial.printf("AMS_MAX: %.2f \n", myAMS->ACCUM_MAXVOLTAGE);
   Serial.printf("AMS_MIN: %.2f\n", myAMS->ACCUM_MINVOLTAGE);
 
@@ -31,16 +35,16 @@ void debugAMSstate(AMSdata* myAMS) {
 
 void debugBMUModule(BMUdata* myBMU,int moduleNum) {
   Serial.printf("=== BMU %d (ID: %X) ===\n", moduleNum, myBMU[moduleNum].BMU_ID);
-  Serial.printf("V_MODULE: %.2fV\n", myBMU[moduleNum].V_MODULE * 0.02f);
+  Serial.printf("V_MODULE: %sV\n", amsText<2>(AmsModuleV(myBMU[moduleNum].V_MODULE)).s);
   Serial.print("V_CELL: ");
   for (int i = 0; i < CELL_NUM; i++) {
-    Serial.printf("%.2f ", myBMU[moduleNum].V_CELL[i] * 0.02f);
+    Serial.printf("%s ", amsText<2>(AmsCellV(myBMU[moduleNum].V_CELL[i])).s);
   } Serial.println("V");
 
-  Serial.printf("DV: %.2fV\n", myBMU[moduleNum].DV * 0.2f);
-  Serial.printf("TEMP: %.1fv, %.1fv\n",
-    myBMU[moduleNum].TEMP_SENSE[0] * 0.0125f + 2,
-    myBMU[moduleNum].TEMP_SENSE[1] * 0.0125f + 2);
+  Serial.printf("DV: %sV\n", amsText<2>(AmsDeltaV(myBMU[moduleNum].DV)).s);
+  Serial.printf("TEMP: %sv, %sv\n",
+    amsText<1>(AmsSenseV(myBMU[moduleNum].TEMP_SENSE[0])).s,
+    amsText<1>(AmsSenseV(myBMU[moduleNum].TEMP_SENSE[1])).s);
   Serial.printf("Ready to Charge: %d, Connected: %d\n",
     myBMU[moduleNum].BMUneedBalance,
     myBMU[moduleNum].BMUconnected);
@@ -84,7 +88,7 @@ void debugOBCmsg(OBCdata* myOBC) {
 
 void teleplotAMSstate(AMSdata* myAMS) {
   // Accumulator voltage and limits
-  Serial.printf(">AMS_Volt:%.2f\n", myAMS->ACCUM_VOLTAGE);
+  Serial.printf(">AMS_Volt:%s\n", amsText<2>(AmsMillivolts(myAMS->ACCUM_VOLTAGE_MV)).s);
   Serial.printf(">AMS_MaxV:%.2f\n", myAMS->ACCUM_MAXVOLTAGE);
   Serial.printf(">AMS_MinV:%.2f\n", myAMS->ACCUM_MINVOLTAGE);
 
@@ -108,11 +112,11 @@ void teleplotAMSstate(AMSdata* myAMS) {
 }
 
 void teleplotBMUModule(BMUdata* myBMU, int moduleNum) {
-  // Module voltage (convert from 0.02V factor)
-  Serial.printf(">M%d_Volt:%.2f\n", moduleNum + 1, myBMU[moduleNum].V_MODULE * 0.02f);
+  // Module voltage (0.02V steps)
+  Serial.printf(">M%d_Volt:%s\n", moduleNum + 1, amsText<2>(AmsModuleV(myBMU[moduleNum].V_MODULE)).s);
 
-  // Delta voltage (convert from 0.1V factor)
-  Serial.printf(">M%d_DV:%.2f\n", moduleNum + 1, myBMU[moduleNum].DV * 0.1f);
+  // Delta voltage (0.1V steps)
+  Serial.printf(">M%d_DV:%s\n", moduleNum + 1, amsText<2>(AmsDeltaV(myBMU[moduleNum].DV)).s);
 
   // Status flags
   Serial.printf(">M%d_NeedBal:%d|M%d_Conn:%d\n",
@@ -121,19 +125,17 @@ void teleplotBMUModule(BMUdata* myBMU, int moduleNum) {
 }
 
 void teleplotBMUCellVoltages(BMUdata* myBMU, int moduleNum) {
-  // Individual cell voltages (convert from 0.02V factor)
+  // Individual cell voltages (0.02V steps)
   for (int i = 0; i < CELL_NUM; i++) {
-    Serial.printf(">M%d_C%d:%.2f\n", moduleNum + 1, i + 1, myBMU[moduleNum].V_CELL[i] * 0.02f);
+    Serial.printf(">M%d_C%d:%s\n", moduleNum + 1, i + 1, amsText<2>(AmsCellV(myBMU[moduleNum].V_CELL[i])).s);
   }
 }
 
 void teleplotBMUTemperatures(BMUdata* myBMU, int moduleNum) {
-  // Temperature sensors (convert from encoded format: offset -40, factor 0.5C)
-  // Stored as raw ADC or encoded value, decode: (value * 0.0125) + 2 for voltage
-  // Or if already in temp format: direct value
-  Serial.printf(">M%d_T1:%.1f|M%d_T2:%.1f\n",
-    moduleNum + 1, myBMU[moduleNum].TEMP_SENSE[0] * 0.0125f + 2,
-    moduleNum + 1, myBMU[moduleNum].TEMP_SENSE[1] * 0.0125f + 2);
+  // Thermistor divider voltage, (value * 0.0125) + 2 V
+  Serial.printf(">M%d_T1:%s|M%d_T2:%s\n",
+    moduleNum + 1, amsText<1>(AmsSenseV(myBMU[moduleNum].TEMP_SENSE[0])).s,
+    moduleNum + 1, amsText<1>(AmsSenseV(myBMU[moduleNum].TEMP_SENSE[1])).s);
 }
 
 void teleplotBMUFaults(BMUdata* myBMU, int moduleNum) {
@@ -164,7 +166,7 @@ void teleplotAllModules(BMUdata* BMU_Package, int moduleCount) {
   // Quick overview of all modules on single plot
   for (int i = 0; i < moduleCount; i++) {
     if (BMU_Package[i].BMUconnected) {
-      Serial.printf(">ModuleV%d:%.2f\n", i + 1, BMU_Package[i].V_MODULE * 0.02f);
+      Serial.printf(">ModuleV%d:%s\n", i + 1, amsText<2>(AmsModuleV(BMU_Package[i].V_MODULE)).s);
     }
   }
 }
@@ -179,31 +181,19 @@ void teleplotLocalCells(float* cellvoltages, int cellCount, const char* prefix)
 /************************* Mock Data Generators ***************************/
 
 void mockBMU(BMUdata* bmu, int moduleNum) {
-  bmu->BMU_ID = 0x18200001 + (moduleNum << 16);
+  bmu->BMU_ID = BMU_ADD + (moduleNum << BMU_MODULE_SHIFT);
   bmu->BMUconnected = true;
 
   if (moduleNum < MODULE_NUM / 2) {
     // Good modules: uniform cells, no faults
-    bmu->BMUneedBalance = 1;
-    bmu->DV = 5;
     bmu->TEMP_SENSE[0] = 0xC8;
     bmu->TEMP_SENSE[1] = 0xC8;
     for (int j = 0; j < CELL_NUM; j++) {
       bmu->V_CELL[j] = 185;
     }
-    bmu->OVERVOLTAGE_WARNING = 0x0000;
-    bmu->OVERVOLTAGE_CRITICAL = 0x0000;
-    bmu->LOWVOLTAGE_WARNING = 0x0000;
-    bmu->LOWVOLTAGE_CRITICAL = 0x0000;
-    bmu->OVERTEMP_WARNING = 0x0000;
-    bmu->OVERTEMP_CRITICAL = 0x0000;
-    bmu->OVERDIV_VOLTAGE_WARNING = 0x0000;
-    bmu->OVERDIV_VOLTAGE_CRITICAL = 0x0000;
     bmu->BalancingDischarge_Cells = 0x0000;
   } else {
     // Faulty modules: mixed cells, some faults
-    bmu->BMUneedBalance = 0;
-    bmu->DV = 15;
     bmu->TEMP_SENSE[0] = 0xFA;
     bmu->TEMP_SENSE[1] = 0xD0;
     bmu->V_CELL[0] = 210;
@@ -216,56 +206,283 @@ void mockBMU(BMUdata* bmu, int moduleNum) {
     bmu->V_CELL[7] = 185;
     bmu->V_CELL[8] = 195;
     bmu->V_CELL[9] = 175;
-    bmu->OVERVOLTAGE_WARNING = 0x0200;
-    bmu->OVERVOLTAGE_CRITICAL = 0x0000;
-    bmu->LOWVOLTAGE_WARNING = 0x0090;
-    bmu->LOWVOLTAGE_CRITICAL = 0x0000;
-    bmu->OVERTEMP_WARNING = 0x0200;
-    bmu->OVERTEMP_CRITICAL = 0x0000;
-    bmu->OVERDIV_VOLTAGE_WARNING = 0x0094;
-    bmu->OVERDIV_VOLTAGE_CRITICAL = 0x0000;
     bmu->BalancingDischarge_Cells = 0x0201;
   }
-}
 
-void mockAMS(AMSdata* ams, BMUdata* bmuArray) {
-  // Compute accumulator voltage from all modules
-  float totalVoltage = 0.0f;
-  bool anyOVWarn = false, anyOVCrit = false;
-  bool anyLVWarn = false, anyLVCrit = false;
-  bool anyOTWarn = false, anyOTCrit = false;
-  bool anyDVWarn = false, anyDVCrit = false;
-
-  for (int i = 0; i < MODULE_NUM; i++) {
-    totalVoltage += bmuArray[i].V_MODULE * 0.02f;
-    if (bmuArray[i].OVERVOLTAGE_WARNING)  anyOVWarn = true;
-    if (bmuArray[i].OVERVOLTAGE_CRITICAL) anyOVCrit = true;
-    if (bmuArray[i].LOWVOLTAGE_WARNING)   anyLVWarn = true;
-    if (bmuArray[i].LOWVOLTAGE_CRITICAL)  anyLVCrit = true;
-    if (bmuArray[i].OVERTEMP_WARNING)     anyOTWarn = true;
-    if (bmuArray[i].OVERTEMP_CRITICAL)    anyOTCrit = true;
-    if (bmuArray[i].OVERDIV_VOLTAGE_WARNING)  anyDVWarn = true;
-    if (bmuArray[i].OVERDIV_VOLTAGE_CRITICAL) anyDVCrit = true;
-  }
+  // Masks, V_MODULE and DV as the BMU evaluates them from its own cells
+  static Pack<CELL_NUM, 1, TEMP_SENSOR_NUM> module;  // loadBMU overwrites all of it
+  module.loadBMU(0, *bmu);
+  module.evaluate();
+  module.storeBMU(0, bmu);
+  bmu->BMUneedBalance = module.module(0).fault[AMS_DV_WARN].any();
+}
 
-  ams->ACCUM_VOLTAGE = totalVoltage;
-  ams->OVERVOLT_WARNING = anyOVWarn;
-  ams->OVERVOLT_CRITICAL = anyOVCrit;
-  ams->LOWVOLT_WARNING = anyLVWarn;
-  ams->LOWVOLT_CRITICAL = anyLVCrit;
-  ams->OVERTEMP_WARNING = anyOTWarn;
-  ams->OVERTEMP_CRITICAL = anyOTCrit;
-  ams->OVERDIV_WARNING = anyDVWarn;
-  ams->OVERDIV_CRITICAL = anyDVCrit;
-
-  ams->AMS_OK = !(anyOVCrit || anyLVCrit || anyOTCrit || anyDVCrit);
-  ams->ACCUM_CHG_READY = ams->AMS_OK && !anyOVWarn;
+void mockAMS(AMSdata* ams, const BMUdata* bmuArray) {
+  // Evaluate the connected modules from their cells and sensors with the fault
+  // kernel and OR in the masks they reported; voltage / flags go into ams
+  AmsCellStore store;
+  AmsFaultResult result;
+  amsLoadCells(&store, bmuArray);
+  amsEvalFaults(&store, &result);
+  amsApplyFaults(&result, bmuArray, ams);
 }
 
 void mockOBC(OBCdata* obc) {
-  obc->OBCVolt = 4800;   // 48.00V (typical charger voltage)
-  obc->OBCAmp = 100;     // 1.00A (typical charge current)
+  obc->OBCVolt = (uint16_t)(VMAX_CELL * CELL_NUM * MODULE_NUM * 10);  // Full pack voltage, 0.1 V/bit (294.0 V)
+  obc->OBCAmp = 100;     // 10.0 A, 0.1 A/bit
   obc->OBCstatusbit = 0; // No faults
   obc->OBC_OK = true;
 }
 
+/************************* CAN Payload Codec ***************************/
+
+// ams_can.dbc describes the same frames for tools and other nodes, keep them in sync
+struct DbcFrameRef {
+  const DbcSignalPos* signals;
+  uint8_t count;
+};
+
+constexpr bool bmuLayoutMatchesDbc() {
+  const DbcFrameRef frames[] = {
+    {DBC_BMU_F0_SIGNALS, DBC_BMU_F0_SIGNAL_NUM}, {DBC_BMU_F1_SIGNALS, DBC_BMU_F1_SIGNAL_NUM},
+    {DBC_BMU_F2_SIGNALS, DBC_BMU_F2_SIGNAL_NUM}, {DBC_BMU_F3_SIGNALS, DBC_BMU_F3_SIGNAL_NUM},
+    {DBC_BMU_F4_SIGNALS, DBC_BMU_F4_SIGNAL_NUM},
+  };
+  if (BMU_FRAME_NUM != 5) return false;
+  int i = 0;
+  for (int k = 0; k < 5; k++) {
+    for (int j = 0; j < frames[k].count; j++, i++) {
+      const AmsSignal& s = BMU_LAYOUT.signals[i];
+      const DbcSignalPos& d = frames[k].signals[j];
+      if (s.frame != k || d.bigEndian || d.startBit != s.byte * 8) return false;
+      if (d.length != (s.kind == AMS_U16 ? 16 : 8)) return false;
+    }
+  }
+  return i == BMU_SIGNAL_NUM;
+}
+static_assert(CELL_NUM != 10 || TEMP_SENSOR_NUM != 2 || bmuLayoutMatchesDbc(),
+              "BMU_LAYOUT and ams_can.dbc disagree, update the DBC and rerun tools/dbc_codegen.py");
+static_assert(DBC_BMU_F0_ID == BMU_ADD && DBC_AMS_STATE_ID == BCU_ADD &&
+              DBC_OBC_CMD_ID == OBC_ADD && DBC_OBC_STATUS_ID == OBC_STATUS_ADD,
+              "CAN IDs in ams_can.dbc out of sync with ams_data_util.h");
+
+template <typename Q>
+constexpr bool unitMatchesDbc(float factor, float offset) {
+  return (float)Q::num / Q::den == factor && (float)Q::bias * Q::num / Q::den == offset;
+}
+static_assert(unitMatchesDbc<AmsCellV>(DBC_V_CELL_FACTOR, DBC_V_CELL_OFFSET) &&
+              unitMatchesDbc<AmsModuleV>(DBC_V_MODULE_FACTOR, DBC_V_MODULE_OFFSET) &&
+              unitMatchesDbc<AmsDeltaV>(DBC_DV_FACTOR, DBC_DV_OFFSET) &&
+              unitMatchesDbc<AmsSenseV>(DBC_TEMP_SENSE_FACTOR, DBC_TEMP_SENSE_OFFSET) &&
+              unitMatchesDbc<AmsAccumCanV>(DBC_ACCUM_VOLTAGE_FACTOR, DBC_ACCUM_VOLTAGE_OFFSET),
+              "ams_units.h raw types out of sync with the scaling in ams_can.dbc");
+
+const AmsSignal OBC_SIGNALS[OBC_SIGNAL_NUM] = {
+  {offsetof(OBCdata, OBCVolt), 0, 0, AMS_U16_BE, 0},
+  {offsetof(OBCdata, OBCAmp), 0, 2, AMS_U16_BE, 0},
+  {offsetof(OBCdata, OBCstatusbit), 0, 4, AMS_U8, 0},
+};
+
+const AmsSignal AMS_SIGNALS[AMS_SIGNAL_NUM] = {
+  {offsetof(AMSdata, ACCUM_VOLTAGE_MV), 0, 0, AMS_MV_DECI, 0},
+  {offsetof(AMSdata, OVERVOLT_WARNING), 0, 2, AMS_BIT, 0},
+  {offsetof(AMSdata, LOWVOLT_WARNING), 0, 2, AMS_BIT, 1},
+  {offsetof(AMSdata, OVERTEMP_WARNING), 0, 2, AMS_BIT, 2},
+  {offsetof(AMSdata, OVERDIV_WARNING), 0, 2, AMS_BIT, 3},
+  {offsetof(AMSdata, OVERVOLT_CRITICAL), 0, 2, AMS_BIT, 4},
+  {offsetof(AMSdata, LOWVOLT_CRITICAL), 0, 2, AMS_BIT, 5},
+  {offsetof(AMSdata, OVERTEMP_CRITICAL), 0, 2, AMS_BIT, 6},
+  {offsetof(AMSdata, OVERDIV_CRITICAL), 0, 2, AMS_BIT, 7},
+  {offsetof(AMSdata, AMS_OK), 0, 3, AMS_BIT, 0},
+  {offsetof(AMSdata, ACCUM_CHG_READY), 0, 3, AMS_BIT, 1},
+};
+
+void amsDecodeSignals(const AmsSignal* sig, int count, const uint8_t* data, uint8_t dlc, void* target) {
+  uint8_t* obj = (uint8_t*)target;
+  for (int i = 0; i < count; i++) {
+    uint8_t b = sig[i].byte;
+    uint8_t* field = obj + sig[i].field;
+    switch (sig[i].kind) {
+      case AMS_U8:
+        if (b < dlc) *field = data[b];
+        break;
+      case AMS_U16:
+        if (b + 1 < dlc) { uint16_t v = data[b] | (data[b + 1] << 8); memcpy(field, &v, 2); }
+        break;
+      case AMS_U16_BE:
+        if (b + 1 < dlc) { uint16_t v = (data[b] << 8) | data[b + 1]; memcpy(field, &v, 2); }
+        break;
+      case AMS_BOOL:
+        if (b < dlc) *(bool*)field = data[b] != 0;
+        break;
+      case AMS_BIT:
+        if (b < dlc) *(bool*)field = (data[b] >> sig[i].bit) & 1;
+        break;
+      case AMS_MV_DECI:
+        if (b + 1 < dlc) {
+          int32_t mv = amsConvert<AmsMillivolts>(AmsAccumCanV(data[b] | (data[b + 1] << 8))).count;
+          memcpy(field, &mv, 4);
+        }
+        break;
+    }
+  }
+}
+
+void amsEncodeSignals(const AmsSignal* sig, int count, const void* source, uint8_t* data) {
+  const uint8_t* obj = (const uint8_t*)source;
+  for (int i = 0; i < count; i++) {
+    uint8_t b = sig[i].byte;
+    const uint8_t* field = obj + sig[i].field;
+    uint16_t v;
+    switch (sig[i].kind) {
+      case AMS_U8:
+        data[b] = *field;
+        break;
+      case AMS_U16:
+        memcpy(&v, field, 2);
+        data[b] = v & 0xFF; data[b + 1] = v >> 8;
+        break;
+      case AMS_U16_BE:
+        memcpy(&v, field, 2);
+        data[b] = v >> 8; data[b + 1] = v & 0xFF;
+        break;
+      case AMS_BOOL:
+        data[b] = *(const bool*)field ? 1 : 0;
+        break;
+      case AMS_BIT:
+        if (*(const bool*)field) data[b] |= 1 << sig[i].bit;
+        break;
+      case AMS_MV_DECI: {
+        int32_t mv;
+        memcpy(&mv, field, 4);
+        v = amsConvert<AmsAccumCanV>(AmsMillivolts(mv)).count;
+        data[b] = v & 0xFF; data[b + 1] = v >> 8;
+        break;
+      }
+    }
+  }
+}
+
+static void initFrame(twai_message_t* msg, uint32_t identifier, uint8_t dlc) {
+  memset(msg, 0, sizeof(*msg));
+  msg->extd = 1;
+  msg->identifier = identifier;
+  msg->data_length_code = dlc;
+}
+
+// The default pack (CELL_NUM 10, TEMP_SENSOR_NUM 2) is exactly what ams_can.dbc
+// describes, so its frames go only through the generated _unpack_to / _pack_from,
+// which read and write the BMUdata members directly; a frame shorter than its DBC
+// DLC is dropped. Other pack sizes use the tables. tools/dbc_check holds the
+// generated path to the tables' bytes.
+#if CELL_NUM == 10 && TEMP_SENSOR_NUM == 2
+static bool decodeBMUFrameData(uint32_t frame, const twai_message_t* rx_msg, BMUdata* bmu) {
+  static const uint8_t DLC[] = {DBC_BMU_F0_DLC, DBC_BMU_F1_DLC, DBC_BMU_F2_DLC, DBC_BMU_F3_DLC, DBC_BMU_F4_DLC};
+  if (rx_msg->data_length_code < DLC[frame]) return false;
+  const uint8_t* d = rx_msg->data;
+  switch (frame) {
+    case 0: dbc_BMU_F0_unpack_to(d, bmu); break;
+    case 1: dbc_BMU_F1_unpack_to(d, bmu); break;
+    case 2: dbc_BMU_F2_unpack_to(d, bmu); break;
+    case 3: dbc_BMU_F3_unpack_to(d, bmu); break;
+    default: dbc_BMU_F4_unpack_to(d, bmu); break;
+  }
+  return true;
+}
+
+static void encodeBMUFrameData(const BMUdata* bmu, twai_message_t* frames) {
+  dbc_BMU_F0_pack_from(bmu, frames[0].data);
+  dbc_BMU_F1_pack_from(bmu, frames[1].data);
+  dbc_BMU_F2_pack_from(bmu, frames[2].data);
+  dbc_BMU_F3_pack_from(bmu, frames[3].data);
+  dbc_BMU_F4_pack_from(bmu, frames[4].data);
+}
+#else
+static bool decodeBMUFrameData(uint32_t frame, const twai_message_t* rx_msg, BMUdata* bmu) {
+  const uint8_t first = BMU_LAYOUT.first[frame];
+  amsDecodeSignals(&BMU_LAYOUT.signals[first], BMU_LAYOUT.first[frame + 1] - first,
+                   rx_msg->data, rx_msg->data_length_code, bmu);
+  return true;
+}
+
+static void encodeBMUFrameData(const BMUdata* bmu, twai_message_t* frames) {
+  for (uint8_t k = 0; k < BMU_FRAME_NUM; k++) {
+    const uint8_t first = BMU_LAYOUT.first[k];
+    amsEncodeSignals(&BMU_LAYOUT.signals[first], BMU_LAYOUT.first[k + 1] - first, bmu, frames[k].data);
+  }
+}
+#endif
+
+int decodeBMUFrame(const twai_message_t* rx_msg, BMUdata* bmuArray) {
+  if (!rx_msg->extd || rx_msg->rtr) return -1;
+  uint32_t offset = rx_msg->identifier - BMU_ADD;  // Wraps to a huge value below BMU_ADD
+  uint32_t module = offset >> BMU_MODULE_SHIFT;
+  uint32_t frame = offset & ((1u << BMU_MODULE_SHIFT) - 1);
+  if (module >= MODULE_NUM || frame >= BMU_FRAME_NUM) return -1;
+
+  BMUdata* bmu = &bmuArray[module];
+  if (!decodeBMUFrameData(frame, rx_msg, bmu)) return -1;
+  bmu->BMU_ID = BMU_ADD + (module << BMU_MODULE_SHIFT);
+  bmu->BMUconnected = true;
+  return (int)module;
+}
+
+uint8_t encodeBMUFrames(const BMUdata* bmu, int moduleNum, twai_message_t* frames) {
+  for (uint8_t k = 0; k < BMU_FRAME_NUM; k++) {
+    initFrame(&frames[k], BMU_ADD + k + ((uint32_t)moduleNum << BMU_MODULE_SHIFT), BMU_LAYOUT.dlc[k]);
+  }
+  encodeBMUFrameData(bmu, frames);
+  return BMU_FRAME_NUM;
+}
+
+bool decodeOBCFrame(const twai_message_t* rx_msg, OBCdata* obc) {
+  if (!rx_msg->extd || rx_msg->identifier != OBC_STATUS_ADD) return false;
+  if (rx_msg->data_length_code >= DBC_OBC_STATUS_DLC) {
+    dbc_OBC_STATUS m;
+    dbc_OBC_STATUS_unpack(rx_msg->data, &m);
+    obc->OBCVolt = m.OBC_VOLT;
+    obc->OBCAmp = m.OBC_AMP;
+    obc->OBCstatusbit = m.OBC_STATUS_BITS;
+  } else {
+    amsDecodeSignals(OBC_SIGNALS, OBC_SIGNAL_NUM, rx_msg->data, rx_msg->data_length_code, obc);
+  }
+  obc->OBC_OK = (obc->OBCstatusbit == 0);
+  return true;
+}
+
+void encodeOBCFrame(const OBCdata* obc, twai_message_t* tx_msg) {
+  initFrame(tx_msg, OBC_ADD, DBC_OBC_CMD_DLC);
+  dbc_OBC_CMD m = {obc->OBCVolt, obc->OBCAmp, (uint8_t)(obc->OBC_OK ? 0 : 1)};  // 0 = charge, 1 = stop
+  dbc_OBC_CMD_pack(&m, tx_msg->data);
+}
+
+bool decodeAMSFrame(const twai_message_t* rx_msg, AMSdata* ams) {
+  if (!rx_msg->extd || rx_msg->identifier != BCU_ADD) return false;
+  if (rx_msg->data_length_code >= DBC_AMS_STATE_DLC) {
+    dbc_AMS_STATE m;
+    dbc_AMS_STATE_unpack(rx_msg->data, &m);
+    ams->ACCUM_VOLTAGE_MV = DBC_ACCUM_VOLTAGE_milli(m.ACCUM_VOLTAGE);
+    ams->OVERVOLT_WARNING = m.OVERVOLT_WARNING;
+    ams->LOWVOLT_WARNING = m.LOWVOLT_WARNING;
+    ams->OVERTEMP_WARNING = m.OVERTEMP_WARNING;
+    ams->OVERDIV_WARNING = m.OVERDIV_WARNING;
+    ams->OVERVOLT_CRITICAL = m.OVERVOLT_CRITICAL;
+    ams->LOWVOLT_CRITICAL = m.LOWVOLT_CRITICAL;
+    ams->OVERTEMP_CRITICAL = m.OVERTEMP_CRITICAL;
+    ams->OVERDIV_CRITICAL = m.OVERDIV_CRITICAL;
+    ams->AMS_OK = m.AMS_OK;
+    ams->ACCUM_CHG_READY = m.ACCUM_CHG_READY;
+  } else {
+    amsDecodeSignals(AMS_SIGNALS, AMS_SIGNAL_NUM, rx_msg->data, rx_msg->data_length_code, ams);
+  }
+  return true;
+}
+
+void encodeAMSFrame(const AMSdata* ams, twai_message_t* tx_msg) {
+  initFrame(tx_msg, BCU_ADD, DBC_AMS_STATE_DLC);
+  dbc_AMS_STATE m = {amsConvert<AmsAccumCanV>(AmsMillivolts(ams->ACCUM_VOLTAGE_MV)).count,
+                     ams->OVERVOLT_WARNING, ams->LOWVOLT_WARNING, ams->OVERTEMP_WARNING, ams->OVERDIV_WARNING,
+                     ams->OVERVOLT_CRITICAL, ams->LOWVOLT_CRITICAL, ams->OVERTEMP_CRITICAL, ams->OVERDIV_CRITICAL,
+                     ams->AMS_OK, ams->ACCUM_CHG_READY};
+  dbc_AMS_STATE_pack(&m, tx_msg->data);
+}
@@ -1,11 +1,19 @@
 // =======================================================================
 // BMS Data , Cells specs , etc.
 // =======================================================================
+#ifndef AMS_DATA_UTIL_H
+#define AMS_DATA_UTIL_H
+
 #include <cstdint>
+#include <cstddef>
+#include <driver/twai.h>
+#include "ams_units.h"
 
 // Cell Configuration 
 #define CELL_NUM 10
+#ifndef MODULE_NUM
 #define MODULE_NUM 7
+#endif
 // #define MODULE_NUM 2 // Test config
 // #define MODULE_NUM 0 // Headless config
 
@@ -22,6 +30,41 @@
 #define TEMP_SENSOR_NUM 2
 // other data here
 
+// Limits in raw CAN units for the fault kernel (ams_cells.h), no float per cell
+// V_CELL 0.02 V/bit (AmsCellV), DV measured as cell - module min in the same units
+constexpr AmsCellV AMS_VMAX_CELL = amsQuantize<AmsCellV>(VMAX_CELL);
+constexpr AmsCellV AMS_VNOM_CELL = amsQuantize<AmsCellV>(VNOM_CELL);
+constexpr AmsCellV AMS_VMIN_CELL = amsQuantize<AmsCellV>(VMIN_CELL);
+constexpr AmsCellV AMS_DVMAX = amsQuantize<AmsCellV>(DVMAX);
+#define VCELL_RAW(v) (amsQuantize<AmsCellV>(v).count)
+#define VMAX_CELL_RAW (AMS_VMAX_CELL.count)  // 210
+#define VNOM_CELL_RAW (AMS_VNOM_CELL.count)  // 185
+#define VMIN_CELL_RAW (AMS_VMIN_CELL.count)  // 145
+#define VCELL_WARN_MARGIN_RAW 5              // Warning 0.1 V inside the limit
+#define DVMAX_RAW (AMS_DVMAX.count)          // 10, critical
+#define DV_WARN_RAW (DVMAX_RAW / 2)          // Balancing starts here
+// TEMP_SENSE divider codes (higher = hotter, AmsSenseV) at the warning and
+// TEMP_MAX_CELL points. They depend on the BMU board's thermistor and divider,
+// so define both from its curve, as build flags or in an ams_limits.h on the
+// include path, e.g. for a divider reading 2.45 V at
+// TEMP_MAX_CELL:  #define TEMP_MAX_RAW TEMP_SENSE_RAW(2.45)
+// (tools/host/ams_limits.h only holds placeholders for the host tools)
+// Without both, OT evaluation is off: the codes default to 0xFFFF, which only a
+// saturated reading reaches, and AMS_OT_CONFIGURED is 0 (ams_cells.cpp warns).
+#define TEMP_SENSE_RAW(volts) (amsQuantize<AmsSenseV>(volts).count)
+#if __has_include("ams_limits.h")
+#include "ams_limits.h"
+#endif
+#if defined(TEMP_WARN_RAW) && defined(TEMP_MAX_RAW)
+#define AMS_OT_CONFIGURED 1
+#else
+#define AMS_OT_CONFIGURED 0
+#undef TEMP_WARN_RAW
+#undef TEMP_MAX_RAW
+#define TEMP_WARN_RAW 0xFFFF
+#define TEMP_MAX_RAW 0xFFFF
+#endif
+
 // AMS Communication
 #define STANDARD_BIT_RATE TWAI_TIMING_CONFIG_250KBITS()
 #define OBC_COMMUNICATE_TIME  500
@@ -29,6 +72,9 @@
 #define DISCONNENCTION_TIMEOUT BMS_COMMUNICATE_TIME * 1.5
 #define BCU_ADD 0x18000000
 #define OBC_ADD 0x1806E5F4
+#define BMU_ADD 0x18200001       // Module 0, next modules at BMU_ADD + (module << BMU_MODULE_SHIFT)
+#define BMU_MODULE_SHIFT 16
+#define OBC_STATUS_ADD 0x18FF50E5  // Charger -> BCU broadcast (OBC_ADD is BCU -> charger)
 
 struct BMUdata {
   // Basic BMU Data
@@ -55,7 +101,7 @@ struct BMUdata {
 // ACCUMULATOR Data , Local to BCU (Make this a struct later , or not? , I don't want over access)
 struct AMSdata {
 
-  float ACCUM_VOLTAGE = 0.0; 
+  int32_t ACCUM_VOLTAGE_MV = 0;  // Accumulator voltage, amsSetAccumVoltage / amsAccumVoltage (volts)
   float ACCUM_MAXVOLTAGE = (VMAX_CELL * CELL_NUM * MODULE_NUM); // Default value
   float ACCUM_MINVOLTAGE = (VMIN_CELL * CELL_NUM * MODULE_NUM); // Defualt value assum 8 module
   // float ACCUM_MAXVOLTAGE = (0); // For headless test
@@ -74,8 +120,21 @@ struct AMSdata {
 
   // bool AMS_OK = 0; // Use this for Active Low Output
   bool AMS_OK = 1; // Use this for Active High Output
+
+  // Estimates from ams_soc.h, not on the CAN frame
+  float ACCUM_SOC = 0.0;    // %, weakest cell
+  float ACCUM_SOH = 100.0;  // %, from internal resistance growth of the worst cell
 };
 
+inline void amsSetAccumVoltage(AMSdata* ams, AmsMillivolts v) {
+  ams->ACCUM_VOLTAGE_MV = v.count;
+}
+
+// Volts, for float consumers; keep it out of per-frame paths
+inline float amsAccumVoltage(const AMSdata* ams) {
+  return amsToFloat(AmsMillivolts(ams->ACCUM_VOLTAGE_MV));
+}
+
 // Physical condition of OBC On board charger
 struct OBCdata {
   uint16_t OBCVolt = 0;
@@ -101,5 +160,110 @@ void teleplotLocalCells(float *cellvoltages, int cellCount, const char* prefix);
 
 // Mock data generators (for testing without hardware)
 void mockBMU(BMUdata *bmu, int moduleNum);
-void mockAMS(AMSdata *ams, BMUdata *bmuArray);
-void mockOBC(OBCdata *obc);
\ No newline at end of file
+void mockAMS(AMSdata *ams, const BMUdata *bmuArray);  // Fault kernel (ams_cells.h) on bmuArray + reported masks
+void mockOBC(OBCdata *obc);
+
+// =======================================================================
+// CAN payload codec (writes straight into the structs)
+// =======================================================================
+// ams_can.dbc is the reference description of these frames. tools/dbc_codegen.py
+// turns it into ams_can_db.h (raw structs, pack/unpack, _unpack_to / _pack_from
+// straight into the structs, DBC_<SIGNAL>_FACTOR / _OFFSET / _milli() scaling)
+// and ams_data_util.cpp checks at compile time that BMU_LAYOUT still matches it.
+// BMU frames of the default pack go only through the generated code; the signal
+// tables below handle other CELL_NUM / TEMP_SENSOR_NUM and short OBC / AMS
+// frames. tools/dbc_check compares the two on every message.
+// BMU frame k of module m: ID = BMU_ADD + k + (m << BMU_MODULE_SHIFT), little endian.
+// Fields are packed in declaration order, a u16 never straddles a frame:
+//   V_CELL[0..CELL_NUM) u8, V_MODULE u16, DV u8, BMUneedBalance, TEMP_SENSE[] u16,
+//   BalancingDischarge_Cells u16, then the 8 fault masks u16
+// OBC (Elcon style, big endian): OBC_STATUS_ADD volt 0.1V, amp 0.1A, status byte
+//                                OBC_ADD same layout, byte 4 = 0 charge / 1 stop
+// AMS (BCU_ADD): ACCUM_VOLTAGE_MV as u16 0.1V, fault flag byte, AMS_OK | CHG_READY << 1
+enum AmsSignalKind : uint8_t {
+  AMS_U8,
+  AMS_U16,       // Little endian
+  AMS_U16_BE,    // Big endian
+  AMS_BOOL,      // Whole byte, non zero = true
+  AMS_BIT,       // One bit of a byte into a bool
+  AMS_MV_DECI,   // int32_t millivolts stored as u16 in 0.1 V steps
+};
+
+struct AmsSignal {
+  uint16_t field;  // offsetof into the target struct
+  uint8_t frame;   // Frame index inside the message group
+  uint8_t byte;
+  uint8_t kind;
+  uint8_t bit;     // AMS_BIT only
+};
+
+#define BMU_SIGNAL_NUM (CELL_NUM + TEMP_SENSOR_NUM + 12)
+
+struct BmuLayout {
+  AmsSignal signals[BMU_SIGNAL_NUM] = {};
+  uint8_t first[BMU_SIGNAL_NUM + 1] = {};  // first[k]..first[k+1] = signals of frame k
+  uint8_t dlc[BMU_SIGNAL_NUM] = {};
+  uint8_t frameNum = 0;
+};
+
+constexpr BmuLayout makeBMULayout() {
+  BmuLayout l;
+  uint16_t fields[BMU_SIGNAL_NUM] = {};
+  uint8_t kinds[BMU_SIGNAL_NUM] = {};
+  int n = 0;
+  for (int i = 0; i < CELL_NUM; i++) { fields[n] = offsetof(BMUdata, V_CELL) + i; kinds[n++] = AMS_U8; }
+  fields[n] = offsetof(BMUdata, V_MODULE); kinds[n++] = AMS_U16;
+  fields[n] = offsetof(BMUdata, DV); kinds[n++] = AMS_U8;
+  fields[n] = offsetof(BMUdata, BMUneedBalance); kinds[n++] = AMS_BOOL;
+  for (int i = 0; i < TEMP_SENSOR_NUM; i++) {
+    fields[n] = offsetof(BMUdata, TEMP_SENSE) + i * sizeof(uint16_t); kinds[n++] = AMS_U16;
+  }
+  const uint16_t masks[] = {
+    offsetof(BMUdata, BalancingDischarge_Cells),
+    offsetof(BMUdata, OVERVOLTAGE_WARNING), offsetof(BMUdata, OVERVOLTAGE_CRITICAL),
+    offsetof(BMUdata, LOWVOLTAGE_WARNING), offsetof(BMUdata, LOWVOLTAGE_CRITICAL),
+    offsetof(BMUdata, OVERTEMP_WARNING), offsetof(BMUdata, OVERTEMP_CRITICAL),
+    offsetof(BMUdata, OVERDIV_VOLTAGE_WARNING), offsetof(BMUdata, OVERDIV_VOLTAGE_CRITICAL),
+  };
+  for (uint16_t f : masks) { fields[n] = f; kinds[n++] = AMS_U16; }
+
+  int pos = 0;  // Byte position in the concatenated payload
+  for (int i = 0; i < n; i++) {
+    int size = (kinds[i] == AMS_U16) ? 2 : 1;
+    if (size == 2 && (pos & 1)) pos++;  // Keep u16 on even bytes
+    l.signals[i] = AmsSignal{fields[i], (uint8_t)(pos / 8), (uint8_t)(pos % 8), kinds[i], 0};
+    pos += size;
+  }
+  l.frameNum = (uint8_t)((pos + 7) / 8);
+  for (int k = 0, i = 0; k <= l.frameNum; k++) {
+    while (i < n && l.signals[i].frame < k) i++;
+    l.first[k] = (uint8_t)i;
+  }
+  for (int k = 0; k < l.frameNum; k++) l.dlc[k] = (k == l.frameNum - 1 && pos % 8) ? pos % 8 : 8;
+  return l;
+}
+
+constexpr BmuLayout BMU_LAYOUT = makeBMULayout();
+constexpr uint8_t BMU_FRAME_NUM = BMU_LAYOUT.frameNum;
+
+#define OBC_SIGNAL_NUM 3
+#define AMS_SIGNAL_NUM 11
+extern const AmsSignal OBC_SIGNALS[OBC_SIGNAL_NUM];  // OBCdata, both OBC directions
+extern const AmsSignal AMS_SIGNALS[AMS_SIGNAL_NUM];  // AMSdata
+
+// Table codec: signals past dlc are left untouched on decode
+void amsDecodeSignals(const AmsSignal* sig, int count, const uint8_t* data, uint8_t dlc, void* target);
+void amsEncodeSignals(const AmsSignal* sig, int count, const void* source, uint8_t* data);
+
+// Returns the module index the frame was written to, -1 if it is not a BMU frame
+// (or, for the default pack, shorter than ams_can.dbc says). Marks the module BMUconnected.
+int decodeBMUFrame(const twai_message_t* rx_msg, BMUdata* bmuArray);
+// Fills frames[0..BMU_FRAME_NUM), returns BMU_FRAME_NUM
+uint8_t encodeBMUFrames(const BMUdata* bmu, int moduleNum, twai_message_t* frames);
+
+bool decodeOBCFrame(const twai_message_t* rx_msg, OBCdata* obc);  // OBC_STATUS_ADD
+void encodeOBCFrame(const OBCdata* obc, twai_message_t* tx_msg);  // OBC_ADD command
+bool decodeAMSFrame(const twai_message_t* rx_msg, AMSdata* ams);  // BCU_ADD
+void encodeAMSFrame(const AMSdata* ams, twai_message_t* tx_msg);
+
+#endif // AMS_DATA_UTIL_H
@@ -0,0 +1,99 @@
+/************************* Pack Topology ***************************/
+
+#include "ams_pack.h"
+#include <string.h>
+
+void amsApplySummary(const AmsPackSummary* s, AMSdata* ams) {
+  uint8_t f = s->faults;
+  amsSetAccumVoltage(ams, amsConvert<AmsMillivolts>(AmsPackV(s->accumSum)));
+  ams->OVERVOLT_WARNING = (f & AMS_FAULT_OV_WARN) != 0;
+  ams->OVERVOLT_CRITICAL = (f & AMS_FAULT_OV_CRIT) != 0;
+  ams->LOWVOLT_WARNING = (f & AMS_FAULT_LV_WARN) != 0;
+  ams->LOWVOLT_CRITICAL = (f & AMS_FAULT_LV_CRIT) != 0;
+  ams->OVERTEMP_WARNING = (f & AMS_FAULT_OT_WARN) != 0;
+  ams->OVERTEMP_CRITICAL = (f & AMS_FAULT_OT_CRIT) != 0;
+  ams->OVERDIV_WARNING = (f & AMS_FAULT_DV_WARN) != 0;
+  ams->OVERDIV_CRITICAL = (f & AMS_FAULT_DV_CRIT) != 0;
+  ams->AMS_OK = (f & (AMS_FAULT_OV_CRIT | AMS_FAULT_LV_CRIT | AMS_FAULT_OT_CRIT | AMS_FAULT_DV_CRIT)) == 0;
+  ams->ACCUM_CHG_READY = ams->AMS_OK && !(f & AMS_FAULT_OV_WARN);
+}
+
+static size_t alignUp(size_t n, size_t a) {
+  return (n + a - 1) / a * a;
+}
+
+size_t PackRuntime::arenaBytes(const AmsPackConfig& cfg) {
+  size_t bits = cfg.cells > cfg.temps ? cfg.cells : cfg.temps;
+  size_t words = bits > 0 ? (bits + 31) / 32 : 1;
+  size_t n = alignUp((size_t)cfg.modules * cfg.cells, 4);                      // _v
+  n += alignUp((size_t)cfg.modules * cfg.temps * sizeof(uint16_t), 4);         // _t
+  n += (size_t)cfg.modules * AMS_FAULT_KINDS * words * sizeof(uint32_t);        // _masks
+  n += alignUp((size_t)cfg.modules * sizeof(AmsModuleEval), 4);                // _eval
+  n += 2 * (size_t)cfg.modules;                                                 // _active, _slot
+  return n;
+}
+
+bool PackRuntime::begin(const AmsPackConfig& cfg) {
+  if (cfg.cells == 0 || cfg.temps == 0 || cfg.modules == 0xFF) return false;
+  if (arenaBytes(cfg) > sizeof(_arena)) return false;
+
+  size_t bits = cfg.cells > cfg.temps ? cfg.cells : cfg.temps;
+  _cfg = cfg;
+  _words = (uint8_t)((bits + 31) / 32);
+  uint8_t* p = _arena;
+  _v = p;
+  p += alignUp((size_t)cfg.modules * cfg.cells, 4);
+  _t = (uint16_t*)p;
+  p += alignUp((size_t)cfg.modules * cfg.temps * sizeof(uint16_t), 4);
+  _masks = (uint32_t*)p;
+  p += (size_t)cfg.modules * AMS_FAULT_KINDS * _words * sizeof(uint32_t);
+  _eval = (AmsModuleEval*)p;
+  p += alignUp((size_t)cfg.modules * sizeof(AmsModuleEval), 4);
+  _active = p;
+  _slot = p + cfg.modules;
+
+  memset(_arena, 0, arenaBytes(cfg));
+  for (uint8_t m = 0; m < cfg.modules; m++) {
+    _eval[m] = AmsModuleEval();
+    _slot[m] = 0xFF;
+  }
+  _activeCount = 0;
+  return true;
+}
+
+void PackRuntime::loadModule(uint8_t m, const uint8_t* v, const uint16_t* t, bool on) {
+  if (m >= _cfg.modules) return;
+  memcpy(vCell(m), v, _cfg.cells);
+  memcpy(temp(m), t, _cfg.temps * sizeof(uint16_t));
+  setConnected(m, on);
+}
+
+bool PackRuntime::loadBMU(uint8_t m, const BMUdata& b) {
+  if (_cfg.cells > CELL_NUM || _cfg.temps > TEMP_SENSOR_NUM) return false;
+  loadModule(m, b.V_CELL, b.TEMP_SENSE, b.BMUconnected);
+  return true;
+}
+
+void PackRuntime::storeBMU(uint8_t m, BMUdata* b) const {
+  b->OVERVOLTAGE_WARNING = (uint16_t)fault(m, AMS_OV_WARN)[0];
+  b->OVERVOLTAGE_CRITICAL = (uint16_t)fault(m, AMS_OV_CRIT)[0];
+  b->LOWVOLTAGE_WARNING = (uint16_t)fault(m, AMS_LV_WARN)[0];
+  b->LOWVOLTAGE_CRITICAL = (uint16_t)fault(m, AMS_LV_CRIT)[0];
+  b->OVERTEMP_WARNING = (uint16_t)fault(m, AMS_OT_WARN)[0];
+  b->OVERTEMP_CRITICAL = (uint16_t)fault(m, AMS_OT_CRIT)[0];
+  b->OVERDIV_VOLTAGE_WARNING = (uint16_t)fault(m, AMS_DV_WARN)[0];
+  b->OVERDIV_VOLTAGE_CRITICAL = (uint16_t)fault(m, AMS_DV_CRIT)[0];
+  b->V_MODULE = _eval[m].vSum;
+  b->DV = (uint8_t)((_eval[m].vMax - _eval[m].vMin) / 5);
+}
+
+AmsPackSummary PackRuntime::evaluate() {
+  AmsPackSummary s;
+  for (uint8_t i = 0; i < _activeCount; i++) {
+    uint8_t m = _active[i];
+    _eval[m] = amsEvalModule(vCell(m), _cfg.cells, temp(m), _cfg.temps, limits,
+                             _masks + (size_t)m * AMS_FAULT_KINDS * _words, _words);
+    amsAddToSummary(&s, _eval[m]);
+  }
+  return s;
+}
@@ -0,0 +1,284 @@
+// =======================================================================
+// Pack topology: compile-time Pack<Cells, Modules, Temps> and runtime PackRuntime
+// =======================================================================
+#ifndef AMS_PACK_H
+#define AMS_PACK_H
+
+#include "ams_cells.h"
+
+// Module-major storage, and evaluation walks the list of connected modules only,
+// so a 2-module bench or a headless board costs 2 or 0 module passes whatever
+// the maximum is. (AmsCellStore is the cell-major layout for SIMD over all lanes.)
+
+// Fault bitset over N cells / sensors, not limited to the 16 bits of BMUdata
+template <size_t N>
+struct FaultBits {
+  static constexpr size_t WORDS = N > 0 ? (N + 31) / 32 : 1;
+  uint32_t w[WORDS] = {};
+
+  void set(size_t i) { w[i >> 5] |= 1u << (i & 31); }
+  void reset(size_t i) { w[i >> 5] &= ~(1u << (i & 31)); }
+  bool test(size_t i) const { return (w[i >> 5] >> (i & 31)) & 1; }
+  bool any() const {
+    uint32_t a = 0;
+    for (size_t k = 0; k < WORDS; k++) a |= w[k];
+    return a != 0;
+  }
+  size_t count() const {
+    size_t n = 0;
+    for (size_t k = 0; k < WORDS; k++) n += __builtin_popcount(w[k]);
+    return n;
+  }
+  void clear() {
+    for (size_t k = 0; k < WORDS; k++) w[k] = 0;
+  }
+  uint16_t low16() const { return (uint16_t)w[0]; }  // BMUdata / CAN mask of the first 16
+};
+
+// Mask index; the summary byte uses the matching AmsFaultBit (1 << kind)
+enum AmsFaultKind : uint8_t {
+  AMS_OV_WARN, AMS_OV_CRIT, AMS_LV_WARN, AMS_LV_CRIT,
+  AMS_OT_WARN, AMS_OT_CRIT, AMS_DV_WARN, AMS_DV_CRIT,
+  AMS_FAULT_KINDS
+};
+
+// Raw limits, same meaning as in ams_cells.h (crit: v > ovCrit, v < lvCrit)
+struct AmsLimits {
+  uint8_t ovWarn = VMAX_CELL_RAW - VCELL_WARN_MARGIN_RAW;
+  uint8_t ovCrit = VMAX_CELL_RAW;
+  uint8_t lvWarn = VMIN_CELL_RAW + VCELL_WARN_MARGIN_RAW;
+  uint8_t lvCrit = VMIN_CELL_RAW;
+  uint8_t dvWarn = DV_WARN_RAW;
+  uint8_t dvCrit = DVMAX_RAW;
+  uint16_t otWarn = TEMP_WARN_RAW;
+  uint16_t otCrit = TEMP_MAX_RAW;
+};
+
+struct AmsModuleEval {
+  uint8_t vMin = 0xFF;
+  uint8_t vMax = 0;
+  uint16_t vSum = 0;  // V_CELL units (0.02 V)
+  uint8_t faults = 0; // AmsFaultBit
+};
+
+struct AmsPackSummary {
+  uint32_t accumSum = 0;  // Connected modules, V_CELL units
+  uint8_t packMin = 0xFF;
+  uint8_t packMax = 0;
+  uint8_t faults = 0;     // AmsFaultBit over connected modules
+  uint8_t connected = 0;
+};
+
+// Branch-free evaluation of one module. masks: AMS_FAULT_KINDS x words, kind major.
+static inline AmsModuleEval amsEvalModule(const uint8_t* v, uint8_t cells, const uint16_t* t, uint8_t temps,
+                                          const AmsLimits& lim, uint32_t* masks, uint8_t words) {
+  AmsModuleEval e;
+  for (uint8_t c = 0; c < cells; c++) {
+    e.vMin = v[c] < e.vMin ? v[c] : e.vMin;
+    e.vMax = v[c] > e.vMax ? v[c] : e.vMax;
+    e.vSum += v[c];
+  }
+  uint32_t any[AMS_FAULT_KINDS] = {0};
+  for (uint8_t w = 0; w < words; w++) {
+    uint32_t m[AMS_FAULT_KINDS] = {0};
+    int top = cells - 1 < w * 32 + 31 ? cells - 1 : w * 32 + 31;
+    for (int c = top; c >= w * 32; c--) {  // Highest first, masks shift up one per cell
+      uint32_t x = v[c];
+      uint32_t d = x - e.vMin;
+      m[AMS_OV_WARN] = (m[AMS_OV_WARN] << 1) | (x >= lim.ovWarn);
+      m[AMS_OV_CRIT] = (m[AMS_OV_CRIT] << 1) | (x > lim.ovCrit);
+      m[AMS_LV_WARN] = (m[AMS_LV_WARN] << 1) | (x <= lim.lvWarn);
+      m[AMS_LV_CRIT] = (m[AMS_LV_CRIT] << 1) | (x < lim.lvCrit);
+      m[AMS_DV_WARN] = (m[AMS_DV_WARN] << 1) | (d >= lim.dvWarn);
+      m[AMS_DV_CRIT] = (m[AMS_DV_CRIT] << 1) | (d >= lim.dvCrit);
+    }
+    top = temps - 1 < w * 32 + 31 ? temps - 1 : w * 32 + 31;
+    for (int s = top; s >= w * 32; s--) {
+      m[AMS_OT_WARN] = (m[AMS_OT_WARN] << 1) | (t[s] >= lim.otWarn);
+      m[AMS_OT_CRIT] = (m[AMS_OT_CRIT] << 1) | (t[s] >= lim.otCrit);
+    }
+    for (uint8_t k = 0; k < AMS_FAULT_KINDS; k++) {
+      masks[k * words + w] = m[k];
+      any[k] |= m[k];
+    }
+  }
+  for (uint8_t k = 0; k < AMS_FAULT_KINDS; k++) e.faults |= (uint8_t)((any[k] != 0) << k);
+  return e;
+}
+
+static inline void amsAddToSummary(AmsPackSummary* s, const AmsModuleEval& e) {
+  s->accumSum += e.vSum;
+  s->packMin = e.vMin < s->packMin ? e.vMin : s->packMin;
+  s->packMax = e.vMax > s->packMax ? e.vMax : s->packMax;
+  s->faults |= e.faults;
+  s->connected++;
+}
+
+// Flags, AMS_OK, ACCUM_CHG_READY and ACCUM_VOLTAGE_MV from a summary
+void amsApplySummary(const AmsPackSummary* summary, AMSdata* ams);
+
+// Connected module list, swap-remove, shared by both pack flavours
+struct AmsActiveList {
+  static void set(uint8_t* list, uint8_t* slot, uint8_t& count, uint8_t m, bool on) {
+    bool present = slot[m] != 0xFF;
+    if (on && !present) {
+      slot[m] = count;
+      list[count++] = m;
+    } else if (!on && present) {
+      uint8_t last = list[--count];
+      list[slot[m]] = last;
+      slot[last] = slot[m];
+      slot[m] = 0xFF;
+    }
+  }
+};
+
+template <uint8_t Cells, uint8_t Modules, uint8_t Temps>
+class Pack {
+ public:
+  static_assert(Cells > 0 && Temps > 0, "A module needs cells and sensors");
+  static constexpr uint8_t CELLS = Cells;
+  static constexpr uint8_t MODULES = Modules;
+  static constexpr uint8_t TEMPS = Temps;
+  static constexpr size_t BITS = Cells > Temps ? Cells : Temps;
+  static constexpr uint8_t LANES = Modules > 0 ? Modules : 1;
+
+  struct Module {
+    uint8_t vCell[Cells] = {};
+    uint16_t temp[Temps] = {};
+    FaultBits<BITS> fault[AMS_FAULT_KINDS];
+    AmsModuleEval eval;
+  };
+
+  Pack() {
+    for (uint8_t m = 0; m < LANES; m++) _slot[m] = 0xFF;
+  }
+
+  Module& module(uint8_t m) { return _modules[m]; }
+  const Module& module(uint8_t m) const { return _modules[m]; }
+  bool connected(uint8_t m) const { return _slot[m] != 0xFF; }
+  uint8_t connectedCount() const { return _activeCount; }
+  void setConnected(uint8_t m, bool on) {
+    if (m < Modules) AmsActiveList::set(_active, _slot, _activeCount, m, on);
+  }
+
+  // All Cells voltages and Temps sensor codes of module m
+  void loadModule(uint8_t m, const uint8_t* v, const uint16_t* t, bool on) {
+    if (m >= Modules) return;
+    for (uint8_t c = 0; c < Cells; c++) _modules[m].vCell[c] = v[c];
+    for (uint8_t s = 0; s < Temps; s++) _modules[m].temp[s] = t[s];
+    setConnected(m, on);
+  }
+
+  // From the CAN struct, its first Cells / Temps. A BMUdata only carries
+  // CELL_NUM / TEMP_SENSOR_NUM, wider modules go through loadModule.
+  void loadBMU(uint8_t m, const BMUdata& b) {
+    static_assert(Cells <= CELL_NUM && Temps <= TEMP_SENSOR_NUM, "Module wider than BMUdata, use loadModule");
+    loadModule(m, b.V_CELL, b.TEMP_SENSE, b.BMUconnected);
+  }
+
+  // Masks (first 16 bits), V_MODULE and DV back into the CAN struct
+  void storeBMU(uint8_t m, BMUdata* b) const {
+    const Module& mod = _modules[m];
+    b->OVERVOLTAGE_WARNING = mod.fault[AMS_OV_WARN].low16();
+    b->OVERVOLTAGE_CRITICAL = mod.fault[AMS_OV_CRIT].low16();
+    b->LOWVOLTAGE_WARNING = mod.fault[AMS_LV_WARN].low16();
+    b->LOWVOLTAGE_CRITICAL = mod.fault[AMS_LV_CRIT].low16();
+    b->OVERTEMP_WARNING = mod.fault[AMS_OT_WARN].low16();
+    b->OVERTEMP_CRITICAL = mod.fault[AMS_OT_CRIT].low16();
+    b->OVERDIV_VOLTAGE_WARNING = mod.fault[AMS_DV_WARN].low16();
+    b->OVERDIV_VOLTAGE_CRITICAL = mod.fault[AMS_DV_CRIT].low16();
+    b->V_MODULE = mod.eval.vSum;
+    b->DV = (uint8_t)((mod.eval.vMax - mod.eval.vMin) / 5);
+  }
+
+  // One pass over the connected modules
+  AmsPackSummary evaluate() {
+    AmsPackSummary s;
+    for (uint8_t i = 0; i < _activeCount; i++) {
+      Module& mod = _modules[_active[i]];
+      mod.eval = amsEvalModule(mod.vCell, Cells, mod.temp, Temps, limits, mod.fault[0].w,
+                               (uint8_t)FaultBits<BITS>::WORDS);
+      amsAddToSummary(&s, mod.eval);
+    }
+    return s;
+  }
+
+  AmsLimits limits;
+
+ private:
+  static_assert(sizeof(FaultBits<BITS>) == FaultBits<BITS>::WORDS * sizeof(uint32_t),
+                "fault[] must be contiguous words for amsEvalModule");
+  Module _modules[LANES];
+  uint8_t _active[LANES] = {};
+  uint8_t _slot[LANES];  // Index in _active, 0xFF = not connected
+  uint8_t _activeCount = 0;
+};
+
+// The car as configured in ams_data_util.h
+typedef Pack<CELL_NUM, MODULE_NUM, TEMP_SENSOR_NUM> CarPack;
+
+// =======================================================================
+// Runtime sized pack, storage carved from a fixed arena inside the object
+// =======================================================================
+struct AmsPackConfig {
+  uint8_t cells;
+  uint8_t modules;
+  uint8_t temps;
+};
+
+constexpr AmsPackConfig AMS_PACK_CAR = {CELL_NUM, MODULE_NUM, TEMP_SENSOR_NUM};
+constexpr AmsPackConfig AMS_PACK_BENCH = {CELL_NUM, 2, TEMP_SENSOR_NUM};
+constexpr AmsPackConfig AMS_PACK_HEADLESS = {CELL_NUM, 0, TEMP_SENSOR_NUM};
+
+#ifndef AMS_PACK_ARENA_BYTES
+#define AMS_PACK_ARENA_BYTES 8192  // 16 modules x 24 cells fits with room to spare
+#endif
+
+class PackRuntime {
+ public:
+  // false = config does not fit AMS_PACK_ARENA_BYTES (previous config is kept)
+  bool begin(const AmsPackConfig& cfg);
+  static size_t arenaBytes(const AmsPackConfig& cfg);
+
+  uint8_t cells() const { return _cfg.cells; }
+  uint8_t modules() const { return _cfg.modules; }
+  uint8_t temps() const { return _cfg.temps; }
+  uint8_t words() const { return _words; }
+
+  uint8_t* vCell(uint8_t m) { return _v + m * _cfg.cells; }
+  uint16_t* temp(uint8_t m) { return _t + m * _cfg.temps; }
+  const uint32_t* fault(uint8_t m, AmsFaultKind kind) const {
+    return _masks + ((size_t)m * AMS_FAULT_KINDS + kind) * _words;
+  }
+  bool testFault(uint8_t m, AmsFaultKind kind, uint8_t i) const { return (fault(m, kind)[i >> 5] >> (i & 31)) & 1; }
+  const AmsModuleEval& eval(uint8_t m) const { return _eval[m]; }
+
+  bool connected(uint8_t m) const { return m < _cfg.modules && _slot[m] != 0xFF; }
+  uint8_t connectedCount() const { return _activeCount; }
+  void setConnected(uint8_t m, bool on) {
+    if (m < _cfg.modules) AmsActiveList::set(_active, _slot, _activeCount, m, on);
+  }
+
+  void loadModule(uint8_t m, const uint8_t* v, const uint16_t* t, bool on);  // cells() / temps() values
+  // false = the module is wider than BMUdata (CELL_NUM / TEMP_SENSOR_NUM), nothing loaded
+  bool loadBMU(uint8_t m, const BMUdata& b);
+  void storeBMU(uint8_t m, BMUdata* b) const;
+  AmsPackSummary evaluate();
+
+  AmsLimits limits;
+
+ private:
+  AmsPackConfig _cfg = {0, 0, 0};
+  uint8_t _words = 0;
+  uint8_t* _v = nullptr;
+  uint16_t* _t = nullptr;
+  uint32_t* _masks = nullptr;
+  AmsModuleEval* _eval = nullptr;
+  uint8_t* _active = nullptr;
+  uint8_t* _slot = nullptr;
+  uint8_t _activeCount = 0;
+  alignas(4) uint8_t _arena[AMS_PACK_ARENA_BYTES];
+};
+
+#endif // AMS_PACK_H
@@ -0,0 +1,238 @@
+/************************* Pack Simulator ***************************/
+
+#include "ams_packsim.h"
+#include "ams_pack.h"
+#include "ams_soc.h"
+#include <math.h>
+#include <string.h>
+
+#define SIM_SUBSTEP_MS 100
+#define SIM_R1_OHM 0.0010f
+#define SIM_TAU_S 30.0f
+#define SIM_WARN_C 55.0f  // Assumed temperature at SIM_WARN_RAW
+#if AMS_OT_CONFIGURED
+#define SIM_WARN_RAW TEMP_WARN_RAW
+#define SIM_MAX_RAW TEMP_MAX_RAW
+#else  // OT off: any two codes, so the sensors still move with temperature
+#define SIM_WARN_RAW 240
+#define SIM_MAX_RAW 260
+#endif
+
+// Raw TEMP_SENSE code, straight line through the two threshold codes (assumed
+// mapping, the real divider / thermistor curve is not linear)
+static inline float simTempRaw(float c) {
+  return SIM_WARN_RAW + (c - SIM_WARN_C) * (float)(SIM_MAX_RAW - SIM_WARN_RAW) / (TEMP_MAX_CELL - SIM_WARN_C);
+}
+
+// ~75 s endurance lap: launches, straights, regen into corners
+static const AmsSimSegment ENDURANCE_LAP[] = {
+  {4000, 160}, {6000, 70}, {2500, -45}, {3000, 110}, {5000, 40}, {2000, -60},
+  {7000, 90},  {1500, 200}, {4000, 55}, {3000, -30}, {6000, 80}, {2500, -50},
+  {5000, 120}, {8000, 45}, {3500, -40}, {4000, 100}, {5000, 60}, {3000, 0},
+};
+
+static inline uint32_t simRand(AmsPackSim* sim) {  // xorshift32
+  uint32_t x = sim->rng;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  return sim->rng = x;
+}
+
+static inline float simUniform(AmsPackSim* sim) {  // [0, 1)
+  return (simRand(sim) >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float simSpread(AmsPackSim* sim, float spread) {  // [-spread, spread)
+  return (2.0f * simUniform(sim) - 1.0f) * spread;
+}
+
+static inline float simNoise(AmsPackSim* sim) {  // ~N(0, 1), sum of four uniforms
+  return (simUniform(sim) + simUniform(sim) + simUniform(sim) + simUniform(sim) - 2.0f) * 1.7320508f;
+}
+
+static float profileCurrent(const AmsSimConfig& cfg, uint32_t timeMs) {
+  const AmsSimSegment* seg = cfg.profile ? cfg.profile : ENDURANCE_LAP;
+  uint8_t n = cfg.profile ? cfg.profileLength : sizeof(ENDURANCE_LAP) / sizeof(ENDURANCE_LAP[0]);
+  uint32_t lap = 0;
+  for (uint8_t i = 0; i < n; i++) lap += seg[i].durationMs;
+  if (lap == 0) return 0.0f;
+  uint32_t t = timeMs % lap;
+  for (uint8_t i = 0; i < n; i++) {
+    if (t < seg[i].durationMs) return seg[i].currentA * cfg.currentScale;
+    t -= seg[i].durationMs;
+  }
+  return 0.0f;
+}
+
+static const AmsSimFault* findFault(const AmsPackSim* sim, AmsSimFaultKind kind, uint8_t m, uint8_t index) {
+  for (uint8_t i = 0; i < sim->faultCount; i++) {
+    const AmsSimFault& f = sim->faults[i];
+    if (f.kind == kind && f.module == m && f.index == index) return &f;
+  }
+  return nullptr;
+}
+
+// What the BMU would measure and report now
+static void updateBMUView(AmsPackSim* sim) {
+  static const AmsLimits limits;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    BMUdata& b = sim->bmu[m];
+    b.BMU_ID = BMU_ADD + ((uint32_t)m << BMU_MODULE_SHIFT);
+    b.BMUconnected = m < sim->cfg.modules && sim->silentUntilMs[m] == 0;
+    if (m >= sim->cfg.modules) continue;
+
+    for (int c = 0; c < CELL_NUM; c++) {
+      float v = amsOcv(sim->soc[m][c], nullptr) - sim->vrc[m][c] - sim->r0[m][c] * sim->currentA;
+      float raw = v / 0.02f + 0.5f + simNoise(sim) * sim->cfg.noiseRaw;
+      if (const AmsSimFault* f = findFault(sim, AMS_SIM_CELL_OFFSET, m, c)) raw += f->value;
+      if (findFault(sim, AMS_SIM_CELL_OPEN, m, c)) raw = 0.0f;
+      b.V_CELL[c] = raw <= 0.0f ? 0 : (raw >= 255.0f ? 255 : (uint8_t)raw);
+    }
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) {
+      float raw = simTempRaw(sim->tempC[m] + s * 1.0f) + simNoise(sim) * 0.5f;  // Sensor 2 sits nearer the busbar
+      if (const AmsSimFault* f = findFault(sim, AMS_SIM_TEMP_OFFSET, m, s)) raw += f->value;
+      if (const AmsSimFault* f = findFault(sim, AMS_SIM_TEMP_STUCK, m, s)) raw = (float)f->value;
+      b.TEMP_SENSE[s] = raw <= 0.0f ? 0 : (raw >= 65535.0f ? 65535 : (uint16_t)raw);
+    }
+
+    uint32_t masks[AMS_FAULT_KINDS];
+    AmsModuleEval e = amsEvalModule(b.V_CELL, CELL_NUM, b.TEMP_SENSE, TEMP_SENSOR_NUM, limits, masks, 1);
+    b.OVERVOLTAGE_WARNING = (uint16_t)masks[AMS_OV_WARN];
+    b.OVERVOLTAGE_CRITICAL = (uint16_t)masks[AMS_OV_CRIT];
+    b.LOWVOLTAGE_WARNING = (uint16_t)masks[AMS_LV_WARN];
+    b.LOWVOLTAGE_CRITICAL = (uint16_t)masks[AMS_LV_CRIT];
+    b.OVERTEMP_WARNING = (uint16_t)masks[AMS_OT_WARN];
+    b.OVERTEMP_CRITICAL = (uint16_t)masks[AMS_OT_CRIT];
+    b.OVERDIV_VOLTAGE_WARNING = (uint16_t)masks[AMS_DV_WARN];
+    b.OVERDIV_VOLTAGE_CRITICAL = (uint16_t)masks[AMS_DV_CRIT];
+    b.V_MODULE = e.vSum;
+    b.DV = (uint8_t)((e.vMax - e.vMin) / 5);
+    b.BMUneedBalance = masks[AMS_DV_WARN] != 0;
+  }
+}
+
+void amsSimInit(AmsPackSim* sim, const AmsSimConfig* cfg) {
+  sim->cfg = cfg ? *cfg : AmsSimConfig();
+  if (sim->cfg.modules > MODULE_NUM) sim->cfg.modules = MODULE_NUM;
+  sim->rng = sim->cfg.seed ? sim->cfg.seed : 1;
+  sim->timeMs = 0;
+  sim->currentA = 0.0f;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    for (int c = 0; c < CELL_NUM; c++) {
+      sim->soc[m][c] = sim->cfg.initialSoc + simSpread(sim, sim->cfg.socSpread);
+      sim->vrc[m][c] = 0.0f;
+      sim->r0[m][c] = sim->cfg.r0Ohm * (1.0f + simSpread(sim, sim->cfg.r0Spread));
+      sim->capacityAs[m][c] = AH_CELL * 3600.0f * (1.0f + simSpread(sim, sim->cfg.capacitySpread));
+    }
+    sim->tempC[m] = sim->cfg.ambientC;
+    sim->silentUntilMs[m] = 0;
+    sim->bmu[m] = BMUdata();
+  }
+  sim->faultCount = 0;
+  sim->frameClockUs = 0;
+  sim->frameDebt = 0;
+  sim->nextModule = 0;
+  sim->nextFrame = 0;
+  sim->framesSent = 0;
+  updateBMUView(sim);
+}
+
+void amsSimStep(AmsPackSim* sim, uint32_t dtMs) {
+  const AmsSimConfig& cfg = sim->cfg;
+  while (dtMs > 0) {
+    uint32_t step = dtMs < SIM_SUBSTEP_MS ? dtMs : SIM_SUBSTEP_MS;
+    dtMs -= step;
+    float dt = step * 0.001f;
+    float i = profileCurrent(cfg, sim->timeMs);
+    float a = expf(-dt / SIM_TAU_S), b = SIM_R1_OHM * (1.0f - a);
+    float dropout = cfg.dropoutPerHour * dt / 3600.0f;
+
+    for (int m = 0; m < cfg.modules; m++) {
+      float heat = 0.0f;
+      for (int c = 0; c < CELL_NUM; c++) {
+        float cellI = i;
+        if (const AmsSimFault* f = findFault(sim, AMS_SIM_CELL_LEAK, m, c)) cellI += f->value * 0.001f;
+        sim->soc[m][c] -= cellI * dt / sim->capacityAs[m][c];
+        if (sim->soc[m][c] < 0.0f) sim->soc[m][c] = 0.0f;
+        if (sim->soc[m][c] > 1.0f) sim->soc[m][c] = 1.0f;
+        sim->vrc[m][c] = a * sim->vrc[m][c] + b * cellI;
+        heat += cellI * cellI * sim->r0[m][c] + sim->vrc[m][c] * cellI;
+      }
+      sim->tempC[m] += (heat - cfg.coolingWPerK * (sim->tempC[m] - cfg.ambientC)) * dt / cfg.thermalMassJPerK;
+
+      if (sim->silentUntilMs[m] && sim->timeMs + step >= sim->silentUntilMs[m]) sim->silentUntilMs[m] = 0;
+      if (!sim->silentUntilMs[m] && simUniform(sim) < dropout) sim->silentUntilMs[m] = sim->timeMs + cfg.dropoutMs;
+    }
+    sim->timeMs += step;
+    sim->currentA = i;
+  }
+  updateBMUView(sim);
+}
+
+bool amsSimInjectFault(AmsPackSim* sim, const AmsSimFault& fault) {
+  if (fault.module >= MODULE_NUM) return false;
+  if (fault.kind == AMS_SIM_MODULE_SILENT) {
+    sim->silentUntilMs[fault.module] = sim->timeMs + (fault.value > 0 ? (uint32_t)fault.value : 1);
+    updateBMUView(sim);
+    return true;
+  }
+  if (sim->faultCount >= AMS_SIM_MAX_FAULTS) return false;
+  sim->faults[sim->faultCount++] = fault;
+  return true;
+}
+
+void amsSimClearFaults(AmsPackSim* sim) {
+  sim->faultCount = 0;
+}
+
+void amsSimFillBMU(const AmsPackSim* sim, BMUdata* bmuArray) {
+  for (int m = 0; m < MODULE_NUM; m++) bmuArray[m] = sim->bmu[m];
+}
+
+void amsSimFillOBC(const AmsPackSim* sim, OBCdata* obc) {
+  uint32_t packRaw = 0;
+  for (int m = 0; m < sim->cfg.modules; m++) packRaw += sim->bmu[m].V_MODULE;
+  bool charging = sim->currentA < 0.0f;
+  obc->OBCVolt = charging ? (uint16_t)(packRaw / 5) : 0;  // 0.02 V -> 0.1 V
+  obc->OBCAmp = charging ? (uint16_t)(-sim->currentA * 10.0f) : 0;
+  obc->OBCstatusbit = 0;
+  obc->OBC_OK = true;
+}
+
+uint32_t amsSimBusCapacity(uint32_t bitrate) {
+  // 29 bit ID, 8 data bytes: 118 stuffable bits (+ up to 29 stuff bits) + 13 fixed
+  return bitrate / 160;
+}
+
+size_t amsSimPollFrames(AmsPackSim* sim, uint32_t nowUs, twai_message_t* out, size_t cap) {
+  uint8_t online = 0;
+  for (int m = 0; m < sim->cfg.modules; m++) online += sim->bmu[m].BMUconnected;
+  uint32_t fps = sim->cfg.framesPerSecond ? sim->cfg.framesPerSecond
+                                          : online * BMU_FRAME_NUM * 1000u / BMS_COMMUNICATE_TIME;
+  uint64_t owed = sim->frameDebt + (uint64_t)(nowUs - sim->frameClockUs) * fps / 1000;
+  sim->frameClockUs = nowUs;
+  if (owed > (uint64_t)fps * 1000) owed = (uint64_t)fps * 1000;  // At most one second behind
+  if (online == 0) {
+    sim->frameDebt = 0;
+    return 0;
+  }
+
+  size_t n = 0;
+  while (owed >= 1000 && n < cap) {
+    if (sim->nextFrame == 0) {  // Next module on the bus, snapshot its frames
+      while (sim->nextModule >= sim->cfg.modules || !sim->bmu[sim->nextModule].BMUconnected)
+        sim->nextModule = (uint8_t)((sim->nextModule + 1) % sim->cfg.modules);
+      encodeBMUFrames(&sim->bmu[sim->nextModule], sim->nextModule, sim->frameCache);
+    }
+    out[n++] = sim->frameCache[sim->nextFrame];
+    owed -= 1000;
+    if (++sim->nextFrame == BMU_FRAME_NUM) {
+      sim->nextFrame = 0;
+      sim->nextModule = (uint8_t)((sim->nextModule + 1) % sim->cfg.modules);
+    }
+  }
+  sim->frameDebt = (uint32_t)owed;
+  sim->framesSent += n;
+  return n;
+}
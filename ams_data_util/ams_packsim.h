@@ -0,0 +1,115 @@
+// =======================================================================
+// Pack simulator: deterministic BMUdata / CAN frame load generator
+// =======================================================================
+#ifndef AMS_PACKSIM_H
+#define AMS_PACKSIM_H
+
+#include "ams_data_util.h"
+
+// Per cell: OCV curve (ams_soc.h), 1-RC model, its own capacity, R0 and
+// self-discharge. Per module: lumped thermal model (I^2 R heating, cooling to
+// ambient) and two sensors. Current follows a repeating endurance lap profile.
+// The BMU side is simulated too:
+// - cells are read with 0.02 V quantisation and noise
+// - fault masks / V_MODULE / DV are evaluated with the ams_pack limits
+// - modules drop off the bus at random and come back after a while
+// Faults can be injected per cell / sensor / module.
+//
+// Everything comes from one xorshift seed, so the same seed and the same call
+// sequence replay exactly. Use it as the mockBMU / mockAMS replacement and as
+// the load generator for the decode / aggregation / logging / telemetry paths.
+//
+// Temperatures are raw TEMP_SENSE codes from an assumed mapping, not a
+// thermistor curve: a straight line through TEMP_WARN_RAW taken as 55 C and
+// TEMP_MAX_RAW at TEMP_MAX_CELL, whatever codes the build defines for them
+// (fixed placeholder codes when AMS_OT_CONFIGURED is 0).
+// Good for exercising the warning / critical thresholds, not for absolute
+// temperatures.
+
+struct AmsSimSegment {
+  uint16_t durationMs;
+  int16_t currentA;  // Discharge positive, regen negative
+};
+
+enum AmsSimFaultKind : uint8_t {
+  AMS_SIM_FAULT_NONE,
+  AMS_SIM_CELL_OFFSET,    // Reading off by value raw codes (signed)
+  AMS_SIM_CELL_OPEN,      // Sense wire open, reads 0
+  AMS_SIM_CELL_LEAK,      // Extra drain of value mA, real imbalance builds up
+  AMS_SIM_TEMP_STUCK,     // Sensor index reads value (raw) forever
+  AMS_SIM_TEMP_OFFSET,    // Sensor index reads value raw codes hotter
+  AMS_SIM_MODULE_SILENT,  // Module off the bus for value ms
+};
+
+struct AmsSimFault {
+  AmsSimFaultKind kind;
+  uint8_t module;
+  uint8_t index;  // Cell or sensor
+  int32_t value;
+};
+
+#define AMS_SIM_MAX_FAULTS 16
+
+struct AmsSimConfig {
+  uint32_t seed = 1;
+  uint8_t modules = MODULE_NUM;     // Modules fitted, <= MODULE_NUM
+  float initialSoc = 0.95f;
+  float socSpread = 0.02f;          // +- per cell
+  float capacitySpread = 0.03f;     // +- fraction of AH_CELL
+  float r0Ohm = 0.0015f;
+  float r0Spread = 0.2f;            // +- fraction
+  float ambientC = 25.0f;
+  float thermalMassJPerK = 2500.0f; // Per module
+  float coolingWPerK = 1.5f;        // Per module
+  float noiseRaw = 0.6f;            // V_CELL noise, raw code RMS
+  float dropoutPerHour = 2.0f;      // Per module
+  uint16_t dropoutMs = 3000;
+  float currentScale = 1.0f;
+  const AmsSimSegment* profile = nullptr;  // nullptr = built-in endurance lap
+  uint8_t profileLength = 0;
+  uint32_t framesPerSecond = 0;     // CAN stream, 0 = every BMS_COMMUNICATE_TIME
+};
+
+struct AmsPackSim {
+  AmsSimConfig cfg;
+  uint32_t rng;
+  uint32_t timeMs;
+  float currentA;
+  // Cell state, truth
+  float soc[MODULE_NUM][CELL_NUM];
+  float vrc[MODULE_NUM][CELL_NUM];
+  float r0[MODULE_NUM][CELL_NUM];
+  float capacityAs[MODULE_NUM][CELL_NUM];
+  float tempC[MODULE_NUM];
+  uint32_t silentUntilMs[MODULE_NUM];  // 0 = on the bus
+  AmsSimFault faults[AMS_SIM_MAX_FAULTS];
+  uint8_t faultCount;
+  // Last BMU view, what goes on the bus
+  BMUdata bmu[MODULE_NUM];
+  // CAN stream state
+  uint32_t frameClockUs;
+  uint32_t frameDebt;     // Frames owed, x 1000
+  uint8_t nextModule;
+  uint8_t nextFrame;
+  twai_message_t frameCache[BMU_FRAME_NUM];  // nextModule, encoded at its frame 0
+  uint64_t framesSent;
+};
+
+void amsSimInit(AmsPackSim* sim, const AmsSimConfig* cfg = nullptr);
+// Advances the physics and the BMU view by dtMs (steps of at most 100 ms)
+void amsSimStep(AmsPackSim* sim, uint32_t dtMs);
+bool amsSimInjectFault(AmsPackSim* sim, const AmsSimFault& fault);
+void amsSimClearFaults(AmsPackSim* sim);
+
+// What a receiver would hold; silent / unfitted modules have BMUconnected false
+void amsSimFillBMU(const AmsPackSim* sim, BMUdata* bmuArray);
+// Charger view: charging (current < 0) at the pack voltage, idle otherwise
+void amsSimFillOBC(const AmsPackSim* sim, OBCdata* obc);
+
+// CAN frames due by nowUs (monotonic), round robin over the modules on the bus,
+// at framesPerSecond. Returns the count written (at most cap).
+size_t amsSimPollFrames(AmsPackSim* sim, uint32_t nowUs, twai_message_t* out, size_t cap);
+// Extended 8 byte frames per second a bus can carry, worst case bit stuffing
+uint32_t amsSimBusCapacity(uint32_t bitrate);
+
+#endif // AMS_PACKSIM_H
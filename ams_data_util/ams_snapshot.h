@@ -0,0 +1,120 @@
+// =======================================================================
+// Latest-value snapshot (seqlock) for sharing BMUdata / AMSdata across tasks
+// =======================================================================
+#ifndef AMS_SNAPSHOT_H
+#define AMS_SNAPSHOT_H
+
+#include <string.h>
+#include <type_traits>
+#include "ams_data_util.h"
+
+// A reader that preempted the writer mid-write (same core, higher priority)
+// would spin until the tick; after a short spin it sleeps so the writer can finish
+#ifdef ARDUINO
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#define AMS_SNAPSHOT_YIELD() vTaskDelay(1)
+#else
+#include <thread>
+#define AMS_SNAPSHOT_YIELD() std::this_thread::yield()
+#endif
+#define AMS_SNAPSHOT_SPIN 64
+
+// One writer (e.g. the CAN RX path) publishes whole values, and any number of
+// readers (logger, telemetry, WebSocket) copy the latest one out.
+// - write() never waits: two sequence bumps and a copy.
+// - read() retries while a write overlaps it, so a reader never sees cells
+//   from one frame paired with masks from another.
+// Same protocol as CAN32_getHealth. The payload is copied word by word with
+// relaxed atomics, so the concurrent copy is not a data race.
+//
+// Usage: the RX task decodes into its own BMUdata, then
+//   bmuSnap[m].write(bmu[m]);
+// and a reader calls
+//   BMUdata b; bmuSnap[m].read(&b);
+// With several writers for one snapshot, serialise them outside.
+
+struct AmsSnapshotStats {
+  uint32_t writes;
+  uint32_t reads;      // Successful copies
+  uint32_t retries;    // Copies thrown away because a write overlapped
+  uint32_t failed;     // read() gave up after maxRetries
+  uint32_t maxRetries; // Worst single read
+};
+
+template <typename T>
+class AmsSnapshot {
+ public:
+  static_assert(std::is_trivially_copyable<T>::value, "AmsSnapshot needs a plain struct");
+
+  AmsSnapshot() {
+    T init{};
+    write(init);
+    _stats.writes = 0;
+  }
+
+  void write(const T& value) {
+    uint32_t words[WORDS] = {};
+    memcpy(words, &value, sizeof(T));
+    uint32_t seq = __atomic_load_n(&_seq, __ATOMIC_RELAXED);
+    __atomic_store_n(&_seq, seq + 1, __ATOMIC_RELAXED);  // Odd: write in progress
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    for (size_t i = 0; i < WORDS; i++) __atomic_store_n(&_words[i], words[i], __ATOMIC_RELAXED);
+    __atomic_store_n(&_seq, seq + 2, __ATOMIC_RELEASE);
+    __atomic_fetch_add(&_stats.writes, 1, __ATOMIC_RELAXED);
+  }
+
+  // false only if maxRetries writes in a row overlapped the copy (out untouched)
+  bool read(T* out, uint32_t maxRetries = 1000) {
+    uint32_t words[WORDS];
+    for (uint32_t attempt = 0; attempt <= maxRetries; attempt++) {
+      uint32_t before = __atomic_load_n(&_seq, __ATOMIC_ACQUIRE);
+      if (attempt && attempt % AMS_SNAPSHOT_SPIN == 0) AMS_SNAPSHOT_YIELD();
+      if (!(before & 1)) {
+        for (size_t i = 0; i < WORDS; i++) words[i] = __atomic_load_n(&_words[i], __ATOMIC_RELAXED);
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&_seq, __ATOMIC_RELAXED) == before) {
+          memcpy(out, words, sizeof(T));
+          __atomic_fetch_add(&_stats.reads, 1, __ATOMIC_RELAXED);
+          if (attempt) {
+            __atomic_fetch_add(&_stats.retries, attempt, __ATOMIC_RELAXED);
+            uint32_t worst = __atomic_load_n(&_stats.maxRetries, __ATOMIC_RELAXED);
+            while (attempt > worst && !__atomic_compare_exchange_n(&_stats.maxRetries, &worst, attempt, true,
+                                                                   __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+          }
+          return true;
+        }
+      }
+    }
+    __atomic_fetch_add(&_stats.retries, maxRetries + 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&_stats.failed, 1, __ATOMIC_RELAXED);
+    return false;
+  }
+
+  // Advances by 2 per write; compare with a saved value to skip unchanged data
+  uint32_t version() const { return __atomic_load_n(&_seq, __ATOMIC_ACQUIRE) & ~1u; }
+
+  AmsSnapshotStats stats() const {
+    AmsSnapshotStats s;
+    s.writes = __atomic_load_n(&_stats.writes, __ATOMIC_RELAXED);
+    s.reads = __atomic_load_n(&_stats.reads, __ATOMIC_RELAXED);
+    s.retries = __atomic_load_n(&_stats.retries, __ATOMIC_RELAXED);
+    s.failed = __atomic_load_n(&_stats.failed, __ATOMIC_RELAXED);
+    s.maxRetries = __atomic_load_n(&_stats.maxRetries, __ATOMIC_RELAXED);
+    return s;
+  }
+
+ private:
+  static constexpr size_t WORDS = (sizeof(T) + 3) / 4;
+  uint32_t _seq = 0;  // Odd while a write is in progress
+  uint32_t _words[WORDS];
+  // Own cache line (ESP32: 32 B), reader counter updates stay off the data
+  alignas(64) AmsSnapshotStats _stats = {};
+};
+
+typedef AmsSnapshot<BMUdata> BMUsnapshot;
+typedef AmsSnapshot<AMSdata> AMSsnapshot;
+typedef AmsSnapshot<OBCdata> OBCsnapshot;
+
+#endif // AMS_SNAPSHOT_H
@@ -0,0 +1,177 @@
+/************************* SOC / SOH Estimator ***************************/
+
+#include "ams_soc.h"
+#include <math.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+static uint32_t socMicros() { return micros(); }
+#else
+#include <chrono>
+static uint32_t socMicros() {
+  return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+#endif
+
+// Generic NMC rest curve, 10 % steps. Replace with the LG34 datasheet points
+// once characterised; both ends match VMIN_CELL / VMAX_CELL.
+#define OCV_POINTS 11
+static const float OCV_V[OCV_POINTS] = {
+  2.90f, 3.45f, 3.56f, 3.63f, 3.69f, 3.76f, 3.85f, 3.94f, 4.03f, 4.11f, 4.20f,
+};
+
+float amsOcv(float soc, float* slope) {
+  if (soc < 0.0f) soc = 0.0f;
+  if (soc > 1.0f) soc = 1.0f;
+  float x = soc * (OCV_POINTS - 1);
+  int i = (int)x;
+  if (i >= OCV_POINTS - 1) i = OCV_POINTS - 2;
+  float k = (OCV_V[i + 1] - OCV_V[i]) * (OCV_POINTS - 1);
+  if (slope) *slope = k;
+  return OCV_V[i] + (x - i) * (OCV_V[i + 1] - OCV_V[i]);
+}
+
+float amsSocFromOcv(float volts) {
+  if (volts <= OCV_V[0]) return 0.0f;
+  if (volts >= OCV_V[OCV_POINTS - 1]) return 1.0f;
+  int i = 0;
+  while (volts > OCV_V[i + 1]) i++;
+  return (i + (volts - OCV_V[i]) / (OCV_V[i + 1] - OCV_V[i])) / (OCV_POINTS - 1);
+}
+
+void amsSocInit(AmsSocEstimator* est, const AmsSocConfig* cfg) {
+  est->cfg = cfg ? *cfg : AmsSocConfig();
+  for (int i = 0; i < AMS_SOC_CELLS; i++) {
+    est->soc[i] = 0.0f;
+    est->vrc[i] = 0.0f;
+    est->p00[i] = 0.01f;
+    est->p01[i] = 0.0f;
+    est->p11[i] = 1e-4f;
+    est->r0[i] = est->cfg.r0Ohm;
+    est->lastRaw[i] = 0;
+  }
+  est->lastCurrentA = 0.0f;
+  est->lastDtMs = 0;
+  est->a = est->b = est->dSoc = 0.0f;
+  est->chargeMas = 0;
+  est->socMin = est->socMean = 0.0f;
+  est->r0Max = est->cfg.r0Ohm;
+  est->seeded = false;
+  est->stats = AmsSocStats();
+}
+
+static void seed(AmsSocEstimator* est, const BMUdata* bmuArray) {
+  uint32_t sum = 0, n = 0;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    if (!bmuArray[m].BMUconnected) continue;
+    for (int c = 0; c < CELL_NUM; c++) {
+      int i = m * CELL_NUM + c;
+      est->soc[i] = amsSocFromOcv(bmuArray[m].V_CELL[c] * 0.02f);
+      est->lastRaw[i] = bmuArray[m].V_CELL[c];
+      sum += bmuArray[m].V_CELL[c];
+      n++;
+    }
+  }
+  if (n == 0) return;
+  // Modules not heard yet start at the pack average
+  float avg = amsSocFromOcv(sum * 0.02f / n);
+  for (int m = 0; m < MODULE_NUM; m++) {
+    if (bmuArray[m].BMUconnected) continue;
+    for (int c = 0; c < CELL_NUM; c++) est->soc[m * CELL_NUM + c] = avg;
+  }
+  est->chargeMas = 0;
+  est->seeded = true;
+}
+
+void amsSocUpdate(AmsSocEstimator* est, const BMUdata* bmuArray, int32_t currentMa, uint32_t dtMs) {
+  uint32_t t0 = socMicros();
+  if (!est->seeded) {
+    seed(est, bmuArray);
+    est->lastCurrentA = currentMa * 0.001f;
+    if (!est->seeded) return;
+  }
+
+  const AmsSocConfig& cfg = est->cfg;
+  if (dtMs != est->lastDtMs) {  // exp only when the period changes
+    float dt = dtMs * 0.001f;
+    est->a = expf(-dt / cfg.tauS);
+    est->b = cfg.r1Ohm * (1.0f - est->a);
+    est->dSoc = dt / (cfg.capacityAh * 3600.0f);
+    est->lastDtMs = dtMs;
+  }
+  const float a = est->a, b = est->b;
+  const float current = currentMa * 0.001f;
+  const float dI = current - est->lastCurrentA;
+  const bool r0Sample = fabsf(dI) >= cfg.r0StepA;
+  const float invDI = r0Sample ? 1.0f / dI : 0.0f;
+  const float socStep = current * est->dSoc;
+  est->chargeMas += (int64_t)currentMa * dtMs / 1000;
+
+  float socMin = 1.0f, socSum = 0.0f, r0Max = 0.0f;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    const BMUdata& bmu = bmuArray[m];
+    const bool measured = bmu.BMUconnected;
+    for (int c = 0; c < CELL_NUM; c++) {
+      const int i = m * CELL_NUM + c;
+      // Predict: coulomb count + RC relaxation
+      float s = est->soc[i] - socStep;
+      float v1 = a * est->vrc[i] + b * current;
+      float p00 = est->p00[i] + cfg.qSoc;
+      float p01 = a * est->p01[i];
+      float p11 = a * a * est->p11[i] + cfg.qVrc;
+
+      if (measured) {
+        const uint8_t raw = bmu.V_CELL[c];
+        if (r0Sample) {  // Ohmic drop across the current step, filtered
+          float r = -(raw - (int)est->lastRaw[i]) * 0.02f * invDI;
+          if (r > 0.0002f && r < 0.02f) est->r0[i] += (r - est->r0[i]) * 0.125f;
+        }
+        est->lastRaw[i] = raw;
+
+        float k;
+        float y = raw * 0.02f - (amsOcv(s, &k) - v1 - est->r0[i] * current);
+        float hp0 = k * p00 - p01;  // H P, H = [k, -1]
+        float hp1 = k * p01 - p11;
+        float inv = 1.0f / (k * hp0 - hp1 + cfg.rMeas);
+        float k0 = hp0 * inv, k1 = hp1 * inv;
+        s += k0 * y;
+        v1 += k1 * y;
+        p00 -= k0 * hp0;
+        p01 -= k0 * hp1;
+        p11 -= k1 * hp1;
+      }
+
+      s = s < 0.0f ? 0.0f : (s > 1.0f ? 1.0f : s);
+      est->soc[i] = s;
+      est->vrc[i] = v1;
+      est->p00[i] = p00;
+      est->p01[i] = p01;
+      est->p11[i] = p11;
+      socMin = s < socMin ? s : socMin;
+      socSum += s;
+      r0Max = est->r0[i] > r0Max ? est->r0[i] : r0Max;
+    }
+  }
+  est->socMin = socMin;
+  est->socMean = socSum / AMS_SOC_CELLS;
+  est->r0Max = r0Max;
+  est->lastCurrentA = current;
+
+  uint32_t us = socMicros() - t0;
+  AmsSocStats& st = est->stats;
+  st.updates++;
+  st.lastUs = us;
+  if (us > st.maxUs) st.maxUs = us;
+  if (us > AMS_SOC_BUDGET_US) st.overBudget++;
+}
+
+void amsSocApply(const AmsSocEstimator* est, AMSdata* ams) {
+  ams->ACCUM_SOC = est->socMin * 100.0f;
+  float soh = est->cfg.r0Ohm / est->r0Max * 100.0f;
+  ams->ACCUM_SOH = soh > 100.0f ? 100.0f : soh;
+}
+
+const AmsSocStats& amsSocStats(const AmsSocEstimator* est) {
+  return est->stats;
+}
@@ -0,0 +1,71 @@
+// =======================================================================
+// State of charge / internal resistance estimator, every cell of the pack
+// =======================================================================
+#ifndef AMS_SOC_H
+#define AMS_SOC_H
+
+#include "ams_data_util.h"
+
+// Per cell: 1-RC equivalent circuit (R0 + R1||C1) with a 2-state EKF over
+// [SOC, V_RC]. The predict step is the coulomb count, and the OCV correction
+// pulls it back using the measured terminal voltage. R0 is tracked from the
+// voltage step on every large current step. SOH = R0 nominal / R0 estimated.
+//
+// float-lite: single precision only (ESP32 FPU), no exp/div in the cell loop
+// except one divide per cell. Cells are in series, so all cells share the
+// current. Disconnected modules still coulomb count and skip the correction.
+
+#define AMS_SOC_CELLS (CELL_NUM * MODULE_NUM)
+#define AMS_SOC_BUDGET_US 500  // Per update, all cells, once per BMS_COMMUNICATE_TIME
+
+struct AmsSocConfig {
+  float capacityAh = AH_CELL;
+  float r0Ohm = 0.0015f;       // Ohmic resistance, new cell
+  float r1Ohm = 0.0010f;       // Polarisation branch
+  float tauS = 30.0f;          // R1 * C1
+  float qSoc = 1e-7f;          // Process noise per update
+  float qVrc = 1e-6f;
+  float rMeas = 1.5e-4f;       // V^2, V_CELL quantisation (0.02 V) dominates
+  float r0StepA = 20.0f;       // Current step that triggers an R0 sample
+};
+
+struct AmsSocStats {
+  uint32_t updates;
+  uint32_t lastUs;
+  uint32_t maxUs;
+  uint32_t overBudget;  // Updates slower than AMS_SOC_BUDGET_US
+};
+
+struct AmsSocEstimator {
+  AmsSocConfig cfg;
+  // Per cell, index module * CELL_NUM + cell
+  float soc[AMS_SOC_CELLS];  // 0..1
+  float vrc[AMS_SOC_CELLS];  // V over the RC branch
+  float p00[AMS_SOC_CELLS];  // Covariance, symmetric 2x2
+  float p01[AMS_SOC_CELLS];
+  float p11[AMS_SOC_CELLS];
+  float r0[AMS_SOC_CELLS];
+  uint8_t lastRaw[AMS_SOC_CELLS];
+  // Shared per update
+  float lastCurrentA;
+  uint32_t lastDtMs;
+  float a, b, dSoc;           // exp(-dt/tau), R1 (1 - a), dt / capacity
+  int64_t chargeMas;          // Pack coulomb counter, mA s, discharge positive
+  float socMin, socMean, r0Max;
+  bool seeded;
+  AmsSocStats stats;
+};
+
+// OCV curve, soc 0..1 -> V, slope in V per unit SOC
+float amsOcv(float soc, float* slope);
+float amsSocFromOcv(float volts);
+
+void amsSocInit(AmsSocEstimator* est, const AmsSocConfig* cfg = nullptr);
+// Current in mA, discharge positive, dtMs since the previous call. The first
+// call with data seeds every cell from its OCV (pack assumed at rest).
+void amsSocUpdate(AmsSocEstimator* est, const BMUdata* bmuArray, int32_t currentMa, uint32_t dtMs);
+// ACCUM_SOC / ACCUM_SOH
+void amsSocApply(const AmsSocEstimator* est, AMSdata* ams);
+const AmsSocStats& amsSocStats(const AmsSocEstimator* est);
+
+#endif // AMS_SOC_H
@@ -0,0 +1,233 @@
+/************************* Telemetry Encoder ***************************/
+
+#include "ams_telemetry.h"
+#include "ams_units.h"
+#include <string.h>
+
+// Values are sent as physical x 10^decimals from ams_units.h, no float per value
+#define TLM_V_DECIMALS 2
+#define TLM_TEMP_DECIMALS 1
+
+struct TlmWriter {
+  AmsTelemetryEncoder* enc;
+  char* out;
+  size_t cap;
+  size_t len;
+  bool full;
+  bool force;  // Full snapshot, ignore change tracking
+};
+
+// One ">[M<module>_]<name>[<index>]:<value>\n" line, module / index < 0 = none
+static void tlmLine(TlmWriter& w, uint16_t slot, int module, const char* name, int index, int32_t scaled,
+                    uint8_t decimals) {
+  AmsTelemetryEncoder* enc = w.enc;
+  bool seen = enc->sent[slot >> 3] >> (slot & 7) & 1;
+  if (w.full || (!w.force && seen && enc->last[slot] == scaled)) return;
+
+  char line[48];
+  size_t n = 0;
+  line[n++] = '>';
+  if (module >= 0) {
+    line[n++] = 'M';
+    n += amsFormatU32(module + 1, line + n);
+    line[n++] = '_';
+  }
+  size_t nameLen = strlen(name);
+  memcpy(line + n, name, nameLen);
+  n += nameLen;
+  if (index >= 0) n += amsFormatU32(index + 1, line + n);
+  line[n++] = ':';
+  n += amsFormatFixed(scaled, decimals, line + n);
+  line[n++] = '\n';
+
+  if (w.len + n > w.cap) {  // Whole lines only; the rest goes next snapshot
+    w.full = true;
+    return;
+  }
+  memcpy(w.out + w.len, line, n);
+  w.len += n;
+  enc->last[slot] = scaled;
+  enc->sent[slot >> 3] |= (uint8_t)(1u << (slot & 7));
+}
+
+void amsTelemetryInit(AmsTelemetryEncoder* enc, const AmsTelemetryConfig* cfg) {
+  enc->cfg = cfg ? *cfg : AmsTelemetryConfig();
+  memset(enc->last, 0, sizeof(enc->last));
+  memset(enc->sent, 0, sizeof(enc->sent));
+  enc->sinceRefresh = 0;
+  enc->truncated = 0;
+  if (enc->cfg.decimation == 0) enc->cfg.decimation = 1;
+}
+
+size_t amsTelemetryEncode(AmsTelemetryEncoder* enc, const AMSdata* ams, const BMUdata* bmuArray, char* out,
+                          size_t cap) {
+  const AmsTelemetryConfig& cfg = enc->cfg;
+  TlmWriter w = {enc, out, cap, 0, false, cfg.mode == AMS_TLM_ALL};
+  if (cfg.mode == AMS_TLM_CHANGED && (enc->sinceRefresh == 0 || enc->sinceRefresh >= cfg.refreshEvery)) {
+    w.force = true;
+    enc->sinceRefresh = 0;
+  }
+
+  if (cfg.sections & AMS_TLM_STATE) {
+    tlmLine(w, 0, -1, "AMS_Volt", -1, amsScaled<TLM_V_DECIMALS>(AmsMillivolts(ams->ACCUM_VOLTAGE_MV)),
+            TLM_V_DECIMALS);
+    tlmLine(w, 1, -1, "AMS_MaxV", -1, (int32_t)(ams->ACCUM_MAXVOLTAGE * 100.0f + 0.5f), 2);
+    tlmLine(w, 2, -1, "AMS_MinV", -1, (int32_t)(ams->ACCUM_MINVOLTAGE * 100.0f + 0.5f), 2);
+    tlmLine(w, 3, -1, "AMS_OK", -1, ams->AMS_OK, 0);
+    tlmLine(w, 4, -1, "AMS_ChgReady", -1, ams->ACCUM_CHG_READY, 0);
+    tlmLine(w, 5, -1, "AMS_OV_Warn", -1, ams->OVERVOLT_WARNING, 0);
+    tlmLine(w, 6, -1, "AMS_OV_Crit", -1, ams->OVERVOLT_CRITICAL, 0);
+    tlmLine(w, 7, -1, "AMS_LV_Warn", -1, ams->LOWVOLT_WARNING, 0);
+    tlmLine(w, 8, -1, "AMS_LV_Crit", -1, ams->LOWVOLT_CRITICAL, 0);
+    tlmLine(w, 9, -1, "AMS_OT_Warn", -1, ams->OVERTEMP_WARNING, 0);
+    tlmLine(w, 10, -1, "AMS_OT_Crit", -1, ams->OVERTEMP_CRITICAL, 0);
+    tlmLine(w, 11, -1, "AMS_DV_Warn", -1, ams->OVERDIV_WARNING, 0);
+    tlmLine(w, 12, -1, "AMS_DV_Crit", -1, ams->OVERDIV_CRITICAL, 0);
+  }
+
+  for (int m = 0; m < MODULE_NUM; m++) {
+    const BMUdata& b = bmuArray[m];
+    uint16_t slot = AMS_TLM_STATE_SLOTS + m * AMS_TLM_MODULE_SLOTS;
+    if (cfg.sections & AMS_TLM_MODULES) tlmLine(w, slot + 3, m, "Conn", -1, b.BMUconnected, 0);
+    if (!b.BMUconnected) continue;  // Only the connection trace for a silent module
+
+    if (cfg.sections & AMS_TLM_MODULES) {
+      tlmLine(w, slot, m, "Volt", -1, amsScaled<TLM_V_DECIMALS>(AmsModuleV(b.V_MODULE)), TLM_V_DECIMALS);
+      tlmLine(w, slot + 1, m, "DV", -1, amsScaled<TLM_V_DECIMALS>(AmsDeltaV(b.DV)), TLM_V_DECIMALS);
+      tlmLine(w, slot + 2, m, "NeedBal", -1, b.BMUneedBalance, 0);
+    }
+    slot += 4;
+    if (cfg.sections & AMS_TLM_CELLS) {
+      for (int c = 0; c < CELL_NUM; c++)
+        tlmLine(w, slot + c, m, "C", c, amsScaled<TLM_V_DECIMALS>(AmsCellV(b.V_CELL[c])),
+                TLM_V_DECIMALS);
+    }
+    slot += CELL_NUM;
+    if (cfg.sections & AMS_TLM_TEMPS) {
+      for (int s = 0; s < TEMP_SENSOR_NUM; s++)
+        tlmLine(w, slot + s, m, "T", s, amsScaled<TLM_TEMP_DECIMALS>(AmsSenseV(b.TEMP_SENSE[s])),
+                TLM_TEMP_DECIMALS);
+    }
+    slot += TEMP_SENSOR_NUM;
+    if (cfg.sections & AMS_TLM_FAULTS) {  // Same weighting as teleplotBMUFaults
+      tlmLine(w, slot, m, "FaultOV", -1,
+              __builtin_popcount(b.OVERVOLTAGE_WARNING) + 10 * __builtin_popcount(b.OVERVOLTAGE_CRITICAL), 0);
+      tlmLine(w, slot + 1, m, "FaultLV", -1,
+              __builtin_popcount(b.LOWVOLTAGE_WARNING) + 10 * __builtin_popcount(b.LOWVOLTAGE_CRITICAL), 0);
+      tlmLine(w, slot + 2, m, "FaultOT", -1,
+              __builtin_popcount(b.OVERTEMP_WARNING) + 10 * __builtin_popcount(b.OVERTEMP_CRITICAL), 0);
+      tlmLine(w, slot + 3, m, "FaultDV", -1,
+              __builtin_popcount(b.OVERDIV_VOLTAGE_WARNING) + 10 * __builtin_popcount(b.OVERDIV_VOLTAGE_CRITICAL),
+              0);
+    }
+  }
+
+  if (w.full) enc->truncated++;
+  if (cfg.mode == AMS_TLM_CHANGED) enc->sinceRefresh++;
+  return w.len;
+}
+
+/************************* Background Writer ***************************/
+#ifdef ARDUINO
+#include "ams_binlink.h"
+
+static_assert(AMS_TLM_BUF_BYTES >= AMS_BIN_FRAME_MAX, "AMS_TLM_BUF_BYTES too small for a binary key frame");
+
+static AmsTelemetryEncoder _tlmEncoder;
+static AmsBinEncoder _tlmBinEncoder;
+static char _tlmBuf[2][AMS_TLM_BUF_BYTES];
+static volatile size_t _tlmPending = 0;  // Bytes in _tlmBuf[_tlmSending], 0 = writer idle
+static volatile uint8_t _tlmSending = 0;  // Set before _tlmPending
+static uint32_t _tlmOffered = 0;
+static Print* _tlmOut = nullptr;
+static TaskHandle_t _tlmTask = nullptr;
+static volatile bool _tlmStopping = false;
+static volatile bool _tlmDone = true;
+static AmsTelemetryStats _tlmStats;
+static portMUX_TYPE _tlmMux = portMUX_INITIALIZER_UNLOCKED;
+
+static void amsTelemetryTask(void* arg) {
+  while (!_tlmStopping) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    size_t n = _tlmPending;
+    if (n == 0) continue;
+    _tlmOut->write((const uint8_t*)_tlmBuf[_tlmSending], n);  // Blocks here, not in the caller
+    portENTER_CRITICAL(&_tlmMux);
+    _tlmStats.bytesWritten += n;
+    _tlmPending = 0;
+    portEXIT_CRITICAL(&_tlmMux);
+  }
+  _tlmDone = true;
+  vTaskDelete(nullptr);
+}
+
+bool amsTelemetryBegin(Print& out, const AmsTelemetryConfig* cfg, int priority, int core) {
+  if (!_tlmDone) return true;
+  amsTelemetryInit(&_tlmEncoder, cfg);
+  amsBinEncoderInit(&_tlmBinEncoder, _tlmEncoder.cfg.keyEvery);
+  memset(&_tlmStats, 0, sizeof(_tlmStats));
+  _tlmOut = &out;
+  _tlmPending = 0;
+  _tlmOffered = 0;
+  _tlmStopping = false;
+  _tlmDone = false;
+  if (xTaskCreatePinnedToCore(amsTelemetryTask, "AMS_tlm", 2048, nullptr, priority, &_tlmTask,
+                              core < 0 ? tskNO_AFFINITY : core) != pdPASS) {
+    _tlmDone = true;
+    return false;
+  }
+  return true;
+}
+
+bool amsTelemetrySnapshot(const AMSdata* ams, const BMUdata* bmuArray, const OBCdata* obc) {
+  if (_tlmDone) return false;
+  if (_tlmOffered++ % _tlmEncoder.cfg.decimation != 0) {
+    _tlmStats.decimated++;
+    return false;
+  }
+  if (_tlmPending != 0) {  // Skip the encode too, change tracking stays in step
+    _tlmStats.dropped++;
+    return false;
+  }
+
+  uint8_t idle = _tlmSending ^ 1;
+  uint32_t t0 = micros();
+  size_t n = _tlmEncoder.cfg.format == AMS_TLM_BINARY
+                 ? amsBinEncode(&_tlmBinEncoder, ams, bmuArray, obc, (uint8_t*)_tlmBuf[idle], AMS_TLM_BUF_BYTES)
+                 : amsTelemetryEncode(&_tlmEncoder, ams, bmuArray, _tlmBuf[idle], AMS_TLM_BUF_BYTES);
+  uint32_t us = micros() - t0;
+
+  _tlmStats.lastUs = us;
+  if (us > _tlmStats.maxUs) _tlmStats.maxUs = us;
+  _tlmStats.truncated = _tlmEncoder.truncated;
+  if (n == 0) {
+    _tlmStats.unchanged++;
+    return false;
+  }
+  _tlmStats.snapshots++;
+  _tlmStats.lastBytes = n;
+  if (n > _tlmStats.maxBytes) _tlmStats.maxBytes = n;
+
+  _tlmSending = idle;
+  _tlmPending = n;
+  xTaskNotifyGive(_tlmTask);
+  return true;
+}
+
+void amsTelemetryEnd() {
+  if (_tlmDone) return;
+  while (_tlmPending != 0) delay(1);  // Let the last snapshot out
+  _tlmStopping = true;
+  xTaskNotifyGive(_tlmTask);
+  while (!_tlmDone) delay(1);
+  _tlmTask = nullptr;
+}
+
+AmsTelemetryStats amsTelemetryGetStats() {
+  portENTER_CRITICAL(&_tlmMux);
+  AmsTelemetryStats s = _tlmStats;
+  portEXIT_CRITICAL(&_tlmMux);
+  return s;
+}
+
+#endif
@@ -0,0 +1,97 @@
+// =======================================================================
+// Teleplot telemetry: whole pack snapshot into one buffer, background UART writer
+// =======================================================================
+#ifndef AMS_TELEMETRY_H
+#define AMS_TELEMETRY_H
+
+#include "ams_data_util.h"
+
+// Same trace names as the teleplot*() functions (>M1_C3:3.70), one value per
+// line, values formatted from the raw CAN fields with integer math only.
+// The teleplot*() functions stay for quick debugging; they printf per value
+// and block on the UART.
+//
+// Modes: AMS_TLM_ALL sends every trace, AMS_TLM_CHANGED only traces whose value
+// moved since it was last sent, with a full snapshot every refreshEvery so a
+// freshly opened Teleplot fills in. decimation N keeps every Nth snapshot.
+
+#ifndef AMS_TLM_BUF_BYTES
+#define AMS_TLM_BUF_BYTES 4096  // Per buffer, two of them; a full 7 module snapshot is ~2 KB
+#endif
+
+enum AmsTelemetrySection : uint8_t {
+  AMS_TLM_STATE = 1 << 0,    // AMSdata
+  AMS_TLM_MODULES = 1 << 1,  // V_MODULE, DV, NeedBal, Conn
+  AMS_TLM_CELLS = 1 << 2,
+  AMS_TLM_TEMPS = 1 << 3,
+  AMS_TLM_FAULTS = 1 << 4,   // Faulty cell counts, critical weighted x10
+  AMS_TLM_EVERYTHING = 0x1F,
+};
+
+enum AmsTelemetryMode : uint8_t {
+  AMS_TLM_ALL,
+  AMS_TLM_CHANGED,
+};
+
+// AMS_TLM_BINARY sends ams_binlink.h packets instead of Teleplot text
+// (delta coded by itself, mode and sections do not apply)
+enum AmsTelemetryFormat : uint8_t {
+  AMS_TLM_TEXT,
+  AMS_TLM_BINARY,
+};
+
+struct AmsTelemetryConfig {
+  AmsTelemetryFormat format = AMS_TLM_TEXT;
+  uint16_t keyEvery = 20;      // AMS_TLM_BINARY: full image every N packets
+  AmsTelemetryMode mode = AMS_TLM_ALL;
+  uint8_t sections = AMS_TLM_EVERYTHING;
+  uint16_t decimation = 1;     // Keep 1 in N snapshots
+  uint16_t refreshEvery = 50;  // AMS_TLM_CHANGED: full snapshot every N sent
+};
+
+#define AMS_TLM_STATE_SLOTS 13
+#define AMS_TLM_MODULE_SLOTS (4 + CELL_NUM + TEMP_SENSOR_NUM + 4)
+#define AMS_TLM_SLOTS (AMS_TLM_STATE_SLOTS + MODULE_NUM * AMS_TLM_MODULE_SLOTS)
+
+// Pure encoder state, usable without the writer (host tools, other transports)
+struct AmsTelemetryEncoder {
+  AmsTelemetryConfig cfg;
+  int32_t last[AMS_TLM_SLOTS];  // Last value sent per trace
+  uint8_t sent[(AMS_TLM_SLOTS + 7) / 8];
+  uint16_t sinceRefresh;
+  uint32_t truncated;           // Snapshots cut short by the buffer size
+};
+
+struct AmsTelemetryStats {
+  uint32_t snapshots;   // Encoded and handed to the writer
+  uint32_t decimated;   // Skipped by decimation
+  uint32_t dropped;     // Writer still busy with the previous snapshot
+  uint32_t unchanged;   // AMS_TLM_CHANGED and nothing moved
+  uint32_t truncated;
+  uint32_t lastBytes;
+  uint32_t maxBytes;
+  uint32_t lastUs;      // CPU time to encode one snapshot
+  uint32_t maxUs;
+  uint64_t bytesWritten;
+};
+
+void amsTelemetryInit(AmsTelemetryEncoder* enc, const AmsTelemetryConfig* cfg = nullptr);
+// Renders one snapshot into out, whole lines only. Returns the byte count,
+// 0 when nothing changed.
+size_t amsTelemetryEncode(AmsTelemetryEncoder* enc, const AMSdata* ams, const BMUdata* bmuArray, char* out,
+                          size_t cap);
+
+#ifdef ARDUINO
+#include <Arduino.h>
+
+// Background writer: amsTelemetrySnapshot encodes into the idle buffer and
+// hands it to a task that writes it to out. The caller never waits on the UART;
+// while the previous snapshot is still going out the new one is dropped.
+bool amsTelemetryBegin(Print& out = Serial, const AmsTelemetryConfig* cfg = nullptr, int priority = 1,
+                       int core = -1);
+bool amsTelemetrySnapshot(const AMSdata* ams, const BMUdata* bmuArray, const OBCdata* obc = nullptr);
+void amsTelemetryEnd();
+AmsTelemetryStats amsTelemetryGetStats();
+#endif
+
+#endif // AMS_TELEMETRY_H
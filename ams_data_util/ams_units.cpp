@@ -0,0 +1,48 @@
+/************************* Fixed-Point Units ***************************/
+
+#include "ams_units.h"
+#include <string.h>
+
+static const char AMS_DIGITS[201] =
+  "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+  "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+  "8081828384858687888990919293949596979899";
+
+size_t amsFormatU32(uint32_t v, char* out) {
+  char tmp[10];
+  char* p = tmp + sizeof(tmp);
+  while (v >= 100) {
+    uint32_t q = v / 100;
+    p -= 2;
+    memcpy(p, AMS_DIGITS + 2 * (v - q * 100), 2);
+    v = q;
+  }
+  if (v >= 10) {
+    p -= 2;
+    memcpy(p, AMS_DIGITS + 2 * v, 2);
+  } else {
+    *--p = (char)('0' + v);
+  }
+  size_t n = tmp + sizeof(tmp) - p;
+  memcpy(out, p, n);
+  return n;
+}
+
+size_t amsFormatFixed(int32_t scaled, uint8_t decimals, char* out) {
+  size_t n = 0;
+  uint32_t mag = (uint32_t)scaled;
+  if (scaled < 0) {
+    out[n++] = '-';
+    mag = 0u - mag;
+  }
+  if (decimals == 0) return n + amsFormatU32(mag, out + n);
+  uint32_t div = (uint32_t)amsPow10(decimals);
+  n += amsFormatU32(mag / div, out + n);
+  out[n++] = '.';
+  uint32_t frac = mag % div;
+  for (int i = decimals - 1; i >= 0; i--) {
+    out[n + i] = (char)('0' + frac % 10);
+    frac /= 10;
+  }
+  return n + decimals;
+}
@@ -0,0 +1,152 @@
+// =======================================================================
+// Fixed-point units: integer counts with the scale carried in the type
+// =======================================================================
+#ifndef AMS_UNITS_H
+#define AMS_UNITS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <limits>
+#include <type_traits>
+
+// AmsFixed<Unit, Rep, Num, Den, Bias> is a Rep count worth
+//   (count + Bias) * Num / Den  Unit
+// so the raw CAN encodings in BMUdata are used as they are, and amsConvert
+// folds any rescale into one integer multiply and one rounding divide chosen at
+// compile time. Quantities of different units do not convert or compare.
+// Nothing here touches float, so it is safe next to ISRs (no FPU context on
+// the ESP32) and gives the same bits on the host as on the target.
+//
+//   AmsCellV v(bmu.V_CELL[c]);                   // 185 -> 3.70 V
+//   amsConvert<AmsMillivolts>(v).count           // 3700
+//   amsFormat<2>(v, buf)                         // "3.70", returns 4
+//   v > AMS_VMAX_CELL                            // Threshold in the same scale
+
+struct AmsVolt {};
+
+template <typename Unit, typename Rep, int32_t Num, int32_t Den, int32_t Bias = 0>
+struct AmsFixed {
+  static_assert(Num > 0 && Den > 0, "AmsFixed scale must be positive");
+  typedef Unit unit;
+  typedef Rep rep;
+  static constexpr int32_t num = Num;
+  static constexpr int32_t den = Den;
+  static constexpr int32_t bias = Bias;
+
+  Rep count;
+
+  constexpr AmsFixed() : count(0) {}
+  constexpr explicit AmsFixed(Rep raw) : count(raw) {}
+
+  constexpr bool operator==(AmsFixed o) const { return count == o.count; }
+  constexpr bool operator!=(AmsFixed o) const { return count != o.count; }
+  constexpr bool operator<(AmsFixed o) const { return count < o.count; }
+  constexpr bool operator<=(AmsFixed o) const { return count <= o.count; }
+  constexpr bool operator>(AmsFixed o) const { return count > o.count; }
+  constexpr bool operator>=(AmsFixed o) const { return count >= o.count; }
+
+  // Sums and differences only mean something without an offset
+  constexpr AmsFixed operator+(AmsFixed o) const {
+    static_assert(Bias == 0, "Adding offset quantities");
+    return AmsFixed((Rep)(count + o.count));
+  }
+  constexpr AmsFixed operator-(AmsFixed o) const {
+    static_assert(Bias == 0, "Subtracting offset quantities");
+    return AmsFixed((Rep)(count - o.count));
+  }
+};
+
+// Raw CAN encodings (ams_can.dbc), checked against the DBC scaling in ams_data_util.cpp
+typedef AmsFixed<AmsVolt, uint8_t, 1, 50> AmsCellV;          // BMUdata::V_CELL, 0.02 V
+typedef AmsFixed<AmsVolt, uint16_t, 1, 50> AmsModuleV;       // BMUdata::V_MODULE, 0.02 V
+typedef AmsFixed<AmsVolt, uint32_t, 1, 50> AmsPackV;         // Sums of V_MODULE
+typedef AmsFixed<AmsVolt, uint8_t, 1, 10> AmsDeltaV;         // BMUdata::DV, 0.1 V
+typedef AmsFixed<AmsVolt, uint16_t, 1, 80, 160> AmsSenseV;   // TEMP_SENSE divider, 0.0125 V + 2 V
+typedef AmsFixed<AmsVolt, uint16_t, 1, 10> AmsAccumCanV;     // AMS frame ACCUM_VOLTAGE, 0.1 V
+typedef AmsFixed<AmsVolt, uint16_t, 1, 100> AmsAccumBinV;    // Binary link ACCUM_VOLTAGE, 0.01 V
+// Working scale
+typedef AmsFixed<AmsVolt, int32_t, 1, 1000> AmsMillivolts;
+
+constexpr int32_t amsPow10(int d) {
+  return d == 0 ? 1 : 10 * amsPow10(d - 1);
+}
+
+constexpr int64_t amsGcd(int64_t a, int64_t b) {
+  return b == 0 ? a : amsGcd(b, a % b);
+}
+
+// From counts to To counts = (count + From::bias) * mul / div - To::bias
+template <typename From, typename To>
+struct AmsRatio {
+  static_assert(std::is_same<typename From::unit, typename To::unit>::value, "Converting between different units");
+  static constexpr int64_t p = (int64_t)From::num * To::den;
+  static constexpr int64_t q = (int64_t)From::den * To::num;
+  static constexpr int32_t mul = (int32_t)(p / amsGcd(p, q));
+  static constexpr int32_t div = (int32_t)(q / amsGcd(p, q));
+  static_assert(mul <= 0xFFFF && div <= 0xFFFF, "Scales too far apart for 32 bit conversion");
+};
+
+// Round half away from zero, div > 0
+constexpr int32_t amsDivRound(int32_t x, int32_t div) {
+  return div == 1 ? x : (x < 0 ? (x - div / 2) / div : (x + div / 2) / div);
+}
+
+template <typename Rep>
+constexpr Rep amsSaturate(int64_t x) {
+  return x < (int64_t)std::numeric_limits<Rep>::min()   ? std::numeric_limits<Rep>::min()
+         : x > (int64_t)std::numeric_limits<Rep>::max() ? std::numeric_limits<Rep>::max()
+                                                         : (Rep)x;
+}
+
+// Rescale to To, rounded to the nearest count and clamped to To's range.
+// (count + bias) * mul has to fit in 32 bits, which every CAN field does.
+template <typename To, typename From>
+constexpr To amsConvert(From v) {
+  return To(amsSaturate<typename To::rep>(
+      (int64_t)amsDivRound(((int32_t)v.count + From::bias) * AmsRatio<From, To>::mul, AmsRatio<From, To>::div) -
+      To::bias));
+}
+
+// Physical value x 10^Decimals, the integer that formatting prints
+template <int Decimals, typename Q>
+constexpr int32_t amsScaled(Q v) {
+  return amsConvert<AmsFixed<typename Q::unit, int32_t, 1, amsPow10(Decimals)>>(v).count;
+}
+
+// Compile time only: a physical constant such as VMAX_CELL to the nearest count
+template <typename To>
+constexpr To amsQuantize(double physical) {
+  return To(amsSaturate<typename To::rep>(
+      (int64_t)(physical * To::den / To::num - To::bias + (physical * To::den / To::num - To::bias < 0 ? -0.5 : 0.5))));
+}
+
+// For float consumers (amsAccumVoltage), keep it out of per-frame paths
+template <typename Q>
+constexpr float amsToFloat(Q v) {
+  return (float)((int32_t)v.count + Q::bias) * Q::num / Q::den;
+}
+
+// Digits of v without terminator, returns the length (at most 10)
+size_t amsFormatU32(uint32_t v, char* out);
+// scaled / 10^decimals with exactly `decimals` decimals, e.g. 370, 2 -> "3.70"
+size_t amsFormatFixed(int32_t scaled, uint8_t decimals, char* out);
+
+template <int Decimals, typename Q>
+size_t amsFormat(Q v, char* out) {
+  return amsFormatFixed(amsScaled<Decimals>(v), Decimals, out);
+}
+
+// Terminated text for printf("%s"), lives until the end of the full expression:
+//   Serial.printf("V_MODULE: %sV\n", amsText<2>(AmsModuleV(bmu.V_MODULE)).s);
+struct AmsText {
+  char s[16];
+};
+
+template <int Decimals, typename Q>
+AmsText amsText(Q v) {
+  AmsText t;
+  t.s[amsFormat<Decimals>(v, t.s)] = '\0';
+  return t;
+}
+
+#endif // AMS_UNITS_H
@@ -0,0 +1,186 @@
+// ============================================================================
+// aggregate_check - host check, incremental aggregator vs full recomputation
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost aggregate_check.cpp ../ams_aggregate.cpp ../ams_pack.cpp ../ams_cells.cpp
+//           ../ams_data_util.cpp ../ams_units.cpp -o aggregate_check
+//         add -DMODULE_NUM=32 (or any count) to see how it scales past the car's 7
+// Usage : aggregate_check [events=200000] [seed=1]
+// Replays a random stream of module updates, disconnects and silent periods.
+// After every event the aggregator must equal the library's mockAMS on the same
+// bmuArray (plus the kernel's cell min / max), and mockAMS must leave bmuArray
+// untouched. Reported masks are random, so they often disagree with the cells.
+// Then times both.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_aggregate.h"
+#include "ams_cells.h"
+
+struct Reference {
+  AMSdata ams;
+  uint8_t cellMin, cellMax, connected;
+};
+
+// mockAMS itself, min / max from the same kernel pass it runs
+static bool referenceEval(const BMUdata* bmu, Reference* r) {
+  static BMUdata before[MODULE_NUM];
+  memcpy((void*)before, bmu, sizeof(before));
+  mockAMS(&r->ams, bmu);
+  AmsCellStore store;
+  AmsFaultResult result;
+  amsLoadCells(&store, bmu);
+  amsEvalFaults(&store, &result);
+  r->cellMin = result.packMin;
+  r->cellMax = result.packMax;
+  r->connected = 0;
+  for (int i = 0; i < MODULE_NUM; i++) r->connected += bmu[i].BMUconnected;
+  return memcmp(before, bmu, sizeof(before)) == 0;
+}
+
+static bool same(const AMSdata& a, const AMSdata& b) {
+  return a.ACCUM_VOLTAGE_MV == b.ACCUM_VOLTAGE_MV && a.OVERVOLT_WARNING == b.OVERVOLT_WARNING &&
+         a.OVERVOLT_CRITICAL == b.OVERVOLT_CRITICAL && a.LOWVOLT_WARNING == b.LOWVOLT_WARNING &&
+         a.LOWVOLT_CRITICAL == b.LOWVOLT_CRITICAL && a.OVERTEMP_WARNING == b.OVERTEMP_WARNING &&
+         a.OVERTEMP_CRITICAL == b.OVERTEMP_CRITICAL && a.OVERDIV_WARNING == b.OVERDIV_WARNING &&
+         a.OVERDIV_CRITICAL == b.OVERDIV_CRITICAL && a.AMS_OK == b.AMS_OK &&
+         a.ACCUM_CHG_READY == b.ACCUM_CHG_READY;
+}
+
+// Sparse masks, so flags actually set and clear during the run
+static uint16_t sparseMask(std::mt19937& rng, int bits) {
+  return (rng() % 8 == 0) ? (uint16_t)(1u << (rng() % bits)) : 0;
+}
+
+// Cells around a random level with the odd outlier, sensors mostly cool, so
+// both evaluated and reported flags set and clear during the run
+static void randomModule(std::mt19937& rng, BMUdata* b) {
+  uint8_t base = (uint8_t)(140 + rng() % 75);
+  uint16_t sum = 0;
+  for (int c = 0; c < CELL_NUM; c++) {
+    b->V_CELL[c] = (uint8_t)(base + (rng() % 16 == 0 ? rng() % 12 : rng() % 3));
+    sum += b->V_CELL[c];
+  }
+  for (int t = 0; t < TEMP_SENSOR_NUM; t++)
+    b->TEMP_SENSE[t] = (uint16_t)(rng() % 64 == 0 ? TEMP_WARN_RAW - 2 + rng() % (TEMP_MAX_RAW - TEMP_WARN_RAW + 4)
+                                                  : TEMP_WARN_RAW / 2);
+  b->V_MODULE = sum;
+  b->OVERVOLTAGE_WARNING = sparseMask(rng, CELL_NUM);
+  b->OVERVOLTAGE_CRITICAL = sparseMask(rng, CELL_NUM);
+  b->LOWVOLTAGE_WARNING = sparseMask(rng, CELL_NUM);
+  b->LOWVOLTAGE_CRITICAL = sparseMask(rng, CELL_NUM);
+  b->OVERTEMP_WARNING = sparseMask(rng, TEMP_SENSOR_NUM);
+  b->OVERTEMP_CRITICAL = sparseMask(rng, TEMP_SENSOR_NUM);
+  b->OVERDIV_VOLTAGE_WARNING = sparseMask(rng, CELL_NUM);
+  b->OVERDIV_VOLTAGE_CRITICAL = sparseMask(rng, CELL_NUM);
+  b->BMUconnected = true;
+}
+
+static bool check(const AmsAggregator& agg, const BMUdata* bmu, const char* what) {
+  AMSdata inc;
+  amsAggApply(&agg, &inc);
+  Reference ref;
+  bool untouched = referenceEval(bmu, &ref);
+  bool ok = untouched && same(inc, ref.ams) && agg.cellMin == ref.cellMin && agg.cellMax == ref.cellMax &&
+            agg.connected == ref.connected;
+  if (!ok && what) printf("%s: %s\n", what, untouched ? "aggregator differs from mockAMS" : "mockAMS wrote bmuArray");
+  return ok;
+}
+
+// Reported masks that disagree with the cells: each side alone must raise the flag
+static long disagreementCases() {
+  static BMUdata bmu[MODULE_NUM];
+  static AmsAggregator agg;
+  long failed = 0;
+  for (int scenario = 0; scenario < 3; scenario++) {
+    amsAggInit(&agg);
+    for (int m = 0; m < MODULE_NUM; m++) {
+      bmu[m] = BMUdata();
+      bmu[m].BMUconnected = true;
+      for (int c = 0; c < CELL_NUM; c++) bmu[m].V_CELL[c] = VNOM_CELL_RAW;
+      for (int t = 0; t < TEMP_SENSOR_NUM; t++) bmu[m].TEMP_SENSE[t] = TEMP_WARN_RAW / 2;
+    }
+    const char* what;
+    if (scenario == 0) {
+      bmu[2 % MODULE_NUM].OVERTEMP_CRITICAL = 1;  // BMU reports, sensors look fine
+      what = "reported OT crit, cool sensors";
+    } else if (scenario == 1) {
+      bmu[1 % MODULE_NUM].V_CELL[3 % CELL_NUM] = VMAX_CELL_RAW + 1;  // Cells show it, BMU reports nothing
+      what = "OV crit cell, nothing reported";
+    } else {
+      bmu[0].LOWVOLTAGE_WARNING = 1;  // Reported warning only, the pack stays OK
+      what = "reported LV warning";
+    }
+    for (int m = 0; m < MODULE_NUM; m++) amsAggUpdate(&agg, m, &bmu[m], 0);
+    AMSdata ams;
+    mockAMS(&ams, bmu);
+    bool flag = scenario == 0 ? ams.OVERTEMP_CRITICAL : scenario == 1 ? ams.OVERVOLT_CRITICAL : ams.LOWVOLT_WARNING;
+    bool okWant = scenario == 2;
+    if (!flag || ams.AMS_OK != okWant) {
+      printf("%s: mockAMS flag %d AMS_OK %d\n", what, flag, ams.AMS_OK);
+      failed++;
+    }
+    if (!check(agg, bmu, what)) failed++;
+  }
+  return failed;
+}
+
+int main(int argc, char** argv) {
+  long events = argc > 1 ? atol(argv[1]) : 200000;
+  std::mt19937 rng(argc > 2 ? atoi(argv[2]) : 1);
+
+  static BMUdata bmu[MODULE_NUM];
+  static AmsAggregator agg;
+  amsAggInit(&agg);
+  uint32_t now = 0;
+  long mismatches = disagreementCases(), expired = 0;
+
+  for (long e = 0; e < events; e++) {
+    int m = rng() % MODULE_NUM;
+    uint32_t r = rng() % 100;
+    now += rng() % 200;
+    if (r < 85) {
+      randomModule(rng, &bmu[m]);
+      amsAggUpdate(&agg, m, &bmu[m], now);
+    } else if (r < 92) {
+      bmu[m].BMUconnected = false;
+      amsAggUpdate(&agg, m, &bmu[m], now);
+    } else {
+      now += AMS_DISCONNECT_TIMEOUT_MS / 2 + rng() % AMS_DISCONNECT_TIMEOUT_MS;  // Bus goes quiet
+    }
+    expired += amsAggExpire(&agg, bmu, now);
+
+    if (!check(agg, bmu, nullptr) && mismatches++ < 5) printf("mismatch at event %ld (module %d)\n", e, m);
+  }
+  printf("%ld events, %ld expiries, %ld mismatches\n", events, expired, mismatches);
+
+  // Timing: one module update + publish, incremental vs mockAMS
+  for (int m = 0; m < MODULE_NUM; m++) {
+    randomModule(rng, &bmu[m]);
+    amsAggUpdate(&agg, m, &bmu[m], now);
+  }
+  const long loops = 1000000;
+  AMSdata out;
+  Reference ref;
+  auto t0 = std::chrono::steady_clock::now();
+  for (long i = 0; i < loops; i++) {
+    int m = i % MODULE_NUM;
+    bmu[m].V_CELL[i % CELL_NUM] ^= 1;
+    amsAggUpdate(&agg, m, &bmu[m], now);
+    amsAggApply(&agg, &out);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for (long i = 0; i < loops; i++) {
+    int m = i % MODULE_NUM;
+    bmu[m].V_CELL[i % CELL_NUM] ^= 1;
+    mockAMS(&ref.ams, bmu);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  double inc = std::chrono::duration<double, std::nano>(t1 - t0).count() / loops;
+  double full = std::chrono::duration<double, std::nano>(t2 - t1).count() / loops;
+  printf("MODULE_NUM %d: incremental %.1f ns/frame, full %.1f ns/frame (%d %d)\n", MODULE_NUM, inc, full,
+         out.AMS_OK, ref.ams.AMS_OK);
+  return mismatches != 0;
+}
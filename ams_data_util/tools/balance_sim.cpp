@@ -0,0 +1,130 @@
+// ============================================================================
+// balance_sim - deterministic host simulator for the balancing planner
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost balance_sim.cpp ../ams_balance.cpp ../ams_soc.cpp -o balance_sim
+// Usage : balance_sim [seed=1] [bleed_mA=500] [maxBleed=4]
+// Cells start with spread-out SOC, bleeding resistors heat their module and the
+// module cools toward ambient. Each planner runs until the pack converges (or
+// 200 h). Prints the simulated convergence time, thermal derating and the
+// planner's CPU cost per cycle. The baseline bleeds the first cells over the
+// start threshold in index order, with the same slot and thermal limits.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_balance.h"
+#include "ams_soc.h"
+
+#define STEP_S 10
+#define AMBIENT_RAW 200.0f
+#define HEAT_PER_BLEEDER 1.0f  // Raw temperature code per step per bleeding cell
+#define COOLING 0.1f           // Fraction of (T - ambient) lost per step
+
+typedef AmsBalanceResult (*Planner)(BMUdata*, const AmsBalanceConfig*);
+
+static AmsBalanceResult baselinePlan(BMUdata* bmu, const AmsBalanceConfig* cfg) {
+  AmsBalanceResult res = {0xFF, 0, 0, 0, false};
+  uint8_t mx = 0;
+  for (int m = 0; m < MODULE_NUM; m++)
+    for (int c = 0; c < CELL_NUM; c++) {
+      res.packMin = bmu[m].V_CELL[c] < res.packMin ? bmu[m].V_CELL[c] : res.packMin;
+      mx = bmu[m].V_CELL[c] > mx ? bmu[m].V_CELL[c] : mx;
+    }
+  res.spread = mx - res.packMin;
+  bool above = false;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    uint16_t hottest = 0;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) hottest = bmu[m].TEMP_SENSE[s] > hottest ? bmu[m].TEMP_SENSE[s] : hottest;
+    int slots = hottest >= cfg->tempStopRaw ? 0 : (hottest >= cfg->tempDerateRaw ? (cfg->maxBleed + 1) / 2 : cfg->maxBleed);
+    if (slots < cfg->maxBleed) res.thermalLimited++;
+    uint16_t mask = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      if (bmu[m].V_CELL[c] - res.packMin < cfg->startRaw) continue;
+      above = true;
+      if (slots > 0) {
+        mask |= 1 << c;
+        slots--;
+      }
+    }
+    bmu[m].BalancingDischarge_Cells = mask;
+    res.bleeding += __builtin_popcount(mask);
+  }
+  res.converged = res.spread < DVMAX_RAW && !above;
+  return res;
+}
+
+struct SimResult {
+  double hours;
+  bool converged;
+  uint8_t finalSpread;
+  long derateCycles;
+  double nsPerCycle;
+  float maxTemp;
+};
+
+static SimResult simulate(Planner plan, const AmsBalanceConfig& cfg, uint32_t seed, float bleedA) {
+  std::mt19937 rng(seed);
+  static BMUdata bmu[MODULE_NUM];
+  float soc[MODULE_NUM][CELL_NUM], temp[MODULE_NUM];
+  for (int m = 0; m < MODULE_NUM; m++) {
+    bmu[m] = BMUdata();
+    bmu[m].BMUconnected = true;
+    temp[m] = AMBIENT_RAW;
+    for (int c = 0; c < CELL_NUM; c++) soc[m][c] = 0.70f + 0.25f * (rng() % 1000) / 1000.0f;
+  }
+  const float dSoc = bleedA * STEP_S / (AH_CELL * 3600.0f);
+  SimResult r = {0, false, 0, 0, 0, AMBIENT_RAW};
+  double ns = 0;
+  long steps = 0;
+  const long maxSteps = 200L * 3600 / STEP_S;
+
+  for (; steps < maxSteps; steps++) {
+    for (int m = 0; m < MODULE_NUM; m++) {
+      for (int c = 0; c < CELL_NUM; c++) bmu[m].V_CELL[c] = (uint8_t)(amsOcv(soc[m][c], nullptr) / 0.02f + 0.5f);
+      for (int s = 0; s < TEMP_SENSOR_NUM; s++) bmu[m].TEMP_SENSE[s] = (uint16_t)temp[m];
+    }
+    auto t0 = std::chrono::steady_clock::now();
+    AmsBalanceResult res = plan(bmu, &cfg);
+    ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    r.derateCycles += res.thermalLimited;
+    r.finalSpread = res.spread;
+    if (res.converged) {
+      r.converged = true;
+      break;
+    }
+    for (int m = 0; m < MODULE_NUM; m++) {
+      uint16_t mask = bmu[m].BalancingDischarge_Cells;
+      for (int c = 0; c < CELL_NUM; c++)
+        if (mask >> c & 1) soc[m][c] -= dSoc;
+      temp[m] += HEAT_PER_BLEEDER * __builtin_popcount(mask) - COOLING * (temp[m] - AMBIENT_RAW);
+      r.maxTemp = temp[m] > r.maxTemp ? temp[m] : r.maxTemp;
+    }
+  }
+  r.hours = steps * STEP_S / 3600.0;
+  r.nsPerCycle = ns / (steps + 1);
+  return r;
+}
+
+static void report(const char* name, const SimResult& r) {
+  printf("%-9s %s after %6.1f h  spread %u raw  derated module-cycles %6ld  max temp %.0f raw  %7.1f ns/cycle\n",
+         name, r.converged ? "converged" : "NOT conv.", r.hours, r.finalSpread, r.derateCycles, r.maxTemp,
+         r.nsPerCycle);
+}
+
+int main(int argc, char** argv) {
+  uint32_t seed = argc > 1 ? atoi(argv[1]) : 1;
+  float bleedA = (argc > 2 ? atoi(argv[2]) : 500) * 0.001f;
+  AmsBalanceConfig cfg;
+  if (argc > 3) cfg.maxBleed = (uint8_t)atoi(argv[3]);
+
+  printf("%d modules x %d cells, bleed %.0f mA, %u bleeders/module, step %d s\n", MODULE_NUM, CELL_NUM,
+         bleedA * 1000, cfg.maxBleed, STEP_S);
+  report("planner", simulate(amsPlanBalancing, cfg, seed, bleedA));
+  report("baseline", simulate(baselinePlan, cfg, seed, bleedA));
+  cfg.noAdjacent = true;
+  report("no-adj", simulate(amsPlanBalancing, cfg, seed, bleedA));
+  return 0;
+}
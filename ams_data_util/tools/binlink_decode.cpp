@@ -0,0 +1,179 @@
+// ============================================================================
+// binlink_decode - host decoder for the binary telemetry link (ams_binlink.h)
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost binlink_decode.cpp ../ams_binlink.cpp ../ams_telemetry.cpp ../ams_units.cpp
+//           -o binlink_decode
+//         the MODULE_NUM of the build must match the sender (keys say so)
+// Usage : binlink_decode --teleplot [capture.bin | -]   Teleplot lines to stdout
+//         binlink_decode --csv [capture.bin | -]        one CSV row per snapshot
+//         binlink_decode --selftest [snapshots=5000] [baud=115200]
+// Input is the raw byte stream from the serial port (e.g. a capture, or
+// stty raw + cat /dev/ttyUSB0 piped in). --selftest encodes a drifting pack,
+// corrupts and drops some frames, checks that every decoded snapshot matches
+// what was sent, and compares bytes and update rate against Teleplot text.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_binlink.h"
+#include "ams_telemetry.h"
+
+static BMUdata bmu[MODULE_NUM];
+static AMSdata ams;
+static OBCdata obc;
+
+static void csvHeader() {
+  printf("snapshot,accum_v,ams_ok,chg_ready,faults,soc,obc_v,obc_a");
+  for (int m = 1; m <= MODULE_NUM; m++) {
+    printf(",M%d_conn,M%d_v", m, m);
+    for (int c = 1; c <= CELL_NUM; c++) printf(",M%d_C%d", m, c);
+    for (int s = 1; s <= TEMP_SENSOR_NUM; s++) printf(",M%d_T%d", m, s);
+  }
+  printf("\n");
+}
+
+static void csvRow(uint32_t index) {
+  uint8_t faults = ams.OVERVOLT_WARNING | ams.LOWVOLT_WARNING << 1 | ams.OVERTEMP_WARNING << 2 |
+                   ams.OVERDIV_WARNING << 3 | ams.OVERVOLT_CRITICAL << 4 | ams.LOWVOLT_CRITICAL << 5 |
+                   ams.OVERTEMP_CRITICAL << 6 | ams.OVERDIV_CRITICAL << 7;
+  printf("%u,%.2f,%d,%d,%u,%.2f,%u,%u", index, amsAccumVoltage(&ams), ams.AMS_OK, ams.ACCUM_CHG_READY, faults,
+         ams.ACCUM_SOC, obc.OBCVolt, obc.OBCAmp);
+  for (int m = 0; m < MODULE_NUM; m++) {
+    printf(",%d,%.2f", bmu[m].BMUconnected, bmu[m].V_MODULE * 0.02f);
+    for (int c = 0; c < CELL_NUM; c++) printf(",%.2f", bmu[m].V_CELL[c] * 0.02f);
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) printf(",%u", bmu[m].TEMP_SENSE[s]);
+  }
+  printf("\n");
+}
+
+static int decodeStream(FILE* in, bool csv) {
+  static AmsBinDecoder dec;
+  amsBinDecoderInit(&dec);
+  AmsTelemetryEncoder text;
+  amsTelemetryInit(&text);
+  static char line[AMS_TLM_BUF_BYTES];
+  uint32_t snapshots = 0;
+  if (csv) csvHeader();
+  int c;
+  while ((c = fgetc(in)) != EOF) {
+    if (!amsBinFeed(&dec, (uint8_t)c, &ams, bmu, &obc)) continue;
+    if (csv) {
+      csvRow(snapshots);
+    } else {
+      size_t n = amsTelemetryEncode(&text, &ams, bmu, line, sizeof(line));
+      fwrite(line, 1, n, stdout);
+    }
+    snapshots++;
+  }
+  const AmsBinDecoderStats& s = dec.stats;
+  fprintf(stderr, "%u snapshots, %u keys, %u bad frames, %u deltas skipped, %u config mismatches\n", snapshots,
+          s.keys, s.crcErrors, s.gaps, s.mismatched);
+  return 0;
+}
+
+static void drift(std::mt19937& rng) {
+  uint32_t total = 0;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    BMUdata& b = bmu[m];
+    uint16_t sum = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      if (rng() % 20 == 0) b.V_CELL[c] += (rng() & 1) ? 1 : -1;
+      sum += b.V_CELL[c];
+    }
+    b.V_MODULE = sum;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++)
+      if (rng() % 10 == 0) b.TEMP_SENSE[s] += (rng() & 1) ? 1 : -1;
+    total += sum;
+  }
+  amsSetAccumVoltage(&ams, AmsMillivolts((int32_t)total * 20));
+  if (rng() % 50 == 0) ams.OVERDIV_WARNING = !ams.OVERDIV_WARNING;
+}
+
+static int selfTest(long snapshots, long baud) {
+  std::mt19937 rng(11);
+  for (int m = 0; m < MODULE_NUM; m++) {
+    bmu[m].BMUconnected = true;
+    for (int c = 0; c < CELL_NUM; c++) bmu[m].V_CELL[c] = (uint8_t)(180 + rng() % 10);
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) bmu[m].TEMP_SENSE[s] = (uint16_t)(200 + rng() % 40);
+  }
+  obc = {4800, 100, 0, true};
+
+  static AmsBinEncoder enc;
+  static AmsBinDecoder dec;
+  amsBinEncoderInit(&enc);
+  amsBinDecoderInit(&dec);
+  AmsTelemetryEncoder textAll, textChanged;
+  AmsTelemetryConfig changed;
+  changed.mode = AMS_TLM_CHANGED;
+  amsTelemetryInit(&textAll);
+  amsTelemetryInit(&textChanged, &changed);
+
+  static uint8_t frame[AMS_BIN_FRAME_MAX], sent[AMS_BIN_IMAGE_BYTES], got[AMS_BIN_IMAGE_BYTES];
+  static char text[AMS_TLM_BUF_BYTES];
+  static BMUdata rxBmu[MODULE_NUM];
+  AMSdata rxAms;
+  OBCdata rxObc;
+  uint64_t binBytes = 0, allBytes = 0, changedBytes = 0;
+  long decoded = 0, wrong = 0, corrupted = 0, lost = 0;
+
+  for (long i = 0; i < snapshots; i++) {
+    drift(rng);
+    size_t n = amsBinEncode(&enc, &ams, bmu, &obc, frame, sizeof(frame));
+    binBytes += n;
+    allBytes += amsTelemetryEncode(&textAll, &ams, bmu, text, sizeof(text));
+    changedBytes += amsTelemetryEncode(&textChanged, &ams, bmu, text, sizeof(text));
+    amsBinPack(&ams, bmu, &obc, sent);
+
+    uint32_t fate = rng() % 200;
+    if (fate == 0) {  // Lost on the wire
+      lost++;
+      continue;
+    }
+    if (fate == 1) {  // One flipped byte
+      frame[rng() % (n - 1)] ^= (uint8_t)(1 + rng() % 255);
+      corrupted++;
+    }
+    for (size_t k = 0; k < n; k++) {
+      if (!amsBinFeed(&dec, frame[k], &rxAms, rxBmu, &rxObc)) continue;
+      decoded++;
+      amsBinPack(&rxAms, rxBmu, &rxObc, got);
+      if (memcmp(sent, got, sizeof(sent)) != 0) wrong++;
+    }
+  }
+
+  const AmsBinDecoderStats& s = dec.stats;
+  printf("%ld snapshots: %ld decoded, %ld wrong, %ld lost, %ld corrupted -> %u bad frames, %u deltas skipped\n",
+         snapshots, decoded, wrong, lost, corrupted, s.crcErrors, s.gaps);
+  const int cells = CELL_NUM * MODULE_NUM;
+  struct {
+    const char* name;
+    uint64_t bytes;
+  } rows[] = {{"teleplot all", allBytes}, {"teleplot changed", changedBytes}, {"binary", binBytes}};
+  for (auto& r : rows) {
+    double per = (double)r.bytes / snapshots;
+    double rate = baud / 10.0 / per;  // 8N1
+    printf("%-17s %7.1f bytes/snapshot  %7.1f snapshots/s  %8.0f cell values/s at %ld baud\n", r.name, per, rate,
+           rate * cells, baud);
+  }
+  return wrong != 0;
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: binlink_decode --teleplot|--csv [file|-]  |  --selftest [snapshots] [baud]\n");
+    return 1;
+  }
+  if (strcmp(argv[1], "--selftest") == 0)
+    return selfTest(argc > 2 ? atol(argv[2]) : 5000, argc > 3 ? atol(argv[3]) : 115200);
+
+  FILE* in = stdin;
+  if (argc > 2 && strcmp(argv[2], "-") != 0) in = fopen(argv[2], "rb");
+  if (!in) {
+    fprintf(stderr, "cannot open %s\n", argv[2]);
+    return 1;
+  }
+  int rc = decodeStream(in, strcmp(argv[1], "--csv") == 0);
+  if (in != stdin) fclose(in);
+  return rc;
+}
@@ -0,0 +1,198 @@
+// ============================================================================
+// codec_bench - host ns/frame benchmark of the CAN payload codec
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost codec_bench.cpp ../ams_data_util.cpp ../ams_cells.cpp ../ams_pack.cpp
+//           ../ams_units.cpp -o codec_bench
+// Usage : codec_bench [rounds=200000]
+// Times decodeBMUFrame / encodeBMUFrames and the OBC / AMS pair (the
+// generated ams_can_db.h codec, straight into BMUdata for the default pack) on
+// a pool of random payloads, next to the table driven amsDecodeSignals (the
+// path of other pack sizes) and the hand-written byte shuffling a firmware
+// would otherwise carry for the same BMU layout. Every decoded BMUdata is compared
+// with the hand-written result first, so the timings are of equal work.
+// A checksum of the outputs is printed to keep the loops from being elided.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_data_util.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const int POOL = 256;
+
+// What each firmware hand-wrote before the table: CELL_NUM 10, TEMP_SENSOR_NUM 2 layout
+static void handDecodeBMU(const twai_message_t* m, BMUdata* bmuArray) {
+  uint32_t offset = m->identifier - BMU_ADD;
+  uint32_t module = offset >> BMU_MODULE_SHIFT, frame = offset & ((1u << BMU_MODULE_SHIFT) - 1);
+  if (!m->extd || module >= MODULE_NUM || frame >= BMU_FRAME_NUM) return;
+  BMUdata* b = &bmuArray[module];
+  const uint8_t* d = m->data;
+  switch (frame) {
+    case 0:
+      for (int c = 0; c < 8; c++) b->V_CELL[c] = d[c];
+      break;
+    case 1:
+      b->V_CELL[8] = d[0];
+      b->V_CELL[9] = d[1];
+      b->V_MODULE = d[2] | (d[3] << 8);
+      b->DV = d[4];
+      b->BMUneedBalance = d[5] != 0;
+      b->TEMP_SENSE[0] = d[6] | (d[7] << 8);
+      break;
+    case 2:
+      b->TEMP_SENSE[1] = d[0] | (d[1] << 8);
+      b->BalancingDischarge_Cells = d[2] | (d[3] << 8);
+      b->OVERVOLTAGE_WARNING = d[4] | (d[5] << 8);
+      b->OVERVOLTAGE_CRITICAL = d[6] | (d[7] << 8);
+      break;
+    case 3:
+      b->LOWVOLTAGE_WARNING = d[0] | (d[1] << 8);
+      b->LOWVOLTAGE_CRITICAL = d[2] | (d[3] << 8);
+      b->OVERTEMP_WARNING = d[4] | (d[5] << 8);
+      b->OVERTEMP_CRITICAL = d[6] | (d[7] << 8);
+      break;
+    case 4:
+      b->OVERDIV_VOLTAGE_WARNING = d[0] | (d[1] << 8);
+      b->OVERDIV_VOLTAGE_CRITICAL = d[2] | (d[3] << 8);
+      break;
+  }
+  b->BMU_ID = BMU_ADD + (module << BMU_MODULE_SHIFT);
+  b->BMUconnected = true;
+}
+
+static double nsPer(Clock::time_point t0, Clock::time_point t1, uint64_t n) {
+  return std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+}
+
+int main(int argc, char** argv) {
+  long rounds = argc > 1 ? atol(argv[1]) : 200000;
+  std::mt19937 rng(6);
+
+  // Pool of random modules, encoded once with the library
+  static BMUdata src[POOL];
+  static twai_message_t frames[POOL][BMU_FRAME_NUM];
+  for (int p = 0; p < POOL; p++) {
+    BMUdata& b = src[p];
+    for (int c = 0; c < CELL_NUM; c++) b.V_CELL[c] = (uint8_t)rng();
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) b.TEMP_SENSE[s] = (uint16_t)rng();
+    b.V_MODULE = (uint16_t)rng();
+    b.DV = (uint8_t)rng();
+    b.OVERVOLTAGE_WARNING = rng() & 0x3FF;
+    b.OVERVOLTAGE_CRITICAL = rng() & 0x3FF;
+    b.LOWVOLTAGE_WARNING = rng() & 0x3FF;
+    b.LOWVOLTAGE_CRITICAL = rng() & 0x3FF;
+    b.OVERTEMP_WARNING = rng() & 0x3;
+    b.OVERTEMP_CRITICAL = rng() & 0x3;
+    b.OVERDIV_VOLTAGE_WARNING = rng() & 0x3FF;
+    b.OVERDIV_VOLTAGE_CRITICAL = rng() & 0x3FF;
+    b.BalancingDischarge_Cells = rng() & 0x3FF;
+    b.BMUneedBalance = rng() & 1;
+    encodeBMUFrames(&b, p % MODULE_NUM, frames[p]);
+  }
+
+  // Same result from the library and the hand-written decoder before timing anything
+  int mismatches = 0;
+  if (CELL_NUM == 10 && TEMP_SENSOR_NUM == 2) {
+    for (int p = 0; p < POOL; p++) {
+      BMUdata table[MODULE_NUM] = {}, hand[MODULE_NUM] = {};
+      for (int k = 0; k < BMU_FRAME_NUM; k++) {
+        decodeBMUFrame(&frames[p][k], table);
+        handDecodeBMU(&frames[p][k], hand);
+      }
+      if (memcmp(&table[p % MODULE_NUM], &hand[p % MODULE_NUM], sizeof(BMUdata)) != 0) mismatches++;
+    }
+  }
+
+  static BMUdata dst[MODULE_NUM];
+  const uint64_t bmuFrames = (uint64_t)rounds * BMU_FRAME_NUM;
+  uint32_t sum = 0;
+
+  Clock::time_point t0 = Clock::now();
+  for (long r = 0; r < rounds; r++) {
+    const twai_message_t* f = frames[r & (POOL - 1)];
+    for (int k = 0; k < BMU_FRAME_NUM; k++) sum += decodeBMUFrame(&f[k], dst);
+  }
+  Clock::time_point t1 = Clock::now();
+  sum += dst[0].V_CELL[3];
+
+  for (long r = 0; r < rounds; r++) {
+    const twai_message_t* f = frames[r & (POOL - 1)];
+    for (int k = 0; k < BMU_FRAME_NUM; k++) handDecodeBMU(&f[k], dst);
+  }
+  Clock::time_point t2 = Clock::now();
+  sum += dst[0].V_CELL[3];
+
+  for (long r = 0; r < rounds; r++) {
+    const twai_message_t* f = frames[r & (POOL - 1)];
+    for (int k = 0; k < BMU_FRAME_NUM; k++) {
+      const uint8_t first = BMU_LAYOUT.first[k];
+      amsDecodeSignals(&BMU_LAYOUT.signals[first], BMU_LAYOUT.first[k + 1] - first, f[k].data,
+                       f[k].data_length_code, &dst[0]);
+    }
+  }
+  Clock::time_point t2b = Clock::now();
+  sum += dst[0].V_CELL[3];
+
+  twai_message_t out[BMU_FRAME_NUM];
+  for (long r = 0; r < rounds; r++) {
+    encodeBMUFrames(&src[r & (POOL - 1)], (int)(r % MODULE_NUM), out);
+    sum += out[1].data[2];
+  }
+  Clock::time_point t3 = Clock::now();
+
+  OBCdata obc;
+  AMSdata ams;
+  twai_message_t obcFrames[POOL], amsFrames[POOL];
+  for (int p = 0; p < POOL; p++) {
+    obc.OBCVolt = (uint16_t)rng();
+    obc.OBCAmp = (uint16_t)rng();
+    obc.OBCstatusbit = (uint8_t)rng();
+    encodeOBCFrame(&obc, &obcFrames[p]);
+    obcFrames[p].identifier = OBC_STATUS_ADD;  // Read back as the charger's reply
+    amsSetAccumVoltage(&ams, AmsMillivolts((int32_t)(rng() % 600000)));
+    ams.OVERVOLT_WARNING = rng() & 1;
+    ams.OVERTEMP_CRITICAL = rng() & 1;
+    ams.AMS_OK = rng() & 1;
+    encodeAMSFrame(&ams, &amsFrames[p]);
+  }
+
+  Clock::time_point t4 = Clock::now();
+  for (long r = 0; r < rounds; r++) {
+    decodeOBCFrame(&obcFrames[r & (POOL - 1)], &obc);
+    sum += obc.OBCVolt;
+  }
+  Clock::time_point t5 = Clock::now();
+  for (long r = 0; r < rounds; r++) {
+    encodeOBCFrame(&obc, &out[0]);
+    obc.OBCAmp += out[0].data[1];
+  }
+  Clock::time_point t6 = Clock::now();
+  for (long r = 0; r < rounds; r++) {
+    decodeAMSFrame(&amsFrames[r & (POOL - 1)], &ams);
+    sum += ams.AMS_OK;
+  }
+  Clock::time_point t7 = Clock::now();
+  for (long r = 0; r < rounds; r++) {
+    encodeAMSFrame(&ams, &out[0]);
+    ams.ACCUM_VOLTAGE_MV += out[0].data[0];
+  }
+  Clock::time_point t8 = Clock::now();
+  sum += obc.OBCAmp + (uint32_t)ams.ACCUM_VOLTAGE_MV;
+
+  printf("%ld rounds, %d BMU frames per module, pool of %d payloads\n", rounds, BMU_FRAME_NUM, POOL);
+  printf("library vs hand-written BMU decode mismatches: %d\n\n", mismatches);
+  printf("%-28s %10s\n", "", "ns/frame");
+  printf("%-28s %10.1f\n", "decodeBMUFrame", nsPer(t0, t1, bmuFrames));
+  printf("%-28s %10.1f\n", "BMU decode (hand-written)", nsPer(t1, t2, bmuFrames));
+  printf("%-28s %10.1f\n", "BMU decode (table, others)", nsPer(t2, t2b, bmuFrames));
+  printf("%-28s %10.1f\n", "encodeBMUFrames", nsPer(t2b, t3, bmuFrames));
+  printf("%-28s %10.1f\n", "decodeOBCFrame", nsPer(t4, t5, rounds));
+  printf("%-28s %10.1f\n", "encodeOBCFrame", nsPer(t5, t6, rounds));
+  printf("%-28s %10.1f\n", "decodeAMSFrame", nsPer(t6, t7, rounds));
+  printf("%-28s %10.1f\n", "encodeAMSFrame", nsPer(t7, t8, rounds));
+  printf("\nchecksum %u\n", sum);
+  return mismatches ? 1 : 0;
+}
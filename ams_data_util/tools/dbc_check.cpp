@@ -0,0 +1,214 @@
+// ============================================================================
+// dbc_check - generated DBC codec vs the signal tables, every message
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost dbc_check.cpp ../ams_data_util.cpp ../ams_cells.cpp ../ams_pack.cpp
+//           ../ams_units.cpp -o dbc_check
+// Usage : dbc_check [payloads=100000]
+// decode/encode*Frame run the generated code of ams_can_db.h (BMU frames of the
+// default pack only through it). For BMU_F0..F4, AMS_STATE, OBC_STATUS and
+// OBC_CMD this checks on random payloads and structs that:
+//   - decoding gives the same struct as amsDecodeSignals with the tables
+//     (short OBC / AMS frames take the table path; short BMU frames of the
+//     default pack are dropped, other packs decode them with the tables)
+//   - encoding gives the same bytes as amsEncodeSignals
+//   - decode(encode(x)) == x
+// and for every raw code of every scaled signal that DBC_<SIGNAL>_milli()
+// equals amsConvert<AmsMillivolts> of the matching ams_units.h type.
+// Exits non-zero on any mismatch.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_can_db.h"
+#include "ams_data_util.h"
+
+#define DEFAULT_PACK (CELL_NUM == 10 && TEMP_SENSOR_NUM == 2)
+
+static std::mt19937 rng(7);
+static long _fail = 0;
+
+static void fail(const char* what, long n) {
+  if (_fail < 10) printf("  MISMATCH %s (case %ld)\n", what, n);
+  _fail++;
+}
+
+static void randomPayload(twai_message_t* m, uint32_t id, uint8_t dlc) {
+  memset(m, 0, sizeof(*m));
+  m->extd = 1;
+  m->identifier = id;
+  m->data_length_code = dlc;
+  for (int i = 0; i < 8; i++) m->data[i] = (uint8_t)rng();
+}
+
+static void randomBMU(BMUdata* b) {
+  memset((void*)b, 0, sizeof(*b));  // Padding too, results are compared with memcmp
+  for (int c = 0; c < CELL_NUM; c++) b->V_CELL[c] = (uint8_t)rng();
+  for (int s = 0; s < TEMP_SENSOR_NUM; s++) b->TEMP_SENSE[s] = (uint16_t)rng();
+  b->V_MODULE = (uint16_t)rng();
+  b->DV = (uint8_t)rng();
+  uint16_t* masks[] = {&b->BalancingDischarge_Cells, &b->OVERVOLTAGE_WARNING, &b->OVERVOLTAGE_CRITICAL,
+                       &b->LOWVOLTAGE_WARNING, &b->LOWVOLTAGE_CRITICAL, &b->OVERTEMP_WARNING,
+                       &b->OVERTEMP_CRITICAL, &b->OVERDIV_VOLTAGE_WARNING, &b->OVERDIV_VOLTAGE_CRITICAL};
+  for (uint16_t* m : masks) *m = (uint16_t)rng();
+  b->BMUneedBalance = rng() & 1;
+}
+
+static bool sameAMS(const AMSdata& a, const AMSdata& b) {
+  return a.ACCUM_VOLTAGE_MV == b.ACCUM_VOLTAGE_MV && a.OVERVOLT_WARNING == b.OVERVOLT_WARNING &&
+         a.LOWVOLT_WARNING == b.LOWVOLT_WARNING && a.OVERTEMP_WARNING == b.OVERTEMP_WARNING &&
+         a.OVERDIV_WARNING == b.OVERDIV_WARNING && a.OVERVOLT_CRITICAL == b.OVERVOLT_CRITICAL &&
+         a.LOWVOLT_CRITICAL == b.LOWVOLT_CRITICAL && a.OVERTEMP_CRITICAL == b.OVERTEMP_CRITICAL &&
+         a.OVERDIV_CRITICAL == b.OVERDIV_CRITICAL && a.AMS_OK == b.AMS_OK && a.ACCUM_CHG_READY == b.ACCUM_CHG_READY;
+}
+
+static bool sameOBC(const OBCdata& a, const OBCdata& b) {
+  return a.OBCVolt == b.OBCVolt && a.OBCAmp == b.OBCAmp && a.OBCstatusbit == b.OBCstatusbit;
+}
+
+static void checkBMU(long payloads) {
+  for (long n = 0; n < payloads; n++) {
+    uint8_t frame = (uint8_t)(n % BMU_FRAME_NUM);
+    int module = (int)(rng() % MODULE_NUM);
+    // Every 8th payload is short
+    bool shortFrame = (n & 7) == 0;
+    uint8_t dlc = shortFrame ? (uint8_t)(rng() % BMU_LAYOUT.dlc[frame]) : BMU_LAYOUT.dlc[frame];
+    twai_message_t m;
+    randomPayload(&m, BMU_ADD + frame + ((uint32_t)module << BMU_MODULE_SHIFT), dlc);
+
+    static BMUdata lib[MODULE_NUM];
+    BMUdata table;
+    memset((void*)lib, 0, sizeof(lib));
+    memset((void*)&table, 0, sizeof(table));
+    if (shortFrame && DEFAULT_PACK) {
+      if (decodeBMUFrame(&m, lib) != -1 || memcmp(&lib[module], &table, sizeof(BMUdata)) != 0)
+        fail("short BMU frame not dropped", n);
+    } else {
+      if (decodeBMUFrame(&m, lib) != module) fail("decodeBMUFrame module", n);
+      const uint8_t first = BMU_LAYOUT.first[frame];
+      amsDecodeSignals(&BMU_LAYOUT.signals[first], BMU_LAYOUT.first[frame + 1] - first, m.data, dlc, &table);
+      table.BMU_ID = BMU_ADD + ((uint32_t)module << BMU_MODULE_SHIFT);
+      table.BMUconnected = true;
+      if (memcmp(&lib[module], &table, sizeof(BMUdata)) != 0) fail("BMU decode vs table", n);
+    }
+
+    BMUdata src, back[MODULE_NUM];
+    randomBMU(&src);
+    twai_message_t frames[BMU_FRAME_NUM];
+    encodeBMUFrames(&src, module, frames);
+    for (uint8_t k = 0; k < BMU_FRAME_NUM; k++) {
+      uint8_t data[8] = {0};
+      amsEncodeSignals(&BMU_LAYOUT.signals[BMU_LAYOUT.first[k]], BMU_LAYOUT.first[k + 1] - BMU_LAYOUT.first[k], &src,
+                       data);
+      if (frames[k].data_length_code != BMU_LAYOUT.dlc[k] || memcmp(frames[k].data, data, 8) != 0)
+        fail("BMU encode vs table", n);
+    }
+    memset((void*)back, 0, sizeof(back));
+    for (uint8_t k = 0; k < BMU_FRAME_NUM; k++) decodeBMUFrame(&frames[k], back);
+    src.BMU_ID = BMU_ADD + ((uint32_t)module << BMU_MODULE_SHIFT);
+    src.BMUconnected = true;
+    if (memcmp(&back[module], &src, sizeof(BMUdata)) != 0) fail("BMU round trip", n);
+  }
+}
+
+static void checkAMS(long payloads) {
+  for (long n = 0; n < payloads; n++) {
+    uint8_t dlc = (n & 7) ? DBC_AMS_STATE_DLC : (uint8_t)(rng() % DBC_AMS_STATE_DLC);
+    twai_message_t m;
+    randomPayload(&m, BCU_ADD, dlc);
+    AMSdata lib, table;
+    decodeAMSFrame(&m, &lib);
+    amsDecodeSignals(AMS_SIGNALS, AMS_SIGNAL_NUM, m.data, dlc, &table);
+    if (!sameAMS(lib, table)) fail("AMS decode vs table", n);
+
+    AMSdata src;
+    amsSetAccumVoltage(&src, AmsMillivolts((int32_t)(rng() % 7000000)));
+    bool* flags[] = {&src.OVERVOLT_WARNING, &src.LOWVOLT_WARNING, &src.OVERTEMP_WARNING, &src.OVERDIV_WARNING,
+                     &src.OVERVOLT_CRITICAL, &src.LOWVOLT_CRITICAL, &src.OVERTEMP_CRITICAL, &src.OVERDIV_CRITICAL,
+                     &src.AMS_OK, &src.ACCUM_CHG_READY};
+    for (bool* f : flags) *f = rng() & 1;
+    twai_message_t out;
+    encodeAMSFrame(&src, &out);
+    uint8_t data[8] = {0};
+    amsEncodeSignals(AMS_SIGNALS, AMS_SIGNAL_NUM, &src, data);
+    if (out.data_length_code != DBC_AMS_STATE_DLC || memcmp(out.data, data, 8) != 0) fail("AMS encode vs table", n);
+    AMSdata back;
+    decodeAMSFrame(&out, &back);
+    // The bus carries 0.1 V
+    src.ACCUM_VOLTAGE_MV = amsConvert<AmsMillivolts>(amsConvert<AmsAccumCanV>(AmsMillivolts(src.ACCUM_VOLTAGE_MV))).count;
+    if (!sameAMS(back, src)) fail("AMS round trip", n);
+  }
+}
+
+static void checkOBC(long payloads) {
+  for (long n = 0; n < payloads; n++) {
+    uint8_t dlc = (n & 7) ? DBC_OBC_STATUS_DLC : (uint8_t)(rng() % DBC_OBC_STATUS_DLC);
+    twai_message_t m;
+    randomPayload(&m, OBC_STATUS_ADD, dlc);
+    OBCdata lib, table;
+    decodeOBCFrame(&m, &lib);
+    amsDecodeSignals(OBC_SIGNALS, OBC_SIGNAL_NUM, m.data, dlc, &table);
+    if (!sameOBC(lib, table) || lib.OBC_OK != (lib.OBCstatusbit == 0)) fail("OBC_STATUS decode vs table", n);
+
+    OBCdata src;
+    src.OBCVolt = (uint16_t)rng();
+    src.OBCAmp = (uint16_t)rng();
+    src.OBCstatusbit = (uint8_t)rng();
+    src.OBC_OK = rng() & 1;
+    twai_message_t out;
+    encodeOBCFrame(&src, &out);
+    uint8_t data[8] = {0};
+    amsEncodeSignals(OBC_SIGNALS, 2, &src, data);  // Volt and amp, byte 4 is the control byte
+    data[4] = src.OBC_OK ? 0 : 1;
+    if (out.identifier != OBC_ADD || out.data_length_code != DBC_OBC_CMD_DLC || memcmp(out.data, data, 8) != 0)
+      fail("OBC_CMD encode vs table", n);
+    // OBC_STATUS shares the layout, the status byte is where OBC_CMD has CMD_STOP
+    out.identifier = OBC_STATUS_ADD;
+    OBCdata back;
+    decodeOBCFrame(&out, &back);
+    if (back.OBCVolt != src.OBCVolt || back.OBCAmp != src.OBCAmp || back.OBCstatusbit != (src.OBC_OK ? 0 : 1))
+      fail("OBC round trip", n);
+  }
+}
+
+template <typename Q>
+static void checkMilli(const char* name, int32_t (*milli)(int32_t)) {
+  const long codes = 1L << (8 * sizeof(typename Q::rep));
+  long bad = 0;
+  for (long raw = 0; raw < codes; raw++) {
+    int32_t want = amsConvert<AmsMillivolts>(Q((typename Q::rep)raw)).count;
+    if (milli((int32_t)raw) != want) {
+      if (bad++ == 0) printf("  MISMATCH %s raw %ld: %d vs %d\n", name, raw, milli((int32_t)raw), want);
+    }
+  }
+  printf("  %-24s %6ld codes, %ld mismatches\n", name, codes, bad);
+  _fail += bad;
+}
+
+int main(int argc, char** argv) {
+  long payloads = argc > 1 ? atol(argv[1]) : 100000;
+
+  printf("%ld payloads per message group, default pack %s\n", payloads,
+         DEFAULT_PACK ? "(generated BMU path)" : "(table BMU path)");
+  checkBMU(payloads);
+  checkAMS(payloads);
+  checkOBC(payloads);
+  printf("  frames: %ld mismatches\n", _fail);
+
+  checkMilli<AmsCellV>("DBC_V_CELL_milli", DBC_V_CELL_milli);
+  checkMilli<AmsModuleV>("DBC_V_MODULE_milli", DBC_V_MODULE_milli);
+  checkMilli<AmsDeltaV>("DBC_DV_milli", DBC_DV_milli);
+  checkMilli<AmsSenseV>("DBC_TEMP_SENSE_milli", DBC_TEMP_SENSE_milli);
+  checkMilli<AmsAccumCanV>("DBC_ACCUM_VOLTAGE_milli", DBC_ACCUM_VOLTAGE_milli);
+  long obcBad = 0;
+  for (long raw = 0; raw < 65536; raw++) {
+    if (DBC_OBC_VOLT_milli((int32_t)raw) != raw * 100 || DBC_OBC_AMP_milli((int32_t)raw) != raw * 100 ||
+        DBC_CMD_VOLT_milli((int32_t)raw) != raw * 100 || DBC_CMD_AMP_milli((int32_t)raw) != raw * 100)
+      obcBad++;
+  }
+  printf("  %-24s %6d codes, %ld mismatches\n", "DBC_OBC/CMD_*_milli", 65536, obcBad);
+  _fail += obcBad;
+
+  printf("%s\n", _fail ? "FAILED" : "OK");
+  return _fail ? 1 : 0;
+}
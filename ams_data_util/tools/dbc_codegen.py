@@ -0,0 +1,279 @@
+#!/usr/bin/env python3
+"""
+DBC -> C++ header generator for ams_data_util.
+
+Emits, for every BO_ message of the DBC:
+  - DBC_<MSG>_ID / _EXTD / _DLC constants
+  - a packed struct of raw signal values
+  - inline pack/unpack functions (one 64-bit load/store, shifts and masks)
+  - dbc_<MSG>_unpack_to / _pack_from templates that read and write the
+    members of any struct named after the signals (NAME_<n> -> NAME[n])
+    directly, no raw struct in between
+  - per signal FACTOR/OFFSET constants and an integer-only <SIG>_milli()
+    that returns the physical value x1000 without float math
+
+Standalone : python3 dbc_codegen.py ams_can.dbc ams_can_db.h
+PlatformIO : run through library.json "build.extraScript" on every build of a
+             project using the library, regenerates ams_can_db.h when
+             ams_can.dbc is newer
+"""
+import os
+import re
+import sys
+from fractions import Fraction
+
+BO_RE = re.compile(r'^BO_\s+(\d+)\s+(\w+)\s*:\s*(\d+)\s+(\w+)')
+SG_RE = re.compile(r'^\s*SG_\s+(\w+)\s*:\s*(\d+)\|(\d+)@([01])([+-])\s*'
+                   r'\(([^,]+),([^)]+)\)\s*\[([^|]*)\|([^\]]*)\]\s*"([^"]*)"')
+
+
+def parse_dbc(path):
+    messages = []
+    with open(path) as f:
+        for line in f:
+            m = BO_RE.match(line)
+            if m:
+                raw_id = int(m.group(1))
+                messages.append({
+                    'name': m.group(2),
+                    'id': raw_id & 0x1FFFFFFF,
+                    'extd': bool(raw_id & 0x80000000),
+                    'dlc': int(m.group(3)),
+                    'signals': [],
+                })
+                continue
+            s = SG_RE.match(line)
+            if s and messages:
+                messages[-1]['signals'].append({
+                    'name': s.group(1),
+                    'start': int(s.group(2)),
+                    'length': int(s.group(3)),
+                    'big_endian': s.group(4) == '0',
+                    'signed': s.group(5) == '-',
+                    'factor': Fraction(s.group(6).strip()),
+                    'offset': Fraction(s.group(7).strip()),
+                    'unit': s.group(10),
+                })
+    return messages
+
+
+def shift_of(sig):
+    """Bit position of the signal LSB in the 64-bit word the frame is loaded into.
+    Intel: little-endian word, Motorola: big-endian word (byte 0 = MSB)."""
+    if not sig['big_endian']:
+        return sig['start']
+    msb = (7 - sig['start'] // 8) * 8 + sig['start'] % 8
+    return msb - sig['length'] + 1
+
+
+def c_type(sig):
+    n = sig['length']
+    bits = 8 if n <= 8 else 16 if n <= 16 else 32 if n <= 32 else 64
+    return ('int%d_t' if sig['signed'] else 'uint%d_t') % bits
+
+
+def c_float(v):
+    return repr(float(v)) + 'f'
+
+
+def milli_expr(sig):
+    """raw -> physical x1000 using integer math only, rounded half up
+    (same as amsConvert for the unsigned raw values on the bus)."""
+    scale = sig['factor'] * 1000
+    off = sig['offset'] * 1000
+    expr = 'raw'
+    if scale.denominator == 1:
+        if scale != 1:
+            expr = 'raw * %d' % scale.numerator
+    else:
+        den = scale.denominator
+        if den & (den - 1) == 0:
+            expr = '((raw * %d + %d) >> %d)' % (scale.numerator, den // 2, den.bit_length() - 1)
+        else:
+            expr = '((raw * %d + %d) / %d)' % (scale.numerator, den // 2, den)
+    if off != 0:
+        expr = '%s + %d' % (expr, round(off))
+    return expr
+
+
+def group_constants(messages):
+    """NAME_<n> signals sharing factor/offset also get a NAME constant."""
+    groups = {}
+    for msg in messages:
+        for sig in msg['signals']:
+            m = re.match(r'^(\w+?)_(\d+)$', sig['name'])
+            if m:
+                groups.setdefault(m.group(1), set()).add((sig['factor'], sig['offset'], sig['name']))
+    out = {}
+    for name, members in groups.items():
+        scales = {(f, o) for f, o, _ in members}
+        first = sorted(members, key=lambda x: x[2])[0][2]
+        if len(members) > 1 and len(scales) == 1:
+            out[name] = first
+    return out
+
+
+def member(sig):
+    """t-> member a signal maps to: NAME_<n> is element n of array NAME."""
+    m = re.match(r'^(\w+?)_(\d+)$', sig['name'])
+    return 't->%s[%s]' % (m.group(1), m.group(2)) if m else 't->' + sig['name']
+
+
+def emit_unpack(w, head, sigs, lvalue):
+    w(head)
+    if any(not s['big_endian'] for s in sigs):
+        w('  const uint64_t le = dbcLoadLE(data);')
+    if any(s['big_endian'] for s in sigs):
+        w('  const uint64_t be = dbcLoadBE(data);')
+    for s in sigs:
+        word = 'be' if s['big_endian'] else 'le'
+        mask = (1 << s['length']) - 1
+        raw = '(%s >> %d) & 0x%XULL' % (word, shift_of(s), mask)
+        if s['signed'] and s['length'] < 64:
+            raw = '((int64_t)(((%s) ^ 0x%XULL) - 0x%XULL))' % (raw, 1 << (s['length'] - 1), 1 << (s['length'] - 1))
+        w('  %s = (%s)(%s);' % (lvalue(s), c_type(s), raw))
+    w('}')
+    w('')
+
+
+def emit_pack(w, head, sigs, rvalue):
+    has_le = any(not s['big_endian'] for s in sigs)
+    has_be = any(s['big_endian'] for s in sigs)
+    w(head)
+    if has_le:
+        w('  uint64_t le = 0;')
+    if has_be:
+        w('  uint64_t be = 0;')
+    for s in sigs:
+        word = 'be' if s['big_endian'] else 'le'
+        mask = (1 << s['length']) - 1
+        w('  %s |= ((uint64_t)%s & 0x%XULL) << %d;' % (word, rvalue(s), mask, shift_of(s)))
+    if has_le and has_be:
+        # Mixed byte order: signals never overlap, merge the two words byte-wise
+        w('  uint8_t tmp[8];')
+        w('  dbcStoreLE(data, le);')
+        w('  dbcStoreBE(tmp, be);')
+        w('  for (int i = 0; i < 8; i++) data[i] |= tmp[i];')
+    elif has_be:
+        w('  dbcStoreBE(data, be);')
+    else:
+        w('  dbcStoreLE(data, le);')
+    w('}')
+    w('')
+
+
+def generate(messages, source):
+    o = []
+    w = o.append
+    w('// Generated by tools/dbc_codegen.py from %s, do not edit' % os.path.basename(source))
+    w('#ifndef AMS_CAN_DB_H')
+    w('#define AMS_CAN_DB_H')
+    w('')
+    w('#include <cstdint>')
+    w('#include <cstring>')
+    w('')
+    w('struct DbcSignalPos {')
+    w('  uint8_t startBit;  // As written in the DBC')
+    w('  uint8_t length;')
+    w('  bool bigEndian;')
+    w('};')
+    w('')
+    w('// memcpy: one load / store where the target allows unaligned access')
+    w('#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__')
+    w('#define DBC_LE64(v) __builtin_bswap64(v)')
+    w('#define DBC_BE64(v) (v)')
+    w('#else')
+    w('#define DBC_LE64(v) (v)')
+    w('#define DBC_BE64(v) __builtin_bswap64(v)')
+    w('#endif')
+    w('static inline uint64_t dbcLoadLE(const uint8_t* d) {')
+    w('  uint64_t v;')
+    w('  memcpy(&v, d, 8);')
+    w('  return DBC_LE64(v);')
+    w('}')
+    w('static inline uint64_t dbcLoadBE(const uint8_t* d) {')
+    w('  uint64_t v;')
+    w('  memcpy(&v, d, 8);')
+    w('  return DBC_BE64(v);')
+    w('}')
+    w('static inline void dbcStoreLE(uint8_t* d, uint64_t v) {')
+    w('  v = DBC_LE64(v);')
+    w('  memcpy(d, &v, 8);')
+    w('}')
+    w('static inline void dbcStoreBE(uint8_t* d, uint64_t v) {')
+    w('  v = DBC_BE64(v);')
+    w('  memcpy(d, &v, 8);')
+    w('}')
+    w('')
+
+    for msg in messages:
+        n = msg['name']
+        sigs = msg['signals']
+        w('// ---- %s ----' % n)
+        w('constexpr uint32_t DBC_%s_ID = 0x%08X;' % (n, msg['id']))
+        w('constexpr bool DBC_%s_EXTD = %s;' % (n, 'true' if msg['extd'] else 'false'))
+        w('constexpr uint8_t DBC_%s_DLC = %d;' % (n, msg['dlc']))
+        w('constexpr uint8_t DBC_%s_SIGNAL_NUM = %d;' % (n, len(sigs)))
+        w('constexpr DbcSignalPos DBC_%s_SIGNALS[] = {' % n)
+        for s in sigs:
+            w('  {%d, %d, %s},  // %s' % (s['start'], s['length'], 'true' if s['big_endian'] else 'false', s['name']))
+        w('};')
+        w('')
+        w('struct __attribute__((packed)) dbc_%s {' % n)
+        for s in sigs:
+            w('  %s %s;' % (c_type(s), s['name']))
+        w('};')
+        w('')
+        emit_unpack(w, 'static inline void dbc_%s_unpack(const uint8_t* data, dbc_%s* m) {' % (n, n),
+                    sigs, lambda s: 'm->' + s['name'])
+        emit_pack(w, 'static inline void dbc_%s_pack(const dbc_%s* m, uint8_t* data) {' % (n, n),
+                  sigs, lambda s: 'm->' + s['name'])
+        w('// Straight into / out of the members of t, e.g. a BMUdata for BMU_F<k>')
+        w('template <typename T>')
+        emit_unpack(w, 'static inline void dbc_%s_unpack_to(const uint8_t* data, T* t) {' % n, sigs, member)
+        w('template <typename T>')
+        emit_pack(w, 'static inline void dbc_%s_pack_from(const T* t, uint8_t* data) {' % n, sigs, member)
+        for s in sigs:
+            if s['factor'] == 1 and s['offset'] == 0:
+                continue
+            p = 'DBC_%s' % s['name']
+            w('constexpr float %s_FACTOR = %s;' % (p, c_float(s['factor'])))
+            w('constexpr float %s_OFFSET = %s;' % (p, c_float(s['offset'])))
+            w('static inline int32_t %s_milli(int32_t raw) { return %s; }  // %s x1000' %
+              (p, milli_expr(s), s['unit'] or 'value'))
+        w('')
+
+    groups = group_constants(messages)
+    if groups:
+        w('// ---- Array signals (NAME_<n> sharing one scaling) ----')
+        for name, first in sorted(groups.items()):
+            w('constexpr float DBC_%s_FACTOR = DBC_%s_FACTOR;' % (name, first))
+            w('constexpr float DBC_%s_OFFSET = DBC_%s_OFFSET;' % (name, first))
+            w('static inline int32_t DBC_%s_milli(int32_t raw) { return DBC_%s_milli(raw); }' % (name, first))
+        w('')
+    w('#endif // AMS_CAN_DB_H')
+    return '\n'.join(o) + '\n'
+
+
+def run(dbc_path, header_path):
+    text = generate(parse_dbc(dbc_path), dbc_path)
+    old = open(header_path).read() if os.path.exists(header_path) else None
+    if text != old:
+        with open(header_path, 'w') as f:
+            f.write(text)
+        print('[dbc_codegen] %s -> %s' % (dbc_path, header_path))
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        print('usage: dbc_codegen.py <input.dbc> <output.h>')
+        sys.exit(1)
+    run(sys.argv[1], sys.argv[2])
+elif 'SCons.Script' in sys.modules:
+    # Run by PlatformIO as the library's extraScript. SCons resolves Dir('.')
+    # to this script's directory, wherever the library is installed.
+    lib_dir = os.path.dirname(Dir('.').srcnode().abspath)  # noqa: F821
+    dbc = os.path.join(lib_dir, 'ams_can.dbc')
+    header = os.path.join(lib_dir, 'ams_can_db.h')
+    if not os.path.exists(header) or os.path.getmtime(dbc) > os.path.getmtime(header):
+        run(dbc, header)
@@ -0,0 +1,131 @@
+// ============================================================================
+// fault_kernel_bench - host benchmark, per-module AoS checks vs the SoA kernel
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost fault_kernel_bench.cpp ../ams_cells.cpp ../ams_pack.cpp -o fault_kernel_bench
+//         add -DMODULE_NUM=32 (or any count) to see how it scales past the car's 7
+// Usage : fault_kernel_bench [iterations=200000]
+// Checks that the SSE2 and scalar kernels agree with a straightforward per-cell
+// reference on random packs, then times all three.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_cells.h"
+
+// Reference: the obvious AoS loop with one branch per check
+static void referenceEval(const BMUdata* bmu, AmsFaultResult* r) {
+  memset(r, 0, sizeof(*r));
+  r->packMin = 0xFF;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    if (!bmu[m].BMUconnected) {
+      r->vMin[m] = 0xFF;
+      for (int c = 0; c < CELL_NUM; c++) {
+        if (bmu[m].V_CELL[c] < r->vMin[m]) r->vMin[m] = bmu[m].V_CELL[c];
+        if (bmu[m].V_CELL[c] > r->vMax[m]) r->vMax[m] = bmu[m].V_CELL[c];
+      }
+      continue;
+    }
+    uint8_t mn = 0xFF, mx = 0;
+    uint16_t sum = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      uint8_t v = bmu[m].V_CELL[c];
+      if (v < mn) mn = v;
+      if (v > mx) mx = v;
+      sum += v;
+    }
+    for (int c = 0; c < CELL_NUM; c++) {
+      uint8_t v = bmu[m].V_CELL[c];
+      if (v >= VMAX_CELL_RAW - VCELL_WARN_MARGIN_RAW) r->ovWarn[m] |= 1 << c;
+      if (v > VMAX_CELL_RAW) r->ovCrit[m] |= 1 << c;
+      if (v <= VMIN_CELL_RAW + VCELL_WARN_MARGIN_RAW) r->lvWarn[m] |= 1 << c;
+      if (v < VMIN_CELL_RAW) r->lvCrit[m] |= 1 << c;
+      if (v - mn >= DV_WARN_RAW) r->dvWarn[m] |= 1 << c;
+      if (v - mn >= DVMAX_RAW) r->dvCrit[m] |= 1 << c;
+    }
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) {
+      if (bmu[m].TEMP_SENSE[s] >= TEMP_WARN_RAW) r->otWarn[m] |= 1 << s;
+      if (bmu[m].TEMP_SENSE[s] >= TEMP_MAX_RAW) r->otCrit[m] |= 1 << s;
+    }
+    r->vMin[m] = mn;
+    r->vMax[m] = mx;
+    r->vSum[m] = sum;
+    r->accumSum += sum;
+    if (mn < r->packMin) r->packMin = mn;
+    if (mx > r->packMax) r->packMax = mx;
+    const uint16_t* masks[8] = {r->ovWarn, r->ovCrit, r->lvWarn, r->lvCrit, r->otWarn, r->otCrit, r->dvWarn, r->dvCrit};
+    for (int i = 0; i < 8; i++) {
+      if (masks[i][m]) r->faults |= 1 << i;
+    }
+  }
+}
+
+static bool same(const AmsFaultResult& a, const AmsFaultResult& b) {
+  for (int m = 0; m < MODULE_NUM; m++) {
+    if (a.ovWarn[m] != b.ovWarn[m] || a.ovCrit[m] != b.ovCrit[m] || a.lvWarn[m] != b.lvWarn[m] ||
+        a.lvCrit[m] != b.lvCrit[m] || a.otWarn[m] != b.otWarn[m] || a.otCrit[m] != b.otCrit[m] ||
+        a.dvWarn[m] != b.dvWarn[m] || a.dvCrit[m] != b.dvCrit[m] || a.vSum[m] != b.vSum[m] ||
+        a.vMin[m] != b.vMin[m] || a.vMax[m] != b.vMax[m]) return false;
+  }
+  return a.accumSum == b.accumSum && a.packMin == b.packMin && a.packMax == b.packMax && a.faults == b.faults;
+}
+
+static void randomPack(std::mt19937& rng, BMUdata* bmu) {
+  for (int m = 0; m < MODULE_NUM; m++) {
+    bmu[m].BMUconnected = rng() % 8 != 0;
+    uint8_t base = 140 + rng() % 75;
+    for (int c = 0; c < CELL_NUM; c++) bmu[m].V_CELL[c] = base + rng() % 14;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) bmu[m].TEMP_SENSE[s] = 200 + rng() % 70;
+  }
+}
+
+// Best of 10 runs, the host's scheduling noise only ever adds time
+template <typename F>
+static double nsPerEval(long iterations, F&& f) {
+  double best = 1e30;
+  for (int run = 0; run < 10; run++) {
+    auto t0 = std::chrono::steady_clock::now();
+    for (long i = 0; i < iterations / 10; i++) f();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+    if (ns / (iterations / 10) < best) best = ns / (iterations / 10);
+  }
+  return best;
+}
+
+int main(int argc, char** argv) {
+  long iterations = argc > 1 ? atol(argv[1]) : 200000;
+  std::mt19937 rng(7);
+  static BMUdata bmu[MODULE_NUM];
+  static AmsCellStore store;
+  static AmsFaultResult ref, fast, scalar;
+
+  for (int trial = 0; trial < 2000; trial++) {
+    randomPack(rng, bmu);
+    amsLoadCells(&store, bmu);
+    referenceEval(bmu, &ref);
+    amsEvalFaults(&store, &fast);
+    amsEvalFaultsScalar(&store, &scalar);
+    if (!same(ref, fast) || !same(ref, scalar)) {
+      printf("MISMATCH at trial %d\n", trial);
+      return 1;
+    }
+  }
+
+  randomPack(rng, bmu);
+  amsLoadCells(&store, bmu);
+  volatile uint8_t sink = 0;
+  double tRef = nsPerEval(iterations, [&] { referenceEval(bmu, &ref); sink = sink + ref.faults; });
+  double tScalar = nsPerEval(iterations, [&] { amsEvalFaultsScalar(&store, &scalar); sink = sink + scalar.faults; });
+  double tFast = nsPerEval(iterations, [&] { amsEvalFaults(&store, &fast); sink = sink + fast.faults; });
+  double tLoad = nsPerEval(iterations, [&] { amsLoadCells(&store, bmu); sink = sink + store.v[0][0]; });
+
+  printf("%d modules x %d cells (%d lanes)\n", MODULE_NUM, CELL_NUM, AMS_MODULE_PAD);
+  printf("reference AoS : %8.1f ns/eval\n", tRef);
+  printf("SoA scalar    : %8.1f ns/eval\n", tScalar);
+#if defined(__SSE2__)
+  printf("SoA SSE2      : %8.1f ns/eval\n", tFast);
+#endif
+  printf("AoS -> SoA    : %8.1f ns/load\n", tLoad);
+  return 0;
+}
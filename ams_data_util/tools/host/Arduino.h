@@ -0,0 +1,32 @@
+// Host stand-in for the Arduino core, enough to link ams_data_util.cpp into host tools
+#pragma once
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define BIN 2
+#define DEC 10
+#define HEX 16
+
+struct HostSerial {
+  int printf(const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vprintf(fmt, args);
+    va_end(args);
+    return n;
+  }
+  size_t print(const char* s) { return fputs(s, stdout), strlen(s); }
+  size_t println(const char* s = "") { return print(s) + print("\n"); }
+  size_t println(unsigned long v, int base = DEC) {
+    char buf[33];
+    int n = 0;
+    do buf[n++] = "0123456789ABCDEF"[v % base]; while ((v /= base) && n < 32);
+    for (int i = 0; i < n / 2; i++) { char c = buf[i]; buf[i] = buf[n - 1 - i]; buf[n - 1 - i] = c; }
+    buf[n] = 0;
+    return println(buf);
+  }
+};
+
+static HostSerial Serial;
@@ -0,0 +1,6 @@
+// Host tools only: placeholder over-temperature codes so ams_data_util.h builds.
+// NOT a calibration of any BMU board, firmware defines its own from the
+// thermistor curve (see ams_data_util.h).
+#pragma once
+#define TEMP_WARN_RAW 240
+#define TEMP_MAX_RAW 260
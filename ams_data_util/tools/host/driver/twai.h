@@ -0,0 +1,22 @@
+// Host stand-in for the ESP-IDF TWAI header, enough for ams_data_util.h in host tools
+#pragma once
+#include <stdint.h>
+
+typedef struct {
+  union {
+    struct {
+      uint32_t extd : 1;
+      uint32_t rtr : 1;
+      uint32_t ss : 1;
+      uint32_t self : 1;
+      uint32_t dlc_non_comp : 1;
+      uint32_t reserved : 27;
+    };
+    uint32_t flags;
+  };
+  uint32_t identifier;
+  uint8_t data_length_code;
+  uint8_t data[8];
+} twai_message_t;
+
+#define TWAI_TIMING_CONFIG_250KBITS() {}
@@ -0,0 +1,266 @@
+// ============================================================================
+// pack_check - Pack<> / PackRuntime against the fault kernel and a reference
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost pack_check.cpp ../ams_pack.cpp ../ams_cells.cpp -o pack_check
+//         add -DMODULE_NUM=32 (or any count) for a longer car pack
+// Usage : pack_check [packs=20000] [seed=1]
+// 1. Car pack (CELL_NUM x MODULE_NUM x TEMP_SENSOR_NUM, default limits): the
+//    same random BMUdata through CarPack, PackRuntime(AMS_PACK_CAR) and
+//    amsEvalFaults. Masks, V_MODULE, DV (storeBMU) and the summary must agree
+//    for every connected module. The packs live across trials, so modules
+//    connect and drop in every order (active list swap-remove).
+// 2. Modules wider than 32 cells / sensors (masks of 2 and 3 words, random
+//    limits): Pack<> and PackRuntime through loadModule against a per-cell
+//    reference, every bit of every word. loadBMU must refuse those modules.
+// Exits non-zero on any mismatch.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_pack.h"
+
+static std::mt19937 rng;
+static int _failures = 0;
+
+#define CHECK(cond, ...)                 \
+  do {                                   \
+    if (!(cond)) {                       \
+      if (_failures < 20) {              \
+        printf("  FAIL: " __VA_ARGS__);  \
+        printf("\n");                    \
+      }                                  \
+      _failures++;                       \
+    }                                    \
+  } while (0)
+
+static bool sameSummary(const AmsPackSummary& a, const AmsPackSummary& b) {
+  return a.accumSum == b.accumSum && a.packMin == b.packMin && a.packMax == b.packMax && a.faults == b.faults &&
+         a.connected == b.connected;
+}
+
+// Module values around every limit, now and then a wild one
+static uint8_t randomCell(uint8_t base) {
+  return rng() % 16 == 0 ? (uint8_t)rng() : (uint8_t)(base + rng() % 14);
+}
+
+static uint16_t randomTemp(uint16_t around) {
+  return (uint16_t)(around - 30 + rng() % 60);
+}
+
+static bool sameFaults(const BMUdata& a, const BMUdata& b) {
+  return a.OVERVOLTAGE_WARNING == b.OVERVOLTAGE_WARNING && a.OVERVOLTAGE_CRITICAL == b.OVERVOLTAGE_CRITICAL &&
+         a.LOWVOLTAGE_WARNING == b.LOWVOLTAGE_WARNING && a.LOWVOLTAGE_CRITICAL == b.LOWVOLTAGE_CRITICAL &&
+         a.OVERTEMP_WARNING == b.OVERTEMP_WARNING && a.OVERTEMP_CRITICAL == b.OVERTEMP_CRITICAL &&
+         a.OVERDIV_VOLTAGE_WARNING == b.OVERDIV_VOLTAGE_WARNING &&
+         a.OVERDIV_VOLTAGE_CRITICAL == b.OVERDIV_VOLTAGE_CRITICAL && a.V_MODULE == b.V_MODULE && a.DV == b.DV;
+}
+
+// ---- 1. Car pack against the kernel ----
+
+static CarPack carPack;
+static PackRuntime carRuntime;
+
+static void carTrial(int trial) {
+  BMUdata bmu[MODULE_NUM];
+  for (int m = 0; m < MODULE_NUM; m++) {
+    bmu[m].BMUconnected = rng() % 4 != 0;
+    uint8_t base = (uint8_t)(135 + rng() % 80);
+    for (int c = 0; c < CELL_NUM; c++) bmu[m].V_CELL[c] = randomCell(base);
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) bmu[m].TEMP_SENSE[s] = randomTemp(TEMP_WARN_RAW);
+  }
+
+  // Kernel: masks / V_MODULE / DV of each module as storeBMU should write them
+  AmsCellStore store;
+  AmsFaultResult result;
+  BMUdata want[MODULE_NUM];
+  memcpy((void*)want, bmu, sizeof(want));
+  amsLoadCells(&store, bmu);
+  amsEvalFaults(&store, &result);
+  for (int m = 0; m < MODULE_NUM; m++) {
+    BMUdata& w = want[m];
+    w.OVERVOLTAGE_WARNING = result.ovWarn[m];
+    w.OVERVOLTAGE_CRITICAL = result.ovCrit[m];
+    w.LOWVOLTAGE_WARNING = result.lvWarn[m];
+    w.LOWVOLTAGE_CRITICAL = result.lvCrit[m];
+    w.OVERTEMP_WARNING = result.otWarn[m];
+    w.OVERTEMP_CRITICAL = result.otCrit[m];
+    w.OVERDIV_VOLTAGE_WARNING = result.dvWarn[m];
+    w.OVERDIV_VOLTAGE_CRITICAL = result.dvCrit[m];
+    w.V_MODULE = result.vSum[m];
+    w.DV = (uint8_t)((result.vMax[m] - result.vMin[m]) / 5);
+  }
+
+  AmsPackSummary ks;
+  ks.accumSum = result.accumSum;
+  ks.packMin = result.packMin;
+  ks.packMax = result.packMax;
+  ks.faults = result.faults;
+  for (int m = 0; m < MODULE_NUM; m++) ks.connected += bmu[m].BMUconnected;
+
+  for (int m = 0; m < MODULE_NUM; m++) {
+    carPack.loadBMU((uint8_t)m, bmu[m]);
+    CHECK(carRuntime.loadBMU((uint8_t)m, bmu[m]), "car trial %d: PackRuntime refused module %d", trial, m);
+  }
+  AmsPackSummary ps = carPack.evaluate();
+  AmsPackSummary rs = carRuntime.evaluate();
+  CHECK(sameSummary(ps, ks), "car trial %d: Pack summary %u/%u/%u/%02x/%u, kernel %u/%u/%u/%02x/%u", trial,
+        (unsigned)ps.accumSum, ps.packMin, ps.packMax, ps.faults, ps.connected, (unsigned)ks.accumSum, ks.packMin,
+        ks.packMax, ks.faults, ks.connected);
+  CHECK(sameSummary(rs, ks), "car trial %d: PackRuntime summary differs from the kernel", trial);
+
+  for (int m = 0; m < MODULE_NUM; m++) {
+    bool on = bmu[m].BMUconnected;
+    CHECK(carPack.connected((uint8_t)m) == on && carRuntime.connected((uint8_t)m) == on,
+          "car trial %d: module %d connected state wrong", trial, m);
+    if (!on) continue;
+    BMUdata fromPack = bmu[m], fromRuntime = bmu[m];
+    carPack.storeBMU((uint8_t)m, &fromPack);
+    carRuntime.storeBMU((uint8_t)m, &fromRuntime);
+    CHECK(sameFaults(fromPack, want[m]), "car trial %d: Pack module %d differs from the kernel", trial, m);
+    CHECK(sameFaults(fromRuntime, want[m]), "car trial %d: PackRuntime module %d differs from the kernel", trial, m);
+  }
+}
+
+// ---- 2. Wide modules against a per-cell reference ----
+
+static const uint8_t WIDE_MODULES = 5;
+static const uint8_t WIDE_TEMPS = 36;  // Sensor masks of 2 words too
+
+struct RefModule {
+  uint32_t mask[AMS_FAULT_KINDS][3];
+  AmsModuleEval eval;
+};
+
+static void referenceModule(const uint8_t* v, uint8_t cells, const uint16_t* t, uint8_t temps,
+                            const AmsLimits& lim, RefModule* r) {
+  memset(r->mask, 0, sizeof(r->mask));
+  r->eval = AmsModuleEval();
+  for (int c = 0; c < cells; c++) {
+    if (v[c] < r->eval.vMin) r->eval.vMin = v[c];
+    if (v[c] > r->eval.vMax) r->eval.vMax = v[c];
+    r->eval.vSum += v[c];
+  }
+  for (int c = 0; c < cells; c++) {
+    uint32_t bit = 1u << (c % 32);
+    int w = c / 32;
+    if (v[c] >= lim.ovWarn) r->mask[AMS_OV_WARN][w] |= bit;
+    if (v[c] > lim.ovCrit) r->mask[AMS_OV_CRIT][w] |= bit;
+    if (v[c] <= lim.lvWarn) r->mask[AMS_LV_WARN][w] |= bit;
+    if (v[c] < lim.lvCrit) r->mask[AMS_LV_CRIT][w] |= bit;
+    if (v[c] - r->eval.vMin >= lim.dvWarn) r->mask[AMS_DV_WARN][w] |= bit;
+    if (v[c] - r->eval.vMin >= lim.dvCrit) r->mask[AMS_DV_CRIT][w] |= bit;
+  }
+  for (int s = 0; s < temps; s++) {
+    if (t[s] >= lim.otWarn) r->mask[AMS_OT_WARN][s / 32] |= 1u << (s % 32);
+    if (t[s] >= lim.otCrit) r->mask[AMS_OT_CRIT][s / 32] |= 1u << (s % 32);
+  }
+  for (int k = 0; k < AMS_FAULT_KINDS; k++) {
+    if (r->mask[k][0] | r->mask[k][1] | r->mask[k][2]) r->eval.faults |= 1 << k;
+  }
+}
+
+static AmsLimits randomLimits() {
+  AmsLimits lim;
+  lim.ovCrit = (uint8_t)(195 + rng() % 20);
+  lim.ovWarn = (uint8_t)(lim.ovCrit - rng() % 10);
+  lim.lvCrit = (uint8_t)(140 + rng() % 20);
+  lim.lvWarn = (uint8_t)(lim.lvCrit + rng() % 10);
+  lim.dvCrit = (uint8_t)(5 + rng() % 10);
+  lim.dvWarn = (uint8_t)(1 + rng() % lim.dvCrit);
+  lim.otWarn = (uint16_t)(200 + rng() % 60);
+  lim.otCrit = (uint16_t)(lim.otWarn + rng() % 20);
+  return lim;
+}
+
+template <uint8_t Cells>
+struct WideCheck {
+  typedef Pack<Cells, WIDE_MODULES, WIDE_TEMPS> WidePack;
+  static constexpr uint8_t WORDS = (uint8_t)FaultBits<WidePack::BITS>::WORDS;
+
+  WidePack pack;
+  PackRuntime runtime;
+
+  bool begin() {
+    AmsPackConfig cfg = {Cells, WIDE_MODULES, WIDE_TEMPS};
+    BMUdata bmu;
+    return runtime.begin(cfg) && !runtime.loadBMU(0, bmu);
+  }
+
+  void trial(int trial) {
+    AmsLimits lim = randomLimits();
+    pack.limits = lim;
+    runtime.limits = lim;
+
+    uint8_t v[WIDE_MODULES][Cells];
+    uint16_t t[WIDE_MODULES][WIDE_TEMPS];
+    bool on[WIDE_MODULES];
+    RefModule ref[WIDE_MODULES];
+    AmsPackSummary want;
+    for (uint8_t m = 0; m < WIDE_MODULES; m++) {
+      on[m] = rng() % 4 != 0;
+      uint8_t base = (uint8_t)(135 + rng() % 80);
+      for (int c = 0; c < Cells; c++) v[m][c] = randomCell(base);
+      for (int s = 0; s < WIDE_TEMPS; s++) t[m][s] = randomTemp(lim.otWarn);
+      pack.loadModule(m, v[m], t[m], on[m]);
+      runtime.loadModule(m, v[m], t[m], on[m]);
+      referenceModule(v[m], Cells, t[m], WIDE_TEMPS, lim, &ref[m]);
+      if (on[m]) amsAddToSummary(&want, ref[m].eval);
+    }
+
+    AmsPackSummary ps = pack.evaluate();
+    AmsPackSummary rs = runtime.evaluate();
+    CHECK(sameSummary(ps, want), "%u cells trial %d: Pack summary differs from the reference", Cells, trial);
+    CHECK(sameSummary(rs, want), "%u cells trial %d: PackRuntime summary differs from the reference", Cells, trial);
+
+    for (uint8_t m = 0; m < WIDE_MODULES; m++) {
+      if (!on[m]) continue;
+      const AmsModuleEval& pe = pack.module(m).eval;
+      const AmsModuleEval& re = runtime.eval(m);
+      CHECK(pe.vMin == ref[m].eval.vMin && pe.vMax == ref[m].eval.vMax && pe.vSum == ref[m].eval.vSum &&
+                pe.faults == ref[m].eval.faults,
+            "%u cells trial %d: Pack module %u eval differs", Cells, trial, m);
+      CHECK(re.vMin == ref[m].eval.vMin && re.vMax == ref[m].eval.vMax && re.vSum == ref[m].eval.vSum &&
+                re.faults == ref[m].eval.faults,
+            "%u cells trial %d: PackRuntime module %u eval differs", Cells, trial, m);
+      for (int k = 0; k < AMS_FAULT_KINDS; k++) {
+        for (int w = 0; w < WORDS; w++) {
+          uint32_t expect = ref[m].mask[k][w];
+          CHECK(pack.module(m).fault[k].w[w] == expect,
+                "%u cells trial %d: Pack module %u kind %d word %d %08x, want %08x", Cells, trial, m, k, w,
+                pack.module(m).fault[k].w[w], expect);
+          CHECK(runtime.fault(m, (AmsFaultKind)k)[w] == expect,
+                "%u cells trial %d: PackRuntime module %u kind %d word %d %08x, want %08x", Cells, trial, m, k, w,
+                runtime.fault(m, (AmsFaultKind)k)[w], expect);
+        }
+      }
+    }
+  }
+};
+
+template <uint8_t Cells>
+static void runWide(int trials) {
+  static WideCheck<Cells> check;
+  int before = _failures;
+  CHECK(check.begin(), "%u cells: PackRuntime begin failed or loadBMU took a wide module", Cells);
+  for (int t = 0; t < trials; t++) check.trial(t);
+  printf("%3u cells x %u modules x %u sensors, %d word masks: %6d packs, %d failed\n", Cells, WIDE_MODULES,
+         WIDE_TEMPS, (int)WideCheck<Cells>::WORDS, trials, _failures - before);
+}
+
+int main(int argc, char** argv) {
+  int packs = argc > 1 ? atoi(argv[1]) : 20000;
+  rng.seed(argc > 2 ? atoi(argv[2]) : 1);
+
+  int before = _failures;
+  CHECK(carRuntime.begin(AMS_PACK_CAR), "PackRuntime begin(AMS_PACK_CAR) failed");
+  for (int t = 0; t < packs; t++) carTrial(t);
+  printf("car %2d cells x %d modules x %d sensors vs amsEvalFaults: %6d packs, %d failed\n", CELL_NUM, MODULE_NUM,
+         TEMP_SENSOR_NUM, packs, _failures - before);
+
+  runWide<40>(packs / 4);
+  runWide<70>(packs / 4);
+
+  printf("\n%s (%d failures)\n", _failures ? "FAILED" : "all checks passed", _failures);
+  return _failures ? 1 : 0;
+}
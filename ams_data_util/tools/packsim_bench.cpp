@@ -0,0 +1,173 @@
+// ============================================================================
+// packsim_bench - pack simulator as load generator for the BCU receive pipeline
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost -I../../SD32_util packsim_bench.cpp ../ams_packsim.cpp ../ams_soc.cpp
+//           ../ams_data_util.cpp ../ams_cells.cpp ../ams_pack.cpp ../ams_aggregate.cpp ../ams_telemetry.cpp
+//           ../ams_binlink.cpp ../ams_units.cpp -o packsim_bench
+// Usage : packsim_bench [seconds=600] [fps=0] [seed=1] [--soc-log out.csv]
+//         fps 0 = bus saturation at 250 kbit/s, otherwise frames per second
+// Simulates an endurance stint with dropouts and a few injected faults, streams
+// the CAN frames through decodeBMUFrame -> amsAggUpdate, logs a CSV row per
+// module update and publishes telemetry (text + binary) at 10 Hz. Prints ns per
+// frame for each stage, checks that the decoded state matches the simulator,
+// and replays the same seed to prove determinism.
+// --soc-log writes the soc_replay log format (1 Hz, truth current).
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "SD32_csv.h"
+#include "ams_aggregate.h"
+#include "ams_binlink.h"
+#include "ams_packsim.h"
+#include "ams_telemetry.h"
+
+#define STEP_MS 10
+
+typedef std::chrono::steady_clock Clock;
+static double since(Clock::time_point t0) {
+  return std::chrono::duration<double, std::nano>(Clock::now() - t0).count();
+}
+
+struct Totals {
+  double simNs, decodeNs, aggNs, logNs, textNs, binNs;
+  uint64_t frames, decodeErrors, logBytes, textBytes, binBytes, snapshots;
+  uint32_t hash;  // FNV-1a over every frame
+  long mismatched;
+};
+
+static void injectFaults(AmsPackSim* sim, uint32_t t) {
+  if (t == 120000) amsSimInjectFault(sim, {AMS_SIM_CELL_LEAK, 1, 3, 500});
+  if (t == 240000) amsSimInjectFault(sim, {AMS_SIM_TEMP_OFFSET, 2 % MODULE_NUM, 0, 40});
+  if (t == 300000) amsSimInjectFault(sim, {AMS_SIM_MODULE_SILENT, 0, 0, 5000});
+  if (t == 360000) amsSimInjectFault(sim, {AMS_SIM_CELL_OPEN, (uint8_t)(MODULE_NUM - 1), 7, 0});
+}
+
+static Totals run(uint32_t seconds, uint32_t fps, uint32_t seed, FILE* socLog) {
+  AmsSimConfig cfg;
+  cfg.seed = seed;
+  cfg.framesPerSecond = fps;
+  static AmsPackSim sim;
+  amsSimInit(&sim, &cfg);
+
+  static BMUdata rx[MODULE_NUM], sent[MODULE_NUM];
+  for (int m = 0; m < MODULE_NUM; m++) rx[m] = BMUdata();
+  static AmsAggregator agg;
+  amsAggInit(&agg);
+  AmsTelemetryEncoder text;
+  amsTelemetryInit(&text);
+  AmsBinEncoder bin;
+  amsBinEncoderInit(&bin);
+  static SD32_CsvBuffer<4096> csv;
+  csv.clear();
+  static char textBuf[AMS_TLM_BUF_BYTES];
+  static uint8_t binBuf[AMS_BIN_FRAME_MAX];
+  twai_message_t frames[64];
+  AMSdata ams;
+  Totals t = {};
+  t.hash = 2166136261u;
+
+  if (socLog) {
+    fprintf(socLog, "ms,current_mA");
+    for (int i = 0; i < CELL_NUM * MODULE_NUM; i++) fprintf(socLog, ",M%dC%d", i / CELL_NUM + 1, i % CELL_NUM + 1);
+    fprintf(socLog, "\n");
+  }
+
+  for (uint32_t now = STEP_MS; now <= seconds * 1000; now += STEP_MS) {
+    injectFaults(&sim, now);
+    auto t0 = Clock::now();
+    amsSimStep(&sim, STEP_MS);
+    size_t n = amsSimPollFrames(&sim, now * 1000, frames, sizeof(frames) / sizeof(frames[0]));
+    t.simNs += since(t0);
+
+    for (size_t i = 0; i < n; i++) {
+      const twai_message_t& f = frames[i];
+      for (size_t k = 0; k < sizeof(f.data); k++) t.hash = (t.hash ^ f.data[k]) * 16777619u;
+      t.hash = (t.hash ^ f.identifier) * 16777619u;
+
+      t0 = Clock::now();
+      int m = decodeBMUFrame(&f, rx);
+      t.decodeNs += since(t0);
+      if (m < 0) {
+        t.decodeErrors++;
+        continue;
+      }
+      uint32_t frame = (f.identifier - BMU_ADD) % (1u << BMU_MODULE_SHIFT);
+      if (frame == 0) sent[m] = sim.bmu[m];  // Simulator encodes a module's frames at its frame 0
+      if (frame != BMU_FRAME_NUM - 1) continue;  // Module complete after its last frame
+
+      t0 = Clock::now();
+      amsAggUpdate(&agg, m, &rx[m], now);
+      t.aggNs += since(t0);
+
+      t0 = Clock::now();
+      csv.u32(now).u32(m + 1).fixed(rx[m].V_MODULE * 2, 2);
+      for (int c = 0; c < CELL_NUM; c++) csv.fixed(rx[m].V_CELL[c] * 2, 2);
+      for (int s = 0; s < TEMP_SENSOR_NUM; s++) csv.u32(rx[m].TEMP_SENSE[s]);
+      csv.u32(rx[m].OVERDIV_VOLTAGE_WARNING).endRow();
+      if (csv.remaining() < 256) {
+        t.logBytes += csv.size();
+        csv.clear();
+      }
+      t.logNs += since(t0);
+
+      // Decoded module must match the state the simulator encoded
+      if (memcmp(rx[m].V_CELL, sent[m].V_CELL, CELL_NUM) != 0 || rx[m].V_MODULE != sent[m].V_MODULE ||
+          memcmp(rx[m].TEMP_SENSE, sent[m].TEMP_SENSE, sizeof(sent[m].TEMP_SENSE)) != 0 ||
+          rx[m].OVERVOLTAGE_WARNING != sent[m].OVERVOLTAGE_WARNING)
+        t.mismatched++;
+    }
+    t.frames += n;
+    amsAggExpire(&agg, rx, now);
+
+    if (now % 100 == 0) {  // 10 Hz telemetry
+      amsAggApply(&agg, &ams);
+      t0 = Clock::now();
+      t.textBytes += amsTelemetryEncode(&text, &ams, rx, textBuf, sizeof(textBuf));
+      t.textNs += since(t0);
+      OBCdata obc;
+      amsSimFillOBC(&sim, &obc);
+      t0 = Clock::now();
+      t.binBytes += amsBinEncode(&bin, &ams, rx, &obc, binBuf, sizeof(binBuf));
+      t.binNs += since(t0);
+      t.snapshots++;
+    }
+    if (socLog && now % 1000 == 0) {
+      fprintf(socLog, "%u,%d", now, (int)(sim.currentA * 1000.0f));
+      for (int m = 0; m < MODULE_NUM; m++)
+        for (int c = 0; c < CELL_NUM; c++) fprintf(socLog, ",%u", sim.bmu[m].V_CELL[c]);
+      fprintf(socLog, "\n");
+    }
+  }
+  return t;
+}
+
+int main(int argc, char** argv) {
+  uint32_t seconds = argc > 1 ? atoi(argv[1]) : 600;
+  uint32_t fps = argc > 2 ? atoi(argv[2]) : 0;
+  uint32_t seed = argc > 3 ? atoi(argv[3]) : 1;
+  FILE* socLog = nullptr;
+  if (argc > 5 && strcmp(argv[4], "--soc-log") == 0) socLog = fopen(argv[5], "w");
+  if (fps == 0) fps = amsSimBusCapacity(250000);
+
+  Totals t = run(seconds, fps, seed, socLog);
+  if (socLog) fclose(socLog);
+  double f = t.frames ? (double)t.frames : 1.0;
+  double s = t.snapshots ? (double)t.snapshots : 1.0;
+  printf("%u s simulated, %d modules, %u frames/s requested: %llu frames (%.0f/s), %llu decode errors\n", seconds,
+         MODULE_NUM, fps, (unsigned long long)t.frames, t.frames / (double)seconds,
+         (unsigned long long)t.decodeErrors);
+  printf("  simulator     %8.1f ns/frame\n", t.simNs / f);
+  printf("  decode        %8.1f ns/frame\n", t.decodeNs / f);
+  printf("  aggregate     %8.1f ns/frame\n", t.aggNs / f);
+  printf("  CSV log       %8.1f ns/frame  %.0f bytes/frame\n", t.logNs / f, t.logBytes / f);
+  printf("  telemetry txt %8.1f us/snapshot  %.0f bytes/snapshot\n", t.textNs / 1000.0 / s, t.textBytes / s);
+  printf("  telemetry bin %8.1f us/snapshot  %.0f bytes/snapshot\n", t.binNs / 1000.0 / s, t.binBytes / s);
+  printf("  decoded module mismatches: %ld\n", t.mismatched);
+
+  Totals again = run(seconds, fps, seed, nullptr);
+  printf("  replay with seed %u: %s (frame hash %08x)\n", seed,
+         again.hash == t.hash && again.frames == t.frames ? "identical" : "DIFFERENT", t.hash);
+  return t.mismatched != 0 || t.decodeErrors != 0 || again.hash != t.hash;
+}
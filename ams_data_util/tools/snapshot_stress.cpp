@@ -0,0 +1,136 @@
+// ============================================================================
+// snapshot_stress - host multi-threaded stress test and benchmark for AmsSnapshot
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -pthread -I.. -Ihost snapshot_stress.cpp -o snapshot_stress
+// Usage : snapshot_stress [seconds=2] [readers=3]
+// One writer publishes BMUdata whose every field is derived from a counter.
+// The readers check that each copy they get comes from a single write. Three
+// variants run in turn:
+//   unsynchronised  word-wise copy with no sequence check, shows the tearing
+//   mutex           std::mutex around the struct (what serialMutex would do)
+//   AmsSnapshot     seqlock
+// Prints torn reads, writer / reader throughput, the writer's worst stall and
+// the snapshot's contention counters.
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "ams_snapshot.h"
+
+static void fill(BMUdata* b, uint32_t k) {
+  b->BMU_ID = k;
+  for (int c = 0; c < CELL_NUM; c++) b->V_CELL[c] = (uint8_t)(k + c);
+  for (int s = 0; s < TEMP_SENSOR_NUM; s++) b->TEMP_SENSE[s] = (uint16_t)(k + s);
+  b->V_MODULE = (uint16_t)k;
+  b->DV = (uint8_t)k;
+  b->OVERVOLTAGE_WARNING = b->OVERVOLTAGE_CRITICAL = b->LOWVOLTAGE_WARNING = b->LOWVOLTAGE_CRITICAL =
+      b->OVERTEMP_WARNING = b->OVERTEMP_CRITICAL = b->OVERDIV_VOLTAGE_WARNING = b->OVERDIV_VOLTAGE_CRITICAL =
+          (uint16_t)~k;
+  b->BalancingDischarge_Cells = (uint16_t)(k >> 3);
+  b->BMUconnected = k & 1;
+  b->BMUneedBalance = !(k & 1);
+}
+
+static bool consistent(const BMUdata& b) {
+  BMUdata ref;
+  fill(&ref, b.BMU_ID);
+  return memcmp(&ref, &b, sizeof(b)) == 0;
+}
+
+// Word copy without the sequence check: well defined, but tears
+struct Unsynchronised {
+  static constexpr size_t WORDS = (sizeof(BMUdata) + 3) / 4;
+  uint32_t words[WORDS] = {};
+  void write(const BMUdata& v) {
+    uint32_t w[WORDS] = {};
+    memcpy(w, &v, sizeof(v));
+    for (size_t i = 0; i < WORDS; i++) __atomic_store_n(&words[i], w[i], __ATOMIC_RELAXED);
+  }
+  bool read(BMUdata* out) {
+    uint32_t w[WORDS];
+    for (size_t i = 0; i < WORDS; i++) w[i] = __atomic_load_n(&words[i], __ATOMIC_RELAXED);
+    memcpy(out, w, sizeof(*out));
+    return true;
+  }
+};
+
+struct Locked {
+  std::mutex lock;
+  BMUdata value;
+  void write(const BMUdata& v) {
+    std::lock_guard<std::mutex> g(lock);
+    value = v;
+  }
+  bool read(BMUdata* out) {
+    std::lock_guard<std::mutex> g(lock);
+    *out = value;
+    return true;
+  }
+};
+
+template <typename S>
+static void run(const char* name, S& shared, double seconds, int readers) {
+  {  // Start from a consistent value
+    BMUdata b;
+    fill(&b, 0);
+    shared.write(b);
+  }
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> reads{0}, torn{0};
+  uint64_t writes = 0;
+  double worstWriteUs = 0;
+
+  std::vector<std::thread> threads;
+  for (int r = 0; r < readers; r++) {
+    threads.emplace_back([&] {
+      uint64_t n = 0, bad = 0;
+      BMUdata b;
+      while (!stop.load(std::memory_order_relaxed)) {
+        if (shared.read(&b)) {
+          n++;
+          bad += !consistent(b);
+        }
+      }
+      reads += n;
+      torn += bad;
+    });
+  }
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::duration<double>(seconds);
+  BMUdata b;
+  for (uint32_t k = 1; std::chrono::steady_clock::now() < end; k++) {
+    fill(&b, k);
+    auto t0 = std::chrono::steady_clock::now();
+    shared.write(b);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    if (us > worstWriteUs) worstWriteUs = us;
+    writes++;
+  }
+  stop = true;
+  for (auto& t : threads) t.join();
+  printf("%-15s %10.0f writes/s %11.0f reads/s  worst write %8.1f us  torn %llu\n", name, writes / seconds,
+         reads / seconds, worstWriteUs, (unsigned long long)torn);
+}
+
+int main(int argc, char** argv) {
+  double seconds = argc > 1 ? atof(argv[1]) : 2.0;
+  int readers = argc > 2 ? atoi(argv[2]) : 3;
+  printf("1 writer, %d readers, %.1f s each, sizeof(BMUdata) %zu\n", readers, seconds, sizeof(BMUdata));
+
+  static Unsynchronised plain;
+  static Locked locked;
+  static BMUsnapshot snap;
+  run("unsynchronised", plain, seconds, readers);
+  run("mutex", locked, seconds, readers);
+  run("AmsSnapshot", snap, seconds, readers);
+
+  AmsSnapshotStats s = snap.stats();
+  printf("AmsSnapshot stats: writes %u reads %u retries %u failed %u max retries %u\n", s.writes, s.reads, s.retries,
+         s.failed, s.maxRetries);
+  return 0;
+}
@@ -0,0 +1,163 @@
+// ============================================================================
+// soc_replay - host replay harness for the SOC / SOH estimator
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost soc_replay.cpp ../ams_soc.cpp -o soc_replay
+//         add -DMODULE_NUM=N to match the logged pack
+// Usage : soc_replay log.csv          replay a recorded log
+//         soc_replay --synth [out.csv] simulated drive cycle with known truth,
+//                                      optionally written out in the log format
+// Log format (CSV, one header line, one row per BMS_COMMUNICATE_TIME):
+//   ms,current_mA,<CELL_NUM * MODULE_NUM V_CELL raw codes, module major>
+// Prints µs per update (mean / max over the run), the estimator's own budget
+// counters, and for --synth the SOC and R0 error against the simulated cells.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include "ams_soc.h"
+
+struct Row {
+  uint32_t ms;
+  int32_t currentMa;
+  uint8_t raw[AMS_SOC_CELLS];
+  float trueSoc[AMS_SOC_CELLS];  // --synth only
+};
+
+static bool readLog(const char* path, std::vector<Row>* rows) {
+  FILE* f = fopen(path, "r");
+  if (!f) return false;
+  char line[8192];
+  if (!fgets(line, sizeof(line), f)) {  // Header
+    fclose(f);
+    return false;
+  }
+  while (fgets(line, sizeof(line), f)) {
+    Row r = {};
+    char* p = line;
+    r.ms = strtoul(p, &p, 10);
+    r.currentMa = strtol(p + 1, &p, 10);
+    int n = 0;
+    while (*p == ',' && n < AMS_SOC_CELLS) r.raw[n++] = (uint8_t)strtoul(p + 1, &p, 10);
+    if (n != AMS_SOC_CELLS) {
+      fprintf(stderr, "row at %u ms has %d cells, expected %d (MODULE_NUM?)\n", r.ms, n, AMS_SOC_CELLS);
+      fclose(f);
+      return false;
+    }
+    rows->push_back(r);
+  }
+  fclose(f);
+  return true;
+}
+
+// Cells with their own capacity / resistance, driven through laps of pulses,
+// regen and pit stops, measured with V_CELL quantisation and a little noise
+static void synthesize(std::vector<Row>* rows, std::vector<float>* trueR0) {
+  std::mt19937 rng(7);
+  std::normal_distribution<float> noise(0.0f, 0.005f);
+  const float dt = BMS_COMMUNICATE_TIME * 0.001f;
+  float cap[AMS_SOC_CELLS], soc[AMS_SOC_CELLS], vrc[AMS_SOC_CELLS];
+  trueR0->resize(AMS_SOC_CELLS);
+  for (int i = 0; i < AMS_SOC_CELLS; i++) {
+    cap[i] = AH_CELL * 3600.0f * (0.97f + 0.06f * (rng() % 1000) / 1000.0f);
+    (*trueR0)[i] = 0.0015f + 0.001f * (rng() % 1000) / 1000.0f;
+    soc[i] = 0.90f + 0.04f * (rng() % 1000) / 1000.0f;
+    vrc[i] = 0.0f;
+  }
+  const float a = expf(-dt / 30.0f), b = 0.0010f * (1.0f - a);
+  for (uint32_t t = 0; t < 2400; t++) {  // 40 min at 1 Hz, ~0.9 down to ~0.35
+    uint32_t phase = t % 120;
+    float current = phase < 20 ? 0.0f : (phase % 10 < 6 ? 80.0f : -30.0f);
+    if (t % 900 > 840) current = 0.0f;  // Pit stop
+    Row r = {};
+    r.ms = t * BMS_COMMUNICATE_TIME;
+    r.currentMa = (int32_t)(current * 1000.0f);
+    for (int i = 0; i < AMS_SOC_CELLS; i++) {
+      soc[i] -= current * dt / cap[i];
+      vrc[i] = a * vrc[i] + b * current;
+      float v = amsOcv(soc[i], nullptr) - vrc[i] - (*trueR0)[i] * current + noise(rng);
+      r.raw[i] = (uint8_t)(v / 0.02f + 0.5f);
+      r.trueSoc[i] = soc[i];
+    }
+    rows->push_back(r);
+  }
+}
+
+static void writeLog(const char* path, const std::vector<Row>& rows) {
+  FILE* f = fopen(path, "w");
+  if (!f) return;
+  fprintf(f, "ms,current_mA");
+  for (int i = 0; i < AMS_SOC_CELLS; i++) fprintf(f, ",M%dC%d", i / CELL_NUM + 1, i % CELL_NUM + 1);
+  fprintf(f, "\n");
+  for (const Row& r : rows) {
+    fprintf(f, "%u,%d", r.ms, r.currentMa);
+    for (int i = 0; i < AMS_SOC_CELLS; i++) fprintf(f, ",%u", r.raw[i]);
+    fprintf(f, "\n");
+  }
+  fclose(f);
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: soc_replay log.csv | --synth [out.csv]\n");
+    return 1;
+  }
+  std::vector<Row> rows;
+  std::vector<float> trueR0;
+  bool synth = strcmp(argv[1], "--synth") == 0;
+  if (synth) {
+    synthesize(&rows, &trueR0);
+    if (argc > 2) writeLog(argv[2], rows);
+  } else if (!readLog(argv[1], &rows)) {
+    fprintf(stderr, "cannot read %s\n", argv[1]);
+    return 1;
+  }
+
+  static BMUdata bmu[MODULE_NUM];
+  static AmsSocEstimator est;
+  amsSocInit(&est);
+  AMSdata ams;
+  double totalNs = 0, maxNs = 0, sq = 0, worst = 0;
+  long errN = 0;
+  uint32_t prevMs = rows.empty() ? 0 : rows[0].ms;
+
+  for (const Row& r : rows) {
+    for (int m = 0; m < MODULE_NUM; m++) {
+      bmu[m].BMUconnected = true;
+      memcpy(bmu[m].V_CELL, &r.raw[m * CELL_NUM], CELL_NUM);
+    }
+    uint32_t dtMs = r.ms - prevMs;
+    prevMs = r.ms;
+    auto t0 = std::chrono::steady_clock::now();
+    amsSocUpdate(&est, bmu, r.currentMa, dtMs ? dtMs : BMS_COMMUNICATE_TIME);
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    totalNs += ns;
+    if (ns > maxNs) maxNs = ns;
+    if (synth && r.ms >= 300000) {  // Error after 5 min convergence
+      for (int i = 0; i < AMS_SOC_CELLS; i++) {
+        double e = est.soc[i] - r.trueSoc[i];
+        sq += e * e;
+        worst = fabs(e) > worst ? fabs(e) : worst;
+        errN++;
+      }
+    }
+  }
+  amsSocApply(&est, &ams);
+
+  const AmsSocStats& st = amsSocStats(&est);
+  printf("%zu updates, %d cells: %.2f us/update mean, %.2f us max (budget %d us, %u over)\n", rows.size(),
+         AMS_SOC_CELLS, totalNs / 1000.0 / rows.size(), maxNs / 1000.0, AMS_SOC_BUDGET_US, st.overBudget);
+  printf("ACCUM_SOC %.1f %%  ACCUM_SOH %.1f %%  mean SOC %.1f %%  charge %.2f Ah\n", ams.ACCUM_SOC, ams.ACCUM_SOH,
+         est.socMean * 100.0f, est.chargeMas / 3.6e6);
+  if (synth) {
+    double r0Err = 0;
+    for (int i = 0; i < AMS_SOC_CELLS; i++) r0Err += fabs(est.r0[i] - trueR0[i]) / trueR0[i];
+    printf("SOC error: rms %.2f %%, max %.2f %%  R0 error: mean %.1f %%\n", sqrt(sq / errN) * 100.0, worst * 100.0,
+           r0Err / AMS_SOC_CELLS * 100.0);
+  }
+  return 0;
+}
@@ -0,0 +1,145 @@
+// ============================================================================
+// telemetry_bench - host benchmark, per-value printf vs the snapshot encoder
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost telemetry_bench.cpp ../ams_telemetry.cpp ../ams_units.cpp -o telemetry_bench
+// Usage : telemetry_bench [snapshots=20000]
+// The printf path mirrors the teleplot*() functions (one float format per value).
+// Checks that AMS_TLM_ALL produces the same traces within one last digit, then
+// reports bytes and µs per snapshot for printf, AMS_TLM_ALL and AMS_TLM_CHANGED
+// on a slowly drifting pack.
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+#include "ams_can_db.h"
+#include "ams_telemetry.h"
+
+static size_t printfSnapshot(const AMSdata* a, const BMUdata* bmu, char* out, size_t cap) {
+  size_t n = 0;
+  auto put = [&](const char* fmt, auto... args) { n += snprintf(out + n, cap - n, fmt, args...); };
+  put(">AMS_Volt:%.2f\n", amsAccumVoltage(a));
+  put(">AMS_MaxV:%.2f\n", a->ACCUM_MAXVOLTAGE);
+  put(">AMS_MinV:%.2f\n", a->ACCUM_MINVOLTAGE);
+  put(">AMS_OK:%d\n", a->AMS_OK ? 1 : 0);
+  put(">AMS_ChgReady:%d\n", a->ACCUM_CHG_READY ? 1 : 0);
+  put(">AMS_OV_Warn:%d\n>AMS_OV_Crit:%d\n", a->OVERVOLT_WARNING ? 1 : 0, a->OVERVOLT_CRITICAL ? 1 : 0);
+  put(">AMS_LV_Warn:%d\n>AMS_LV_Crit:%d\n", a->LOWVOLT_WARNING ? 1 : 0, a->LOWVOLT_CRITICAL ? 1 : 0);
+  put(">AMS_OT_Warn:%d\n>AMS_OT_Crit:%d\n", a->OVERTEMP_WARNING ? 1 : 0, a->OVERTEMP_CRITICAL ? 1 : 0);
+  put(">AMS_DV_Warn:%d\n>AMS_DV_Crit:%d\n", a->OVERDIV_WARNING ? 1 : 0, a->OVERDIV_CRITICAL ? 1 : 0);
+  for (int m = 0; m < MODULE_NUM; m++) {
+    const BMUdata& b = bmu[m];
+    put(">M%d_Conn:%d\n", m + 1, b.BMUconnected ? 1 : 0);
+    if (!b.BMUconnected) continue;
+    put(">M%d_Volt:%.2f\n", m + 1, b.V_MODULE * DBC_V_MODULE_FACTOR);
+    put(">M%d_DV:%.2f\n", m + 1, b.DV * DBC_DV_FACTOR);
+    put(">M%d_NeedBal:%d\n", m + 1, b.BMUneedBalance ? 1 : 0);
+    for (int c = 0; c < CELL_NUM; c++) put(">M%d_C%d:%.2f\n", m + 1, c + 1, b.V_CELL[c] * DBC_V_CELL_FACTOR);
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++)
+      put(">M%d_T%d:%.1f\n", m + 1, s + 1, b.TEMP_SENSE[s] * DBC_TEMP_SENSE_FACTOR + DBC_TEMP_SENSE_OFFSET);
+    put(">M%d_FaultOV:%d\n", m + 1,
+        __builtin_popcount(b.OVERVOLTAGE_WARNING) + 10 * __builtin_popcount(b.OVERVOLTAGE_CRITICAL));
+    put(">M%d_FaultLV:%d\n", m + 1,
+        __builtin_popcount(b.LOWVOLTAGE_WARNING) + 10 * __builtin_popcount(b.LOWVOLTAGE_CRITICAL));
+    put(">M%d_FaultOT:%d\n", m + 1,
+        __builtin_popcount(b.OVERTEMP_WARNING) + 10 * __builtin_popcount(b.OVERTEMP_CRITICAL));
+    put(">M%d_FaultDV:%d\n", m + 1,
+        __builtin_popcount(b.OVERDIV_VOLTAGE_WARNING) + 10 * __builtin_popcount(b.OVERDIV_VOLTAGE_CRITICAL));
+  }
+  return n;
+}
+
+static std::map<std::string, std::string> parse(const char* buf, size_t len) {
+  std::map<std::string, std::string> traces;
+  std::string s(buf, len);
+  size_t pos = 0;
+  while (pos < s.size()) {
+    size_t nl = s.find('\n', pos), colon = s.find(':', pos);
+    traces[s.substr(pos + 1, colon - pos - 1)] = s.substr(colon + 1, nl - colon - 1);
+    pos = nl + 1;
+  }
+  return traces;
+}
+
+// Same value within one unit of the last printed digit
+static bool close(const std::string& a, const std::string& b) {
+  size_t dot = a.find('.');
+  double lsb = dot == std::string::npos ? 0.5 : pow(10.0, -(double)(a.size() - dot - 1)) * 1.01;
+  return fabs(atof(a.c_str()) - atof(b.c_str())) <= lsb;
+}
+
+static void drift(std::mt19937& rng, AMSdata* ams, BMUdata* bmu) {
+  uint32_t total = 0;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    BMUdata& b = bmu[m];
+    uint16_t sum = 0;
+    for (int c = 0; c < CELL_NUM; c++) {
+      if (rng() % 20 == 0) b.V_CELL[c] += (rng() & 1) ? 1 : -1;  // A few cells move per update
+      sum += b.V_CELL[c];
+    }
+    b.V_MODULE = sum;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++)
+      if (rng() % 10 == 0) b.TEMP_SENSE[s] += (rng() & 1) ? 1 : -1;
+    total += sum;
+  }
+  amsSetAccumVoltage(ams, AmsMillivolts((int32_t)total * 20));
+}
+
+int main(int argc, char** argv) {
+  long snapshots = argc > 1 ? atol(argv[1]) : 20000;
+  std::mt19937 rng(5);
+  static BMUdata bmu[MODULE_NUM];
+  AMSdata ams;
+  for (int m = 0; m < MODULE_NUM; m++) {
+    bmu[m].BMUconnected = true;
+    for (int c = 0; c < CELL_NUM; c++) bmu[m].V_CELL[c] = (uint8_t)(180 + rng() % 10);
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) bmu[m].TEMP_SENSE[s] = (uint16_t)(200 + rng() % 40);
+    bmu[m].DV = (uint8_t)(rng() % 3);
+    bmu[m].OVERDIV_VOLTAGE_WARNING = (uint16_t)(rng() % 4);
+  }
+  drift(rng, &ams, bmu);
+
+  static char ref[16384], buf[AMS_TLM_BUF_BYTES];
+  AmsTelemetryEncoder enc;
+  amsTelemetryInit(&enc);
+  size_t refLen = printfSnapshot(&ams, bmu, ref, sizeof(ref));
+  size_t len = amsTelemetryEncode(&enc, &ams, bmu, buf, sizeof(buf));
+  auto a = parse(ref, refLen), b = parse(buf, len);
+  int diffs = 0;
+  for (auto& kv : a) {
+    auto it = b.find(kv.first);
+    if (it == b.end() || !close(kv.second, it->second)) {
+      if (diffs++ < 5) printf("trace %s: printf %s, encoder %s\n", kv.first.c_str(), kv.second.c_str(),
+                              it == b.end() ? "(missing)" : it->second.c_str());
+    }
+  }
+  printf("%zu traces, %d differ (%zu extra)\n", a.size(), diffs, b.size() - (a.size() - diffs));
+
+  struct Run {
+    const char* name;
+    int kind;  // 0 printf, 1 encoder all, 2 encoder changed
+  } runs[] = {{"printf", 0}, {"AMS_TLM_ALL", 1}, {"AMS_TLM_CHANGED", 2}};
+  for (const Run& r : runs) {
+    std::mt19937 local(9);
+    AmsTelemetryConfig cfg;
+    cfg.mode = r.kind == 2 ? AMS_TLM_CHANGED : AMS_TLM_ALL;
+    amsTelemetryInit(&enc, &cfg);
+    uint64_t bytes = 0;
+    double ns = 0;
+    for (long i = 0; i < snapshots; i++) {
+      drift(local, &ams, bmu);
+      auto t0 = std::chrono::steady_clock::now();
+      size_t n = r.kind == 0 ? printfSnapshot(&ams, bmu, ref, sizeof(ref))
+                             : amsTelemetryEncode(&enc, &ams, bmu, buf, sizeof(buf));
+      ns += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+      bytes += n;
+    }
+    printf("%-16s %7.0f bytes/snapshot  %7.2f us/snapshot\n", r.name, (double)bytes / snapshots,
+           ns / 1000.0 / snapshots);
+  }
+  return diffs != 0;
+}
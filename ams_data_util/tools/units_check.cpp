@@ -0,0 +1,206 @@
+// ============================================================================
+// units_check - host check and benchmark, ams_units.h fixed point vs float
+// ============================================================================
+// Build : g++ -std=c++17 -O2 -I.. -Ihost units_check.cpp ../ams_units.cpp -o units_check
+// Usage : units_check [snapshots=20000]
+// 1. Every code of every raw CAN type formats exactly like a 64 bit rational
+//    reference (round half away from zero). The old float printf path is
+//    compared too; it may only differ on exact ties.
+// 2. Conversions to / from millivolts and the bus encodings, the raw limits.
+// 3. Aggregation, threshold checks and formatting of whole pack snapshots,
+//    float path (as the teleplot / mockAMS code had it) vs fixed point.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include "ams_can_db.h"
+#include "ams_data_util.h"
+
+static long failures = 0;
+
+// (raw + bias) * num / den with `decimals` decimals, straight from the definition
+template <typename Q>
+static void referenceText(long raw, int decimals, char* out, bool* tie) {
+  int64_t n = (int64_t)(raw + Q::bias) * Q::num * amsPow10(decimals);
+  int64_t q = n / Q::den, r = n % Q::den;
+  *tie = 2 * r == Q::den;
+  if (2 * r >= Q::den) q++;
+  int64_t p = amsPow10(decimals);
+  if (decimals) sprintf(out, "%lld.%0*lld", (long long)(q / p), decimals, (long long)(q % p));
+  else sprintf(out, "%lld", (long long)q);
+}
+
+template <typename Q, int Decimals>
+static void checkFormat(const char* name, long codes, float factor, float offset) {
+  long wrong = 0, floatDiff = 0, floatTie = 0;
+  char ref[24], fixed[24], flt[24];
+  for (long raw = 0; raw < codes; raw++) {
+    bool tie;
+    referenceText<Q>(raw, Decimals, ref, &tie);
+    fixed[amsFormat<Decimals>(Q((typename Q::rep)raw), fixed)] = '\0';
+    snprintf(flt, sizeof(flt), "%.*f", Decimals, raw * factor + offset);
+    if (strcmp(ref, fixed) != 0) {
+      if (wrong++ < 3) printf("  %s %ld: fixed %s, reference %s\n", name, raw, fixed, ref);
+    }
+    if (strcmp(ref, flt) != 0) (tie ? floatTie : floatDiff)++;
+  }
+  printf("%-10s %6ld codes  fixed: %ld wrong   float printf: %ld on ties, %ld elsewhere\n", name, codes, wrong,
+         floatTie, floatDiff);
+  failures += wrong;
+}
+
+static void checkConversions() {
+  long wrong = 0;
+  for (int raw = 0; raw < 256; raw++) {
+    AmsMillivolts mv = amsConvert<AmsMillivolts>(AmsCellV((uint8_t)raw));
+    wrong += mv.count != raw * 20;
+    wrong += amsConvert<AmsCellV>(mv).count != raw;
+  }
+  // Bus encodings of ACCUM_VOLTAGE_MV, against the float path they replace
+  long canDiff = 0, binDiff = 0;
+  for (int32_t mv = -1000; mv <= 7000000; mv++) {
+    int64_t can = mv < 0 ? 0 : (mv + 50) / 100, bin = mv < 0 ? 0 : (mv + 5) / 10;
+    if (can > 65535) can = 65535;
+    if (bin > 65535) bin = 65535;
+    wrong += amsConvert<AmsAccumCanV>(AmsMillivolts(mv)).count != can;
+    wrong += amsConvert<AmsAccumBinV>(AmsMillivolts(mv)).count != bin;
+    float f = (mv / 1000.0f) / DBC_ACCUM_VOLTAGE_FACTOR + 0.5f;  // encodeAMSFrame before
+    canDiff += (f <= 0.0f ? 0 : f >= 65535.0f ? 65535 : (int64_t)f) != can;
+    f = (mv / 1000.0f) * 100.0f + 0.5f;  // amsBinPack before
+    binDiff += (f <= 0.0f ? 0 : f >= 65535.0f ? 65535 : (int64_t)f) != bin;
+  }
+  wrong += VMAX_CELL_RAW != 210 || VNOM_CELL_RAW != 185 || VMIN_CELL_RAW != 145 || DVMAX_RAW != 10;
+  wrong += VCELL_RAW(VMAX_CELL) != (uint8_t)(VMAX_CELL / 0.02 + 0.5);
+  printf("conversions: %ld wrong   float path off by one on %ld CAN / %ld binary ACCUM_VOLTAGE codes\n", wrong,
+         canDiff, binDiff);
+  failures += wrong;
+
+  // Threshold decisions, raw compare vs float compare of every V_CELL code
+  long thrDiff = 0;
+  for (int raw = 0; raw < 256; raw++) {
+    AmsCellV v((uint8_t)raw);
+    float f = raw * DBC_V_CELL_FACTOR;
+    thrDiff += (v > AMS_VMAX_CELL) != (f > (float)VMAX_CELL);
+    thrDiff += (v < AMS_VMIN_CELL) != (f < (float)VMIN_CELL);
+  }
+  printf("limits: VMAX %u VMIN %u DVMAX %u raw, float compare disagrees on %ld codes\n", VMAX_CELL_RAW,
+         VMIN_CELL_RAW, DVMAX_RAW, thrDiff);
+}
+
+typedef std::chrono::steady_clock Clock;
+static volatile uint32_t sink;
+
+struct PathTimes {
+  double aggNs, limitNs, fmtNs;
+  size_t bytes;
+};
+
+static PathTimes floatPath(const BMUdata* bmu, long snapshots, char* out) {
+  PathTimes t = {};
+  for (long i = 0; i < snapshots; i++) {
+    const BMUdata* b = bmu + (i & 7) * MODULE_NUM;
+    auto t0 = Clock::now();
+    float total = 0;
+    for (int m = 0; m < MODULE_NUM; m++) total += b[m].V_MODULE * DBC_V_MODULE_FACTOR;
+    auto t1 = Clock::now();
+    uint32_t faults = 0;
+    for (int m = 0; m < MODULE_NUM; m++)
+      for (int c = 0; c < CELL_NUM; c++) {
+        float v = b[m].V_CELL[c] * DBC_V_CELL_FACTOR;
+        faults += (v > VMAX_CELL) + (v < VMIN_CELL);
+      }
+    auto t2 = Clock::now();
+    size_t n = snprintf(out, 32, "%.2f\n", total);
+    for (int m = 0; m < MODULE_NUM; m++) {
+      n += snprintf(out + n, 32, "%.2f\n", b[m].V_MODULE * DBC_V_MODULE_FACTOR);
+      for (int c = 0; c < CELL_NUM; c++) n += snprintf(out + n, 32, "%.2f\n", b[m].V_CELL[c] * DBC_V_CELL_FACTOR);
+      for (int s = 0; s < TEMP_SENSOR_NUM; s++)
+        n += snprintf(out + n, 32, "%.1f\n", b[m].TEMP_SENSE[s] * DBC_TEMP_SENSE_FACTOR + DBC_TEMP_SENSE_OFFSET);
+    }
+    auto t3 = Clock::now();
+    sink = sink + faults + (uint32_t)total;
+    t.aggNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    t.limitNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+    t.fmtNs += std::chrono::duration<double, std::nano>(t3 - t2).count();
+    t.bytes += n;
+  }
+  return t;
+}
+
+static PathTimes fixedPath(const BMUdata* bmu, long snapshots, char* out) {
+  PathTimes t = {};
+  for (long i = 0; i < snapshots; i++) {
+    const BMUdata* b = bmu + (i & 7) * MODULE_NUM;
+    auto t0 = Clock::now();
+    uint32_t raw = 0;
+    for (int m = 0; m < MODULE_NUM; m++) raw += b[m].V_MODULE;
+    AmsMillivolts total = amsConvert<AmsMillivolts>(AmsPackV(raw));
+    auto t1 = Clock::now();
+    uint32_t faults = 0;
+    for (int m = 0; m < MODULE_NUM; m++)
+      for (int c = 0; c < CELL_NUM; c++) {
+        AmsCellV v(b[m].V_CELL[c]);
+        faults += (v > AMS_VMAX_CELL) + (v < AMS_VMIN_CELL);
+      }
+    auto t2 = Clock::now();
+    size_t n = amsFormat<2>(total, out);
+    out[n++] = '\n';
+    for (int m = 0; m < MODULE_NUM; m++) {
+      n += amsFormat<2>(AmsModuleV(b[m].V_MODULE), out + n);
+      out[n++] = '\n';
+      for (int c = 0; c < CELL_NUM; c++) {
+        n += amsFormat<2>(AmsCellV(b[m].V_CELL[c]), out + n);
+        out[n++] = '\n';
+      }
+      for (int s = 0; s < TEMP_SENSOR_NUM; s++) {
+        n += amsFormat<1>(AmsSenseV(b[m].TEMP_SENSE[s]), out + n);
+        out[n++] = '\n';
+      }
+    }
+    auto t3 = Clock::now();
+    sink = sink + faults + (uint32_t)total.count;
+    t.aggNs += std::chrono::duration<double, std::nano>(t1 - t0).count();
+    t.limitNs += std::chrono::duration<double, std::nano>(t2 - t1).count();
+    t.fmtNs += std::chrono::duration<double, std::nano>(t3 - t2).count();
+    t.bytes += n;
+  }
+  return t;
+}
+
+int main(int argc, char** argv) {
+  long snapshots = argc > 1 ? atol(argv[1]) : 20000;
+
+  checkFormat<AmsCellV, 2>("V_CELL", 256, DBC_V_CELL_FACTOR, DBC_V_CELL_OFFSET);
+  checkFormat<AmsModuleV, 2>("V_MODULE", 65536, DBC_V_MODULE_FACTOR, DBC_V_MODULE_OFFSET);
+  checkFormat<AmsDeltaV, 2>("DV", 256, DBC_DV_FACTOR, DBC_DV_OFFSET);
+  checkFormat<AmsSenseV, 1>("TEMP_SENSE", 65536, DBC_TEMP_SENSE_FACTOR, DBC_TEMP_SENSE_OFFSET);
+  checkFormat<AmsMillivolts, 2>("ACCUM mV", 700000, 0.001f, 0.0f);
+  checkConversions();
+
+  // 8 pack snapshots around nominal, cycled so both paths see the same data
+  static BMUdata bmu[8 * MODULE_NUM];
+  std::mt19937 rng(3);
+  for (BMUdata& b : bmu) {
+    uint16_t sum = 0;
+    for (int c = 0; c < CELL_NUM; c++) sum += b.V_CELL[c] = (uint8_t)(140 + rng() % 75);
+    b.V_MODULE = sum;
+    for (int s = 0; s < TEMP_SENSOR_NUM; s++) b.TEMP_SENSE[s] = (uint16_t)(180 + rng() % 90);
+  }
+  static char fbuf[4096], xbuf[4096];
+  PathTimes f = floatPath(bmu, snapshots, fbuf);
+  PathTimes x = fixedPath(bmu, snapshots, xbuf);
+  bool same = f.bytes == x.bytes && memcmp(fbuf, xbuf, f.bytes / snapshots) == 0;
+  printf("%d modules x %d cells, %ld snapshots (ns per snapshot)   float   fixed\n", MODULE_NUM, CELL_NUM,
+         snapshots);
+  printf("  aggregate ACCUM_VOLTAGE                             %7.1f %7.1f\n", f.aggNs / snapshots,
+         x.aggNs / snapshots);
+  printf("  cell limit checks                                   %7.1f %7.1f\n", f.limitNs / snapshots,
+         x.limitNs / snapshots);
+  printf("  format %3d values                                   %7.1f %7.1f\n", 1 + MODULE_NUM * (1 + CELL_NUM + TEMP_SENSOR_NUM),
+         f.fmtNs / snapshots, x.fmtNs / snapshots);
+  printf("  output text %s\n", same ? "identical" : "differs (ties, see above)");
+  printf("%s\n", failures ? "FAIL" : "OK");
+  return failures != 0;
+}